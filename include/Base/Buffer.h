@@ -32,37 +32,105 @@
 #include "Base/Exception.h"
 #include <cstring>
 #include <cstddef>
+#include <type_traits>
 
 namespace Technosoftware
 {
     namespace Base
     {
+        /**
+         * @class   BufferInlineStorage
+         *
+         * @brief   The storage of a Buffer for up to InlineCapacity elements held in the Buffer object
+         *          itself, aligned to Alignment bytes or the alignment of T, whichever is larger.
+         *          Used only internally.
+         */
+
+        template <class T, std::size_t Alignment, std::size_t InlineCapacity>
+        class BufferInlineStorage
+        {
+        protected:
+            T* GetInlineStorage()
+            {
+                return reinterpret_cast<T*>(inline_);
+            }
+
+            const T* GetInlineStorage() const
+            {
+                return reinterpret_cast<const T*>(inline_);
+            }
+
+        private:
+            alignas(Alignment > std::alignment_of<T>::value ? Alignment : std::alignment_of<T>::value) char inline_[InlineCapacity * sizeof(T)];
+        };
+
+        /**
+         * @class   BufferInlineStorage<T, Alignment, 0>
+         *
+         * @brief   Specialization for Buffers without inline storage; it adds neither size nor alignment
+         *          to the Buffer. Used only internally.
+         */
+
+        template <class T, std::size_t Alignment>
+        class BufferInlineStorage<T, Alignment, 0>
+        {
+        protected:
+            T* GetInlineStorage()
+            {
+                return 0;
+            }
+
+            const T* GetInlineStorage() const
+            {
+                return 0;
+            }
+        };
+
         /**
          * @class   Buffer
          *
          * @brief   A buffer class that allocates a buffer of a given type and size in the constructor
          *          and deallocates the buffer in the destructor.
          *          
-         *          This class is useful everywhere where a temporary buffer is needed.
+         *          This class is useful everywhere where a temporary buffer is needed, like the arrays
+         *          of handles, values or timestamps of a batch call.
+         *
+         *          The elements are copied with memcpy() and are never constructed or initialized,
+         *          neither by the constructor nor by Resize(); T must be a trivially copyable type.
+         *          Clear() sets the content to zero.
+         *
+         *          The storage is aligned to Alignment bytes (e.g. 32 or 64 for SIMD code or to start
+         *          at a cache line); 0 selects the alignment of T. Up to InlineCapacity elements are
+         *          stored in the Buffer object itself, so that small batches don't allocate memory at
+         *          all; the alignment of the inline storage is only guaranteed for Buffer objects on
+         *          the stack or in static storage. With the default InlineCapacity of 0 there is no
+         *          inline storage, and the Buffer has the size and alignment of its members.
+         *
+         * @tparam  T               The element type.
+         * @tparam  Alignment       The alignment of the storage in bytes, a power of two or 0.
+         * @tparam  InlineCapacity  The number of elements stored without allocation.
          *
          * @ingroup BaseCore
          */
 
-        template <class T>
-        class Buffer
+        template <class T, std::size_t Alignment = 0, std::size_t InlineCapacity = 0>
+        class Buffer : private BufferInlineStorage<T, Alignment, InlineCapacity>
         {
         public:
+            enum
+            {
+                ALIGNMENT = Alignment > std::alignment_of<T>::value ? Alignment : std::alignment_of<T>::value
+            };
+
             Buffer(std::size_t capacity) :
-                capacity_(capacity),
+                capacity_(0),
                 used_(capacity),
                 ptr_(0),
+                memory_(0),
                 ownMem_(true)
                 /// Creates and allocates the Buffer.
             {
-                if (capacity > 0)
-                {
-                    ptr_ = new T[capacity];
-                }
+                ptr_ = Allocate(capacity, memory_, capacity_);
             }
 
             /**
@@ -81,6 +149,7 @@ namespace Technosoftware
                 capacity_(length),
                 used_(length),
                 ptr_(pMem),
+                memory_(0),
                 ownMem_(false)
             {
             }
@@ -97,14 +166,15 @@ namespace Technosoftware
              */
 
             Buffer(const T* pMem, std::size_t length) :
-                capacity_(length),
+                capacity_(0),
                 used_(length),
                 ptr_(0),
+                memory_(0),
                 ownMem_(true)
             {
-                if (capacity_ > 0)
+                ptr_ = Allocate(length, memory_, capacity_);
+                if (used_ > 0)
                 {
-                    ptr_ = new T[capacity_];
                     std::memcpy(ptr_, pMem, used_ * sizeof(T));
                 }
             }
@@ -118,14 +188,15 @@ namespace Technosoftware
              */
 
             Buffer(const Buffer& other) :
-                capacity_(other.used_),
+                capacity_(0),
                 used_(other.used_),
                 ptr_(0),
+                memory_(0),
                 ownMem_(true)
             {
-                if (used_)
+                ptr_ = Allocate(used_, memory_, capacity_);
+                if (used_ > 0)
                 {
-                    ptr_ = new T[used_];
                     std::memcpy(ptr_, other.ptr_, used_ * sizeof(T));
                 }
             }
@@ -145,7 +216,7 @@ namespace Technosoftware
                 if (this != &other)
                 {
                     Buffer tmp(other);
-                    swap(tmp);
+                    Swap(tmp);
                 }
 
                 return *this;
@@ -159,7 +230,7 @@ namespace Technosoftware
 
             ~Buffer()
             {
-                if (ownMem_) delete[] ptr_;
+                delete[] memory_;
             }
 
             /**
@@ -170,6 +241,10 @@ namespace Technosoftware
              *          smaller than the current one; if it is smaller, capacity will remain intact. Size
              *          will always be set to the new capacity.
              *          
+             *          New elements are not initialized. With preserveContent false, a buffer reused for
+             *          batches of varying size only allocates memory when a batch exceeds the capacity and
+             *          never copies or initializes elements.
+             *          
              *          Buffers only wrapping externally owned storage can not be resized. If resize is
              *          attempted on those, IllegalAccessException is thrown.
              *
@@ -186,14 +261,17 @@ namespace Technosoftware
 
                 if (newCapacity > capacity_)
                 {
-                    T* ptr = new T[newCapacity];
-                    if (preserveContent)
+                    char* memory = 0;
+                    std::size_t capacity = 0;
+                    T* ptr = Allocate(newCapacity, memory, capacity);
+                    if (preserveContent && used_ > 0)
                     {
                         std::memcpy(ptr, ptr_, used_ * sizeof(T));
                     }
-                    delete[] ptr_;
+                    delete[] memory_;
+                    memory_ = memory;
                     ptr_ = ptr;
-                    capacity_ = newCapacity;
+                    capacity_ = capacity;
                 }
 
                 used_ = newCapacity;
@@ -205,7 +283,8 @@ namespace Technosoftware
              * @brief   Sets the buffer capacity. If preserveContent is true, the content of the old buffer
              *          is copied over to the new buffer. The new capacity can be larger or smaller than the
              *          current one; size will be set to the new capacity only if new capacity is smaller
-             *          than the current size, otherwise it will remain intact.
+             *          than the current size, otherwise it will remain intact. The capacity never drops
+             *          below InlineCapacity.
              *          
              *          Buffers only wrapping externally owned storage can not be resized. If resize is
              *          attempted on those, IllegalAccessException is thrown.
@@ -223,19 +302,21 @@ namespace Technosoftware
 
                 if (newCapacity != capacity_)
                 {
-                    T* ptr = 0;
-                    if (newCapacity > 0)
+                    char* memory = 0;
+                    std::size_t capacity = 0;
+                    T* ptr = Allocate(newCapacity, memory, capacity);
+                    if (ptr != ptr_)
                     {
-                        ptr = new T[newCapacity];
-                        if (preserveContent)
+                        std::size_t newSz = used_ < newCapacity ? used_ : newCapacity;
+                        if (preserveContent && newSz > 0)
                         {
-                            std::size_t newSz = used_ < newCapacity ? used_ : newCapacity;
                             std::memcpy(ptr, ptr_, newSz * sizeof(T));
                         }
+                        delete[] memory_;
+                        memory_ = memory;
+                        ptr_ = ptr;
                     }
-                    delete[] ptr_;
-                    ptr_ = ptr;
-                    capacity_ = newCapacity;
+                    capacity_ = capacity;
 
                     if (newCapacity < used_) used_ = newCapacity;
                 }
@@ -253,7 +334,7 @@ namespace Technosoftware
             void Assign(const T* buf, std::size_t sz)
             {
                 if (0 == sz) return;
-                if (sz > capacity_) resize(sz, false);
+                if (sz > capacity_) Resize(sz, false);
                 std::memcpy(ptr_, buf, sz * sizeof(T));
                 used_ = sz;
             }
@@ -270,7 +351,7 @@ namespace Technosoftware
             void Append(const T* buf, std::size_t sz)
             {
                 if (0 == sz) return;
-                resize(used_ + sz, true);
+                Resize(used_ + sz, true);
                 std::memcpy(ptr_ + used_ - sz, buf, sz * sizeof(T));
             }
 
@@ -284,7 +365,7 @@ namespace Technosoftware
 
             void Append(T val)
             {
-                resize(used_ + 1, true);
+                Resize(used_ + 1, true);
                 ptr_[used_ - 1] = val;
             }
 
@@ -298,7 +379,7 @@ namespace Technosoftware
 
             void Append(const Buffer& buf)
             {
-                append(buf.begin(), buf.size());
+                Append(buf.Begin(), buf.GetSize());
             }
 
             /**
@@ -327,10 +408,23 @@ namespace Technosoftware
                 return capacity_ * sizeof(T);
             }
 
+            /**
+             * @fn  bool Buffer::IsInline() const
+             *
+             * @brief   Returns true if the content is stored in the Buffer object itself.
+             *
+             * @return  true if no memory has been allocated for the content.
+             */
+
+            bool IsInline() const
+            {
+                return InlineCapacity > 0 && ptr_ == this->GetInlineStorage();
+            }
+
             /**
              * @fn  void Buffer::Swap(Buffer& other)
              *
-             * @brief   Swaps the buffer with another one.
+             * @brief   Swaps the buffer with another one. Content stored inline is copied.
              *
              * @param [in,out]  other   The other.
              */
@@ -339,9 +433,18 @@ namespace Technosoftware
             {
                 using std::swap;
 
-                Swap(ptr_, other.ptr_);
-                Swap(capacity_, other.capacity_);
-                Swap(used_, other.used_);
+                if (IsInline() || other.IsInline())
+                {
+                    Buffer tmp(other);
+                    other.CopyFrom(*this);
+                    CopyFrom(tmp);
+                    return;
+                }
+                swap(ptr_, other.ptr_);
+                swap(memory_, other.memory_);
+                swap(capacity_, other.capacity_);
+                swap(used_, other.used_);
+                swap(ownMem_, other.ownMem_);
             }
 
             /**
@@ -360,7 +463,7 @@ namespace Technosoftware
                 {
                     if (used_ == other.used_)
                     {
-                        if (std::memcmp(ptr_, other.ptr_, used_ * sizeof(T)) == 0)
+                        if (used_ == 0 || std::memcmp(ptr_, other.ptr_, used_ * sizeof(T)) == 0)
                         {
                             return true;
                         }
@@ -394,7 +497,10 @@ namespace Technosoftware
 
             void Clear()
             {
-                std::memset(ptr_, 0, used_ * sizeof(T));
+                if (used_ > 0)
+                {
+                    std::memset(ptr_, 0, used_ * sizeof(T));
+                }
             }
 
             /**
@@ -505,9 +611,52 @@ namespace Technosoftware
         private:
             Buffer();
 
+            static_assert((ALIGNMENT & (ALIGNMENT - 1)) == 0, "Buffer alignment must be a power of two");
+            static_assert(std::is_trivially_copyable<T>::value, "Buffer elements are copied with memcpy() and must be trivially copyable");
+
+            // Returns storage for count elements: the inline storage if it is large enough, else aligned
+            // memory allocated into memory. Used only internally.
+            T* Allocate(std::size_t count, char*& memory, std::size_t& capacity)
+            {
+                memory = 0;
+                if (InlineCapacity > 0 && count <= InlineCapacity)
+                {
+                    capacity = InlineCapacity;
+                    return this->GetInlineStorage();
+                }
+                capacity = count;
+                if (count == 0)
+                {
+                    return 0;
+                }
+                memory = new char[count * sizeof(T) + ALIGNMENT - 1];
+                std::size_t misalignment = reinterpret_cast<std::size_t>(memory) & (ALIGNMENT - 1);
+                return reinterpret_cast<T*>(memory + (misalignment == 0 ? 0 : ALIGNMENT - misalignment));
+            }
+
+            void CopyFrom(const Buffer& other)
+            {
+                if (ownMem_)
+                {
+                    Resize(other.used_, false);
+                }
+                else
+                {
+                    // Wrapped memory is replaced by storage of our own.
+                    ownMem_ = true;
+                    ptr_ = Allocate(other.used_, memory_, capacity_);
+                    used_ = other.used_;
+                }
+                if (used_ > 0)
+                {
+                    std::memcpy(ptr_, other.ptr_, used_ * sizeof(T));
+                }
+            }
+
             std::size_t capacity_;
             std::size_t used_;
             T*          ptr_;
+            char*       memory_;        // Allocated memory holding the aligned elements, 0 if inline or not owned
             bool        ownMem_;
         };
 
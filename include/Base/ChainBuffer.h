@@ -0,0 +1,311 @@
+/*
+ * Copyright (c) 2011-2021 Technosoftware GmbH. All rights reserved
+ * Web: https://technosoftware.com
+ *
+ * Purpose:
+ * Definition of the ChainBuffer class.
+ *
+ * The source code in this file is covered under a dual-license scenario:
+ *   - Owner of a purchased license: SCLA 1.0
+ *   - GPL V3: everybody else
+ *
+ * SCLA license terms accompanied with this source code.
+ * See SCLA 1.0: https://technosoftware.com/license/Source_Code_License_Agreement.pdf
+ *
+ * GNU General Public License as published by the Free Software Foundation;
+ * version 3 of the License are accompanied with this source code.
+ * See https://technosoftware.com/license/GPLv3License.txt
+ *
+ * This source code is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#ifndef TECHNOSOFTWARE_CHAINBUFFER_H
+#define TECHNOSOFTWARE_CHAINBUFFER_H
+
+#include "Base/Base.h"
+#include "Base/Bugcheck.h"
+
+#include <cstddef>
+#include <cstring>
+
+namespace Technosoftware
+{
+    namespace Base
+    {
+        /**
+         * @class   ChainBuffer
+         *
+         * @brief   A growable output buffer of bytes made of a chain of segments, for building records
+         *          and exports which are written to a file or socket as a whole.
+         *
+         *          Unlike MemoryOutputStream, a ChainBuffer is not limited to a buffer supplied by the
+         *          caller and has no stream buffer and locale overhead. Unlike a std::vector, growing
+         *          it never moves the data written so far: a new segment is added to the chain instead.
+         *          Pointers returned by Reserve() therefore stay valid until Clear(), which allows
+         *          writing a header first and filling it in when the size of the record is known.
+         *
+         *          Data is written either by copying it with Append(), or directly into the buffer with
+         *          Reserve() followed by Commit(). The content is exported without copying with
+         *          Gather(), which fills IoVec entries for writev() or one write per segment, or copied
+         *          into contiguous memory with CopyTo().
+         *
+         *          Clear() keeps the segments for reuse, a buffer which is cleared and refilled with
+         *          records of similar size doesn't allocate memory after the first record.
+         *
+         * @ingroup BaseCore
+         */
+
+        class TECHNOSOFTWARE_API ChainBuffer
+        {
+        public:
+
+            /**
+             * @struct  IoVec
+             *
+             * @brief   Describes one contiguous part of the content. Has the layout of the POSIX struct
+             *          iovec and can be passed to writev() with a cast.
+             */
+
+            struct IoVec
+            {
+                void*       base;
+                std::size_t length;
+            };
+
+            enum
+            {
+                DEFAULT_SEGMENT_SIZE = 4096
+            };
+
+            /**
+             * @fn  explicit ChainBuffer::ChainBuffer(std::size_t segmentSize = DEFAULT_SEGMENT_SIZE);
+             *
+             * @brief   Creates an empty ChainBuffer. No memory is allocated until data is written.
+             *
+             * @param   segmentSize The size of the segments. Larger segments are allocated for reservations
+             *                      which don't fit into a segment of this size.
+             */
+
+            explicit ChainBuffer(std::size_t segmentSize = DEFAULT_SEGMENT_SIZE);
+
+            /**
+             * @fn  ChainBuffer::~ChainBuffer();
+             *
+             * @brief   Destroys the ChainBuffer and frees all segments.
+             */
+
+            ~ChainBuffer();
+
+            /**
+             * @fn  char* ChainBuffer::Reserve(std::size_t length);
+             *
+             * @brief   Returns a pointer to at least length bytes of contiguous memory at the end of the
+             *          buffer. The bytes become part of the content when they are committed with Commit().
+             *          If the current segment has not enough space left, the remaining space is left
+             *          unused and the next segment is used.
+             *
+             * @param   length  The number of bytes to reserve.
+             *
+             * @return  A pointer to the reserved memory, valid until Clear() or the destruction of the
+             *          buffer.
+             */
+
+            char* Reserve(std::size_t length);
+
+            /**
+             * @fn  void ChainBuffer::Commit(std::size_t length);
+             *
+             * @brief   Appends length bytes written into the memory returned by the last Reserve() to the
+             *          content.
+             *
+             * @param   length  The number of bytes written, at most the number of bytes reserved.
+             */
+
+            void Commit(std::size_t length);
+
+            /**
+             * @fn  void ChainBuffer::Append(const void* data, std::size_t length);
+             *
+             * @brief   Copies data to the end of the buffer. The data may be split over segments.
+             *
+             * @param   data    The data.
+             * @param   length  The number of bytes.
+             */
+
+            void Append(const void* data, std::size_t length);
+
+            /**
+             * @fn  std::size_t ChainBuffer::Size() const;
+             *
+             * @brief   Returns the number of bytes of the content.
+             *
+             * @return  The number of bytes.
+             */
+
+            std::size_t Size() const;
+
+            /**
+             * @fn  bool ChainBuffer::IsEmpty() const;
+             *
+             * @brief   Returns true if the buffer has no content.
+             *
+             * @return  true if empty, false if not.
+             */
+
+            bool IsEmpty() const;
+
+            /**
+             * @fn  void ChainBuffer::Clear();
+             *
+             * @brief   Removes the content. The segments are kept and reused by the following writes.
+             */
+
+            void Clear();
+
+            /**
+             * @fn  std::size_t ChainBuffer::GetSegmentCount() const;
+             *
+             * @brief   Returns the number of segments holding content, which is the number of IoVec
+             *          entries needed by Gather().
+             *
+             * @return  The number of segments holding content.
+             */
+
+            std::size_t GetSegmentCount() const;
+
+            /**
+             * @fn  std::size_t ChainBuffer::Gather(IoVec* vectors, std::size_t count) const;
+             *
+             * @brief   Describes the content as a list of contiguous parts, in order.
+             *
+             * @param [out] vectors The IoVec entries to fill.
+             * @param       count   The number of entries available.
+             *
+             * @return  The number of entries filled. If it is less than GetSegmentCount(), only the first
+             *          part of the content has been described.
+             */
+
+            std::size_t Gather(IoVec* vectors, std::size_t count) const;
+
+            /**
+             * @fn  template <class F> bool ChainBuffer::ForEachSegment(F function) const;
+             *
+             * @brief   Calls a function for each contiguous part of the content, in order.
+             *
+             * @param   function    A function or functor called with a const char* and a std::size_t,
+             *                      returning false to stop.
+             *
+             * @return  false if the function returned false, true otherwise.
+             */
+
+            template <class F>
+            bool ForEachSegment(F function) const;
+
+            /**
+             * @fn  void ChainBuffer::CopyTo(void* destination) const;
+             *
+             * @brief   Copies the content into contiguous memory.
+             *
+             * @param [out] destination The memory, at least Size() bytes.
+             */
+
+            void CopyTo(void* destination) const;
+
+        private:
+            ChainBuffer(const ChainBuffer&);
+            ChainBuffer& operator = (const ChainBuffer&);
+
+            struct Segment
+            {
+                Segment*    next;
+                std::size_t capacity;
+                std::size_t used;
+
+                char* Data()
+                {
+                    return reinterpret_cast<char*>(this + 1);
+                }
+            };
+
+            char* NextSegment(std::size_t length);
+            void AppendSegments(const char* data, std::size_t length);
+
+            Segment*    head_;
+            Segment*    tail_;          // Segment written to; all following segments are empty
+            std::size_t size_;
+            std::size_t segmentSize_;
+        };
+
+
+        //
+        // inlines
+        //
+
+        inline char* ChainBuffer::Reserve(std::size_t length)
+        {
+            if (tail_ && tail_->capacity - tail_->used >= length)
+            {
+                return tail_->Data() + tail_->used;
+            }
+            return NextSegment(length);
+        }
+
+
+        inline void ChainBuffer::Commit(std::size_t length)
+        {
+            technosoftware_assert_dbg(tail_ ? tail_->used + length <= tail_->capacity : length == 0);
+            if (length)
+            {
+                tail_->used += length;
+                size_ += length;
+            }
+        }
+
+
+        inline void ChainBuffer::Append(const void* data, std::size_t length)
+        {
+            if (tail_ && tail_->capacity - tail_->used >= length)
+            {
+                std::memcpy(tail_->Data() + tail_->used, data, length);
+                tail_->used += length;
+                size_ += length;
+                return;
+            }
+            AppendSegments(static_cast<const char*>(data), length);
+        }
+
+
+        inline std::size_t ChainBuffer::Size() const
+        {
+            return size_;
+        }
+
+
+        inline bool ChainBuffer::IsEmpty() const
+        {
+            return size_ == 0;
+        }
+
+
+        template <class F>
+        inline bool ChainBuffer::ForEachSegment(F function) const
+        {
+            for (Segment* segment = head_; segment; segment = segment->next)
+            {
+                if (segment->used && !function(const_cast<const char*>(segment->Data()), segment->used))
+                {
+                    return false;
+                }
+                if (segment == tail_)
+                {
+                    break;
+                }
+            }
+            return true;
+        }
+    }
+}
+
+#endif /* TECHNOSOFTWARE_CHAINBUFFER_H */
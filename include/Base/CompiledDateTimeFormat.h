@@ -0,0 +1,129 @@
+/*
+ * Copyright (c) 2011-2021 Technosoftware GmbH. All rights reserved
+ * Web: https://www.technosoftware.com
+ *
+ * The source code in this file is covered under a dual-license scenario:
+ *   - Owner of a purchased license: SCLA 1.0
+ *   - GPL V3: everybody else
+ *
+ * SCLA license terms accompanied with this source code.
+ * See SCLA 1.0: https://technosoftware.com/license/Source_Code_License_Agreement.pdf
+ *
+ * GNU General Public License as published by the Free Software Foundation;
+ * version 3 of the License are accompanied with this source code.
+ * See https://technosoftware.com/license/GPLv3License.txt
+ *
+ * This source code is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#ifndef TECHNOSOFTWARE_COMPILEDDATETIMEFORMAT_H
+#define TECHNOSOFTWARE_COMPILEDDATETIMEFORMAT_H
+
+#include "Base/Base.h"
+#include "Base/Timestamp.h"
+#include "Base/DateTimeFormatter.h"
+
+#include <string>
+#include <vector>
+
+namespace Technosoftware
+{
+    namespace Base
+    {
+        /**
+         * @class   CompiledDateTimeFormat
+         *
+         * @brief   Formats timestamps with a format string which is parsed only once.
+         *
+         *          The format string uses the same special characters as DateTimeFormatter::Format() and
+         *          produces the same output. The format is split into the part which changes at most once
+         *          per second and the sub-second fields (%i, %c, %F and the fraction of %s), which have a
+         *          fixed width. The rendered text of the last second is cached, so formatting consecutive
+         *          timestamps of the same second only writes the sub-second digits.
+         *
+         *          Because of the cache an instance must not be used by several threads at the same time.
+         *
+         * @ingroup BaseDateTime
+         */
+
+        class TECHNOSOFTWARE_API CompiledDateTimeFormat
+        {
+        public:
+
+            /**
+             * @fn  CompiledDateTimeFormat::CompiledDateTimeFormat(const std::string& fmt, int timeZoneDifferential = DateTimeFormatter::UTC);
+             *
+             * @brief   Parses the format.
+             *
+             * @param   fmt                     Describes the format to use, see DateTimeFormatter::Format().
+             * @param   timeZoneDifferential    (Optional) The time zone differential used for %z and %Z.
+             */
+
+            CompiledDateTimeFormat(const std::string& fmt, int timeZoneDifferential = DateTimeFormatter::UTC);
+
+            /**
+             * @fn  CompiledDateTimeFormat::~CompiledDateTimeFormat();
+             *
+             * @brief   Destructor.
+             */
+
+            ~CompiledDateTimeFormat();
+
+            /**
+             * @fn  std::size_t CompiledDateTimeFormat::Format(const Timestamp& timestamp, char* buffer, std::size_t size);
+             *
+             * @brief   Formats the given timestamp into a buffer. The result is not zero terminated.
+             *
+             * @param           timestamp   The timestamp.
+             * @param [out]     buffer      The buffer.
+             * @param           size        The size of the buffer in bytes.
+             *
+             * @return  The number of characters written or 0 if the buffer is too small.
+             */
+
+            std::size_t Format(const Timestamp& timestamp, char* buffer, std::size_t size);
+
+            /**
+             * @fn  void CompiledDateTimeFormat::Append(std::string& str, const Timestamp& timestamp);
+             *
+             * @brief   Formats the given timestamp and appends it to str.
+             *
+             * @param [in,out]  str         The string.
+             * @param           timestamp   The timestamp.
+             */
+
+            void Append(std::string& str, const Timestamp& timestamp);
+
+        private:
+            CompiledDateTimeFormat(const CompiledDateTimeFormat&);
+            CompiledDateTimeFormat& operator = (const CompiledDateTimeFormat&);
+
+            struct Segment
+            {
+                char            field;      // Sub-second field or 0 for a per-second part
+                std::string     format;     // Format of a per-second part for DateTimeFormatter
+            };
+
+            struct SubSecondField
+            {
+                std::size_t     offset;
+                char            field;
+            };
+
+            void Render(Timestamp::TimeVal second);
+            void WriteSubSecondFields(char* buffer, Timestamp::TimeVal microsecond) const;
+
+            std::vector<Segment>    segments_;
+            int                     timeZoneDifferential_;
+
+            std::string             cache_;         // Rendered text of cachedSecond_
+            std::vector<SubSecondField> subSecondFields_; // Positions in cache_
+            Timestamp::TimeVal      cachedSecond_;
+            bool                    cacheValid_;
+        };
+    }
+}
+
+#endif /* TECHNOSOFTWARE_COMPILEDDATETIMEFORMAT_H */
@@ -529,6 +529,72 @@ namespace Technosoftware
 
             static bool IsValid(int year, int month, int day, int hour = 0, int minute = 0, int second = 0, int millisecond = 0, int microsecond = 0);
 
+            /**
+             * @fn  static Int64 DateTime::DaysFromCivil(int year, int month, int day);
+             *
+             * @brief   Returns the number of days between the Unix epoch (January 1, 1970) and the given
+             *          Gregorian calendar date. Dates before the epoch give negative values.
+             *          
+             *          The computation uses integer arithmetic only and takes constant time. See
+             *          http://howardhinnant.github.io/date_algorithms.html for the algorithm.
+             *
+             * @param   year    The year.
+             * @param   month   The month (1 to 12).
+             * @param   day     The day (1 to 31).
+             *
+             * @return  The number of days since the Unix epoch.
+             */
+
+            static Int64 DaysFromCivil(int year, int month, int day);
+
+            /**
+             * @fn  static void DateTime::CivilFromDays(Int64 days, int& year, int& month, int& day);
+             *
+             * @brief   Computes the Gregorian calendar date for the given number of days since the Unix
+             *          epoch. This is the inverse of DaysFromCivil().
+             *
+             * @param           days    The number of days since the Unix epoch.
+             * @param [out]     year    The year.
+             * @param [out]     month   The month (1 to 12).
+             * @param [out]     day     The day (1 to 31).
+             */
+
+            static void CivilFromDays(Int64 days, int& year, int& month, int& day);
+
+            /**
+             * @struct  Fields
+             *
+             * @brief   The calendar fields of a timestamp, see Decompose().
+             */
+
+            struct Fields
+            {
+                short  year;
+                short  month;
+                short  day;
+                short  hour;
+                short  minute;
+                short  second;
+                short  millisecond;
+                short  microsecond;
+            };
+
+            /**
+             * @fn  static void DateTime::Decompose(const Timestamp* timestamps, std::size_t count, Fields* fields);
+             *
+             * @brief   Decomposes an array of timestamps into their calendar fields (UTC) in one pass.
+             *          
+             *          The loop has no branches depending on the values and uses integer arithmetic only,
+             *          so the compiler can vectorize it. Use this instead of constructing a DateTime for
+             *          each timestamp when many timestamps must be converted.
+             *
+             * @param           timestamps  The timestamps.
+             * @param           count       The number of timestamps.
+             * @param [out]     fields      Receives count calendar fields.
+             */
+
+            static void Decompose(const Timestamp* timestamps, std::size_t count, Fields* fields);
+
         protected:
 
             /**
@@ -594,6 +660,14 @@ namespace Technosoftware
 
             void ComputeDaytime();
 
+            /**
+             * @fn  void DateTime::ComputeFields();
+             *
+             * @brief   Computes all date and time fields from the stored utcTime with integer arithmetic.
+             */
+
+            void ComputeFields();
+
         private:
             void CheckLimit(short& lower, short& higher, short limit);
             ///utility functions used to correct the overflow in computeGregorian
@@ -168,6 +168,72 @@ namespace Technosoftware
 
             static bool TryParse(const std::string& str, DateTime& dateTime, int& timeZoneDifferential);
 
+            /**
+             * @fn  static bool DateTimeParser::ParseISO8601(const char* str, std::size_t length, Timestamp::UtcTimeVal& utcTime) noexcept;
+             *
+             * @brief   Parses an ISO 8601 date and time in extended format without using the generic
+             *          format interpreter. Never throws.
+             *          
+             *          Accepted is YYYY-MM-DD, optionally followed by 'T' or a space and hh:mm, hh:mm:ss or
+             *          hh:mm:ss.f with one or more fraction digits ('.' or ','), optionally followed by a
+             *          time zone designator 'Z', +hh, +hhmm or +hh:mm (or '-'). Without time zone designator
+             *          the time is taken as UTC. The whole string must match; the digit positions are
+             *          validated eight characters at a time.
+             *
+             * @param           str     The string.
+             * @param           length  The length of the string.
+             * @param [out]     utcTime Receives the UTC time in 100 nanosecond resolution. Fraction digits
+             *                          beyond the seventh are ignored.
+             *
+             * @return  true if it succeeds, false if the string is not a valid ISO 8601 date and time.
+             */
+
+            static bool ParseISO8601(const char* str, std::size_t length, Timestamp::UtcTimeVal& utcTime) noexcept;
+
+            /**
+             * @fn  static bool DateTimeParser::ParseISO8601(const char* str, std::size_t length, Timestamp& timestamp) noexcept;
+             *
+             * @brief   Parses an ISO 8601 date and time into a timestamp. Never throws. See
+             *          ParseISO8601(const char*, std::size_t, Timestamp::UtcTimeVal&) for the accepted format.
+             *          Fraction digits beyond the sixth are ignored.
+             *
+             * @param           str         The string.
+             * @param           length      The length of the string.
+             * @param [out]     timestamp   Receives the timestamp.
+             *
+             * @return  true if it succeeds, false if the string is not a valid ISO 8601 date and time.
+             */
+
+            static bool ParseISO8601(const char* str, std::size_t length, Timestamp& timestamp) noexcept;
+
+            /**
+             * @fn  static bool DateTimeParser::ParseISO8601(const std::string& str, Timestamp& timestamp) noexcept;
+             *
+             * @brief   Parses an ISO 8601 date and time into a timestamp. Never throws.
+             *
+             * @param           str         The string.
+             * @param [out]     timestamp   Receives the timestamp.
+             *
+             * @return  true if it succeeds, false if the string is not a valid ISO 8601 date and time.
+             */
+
+            static bool ParseISO8601(const std::string& str, Timestamp& timestamp) noexcept;
+
+            /**
+             * @fn  static std::size_t DateTimeParser::ParseISO8601(const std::string* strings, std::size_t count, Timestamp* timestamps, bool* valid) noexcept;
+             *
+             * @brief   Parses an array of ISO 8601 dates and times. Never throws.
+             *
+             * @param           strings     The strings.
+             * @param           count       The number of strings.
+             * @param [out]     timestamps  Receives count timestamps. Invalid strings give a zero timestamp.
+             * @param [out]     valid       (Optional) Receives count flags whether the string was valid.
+             *
+             * @return  The number of valid strings.
+             */
+
+            static std::size_t ParseISO8601(const std::string* strings, std::size_t count, Timestamp* timestamps, bool* valid) noexcept;
+
             /**
              * @fn  static int DateTimeParser::ParseMonth(std::string::const_iterator& it, const std::string::const_iterator& end);
              *
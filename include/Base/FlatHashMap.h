@@ -0,0 +1,697 @@
+/*
+ * Copyright (c) 2011-2021 Technosoftware GmbH. All rights reserved
+ * Web: https://www.technosoftware.com
+ *
+ * The source code in this file is covered under a dual-license scenario:
+ *   - Owner of a purchased license: SCLA 1.0
+ *   - GPL V3: everybody else
+ *
+ * SCLA license terms accompanied with this source code.
+ * See SCLA 1.0: https://technosoftware.com/license/Source_Code_License_Agreement.pdf
+ *
+ * GNU General Public License as published by the Free Software Foundation;
+ * version 3 of the License are accompanied with this source code.
+ * See https://technosoftware.com/license/GPLv3License.txt
+ *
+ * This source code is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#ifndef TECHNOSOFTWARE_FLATHASHMAP_H
+#define TECHNOSOFTWARE_FLATHASHMAP_H
+
+#include "Base/Base.h"
+#include "Base/Hash.h"
+#include "Base/HashMap.h"
+#include "Base/HashStatistic.h"
+#include "Base/Exception.h"
+
+#include <cstring>
+#include <iterator>
+#include <new>
+#include <utility>
+#include <vector>
+
+#if defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+#include <emmintrin.h>
+#define TECHNOSOFTWARE_FLATHASHMAP_SSE2
+#endif
+
+namespace Technosoftware
+{
+    namespace Base
+    {
+        /**
+         * @class   FlatHashMapGroup
+         *
+         * @brief   Matches 16 control bytes of a FlatHashMap at once. Used internally by FlatHashMap.
+         *
+         *          A control byte is EMPTY, DELETED or, for a used slot, the lower 7 bits of the hash
+         *          of its key. The match functions return a bit mask with bit i set if control byte i
+         *          matches.
+         *
+         * @ingroup Hashing
+         */
+
+        class FlatHashMapGroup
+        {
+        public:
+            enum
+            {
+                WIDTH   = 16,
+                EMPTY   = -128,
+                DELETED = -2
+            };
+
+            explicit FlatHashMapGroup(const signed char* ctrl)
+            {
+#if defined(TECHNOSOFTWARE_FLATHASHMAP_SSE2)
+                ctrl_ = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ctrl));
+#else
+                std::memcpy(ctrl_, ctrl, WIDTH);
+#endif
+            }
+
+            unsigned Match(signed char h2) const
+            {
+#if defined(TECHNOSOFTWARE_FLATHASHMAP_SSE2)
+                return static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h2), ctrl_)));
+#else
+                unsigned mask = 0;
+                for (int i = 0; i < WIDTH; ++i)
+                {
+                    if (ctrl_[i] == h2) mask |= 1u << i;
+                }
+                return mask;
+#endif
+            }
+
+            unsigned MatchEmpty() const
+            {
+                return Match(static_cast<signed char>(EMPTY));
+            }
+
+            /// Empty and deleted slots are the only ones with the sign bit set.
+            unsigned MatchFree() const
+            {
+#if defined(TECHNOSOFTWARE_FLATHASHMAP_SSE2)
+                return static_cast<unsigned>(_mm_movemask_epi8(ctrl_));
+#else
+                unsigned mask = 0;
+                for (int i = 0; i < WIDTH; ++i)
+                {
+                    if (ctrl_[i] < 0) mask |= 1u << i;
+                }
+                return mask;
+#endif
+            }
+
+            static int LowestBit(unsigned mask)
+            {
+                int bit = 0;
+                while (!(mask & 1u))
+                {
+                    mask >>= 1;
+                    ++bit;
+                }
+                return bit;
+            }
+
+        private:
+#if defined(TECHNOSOFTWARE_FLATHASHMAP_SSE2)
+            __m128i     ctrl_;
+#else
+            signed char ctrl_[WIDTH];
+#endif
+        };
+
+
+        /**
+         * @class   FlatHashMap
+         *
+         * @brief   A map using open addressing in a single array, as an alternative to HashMap.
+         *
+         *          Entries are stored directly in the slot array, so an insert only allocates when the
+         *          table grows and a lookup touches one array of control bytes and one slot. A separate
+         *          control byte per slot holds 7 bits of the hash; lookups compare 16 control bytes at
+         *          once (SSE2 where available) and only compare keys whose control byte matches. The
+         *          table grows when it is 7/8 full.
+         *
+         *          The interface is the one of HashMap. In addition find() and count() accept every key
+         *          type the hash function and the key comparison accept, e.g. a const char* for
+         *          std::string keys without creating a temporary string, and GetStatistic() reports the
+         *          load factor and the probe lengths.
+         *
+         *          Unlike HashMap, inserting can move the entries, so iterators, pointers and
+         *          references to entries are invalidated by insert() and operator []. erase() does not
+         *          move other entries.
+         *
+         *          A FlatHashMap is not thread safe.
+         *
+         * @ingroup Hashing
+         */
+
+        template <class Key, class Mapped, class HashFunc = Hash<Key> >
+        class FlatHashMap
+        {
+        public:
+            typedef Key                 KeyType;
+            typedef Mapped              MappedType;
+            typedef Mapped&             Reference;
+            typedef const Mapped&       ConstReference;
+            typedef Mapped*             Pointer;
+            typedef const Mapped*       ConstPointer;
+
+            typedef HashMapEntry<Key, Mapped>      ValueType;
+            typedef std::pair<KeyType, MappedType> PairType;
+
+            class ConstIterator : public std::iterator<std::forward_iterator_tag, ValueType>
+            {
+            public:
+                ConstIterator() : ctrl_(0), slot_(0), end_(0)
+                {
+                }
+
+                ConstIterator(const signed char* ctrl, ValueType* slot, const signed char* end) :
+                    ctrl_(ctrl),
+                    slot_(slot),
+                    end_(end)
+                {
+                    SkipFree();
+                }
+
+                bool operator == (const ConstIterator& it) const
+                {
+                    return ctrl_ == it.ctrl_;
+                }
+
+                bool operator != (const ConstIterator& it) const
+                {
+                    return ctrl_ != it.ctrl_;
+                }
+
+                const ValueType& operator * () const
+                {
+                    return *slot_;
+                }
+
+                const ValueType* operator -> () const
+                {
+                    return slot_;
+                }
+
+                ConstIterator& operator ++ () // prefix
+                {
+                    ++ctrl_;
+                    ++slot_;
+                    SkipFree();
+                    return *this;
+                }
+
+                ConstIterator operator ++ (int) // postfix
+                {
+                    ConstIterator tmp(*this);
+                    ++*this;
+                    return tmp;
+                }
+
+            protected:
+                void SkipFree()
+                {
+                    while (ctrl_ != end_ && *ctrl_ < 0)
+                    {
+                        ++ctrl_;
+                        ++slot_;
+                    }
+                }
+
+                const signed char*  ctrl_;
+                ValueType*          slot_;
+                const signed char*  end_;
+
+                friend class FlatHashMap;
+            };
+
+            class Iterator : public ConstIterator
+            {
+            public:
+                Iterator()
+                {
+                }
+
+                Iterator(const signed char* ctrl, ValueType* slot, const signed char* end) :
+                    ConstIterator(ctrl, slot, end)
+                {
+                }
+
+                ValueType& operator * () const
+                {
+                    return *this->slot_;
+                }
+
+                ValueType* operator -> () const
+                {
+                    return this->slot_;
+                }
+
+                Iterator& operator ++ () // prefix
+                {
+                    ConstIterator::operator ++ ();
+                    return *this;
+                }
+
+                Iterator operator ++ (int) // postfix
+                {
+                    Iterator tmp(*this);
+                    ++*this;
+                    return tmp;
+                }
+            };
+
+            /**
+             * @fn  FlatHashMap::FlatHashMap()
+             *
+             * @brief   Creates an empty FlatHashMap. Nothing is allocated until the first insert.
+             */
+
+            FlatHashMap() :
+                ctrl_(0),
+                slots_(0),
+                capacity_(0),
+                size_(0),
+                growthLeft_(0)
+            {
+            }
+
+            /**
+             * @fn  FlatHashMap::FlatHashMap(std::size_t initialReserve)
+             *
+             * @brief   Creates the FlatHashMap with room for initialReserve entries.
+             *
+             * @param   initialReserve  The number of entries which can be inserted without growing.
+             */
+
+            explicit FlatHashMap(std::size_t initialReserve) :
+                ctrl_(0),
+                slots_(0),
+                capacity_(0),
+                size_(0),
+                growthLeft_(0)
+            {
+                reserve(initialReserve);
+            }
+
+            FlatHashMap(const FlatHashMap& map) :
+                ctrl_(0),
+                slots_(0),
+                capacity_(0),
+                size_(0),
+                growthLeft_(0)
+            {
+                reserve(map.size_);
+                for (ConstIterator it = map.begin(); it != map.end(); ++it)
+                {
+                    InsertNew(*it, HashOf(it->first));
+                }
+            }
+
+            FlatHashMap(FlatHashMap&& map) noexcept :
+                ctrl_(map.ctrl_),
+                slots_(map.slots_),
+                capacity_(map.capacity_),
+                size_(map.size_),
+                growthLeft_(map.growthLeft_)
+            {
+                map.ctrl_ = 0;
+                map.slots_ = 0;
+                map.capacity_ = 0;
+                map.size_ = 0;
+                map.growthLeft_ = 0;
+            }
+
+            ~FlatHashMap()
+            {
+                Destroy();
+            }
+
+            FlatHashMap& operator = (const FlatHashMap& map)
+            {
+                FlatHashMap tmp(map);
+                swap(tmp);
+                return *this;
+            }
+
+            FlatHashMap& operator = (FlatHashMap&& map) noexcept
+            {
+                FlatHashMap tmp(std::move(map));
+                swap(tmp);
+                return *this;
+            }
+
+            void swap(FlatHashMap& map) noexcept
+            {
+                std::swap(ctrl_, map.ctrl_);
+                std::swap(slots_, map.slots_);
+                std::swap(capacity_, map.capacity_);
+                std::swap(size_, map.size_);
+                std::swap(growthLeft_, map.growthLeft_);
+            }
+
+            ConstIterator begin() const
+            {
+                return ConstIterator(ctrl_, slots_, ctrl_ + capacity_);
+            }
+
+            ConstIterator end() const
+            {
+                return ConstIterator(ctrl_ + capacity_, slots_ + capacity_, ctrl_ + capacity_);
+            }
+
+            Iterator begin()
+            {
+                return Iterator(ctrl_, slots_, ctrl_ + capacity_);
+            }
+
+            Iterator end()
+            {
+                return Iterator(ctrl_ + capacity_, slots_ + capacity_, ctrl_ + capacity_);
+            }
+
+            template <class K>
+            ConstIterator find(const K& key) const
+            {
+                std::size_t index = FindIndex(key, HashOf(key));
+                return index == capacity_ ? end() : ConstIterator(ctrl_ + index, slots_ + index, ctrl_ + capacity_);
+            }
+
+            template <class K>
+            Iterator find(const K& key)
+            {
+                std::size_t index = FindIndex(key, HashOf(key));
+                return index == capacity_ ? end() : Iterator(ctrl_ + index, slots_ + index, ctrl_ + capacity_);
+            }
+
+            template <class K>
+            std::size_t count(const K& key) const
+            {
+                return FindIndex(key, HashOf(key)) != capacity_ ? 1 : 0;
+            }
+
+            std::pair<Iterator, bool> insert(const PairType& pair)
+            {
+                return insert(ValueType(pair.first, pair.second));
+            }
+
+            std::pair<Iterator, bool> insert(const ValueType& value)
+            {
+                std::size_t hash = HashOf(value.first);
+                std::size_t index = FindIndex(value.first, hash);
+                if (index != capacity_)
+                {
+                    return std::make_pair(Iterator(ctrl_ + index, slots_ + index, ctrl_ + capacity_), false);
+                }
+                index = InsertNew(value, hash);
+                return std::make_pair(Iterator(ctrl_ + index, slots_ + index, ctrl_ + capacity_), true);
+            }
+
+            void erase(Iterator it)
+            {
+                if (it == end()) return;
+                std::size_t index = static_cast<std::size_t>(it.ctrl_ - ctrl_);
+                slots_[index].~ValueType();
+                SetCtrl(index, static_cast<signed char>(FlatHashMapGroup::DELETED));
+                --size_;
+            }
+
+            void erase(const KeyType& key)
+            {
+                erase(find(key));
+            }
+
+            void clear()
+            {
+                for (std::size_t i = 0; i < capacity_; ++i)
+                {
+                    if (ctrl_[i] >= 0) slots_[i].~ValueType();
+                }
+                if (capacity_)
+                {
+                    std::memset(ctrl_, FlatHashMapGroup::EMPTY, capacity_ + FlatHashMapGroup::WIDTH);
+                }
+                size_ = 0;
+                growthLeft_ = MaxLoad(capacity_);
+            }
+
+            /**
+             * @fn  void FlatHashMap::reserve(std::size_t count)
+             *
+             * @brief   Makes room for count entries, so that inserting up to count entries does not
+             *          grow the table.
+             *
+             * @param   count   The number of entries.
+             */
+
+            void reserve(std::size_t count)
+            {
+                std::size_t capacity = FlatHashMapGroup::WIDTH;
+                while (MaxLoad(capacity) < count) capacity *= 2;
+                if (capacity > capacity_) Rehash(capacity);
+            }
+
+            std::size_t size() const
+            {
+                return size_;
+            }
+
+            bool empty() const
+            {
+                return size_ == 0;
+            }
+
+            /**
+             * @fn  std::size_t FlatHashMap::capacity() const
+             *
+             * @brief   Returns the number of slots.
+             *
+             * @return  The number of slots.
+             */
+
+            std::size_t capacity() const
+            {
+                return capacity_;
+            }
+
+            /**
+             * @fn  double FlatHashMap::GetLoadFactor() const
+             *
+             * @brief   Returns the ratio of entries to slots.
+             *
+             * @return  The load factor; 0 for an empty table.
+             */
+
+            double GetLoadFactor() const
+            {
+                return capacity_ ? static_cast<double>(size_) / capacity_ : 0.0;
+            }
+
+            /**
+             * @fn  HashStatistic FlatHashMap::GetStatistic(bool details = false) const
+             *
+             * @brief   Reports the state of the table. Other than for HashMap, a position is a slot and
+             *          the entries per position are replaced by probe lengths: maxEntriesPerHash() is
+             *          the largest number of groups of 16 slots which a lookup of an existing key
+             *          inspects, and detailedEntriesPerHash()[n] is the number of entries which are found
+             *          in the n-th group inspected, starting with 0.
+             *
+             * @param   details (Optional) True to compute the probe length histogram.
+             *
+             * @return  The statistic.
+             */
+
+            HashStatistic GetStatistic(bool details = false) const
+            {
+                std::vector<UInt32> histogram;
+                UInt32 maxProbe = 0;
+                for (std::size_t i = 0; i < capacity_; ++i)
+                {
+                    if (ctrl_[i] < 0) continue;
+                    UInt32 probe = ProbeLength(i);
+                    if (probe + 1 > maxProbe) maxProbe = probe + 1;
+                    if (details)
+                    {
+                        if (histogram.size() <= probe) histogram.resize(probe + 1);
+                        ++histogram[probe];
+                    }
+                }
+                return HashStatistic(static_cast<UInt32>(capacity_), static_cast<UInt32>(size_),
+                    static_cast<UInt32>(capacity_ - size_), maxProbe, histogram);
+            }
+
+            ConstReference operator [] (const KeyType& key) const
+            {
+                ConstIterator it = find(key);
+                if (it != end())
+                    return it->second;
+                else
+                    throw NotFoundException();
+            }
+
+            Reference operator [] (const KeyType& key)
+            {
+                std::pair<Iterator, bool> res = insert(ValueType(key));
+                return res.first->second;
+            }
+
+        private:
+            static std::size_t MaxLoad(std::size_t capacity)
+            {
+                return capacity - capacity / 8;
+            }
+
+            /// Mixes the hash so that weak hash functions (e.g. a multiplication for integer keys)
+            /// give well distributed upper and lower bits.
+            template <class K>
+            static std::size_t HashOf(const K& key)
+            {
+                UInt64 hash = static_cast<UInt64>(HashFunc()(key)) * 0x9E3779B97F4A7C15ULL;
+                return static_cast<std::size_t>(hash ^ (hash >> 32));
+            }
+
+            static signed char H2(std::size_t hash)
+            {
+                return static_cast<signed char>(hash & 0x7F);
+            }
+
+            std::size_t H1(std::size_t hash) const
+            {
+                return (hash >> 7) & (capacity_ - 1);
+            }
+
+            void SetCtrl(std::size_t index, signed char value)
+            {
+                ctrl_[index] = value;
+                // The first group is repeated behind the table so that a group can be loaded at every slot
+                if (index < FlatHashMapGroup::WIDTH) ctrl_[capacity_ + index] = value;
+            }
+
+            template <class K>
+            std::size_t FindIndex(const K& key, std::size_t hash) const
+            {
+                if (capacity_ == 0) return capacity_;
+
+                std::size_t mask = capacity_ - 1;
+                std::size_t position = H1(hash);
+                signed char h2 = H2(hash);
+                for (std::size_t probe = 1; ; ++probe)
+                {
+                    FlatHashMapGroup group(ctrl_ + position);
+                    for (unsigned match = group.Match(h2); match; match &= match - 1)
+                    {
+                        std::size_t index = (position + FlatHashMapGroup::LowestBit(match)) & mask;
+                        if (slots_[index].first == key) return index;
+                    }
+                    if (group.MatchEmpty() || probe > capacity_ / FlatHashMapGroup::WIDTH) return capacity_;
+                    position = (position + probe * FlatHashMapGroup::WIDTH) & mask;
+                }
+            }
+
+            std::size_t FindFree(std::size_t hash) const
+            {
+                std::size_t mask = capacity_ - 1;
+                std::size_t position = H1(hash);
+                for (std::size_t probe = 1; ; ++probe)
+                {
+                    unsigned match = FlatHashMapGroup(ctrl_ + position).MatchFree();
+                    if (match) return (position + FlatHashMapGroup::LowestBit(match)) & mask;
+                    position = (position + probe * FlatHashMapGroup::WIDTH) & mask;
+                }
+            }
+
+            UInt32 ProbeLength(std::size_t index) const
+            {
+                std::size_t mask = capacity_ - 1;
+                std::size_t position = H1(HashOf(slots_[index].first));
+                UInt32 probe = 0;
+                while (((index - position) & mask) >= FlatHashMapGroup::WIDTH)
+                {
+                    ++probe;
+                    position = (position + probe * FlatHashMapGroup::WIDTH) & mask;
+                }
+                return probe;
+            }
+
+            std::size_t InsertNew(const ValueType& value, std::size_t hash)
+            {
+                if (growthLeft_ == 0)
+                {
+                    // Grow if the table is really full, otherwise only remove the deleted slots
+                    std::size_t capacity = capacity_ ? capacity_ : static_cast<std::size_t>(FlatHashMapGroup::WIDTH);
+                    if (size_ + 1 > MaxLoad(capacity) / 2) capacity *= 2;
+                    Rehash(capacity);
+                }
+                std::size_t index = FindFree(hash);
+                new (slots_ + index) ValueType(value);
+                if (ctrl_[index] == static_cast<signed char>(FlatHashMapGroup::EMPTY)) --growthLeft_;
+                SetCtrl(index, H2(hash));
+                ++size_;
+                return index;
+            }
+
+            void Rehash(std::size_t capacity)
+            {
+                signed char* ctrl = static_cast<signed char*>(::operator new(capacity + FlatHashMapGroup::WIDTH));
+                ValueType* slots;
+                try
+                {
+                    slots = static_cast<ValueType*>(::operator new(capacity * sizeof(ValueType)));
+                }
+                catch (...)
+                {
+                    ::operator delete(ctrl);
+                    throw;
+                }
+                std::memset(ctrl, FlatHashMapGroup::EMPTY, capacity + FlatHashMapGroup::WIDTH);
+
+                signed char* oldCtrl = ctrl_;
+                ValueType* oldSlots = slots_;
+                std::size_t oldCapacity = capacity_;
+
+                ctrl_ = ctrl;
+                slots_ = slots;
+                capacity_ = capacity;
+                growthLeft_ = MaxLoad(capacity) - size_;
+
+                for (std::size_t i = 0; i < oldCapacity; ++i)
+                {
+                    if (oldCtrl[i] < 0) continue;
+                    std::size_t hash = HashOf(oldSlots[i].first);
+                    std::size_t index = FindFree(hash);
+                    new (slots_ + index) ValueType(std::move(oldSlots[i]));
+                    SetCtrl(index, H2(hash));
+                    oldSlots[i].~ValueType();
+                }
+                ::operator delete(oldCtrl);
+                ::operator delete(oldSlots);
+            }
+
+            void Destroy()
+            {
+                for (std::size_t i = 0; i < capacity_; ++i)
+                {
+                    if (ctrl_[i] >= 0) slots_[i].~ValueType();
+                }
+                ::operator delete(ctrl_);
+                ::operator delete(slots_);
+            }
+
+            signed char*    ctrl_;          // capacity_ + WIDTH control bytes
+            ValueType*      slots_;
+            std::size_t     capacity_;      // 0 or a power of 2 >= WIDTH
+            std::size_t     size_;
+            std::size_t     growthLeft_;    // Empty slots which may still be used before rehashing
+        };
+    }
+}
+
+#endif /* TECHNOSOFTWARE_FLATHASHMAP_H */
@@ -29,6 +29,8 @@
 #define TECHNOSOFTWARE_HASH_H
 
 #include <cstddef>
+#include <cstring>
+#include <string>
 
 #include "Base/Base.h"
 #include "Base/Handles.h"
@@ -39,6 +41,7 @@ namespace Technosoftware
     {
 
         std::size_t TECHNOSOFTWARE_API hash(const std::string& str);
+        std::size_t TECHNOSOFTWARE_API hash(const char* str, std::size_t length);
         std::size_t TECHNOSOFTWARE_API hash(ServerHandle n);
 
         template <class T>
@@ -68,6 +71,31 @@ namespace Technosoftware
         };
 
 
+        /**
+         * @struct  Hash<std::string>
+         *
+         * @brief   The hash function for strings. Takes the string by reference and also accepts zero
+         *          terminated strings, so that maps with string keys can be searched without creating a
+         *          temporary string.
+         *
+         * @ingroup Hashing
+         */
+
+        template <>
+        struct Hash<std::string>
+        {
+            std::size_t operator () (const std::string& value) const
+            {
+                return Base::hash(value.data(), value.size());
+            }
+
+            std::size_t operator () (const char* value) const
+            {
+                return Base::hash(value, std::strlen(value));
+            }
+        };
+
+
         //
         // inlines
         //
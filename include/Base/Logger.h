@@ -132,12 +132,42 @@ const int LOGGER_DEFAULT_LIMITSIZE = 50;
 /** @brief   The logger default showsuffix. */
 const bool LOGGER_DEFAULT_SHOWSUFFIX = true;
 
+/** @brief   The logger default mmap. */
+const bool LOGGER_DEFAULT_MMAP = false;
+
+/** @brief   Size of the segments a mapped log file grows by, a multiple of 64 KB. */
+const size_t LOGGER_MMAP_SEGMENT_SIZE = 1024 * 1024 * 4;
+
+/** @brief   The logger default compress. */
+const bool LOGGER_DEFAULT_COMPRESS = false;
+
+/** @brief   The logger default reserve size of the closed log files, unit Million byte. 0 is unlimited. */
+const unsigned int LOGGER_DEFAULT_RESERVESIZE = 0;
+
+/** @brief   Extension appended to the name of a compressed log file. */
+const char* const LOGGER_ARCHIVE_EXTENSION = ".lzb";
+
+/** @brief   Extension of the index file which lists the closed log files of a logger. */
+const char* const LOGGER_INDEX_EXTENSION = ".index";
+
+/** @brief   Maximum size of the uncompressed blocks of a compressed log file. */
+const int LOGGER_ARCHIVE_BLOCK_SIZE = 1024 * 64;
+
 /* support ANSI->OEM console conversion on Windows */
 #undef LOGGER_OEM_CONSOLE
 
 /** @brief   Number of logger force reserve files. */
 const size_t LOGGER_FORCE_RESERVE_FILE_COUNT = 7;
 
+/** @brief   Interval in seconds to align the coarse log clock with the system time. */
+const int LOGGER_COARSE_CLOCK_ADJUST_INTERVAL = 60;
+
+/** @brief   Size of the binary log ring of each logging thread, a power of 2. */
+const int LOGGER_BINARY_RING_SIZE = 1024 * 1024;
+
+/** @brief   Maximum size of one binary log record. */
+const int LOGGER_BINARY_RECORD_SIZE = 1024 * 4;
+
 /**
  * @struct  LogData
  *
@@ -151,11 +181,25 @@ struct LogData
     int    _typeval;
     int    _level;                              // log level
     time_t _time;                               // create time
-    unsigned int _precise;                      // create time 
+    unsigned int _precise;                      // microseconds of the create time
     int _contentLen;
     char _content[LOGGER_LOG_BUF_SIZE];         // content
 };
 
+/**
+ * @struct  LoggerFormatSite
+ *
+ * @brief   The static part of a binary log statement. Every LOG_BINARY_STREAM statement owns one
+ *          constant instance; its address identifies the statement in the binary log records.
+ */
+
+struct LoggerFormatSite
+{
+    const char * _file;
+    int _line;
+    int _level;
+};
+
 
 /**
  * @class   LogManager
@@ -263,7 +307,9 @@ public:
     /**
      * @fn  virtual bool LogManager::prePushLog(LoggerId id, int level) = 0;
      *
-     * @brief   pre-check the log filter. if filter out return false.
+     * @brief   pre-check the log filter. if filter out return false. A disabled logger or level
+     *          is rejected with a single relaxed atomic load and without a lock; the setters
+     *          take effect for the next call.
      *          Thread safe.
      *
      * @param   id      The identifier.
@@ -429,6 +475,55 @@ public:
 
     virtual bool setLoggerReserveTime(LoggerId id, time_t sec) = 0;
 
+    /**
+     * @fn  virtual bool LogManager::setLoggerMmap(LoggerId id, bool enable) = 0;
+     *
+     * @brief   Writes the log files through memory mapped segments of LOGGER_MMAP_SEGMENT_SIZE bytes
+     *          instead of fwrite. The file is extended by a whole segment when the current one is
+     *          full and truncated to its content when it is closed; a file of a crashed process keeps
+     *          a zero filled tail.
+     *          Thread safe.
+     *
+     * @param   id      The identifier.
+     * @param   enable  True to enable, false to disable.
+     *
+     * @return  True if it succeeds, false if it fails.
+     */
+
+    virtual bool setLoggerMmap(LoggerId id, bool enable) = 0;
+
+    /**
+     * @fn  virtual bool LogManager::setLoggerCompress(LoggerId id, bool enable) = 0;
+     *
+     * @brief   Compresses the closed log files of the logger. The files are compressed by a low
+     *          priority background thread into blocks of whole lines, named like the log file with
+     *          LOGGER_ARCHIVE_EXTENSION appended; LoggerArchiveReader reads them.
+     *          Thread safe.
+     *
+     * @param   id      The identifier.
+     * @param   enable  True to enable, false to disable.
+     *
+     * @return  True if it succeeds, false if it fails.
+     */
+
+    virtual bool setLoggerCompress(LoggerId id, bool enable) = 0;
+
+    /**
+     * @fn  virtual bool LogManager::setLoggerReserveSize(LoggerId id, unsigned int reserveSize) = 0;
+     *
+     * @brief   Sets the size the closed log files of the logger may use on disk. The oldest files are
+     *          removed by the background thread, at least LOGGER_FORCE_RESERVE_FILE_COUNT files are
+     *          kept.
+     *          Thread safe.
+     *
+     * @param   id          The identifier.
+     * @param   reserveSize The size in Million bytes, 0 is unlimited.
+     *
+     * @return  True if it succeeds, false if it fails.
+     */
+
+    virtual bool setLoggerReserveSize(LoggerId id, unsigned int reserveSize) = 0;
+
 
     /**
      * @fn  virtual bool LogManager::setAutoUpdate(int interval) = 0;
@@ -443,6 +538,22 @@ public:
 
     virtual bool setAutoUpdate(int interval/*per second, 0 is disable auto update*/) = 0;
 
+    /**
+     * @fn  virtual bool LogManager::setCoarseClock(bool enable) = 0;
+     *
+     * @brief   Takes the log time from a coarse monotonic clock (GetTickCount64,
+     *          CLOCK_MONOTONIC_COARSE) which is cheaper to read than the system time. Its resolution
+     *          is 1 to 16 milliseconds; the logger thread aligns it with the system time every
+     *          LOGGER_COARSE_CLOCK_ADJUST_INTERVAL seconds.
+     *          Thread safe.
+     *
+     * @param   enable  True to use the coarse clock, false to use the system time (default).
+     *
+     * @return  True if it succeeds, false if it fails.
+     */
+
+    virtual bool setCoarseClock(bool enable) = 0;
+
     /**
      * @fn  virtual bool LogManager::updateConfig() = 0;
      *
@@ -461,12 +572,99 @@ public:
     virtual unsigned long long getStatusTotalPopQueue() = 0;
     virtual unsigned int getStatusActiveLoggers() = 0;
 
+    virtual unsigned long long getStatusTotalDiscardBinary() = 0;
+
     virtual LogData * makeLogData(LoggerId id, int level) = 0;
     virtual void freeLogData(LogData * log) = 0;
+
+    /**
+     * @fn  virtual char * LogManager::beginBinaryLog(LoggerId id, const LoggerFormatSite * site, int & capacity) = 0;
+     *
+     * @brief   Starts a binary log record in the log ring of the calling thread and stores the
+     *          timestamp. Used by LoggerBinaryStream.
+     *          Thread safe.
+     *
+     * @param           id          The identifier.
+     * @param           site        The log statement.
+     * @param [out]     capacity    The number of bytes available for the arguments, or -1 if the
+     *                              ring of the calling thread is already destroyed.
+     *
+     * @return  The memory for the arguments, or NULL if the ring is full and the log is discarded
+     *          or if the ring is destroyed and the log has to be written with LOG_STREAM.
+     */
+
+    virtual char * beginBinaryLog(LoggerId id, const LoggerFormatSite * site, int & capacity) = 0;
+
+    /**
+     * @fn  virtual void LogManager::commitBinaryLog(char * args, int length) = 0;
+     *
+     * @brief   Publishes the record started by beginBinaryLog to the logger thread.
+     *          Thread safe.
+     *
+     * @param   args    The memory returned by beginBinaryLog.
+     * @param   length  The number of bytes used for the arguments.
+     */
+
+    virtual void commitBinaryLog(char * args, int length) = 0;
+};
+
+/**
+ * @class   LoggerArchiveReader
+ *
+ * @brief   Reads a closed log file block by block, so that it can be searched without
+ *          decompressing it as a whole. Files compressed by setLoggerCompress are decompressed,
+ *          other files are read as they are. A block always ends with a complete line.
+ *
+ *          The closed files of a logger are listed in its index file, named like the log files
+ *          without time and index and with LOGGER_INDEX_EXTENSION. Each line holds the time the
+ *          file was created and the time it was replaced by the next file (YYYYMMDDHHMMSS), the
+ *          size of the log text, the size on disk and the path of the file.
+ */
+
+class LoggerArchiveReader
+{
+public:
+    LoggerArchiveReader();
+    ~LoggerArchiveReader();
+
+    /**
+     * @fn  bool LoggerArchiveReader::open(const char * path);
+     *
+     * @brief   Opens a log file or a compressed log file.
+     *
+     * @param   path    Full pathname of the file.
+     *
+     * @return  True if it succeeds, false if it fails.
+     */
+
+    bool open(const char * path);
+
+    /**
+     * @fn  bool LoggerArchiveReader::read(std::string & text);
+     *
+     * @brief   Reads the next block of at most LOGGER_ARCHIVE_BLOCK_SIZE bytes of log lines.
+     *
+     * @param [out] text    The log lines.
+     *
+     * @return  False at the end of the file or if the file is corrupt.
+     */
+
+    bool read(std::string & text);
+
+    void close();
+private:
+    LoggerArchiveReader(const LoggerArchiveReader &);
+    LoggerArchiveReader & operator = (const LoggerArchiveReader &);
+
+    FILE * _file;
+    bool _compressed;
+    std::string _packed;    // compressed block
+    std::string _carry;     // incomplete last line of an uncompressed file
 };
 
 class LoggerStream;
 class LoggerBinary;
+class LoggerBinaryStream;
 
 //! base macro.
 #define LOG_STREAM(id, level, file, line, log)\
@@ -481,8 +679,37 @@ do{\
     }\
 } while (0)
 
+//! binary macro. the calling thread only copies the raw arguments into its log ring,
+//! the text is formatted by the logger thread.
+#define LOG_BINARY_STREAM(id, level, file, line, log)\
+do{\
+    if (LogManager::getPtr()->prePushLog(id,level)) \
+    {\
+        static const LoggerFormatSite __site = { file, line, level }; \
+        LoggerBinaryStream __bs(id, &__site); \
+        if (__bs.isRingDestroyed()) \
+        {\
+            LOG_STREAM(id, level, file, line, log);\
+        }\
+        else \
+        {\
+            __bs << log;\
+            __bs.commit(); \
+        }\
+    }\
+} while (0)
 
-//! fast macro
+
+//! fast macro. define LOGGER_BINARY_STREAM_DEFAULT to use the binary mode for them.
+#ifdef LOGGER_BINARY_STREAM_DEFAULT
+#define LOG_TRACE(id, log) LOG_BINARY_STREAM(id, LOG_LEVEL_TRACE, __FILE__, __LINE__, log)
+#define LOG_DEBUG(id, log) LOG_BINARY_STREAM(id, LOG_LEVEL_DEBUG, __FILE__, __LINE__, log)
+#define LOG_INFO(id, log)  LOG_BINARY_STREAM(id, LOG_LEVEL_INFO, __FILE__, __LINE__, log)
+#define LOG_WARN(id, log)  LOG_BINARY_STREAM(id, LOG_LEVEL_WARN, __FILE__, __LINE__, log)
+#define LOG_ERROR(id, log) LOG_BINARY_STREAM(id, LOG_LEVEL_ERROR, __FILE__, __LINE__, log)
+#define LOG_ALARM(id, log) LOG_BINARY_STREAM(id, LOG_LEVEL_ALARM, __FILE__, __LINE__, log)
+#define LOG_FATAL(id, log) LOG_BINARY_STREAM(id, LOG_LEVEL_FATAL, __FILE__, __LINE__, log)
+#else
 #define LOG_TRACE(id, log) LOG_STREAM(id, LOG_LEVEL_TRACE, __FILE__, __LINE__, log)
 #define LOG_DEBUG(id, log) LOG_STREAM(id, LOG_LEVEL_DEBUG, __FILE__, __LINE__, log)
 #define LOG_INFO(id, log)  LOG_STREAM(id, LOG_LEVEL_INFO, __FILE__, __LINE__, log)
@@ -490,6 +717,16 @@ do{\
 #define LOG_ERROR(id, log) LOG_STREAM(id, LOG_LEVEL_ERROR, __FILE__, __LINE__, log)
 #define LOG_ALARM(id, log) LOG_STREAM(id, LOG_LEVEL_ALARM, __FILE__, __LINE__, log)
 #define LOG_FATAL(id, log) LOG_STREAM(id, LOG_LEVEL_FATAL, __FILE__, __LINE__, log)
+#endif
+
+//! binary macro, always deferred.
+#define LOGBIN_TRACE(id, log) LOG_BINARY_STREAM(id, LOG_LEVEL_TRACE, __FILE__, __LINE__, log)
+#define LOGBIN_DEBUG(id, log) LOG_BINARY_STREAM(id, LOG_LEVEL_DEBUG, __FILE__, __LINE__, log)
+#define LOGBIN_INFO(id, log)  LOG_BINARY_STREAM(id, LOG_LEVEL_INFO, __FILE__, __LINE__, log)
+#define LOGBIN_WARN(id, log)  LOG_BINARY_STREAM(id, LOG_LEVEL_WARN, __FILE__, __LINE__, log)
+#define LOGBIN_ERROR(id, log) LOG_BINARY_STREAM(id, LOG_LEVEL_ERROR, __FILE__, __LINE__, log)
+#define LOGBIN_ALARM(id, log) LOG_BINARY_STREAM(id, LOG_LEVEL_ALARM, __FILE__, __LINE__, log)
+#define LOGBIN_FATAL(id, log) LOG_BINARY_STREAM(id, LOG_LEVEL_FATAL, __FILE__, __LINE__, log)
 
 //! super macro.
 #define LOGT( log ) LOG_TRACE(LOGGER_MAIN_LOGGER_ID, log )
@@ -499,6 +736,13 @@ do{\
 #define LOGE( log ) LOG_ERROR(LOGGER_MAIN_LOGGER_ID, log )
 #define LOGA( log ) LOG_ALARM(LOGGER_MAIN_LOGGER_ID, log )
 #define LOGF( log ) LOG_FATAL(LOGGER_MAIN_LOGGER_ID, log )
+#define LOGBINT( log ) LOGBIN_TRACE(LOGGER_MAIN_LOGGER_ID, log )
+#define LOGBIND( log ) LOGBIN_DEBUG(LOGGER_MAIN_LOGGER_ID, log )
+#define LOGBINI( log ) LOGBIN_INFO(LOGGER_MAIN_LOGGER_ID, log )
+#define LOGBINW( log ) LOGBIN_WARN(LOGGER_MAIN_LOGGER_ID, log )
+#define LOGBINE( log ) LOGBIN_ERROR(LOGGER_MAIN_LOGGER_ID, log )
+#define LOGBINA( log ) LOGBIN_ALARM(LOGGER_MAIN_LOGGER_ID, log )
+#define LOGBINF( log ) LOGBIN_FATAL(LOGGER_MAIN_LOGGER_ID, log )
 
 
 //! format input log.
@@ -575,9 +819,17 @@ public:
     {
         _buf = (const char *)buf;
         _len = len;
+        _origin = _buf;
+    }
+    LoggerBinary(const void * buf, int len, const void * origin)
+    {
+        _buf = (const char *)buf;
+        _len = len;
+        _origin = (const char *)origin;
     }
     const char * _buf;
     int  _len;
+    const char * _origin;   //address shown in the dump, differs from _buf for copies of binary logs
 };
 class LoggerStream
 {
@@ -590,10 +842,10 @@ private:
     inline LoggerStream & writeLongLong(long long t);
     inline LoggerStream & writeULongLong(unsigned long long t);
     inline LoggerStream & writePointer(const void * t);
-    inline LoggerStream & writeString(const char * t, size_t len);
     inline LoggerStream & writeWString(const wchar_t* t);
     inline LoggerStream & writeBinary(const LoggerBinary & t);
 public:
+    inline LoggerStream & writeString(const char * t, size_t len);
     inline LoggerStream & operator <<(const void * t) { return  writePointer(t); }
 
     inline LoggerStream & operator <<(const char * t) { return writeString(t, strlen(t)); }
@@ -823,14 +1075,14 @@ inline LoggerStream & LoggerStream::writeBinary(const LoggerBinary & t)
     for (int i = 0; i < (t._len / 16) + 1; i++)
     {
         writeData("%s", "\r\n\t");
-        *this << (void*)(t._buf + i * 16);
+        *this << (void*)(t._origin + i * 16);
         writeData("%s", ": ");
         for (int j = i * 16; j < (i + 1) * 16 && j < t._len; j++)
         {
             writeData("%02x ", (unsigned char)t._buf[j]);
         }
         writeData("%s", "\r\n\t");
-        *this << (void*)(t._buf + i * 16);
+        *this << (void*)(t._origin + i * 16);
         writeData("%s", ": ");
         for (int j = i * 16; j < (i + 1) * 16 && j < t._len; j++)
         {
@@ -890,6 +1142,217 @@ inline LoggerStream & LoggerStream::writeWString(const wchar_t* t)
     return *this;
 }
 
+//! argument types of a binary log record
+enum LoggerBinaryType
+{
+    LBT_SIGNED = 1,     //long long
+    LBT_UNSIGNED,       //unsigned long long
+    LBT_DOUBLE,         //double
+    LBT_CHAR,           //char
+    LBT_BOOL,           //unsigned char
+    LBT_POINTER,        //unsigned long long
+    LBT_STRING,         //unsigned int length, chars
+    LBT_WSTRING,        //unsigned int length, wchar_t
+    LBT_BINARY,         //unsigned int length, unsigned long long origin, bytes
+};
+
+//! records the arguments of LOG_BINARY_STREAM without formatting them.
+//! the output of the logger thread is the same as for LOG_STREAM.
+class LoggerBinaryStream
+{
+public:
+    inline LoggerBinaryStream(LoggerId id, const LoggerFormatSite * site);
+    inline void commit();
+    //! true if the calling thread is exiting and its log ring is gone, the log has to be written as text.
+    inline bool isRingDestroyed() const { return _ringDestroyed; }
+private:
+    inline LoggerBinaryStream & writeValue(unsigned char type, const void * value, size_t len);
+    inline LoggerBinaryStream & writeBytes(unsigned char type, const void * data, size_t len, const void * origin = NULL);
+    inline LoggerBinaryStream & writeSigned(long long t) { return writeValue(LBT_SIGNED, &t, sizeof(t)); }
+    inline LoggerBinaryStream & writeUnsigned(unsigned long long t) { return writeValue(LBT_UNSIGNED, &t, sizeof(t)); }
+    inline LoggerBinaryStream & writeDouble(double t) { return writeValue(LBT_DOUBLE, &t, sizeof(t)); }
+public:
+    inline LoggerBinaryStream & operator <<(const void * t) { unsigned long long v = (unsigned long long)(size_t)t; return writeValue(LBT_POINTER, &v, sizeof(v)); }
+
+    inline LoggerBinaryStream & operator <<(const char * t) { return writeBytes(LBT_STRING, t, strlen(t)); }
+
+    inline LoggerBinaryStream & operator <<(char * t) { return *this << (const char *)t; }
+#ifdef WIN32
+    inline LoggerBinaryStream & operator <<(const wchar_t * t) { return writeBytes(LBT_WSTRING, t, wcslen(t) * sizeof(wchar_t)); }
+
+    inline LoggerBinaryStream & operator <<(wchar_t * t) { return *this << (const wchar_t *)t; }
+#endif
+    inline LoggerBinaryStream & operator <<(bool t) { unsigned char v = t ? 1 : 0; return writeValue(LBT_BOOL, &v, 1); }
+
+    inline LoggerBinaryStream & operator <<(char t) { return writeValue(LBT_CHAR, &t, 1); }
+
+    inline LoggerBinaryStream & operator <<(unsigned char t) { return writeUnsigned(t); }
+
+    inline LoggerBinaryStream & operator <<(short t) { return writeSigned(t); }
+
+    inline LoggerBinaryStream & operator <<(unsigned short t) { return writeUnsigned(t); }
+
+    inline LoggerBinaryStream & operator <<(int t) { return writeSigned(t); }
+
+    inline LoggerBinaryStream & operator <<(unsigned int t) { return writeUnsigned(t); }
+
+    inline LoggerBinaryStream & operator <<(long t) { return writeSigned(t); }
+
+    inline LoggerBinaryStream & operator <<(unsigned long t) { return writeUnsigned(t); }
+
+    inline LoggerBinaryStream & operator <<(long long t) { return writeSigned(t); }
+
+    inline LoggerBinaryStream & operator <<(unsigned long long t) { return writeUnsigned(t); }
+
+    inline LoggerBinaryStream & operator <<(float t) { return writeDouble(t); }
+
+    inline LoggerBinaryStream & operator <<(double t) { return writeDouble(t); }
+
+    template<class _Traits, class _Alloc> //support std::string
+    inline LoggerBinaryStream & operator <<(const std::basic_string<char, _Traits, _Alloc> & t) { return writeBytes(LBT_STRING, t.c_str(), t.length()); }
+#ifdef WIN32
+    template<class _Traits, class _Alloc> //support std::wstring
+    inline LoggerBinaryStream & operator <<(const std::basic_string<wchar_t, _Traits, _Alloc> & t) { return writeBytes(LBT_WSTRING, t.c_str(), t.length() * sizeof(wchar_t)); }
+#endif
+
+    inline LoggerBinaryStream & operator << (const LoggerBinary & binary) { return writeBytes(LBT_BINARY, binary._buf, binary._len < 0 ? 0 : binary._len, binary._origin); }
+
+    template<class _Ty1, class _Ty2>
+    inline LoggerBinaryStream & operator <<(const std::pair<_Ty1, _Ty2> & t) { return *this << "pair(" << t.first << ":" << t.second << ")"; }
+
+    template<class _Elem, class _Alloc>
+    inline LoggerBinaryStream & operator <<(const std::vector<_Elem, _Alloc> & t) { return writeContainer("vector(", t); }
+
+    template<class _Elem, class _Alloc>
+    inline LoggerBinaryStream & operator <<(const std::list<_Elem, _Alloc> & t) { return writeContainer("list(", t); }
+
+    template<class _Elem, class _Alloc>
+    inline LoggerBinaryStream & operator <<(const std::deque<_Elem, _Alloc> & t) { return writeContainer("deque(", t); }
+
+    template<class _K, class _V, class _Pr, class _Alloc>
+    inline LoggerBinaryStream & operator <<(const std::map<_K, _V, _Pr, _Alloc> & t) { return writeContainer("map(", t); }
+
+    //! any other type, e.g. an enum or a pointer to another type, is rendered by LoggerStream in the
+    //! calling thread and recorded as text, so that LOG_BINARY_STREAM accepts what LOG_STREAM accepts.
+    template<class T>
+    inline LoggerBinaryStream & operator <<(const T & t) { return writeText(t); }
+
+private:
+    template<class T>
+    inline LoggerBinaryStream & writeText(const T & t)
+    {
+        size_t head = 1 + sizeof(unsigned int);
+        if ((size_t)(_end - _cur) > head)
+        {
+            LoggerStream ss(_cur + head, (int)(_end - _cur - head));
+            ss << t;
+            unsigned int length = (unsigned int)ss.getCurrentLen();
+            *_cur++ = (char)LBT_STRING;
+            memcpy(_cur, &length, sizeof(length));
+            _cur += sizeof(length) + length;
+        }
+        else
+        {
+            _end = _cur;
+        }
+        return *this;
+    }
+
+    template<class _Container>
+    inline LoggerBinaryStream & writeContainer(const char * name, const _Container & t)
+    {
+        *this << name << t.size() << ")[";
+        int inputCount = 0;
+        for (typename _Container::const_iterator iter = t.begin(); iter != t.end(); iter++)
+        {
+            if (inputCount > 0)
+            {
+                *this << ", ";
+            }
+            inputCount++;
+            if (inputCount > LOGGER_LOG_CONTAINER_DEPTH)
+            {
+                *this << "...";
+                break;
+            }
+            *this << *iter;
+        }
+        return *this << "]";
+    }
+
+    LoggerBinaryStream() {}
+    LoggerBinaryStream(LoggerBinaryStream &) {}
+    char *  _begin;
+    char *  _end;
+    char *  _cur;
+    bool    _ringDestroyed;
+};
+
+inline LoggerBinaryStream::LoggerBinaryStream(LoggerId id, const LoggerFormatSite * site)
+{
+    int capacity = 0;
+    _begin = LogManager::getPtr()->beginBinaryLog(id, site, capacity);
+    _cur = _begin;
+    _end = _begin ? _begin + capacity : _begin;
+    _ringDestroyed = capacity < 0;
+}
+
+inline void LoggerBinaryStream::commit()
+{
+    if (_begin)
+    {
+        LogManager::getPtr()->commitBinaryLog(_begin, (int)(_cur - _begin));
+    }
+}
+
+inline LoggerBinaryStream & LoggerBinaryStream::writeValue(unsigned char type, const void * value, size_t len)
+{
+    if ((size_t)(_end - _cur) > len)
+    {
+        *_cur++ = (char)type;
+        memcpy(_cur, value, len);
+        _cur += len;
+    }
+    else
+    {
+        _end = _cur; //record is full, drop the remaining arguments
+    }
+    return *this;
+}
+
+inline LoggerBinaryStream & LoggerBinaryStream::writeBytes(unsigned char type, const void * data, size_t len, const void * origin)
+{
+    size_t head = 1 + sizeof(unsigned int) + (type == LBT_BINARY ? sizeof(unsigned long long) : 0);
+    if ((size_t)(_end - _cur) > head)
+    {
+        if (len > (size_t)(_end - _cur) - head)
+        {
+            len = (size_t)(_end - _cur) - head;
+        }
+        if (type == LBT_WSTRING)
+        {
+            len -= len % sizeof(wchar_t);
+        }
+        unsigned int length = (unsigned int)len;
+        *_cur++ = (char)type;
+        memcpy(_cur, &length, sizeof(length));
+        _cur += sizeof(length);
+        if (type == LBT_BINARY)
+        {
+            unsigned long long address = (unsigned long long)(size_t)origin;
+            memcpy(_cur, &address, sizeof(address));
+            _cur += sizeof(address);
+        }
+        memcpy(_cur, data, len);
+        _cur += len;
+    }
+    else
+    {
+        _end = _cur;
+    }
+    return *this;
+}
+
 #ifdef WIN32
 #pragma warning(pop)
 #endif
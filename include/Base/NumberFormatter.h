@@ -41,11 +41,13 @@ namespace Technosoftware
          * @brief   The NumberFormatter class provides static methods for formatting numeric values into
          *          strings.
          *          
-         *          There are two kind of static member functions:
+         *          There are three kind of static member functions:
          *             * format* functions return a std::string containing
          *               the formatted value.
          *             * append* functions append the formatted value to
          *               an existing string.
+         *             * ToChars functions write the formatted value into
+         *               a buffer of the caller and never allocate.
          *
          * @ingroup BaseCore
          */
@@ -62,6 +64,7 @@ namespace Technosoftware
 
             static const unsigned NF_MAX_INT_STRING_LEN = 32; // increase for 64-bit binary formatting support
             static const unsigned NF_MAX_FLT_STRING_LEN = TECHNOSOFTWARE_MAX_FLT_STRING_LEN;
+            static const unsigned NF_MAX_DBL_CHARS_LEN = 48;  // ToChars(double) writes at most 34 characters
 
             /**
              * @fn  static std::string NumberFormatter::Format(int value);
@@ -1061,6 +1064,150 @@ namespace Technosoftware
 
             static void Append(std::string& str, const void* ptr);
 
+            /**
+             * @fn  static std::size_t NumberFormatter::ToChars(char* buffer, std::size_t size, int value) noexcept;
+             *
+             * @brief   Writes an integer value in decimal notation into a buffer without allocating. The
+             *          result is not zero terminated.
+             *
+             * @param [out]     buffer  The buffer.
+             * @param           size    The size of the buffer in bytes.
+             * @param           value   The value.
+             *
+             * @return  The number of characters written or 0 if the buffer is too small.
+             */
+
+            static std::size_t ToChars(char* buffer, std::size_t size, int value) noexcept;
+
+            /**
+             * @fn  static std::size_t NumberFormatter::ToChars(char* buffer, std::size_t size, unsigned value) noexcept;
+             *
+             * @brief   Writes an unsigned int value in decimal notation into a buffer without allocating.
+             *          The result is not zero terminated.
+             *
+             * @param [out]     buffer  The buffer.
+             * @param           size    The size of the buffer in bytes.
+             * @param           value   The value.
+             *
+             * @return  The number of characters written or 0 if the buffer is too small.
+             */
+
+            static std::size_t ToChars(char* buffer, std::size_t size, unsigned value) noexcept;
+
+            /**
+             * @fn  static std::size_t NumberFormatter::ToChars(char* buffer, std::size_t size, long value) noexcept;
+             *
+             * @brief   Writes a long value in decimal notation into a buffer without allocating. The result
+             *          is not zero terminated.
+             *
+             * @param [out]     buffer  The buffer.
+             * @param           size    The size of the buffer in bytes.
+             * @param           value   The value.
+             *
+             * @return  The number of characters written or 0 if the buffer is too small.
+             */
+
+            static std::size_t ToChars(char* buffer, std::size_t size, long value) noexcept;
+
+            /**
+             * @fn  static std::size_t NumberFormatter::ToChars(char* buffer, std::size_t size, unsigned long value) noexcept;
+             *
+             * @brief   Writes an unsigned long value in decimal notation into a buffer without allocating.
+             *          The result is not zero terminated.
+             *
+             * @param [out]     buffer  The buffer.
+             * @param           size    The size of the buffer in bytes.
+             * @param           value   The value.
+             *
+             * @return  The number of characters written or 0 if the buffer is too small.
+             */
+
+            static std::size_t ToChars(char* buffer, std::size_t size, unsigned long value) noexcept;
+
+#if defined(TECHNOSOFTWARE_HAVE_INT64) && !defined(TECHNOSOFTWARE_LONG_IS_64_BIT)
+
+            /**
+             * @fn  static std::size_t NumberFormatter::ToChars(char* buffer, std::size_t size, Int64 value) noexcept;
+             *
+             * @brief   Writes a 64-bit integer value in decimal notation into a buffer without allocating.
+             *          The result is not zero terminated.
+             *
+             * @param [out]     buffer  The buffer.
+             * @param           size    The size of the buffer in bytes.
+             * @param           value   The value.
+             *
+             * @return  The number of characters written or 0 if the buffer is too small.
+             */
+
+            static std::size_t ToChars(char* buffer, std::size_t size, Int64 value) noexcept;
+
+            /**
+             * @fn  static std::size_t NumberFormatter::ToChars(char* buffer, std::size_t size, UInt64 value) noexcept;
+             *
+             * @brief   Writes an unsigned 64-bit integer value in decimal notation into a buffer without
+             *          allocating. The result is not zero terminated.
+             *
+             * @param [out]     buffer  The buffer.
+             * @param           size    The size of the buffer in bytes.
+             * @param           value   The value.
+             *
+             * @return  The number of characters written or 0 if the buffer is too small.
+             */
+
+            static std::size_t ToChars(char* buffer, std::size_t size, UInt64 value) noexcept;
+
+#endif // defined(TECHNOSOFTWARE_HAVE_INT64) && !defined(TECHNOSOFTWARE_LONG_IS_64_BIT)
+
+            /**
+             * @fn  static std::size_t NumberFormatter::ToChars(char* buffer, std::size_t size, float value) noexcept;
+             *
+             * @brief   Writes the shortest representation of a float value which reads back to the same
+             *          value into a buffer without allocating. The text is the same as of Format(float).
+             *          The result is not zero terminated.
+             *
+             * @param [out]     buffer  The buffer.
+             * @param           size    The size of the buffer in bytes.
+             * @param           value   The value.
+             *
+             * @return  The number of characters written or 0 if the buffer is too small.
+             */
+
+            static std::size_t ToChars(char* buffer, std::size_t size, float value) noexcept;
+
+            /**
+             * @fn  static std::size_t NumberFormatter::ToChars(char* buffer, std::size_t size, double value) noexcept;
+             *
+             * @brief   Writes the shortest representation of a double value which reads back to the same
+             *          value into a buffer without allocating. The text is the same as of Format(double).
+             *          The result is not zero terminated.
+             *
+             * @param [out]     buffer  The buffer.
+             * @param           size    The size of the buffer in bytes.
+             * @param           value   The value.
+             *
+             * @return  The number of characters written or 0 if the buffer is too small.
+             */
+
+            static std::size_t ToChars(char* buffer, std::size_t size, double value) noexcept;
+
+            /**
+             * @fn  static std::size_t NumberFormatter::FormatColumn(const double* values, std::size_t count, char separator, char* buffer, std::size_t size) noexcept;
+             *
+             * @brief   Writes the shortest representation of each value, each followed by separator, into a
+             *          buffer. 35 bytes per value (34 characters and the separator) are always sufficient.
+             *
+             * @param           values      The values.
+             * @param           count       Number of values.
+             * @param           separator   The character written after each value, e.g. '\n' or ';'.
+             * @param [out]     buffer      The buffer.
+             * @param           size        The size of the buffer in bytes.
+             *
+             * @return  The number of characters written or 0 if the buffer is too small, in which case the
+             *          content of the buffer is undefined.
+             */
+
+            static std::size_t FormatColumn(const double* values, std::size_t count, char separator, char* buffer, std::size_t size) noexcept;
+
         private:
         };
 
@@ -1071,9 +1218,8 @@ namespace Technosoftware
 
         inline std::string NumberFormatter::Format(int value)
         {
-            std::string result;
-            IntToStr(value, 10, result);
-            return result;
+            char buffer[NF_MAX_INT_STRING_LEN];
+            return std::string(buffer, ToChars(buffer, NF_MAX_INT_STRING_LEN, value));
         }
 
 
@@ -1111,9 +1257,8 @@ namespace Technosoftware
 
         inline std::string NumberFormatter::Format(unsigned value)
         {
-            std::string result;
-            UIntToStr(value, 10, result);
-            return result;
+            char buffer[NF_MAX_INT_STRING_LEN];
+            return std::string(buffer, ToChars(buffer, NF_MAX_INT_STRING_LEN, value));
         }
 
 
@@ -1151,9 +1296,8 @@ namespace Technosoftware
 
         inline std::string NumberFormatter::Format(long value)
         {
-            std::string result;
-            IntToStr(value, 10, result);
-            return result;
+            char buffer[NF_MAX_INT_STRING_LEN];
+            return std::string(buffer, ToChars(buffer, NF_MAX_INT_STRING_LEN, value));
         }
 
 
@@ -1191,9 +1335,8 @@ namespace Technosoftware
 
         inline std::string NumberFormatter::Format(unsigned long value)
         {
-            std::string result;
-            UIntToStr(value, 10, result);
-            return result;
+            char buffer[NF_MAX_INT_STRING_LEN];
+            return std::string(buffer, ToChars(buffer, NF_MAX_INT_STRING_LEN, value));
         }
 
 
@@ -1234,9 +1377,8 @@ namespace Technosoftware
 
         inline std::string NumberFormatter::Format(Int64 value)
         {
-            std::string result;
-            IntToStr(value, 10, result);
-            return result;
+            char buffer[NF_MAX_INT_STRING_LEN];
+            return std::string(buffer, ToChars(buffer, NF_MAX_INT_STRING_LEN, value));
         }
 
 
@@ -1274,9 +1416,8 @@ namespace Technosoftware
 
         inline std::string NumberFormatter::Format(UInt64 value)
         {
-            std::string result;
-            UIntToStr(value, 10, result);
-            return result;
+            char buffer[NF_MAX_INT_STRING_LEN];
+            return std::string(buffer, ToChars(buffer, NF_MAX_INT_STRING_LEN, value));
         }
 
 
@@ -1341,9 +1482,8 @@ namespace Technosoftware
 
         inline std::string NumberFormatter::Format(double value)
         {
-            char buffer[TECHNOSOFTWARE_MAX_FLT_STRING_LEN];
-            DoubleToStr(buffer, TECHNOSOFTWARE_MAX_FLT_STRING_LEN, value);
-            return std::string(buffer);
+            char buffer[NF_MAX_DBL_CHARS_LEN];
+            return std::string(buffer, ToChars(buffer, NF_MAX_DBL_CHARS_LEN, value));
         }
 
 
@@ -614,6 +614,23 @@ namespace Technosoftware
             float value,
             int precision);
 
+        /**
+         * @fn    TECHNOSOFTWARE_API std::size_t FloatToChars(char* buffer, std::size_t bufferSize, float value) noexcept;
+         *
+         * @brief    Converts a float value to the same shortest representation as FloatToStr() with the
+         *             default lowDec and highDec. The result is not zero terminated.
+         *
+         * @param [out]    buffer    The buffer.
+         * @param    bufferSize          Size of the buffer.
+         * @param    value              The value.
+         *
+         * @return    The number of characters written or 0 if the buffer is too small.
+         *
+         * @ingroup BaseCore
+         */
+
+        TECHNOSOFTWARE_API std::size_t FloatToChars(char* buffer, std::size_t bufferSize, float value) noexcept;
+
         /**
          * @fn    TECHNOSOFTWARE_API std::string& FloatToStr(std::string& str, float value, int precision = -1, int width = 0, char thSep = 0, char decSep = 0);
          *
@@ -712,6 +729,24 @@ namespace Technosoftware
             double value,
             int precision);
 
+        /**
+         * @fn    TECHNOSOFTWARE_API std::size_t DoubleToChars(char* buffer, std::size_t bufferSize, double value) noexcept;
+         *
+         * @brief    Converts a double value to the same shortest representation as DoubleToStr() with the
+         *             default lowDec and highDec. The result is not zero terminated and the converter is
+         *             not constructed per call.
+         *
+         * @param [out]    buffer    The buffer.
+         * @param    bufferSize          Size of the buffer.
+         * @param    value              The value.
+         *
+         * @return    The number of characters written or 0 if the buffer is too small.
+         *
+         * @ingroup BaseCore
+         */
+
+        TECHNOSOFTWARE_API std::size_t DoubleToChars(char* buffer, std::size_t bufferSize, double value) noexcept;
+
         /**
          * @fn    TECHNOSOFTWARE_API std::string& DoubleToStr(std::string& str, double value, int precision = -1, int width = 0, char thSep = 0, char decSep = 0);
          *
@@ -838,6 +873,77 @@ namespace Technosoftware
          */
 
         TECHNOSOFTWARE_API bool StrToDouble(const std::string& str, double& result, char decSep = '.', char thSep = ',');
+
+        //
+        // Parsing of numbers without NUL terminator, locale or allocation.
+        //
+        // The decimal significand and exponent are converted with the Eisel-Lemire algorithm
+        // (https://arxiv.org/abs/2101.11408). The rare inputs it cannot decide, e.g. numbers with more
+        // than 19 significant digits close to a rounding boundary, are converted by the bignum based
+        // Strtod() of the double-conversion library.
+        //
+
+        /**
+         * @fn    TECHNOSOFTWARE_API std::size_t CharsToDouble(const char* str, std::size_t length, double& result) noexcept;
+         *
+         * @brief    Parses a double-precision floating point number from the beginning of a character
+         *             range, like std::from_chars().
+         *             
+         *             The accepted syntax is an optional '-', decimal digits with an optional '.' and
+         *             fraction, and an optional exponent ('e' or 'E', optional sign, digits), or "inf",
+         *             "infinity" or "nan" in any case. Leading spaces and '+' are not accepted. The
+         *             result is rounded to nearest; values out of range give infinity or zero.
+         *
+         * @param    str              The characters, need not be zero terminated.
+         * @param    length          The number of characters.
+         * @param [out]    result    Receives the value. Not modified if no number was found.
+         *
+         * @return    The number of characters consumed or 0 if the range does not start with a number.
+         *
+         * @ingroup BaseCore
+         */
+
+        TECHNOSOFTWARE_API std::size_t CharsToDouble(const char* str, std::size_t length, double& result) noexcept;
+
+        /**
+         * @fn    TECHNOSOFTWARE_API std::size_t CharsToFloat(const char* str, std::size_t length, float& result) noexcept;
+         *
+         * @brief    Parses a single-precision floating point number from the beginning of a character
+         *             range. See CharsToDouble() for the syntax. The number is rounded to float directly,
+         *             not through double.
+         *
+         * @param    str              The characters, need not be zero terminated.
+         * @param    length          The number of characters.
+         * @param [out]    result    Receives the value. Not modified if no number was found.
+         *
+         * @return    The number of characters consumed or 0 if the range does not start with a number.
+         *
+         * @ingroup BaseCore
+         */
+
+        TECHNOSOFTWARE_API std::size_t CharsToFloat(const char* str, std::size_t length, float& result) noexcept;
+
+        /**
+         * @fn    TECHNOSOFTWARE_API std::size_t CharsToDoubles(const char* str, std::size_t length, char separator, double* values, std::size_t count, std::size_t* consumed = 0) noexcept;
+         *
+         * @brief    Parses a delimited list of numbers, e.g. a column or a line of a setpoint file.
+         *             Spaces, tabs, carriage returns and line feeds around the numbers are skipped.
+         *             Parsing stops at the end of the range, after count values or at the first field
+         *             which is not a number.
+         *
+         * @param    str                  The characters, need not be zero terminated.
+         * @param    length              The number of characters.
+         * @param    separator          The character between two numbers, e.g. ';', ',' or '\n'.
+         * @param [out]    values        Receives the values.
+         * @param    count              The capacity of values.
+         * @param [out]    consumed    (Optional) Receives the number of characters consumed.
+         *
+         * @return    The number of values parsed.
+         *
+         * @ingroup BaseCore
+         */
+
+        TECHNOSOFTWARE_API std::size_t CharsToDoubles(const char* str, std::size_t length, char separator, double* values, std::size_t count, std::size_t* consumed = 0) noexcept;
     }
 }
 
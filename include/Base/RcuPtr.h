@@ -0,0 +1,278 @@
+/*
+ * Copyright (c) 2011-2021 Technosoftware GmbH. All rights reserved
+ * Web: https://technosoftware.com
+ *
+ * Purpose:
+ * Definition of the Rcu class and the RcuPtr template.
+ *
+ * The source code in this file is covered under a dual-license scenario:
+ *   - Owner of a purchased license: SCLA 1.0
+ *   - GPL V3: everybody else
+ *
+ * SCLA license terms accompanied with this source code.
+ * See SCLA 1.0: https://technosoftware.com/license/Source_Code_License_Agreement.pdf
+ *
+ * GNU General Public License as published by the Free Software Foundation;
+ * version 3 of the License are accompanied with this source code.
+ * See https://technosoftware.com/license/GPLv3License.txt
+ *
+ * This source code is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#ifndef TECHNOSOFTWARE_RCUPTR_H
+#define TECHNOSOFTWARE_RCUPTR_H
+
+#include "Base/Base.h"
+#include "Base/Bugcheck.h"
+
+#include <atomic>
+#include <cstddef>
+
+namespace Technosoftware
+{
+    namespace Base
+    {
+        /**
+         * @class   Rcu
+         *
+         * @brief   Epoch based reclamation for read-copy-update. Shared by all RcuPtr objects.
+         *
+         *          A reader announces the global epoch in a slot of its own (one cache line per thread)
+         *          when it enters a read section, and clears it when it leaves. A writer publishes a new
+         *          object, advances the global epoch and retires the old object with that epoch; the
+         *          old object is deleted once no reader has announced an older epoch. Readers never
+         *          wait and never write to memory shared with other readers.
+         *
+         *          Read sections can be nested. Synchronize() must not be called inside a read section.
+         *
+         * @ingroup BaseCore
+         */
+
+        class TECHNOSOFTWARE_API Rcu
+        {
+        public:
+            typedef void (*Deleter)(void*);
+
+            /**
+             * @fn  static void Rcu::ReadLock();
+             *
+             * @brief   Enters a read section. Objects read from an RcuPtr stay valid until the matching
+             *          ReadUnlock().
+             */
+
+            static void ReadLock();
+
+            /**
+             * @fn  static void Rcu::ReadUnlock();
+             *
+             * @brief   Leaves a read section.
+             */
+
+            static void ReadUnlock();
+
+            /**
+             * @fn  static void Rcu::Retire(void* object, Deleter deleter);
+             *
+             * @brief   Hands an object which has been unlinked from all RcuPtr objects over for deletion.
+             *          The deleter is called once all read sections which might still use the object
+             *          have been left. Objects which can be reclaimed already are deleted before the
+             *          call returns; the call never waits for readers.
+             *
+             * @param [in]  object  The object, may be null.
+             * @param       deleter The function deleting the object.
+             */
+
+            static void Retire(void* object, Deleter deleter);
+
+            /**
+             * @fn  static void Rcu::Synchronize();
+             *
+             * @brief   Waits until all read sections entered before the call have been left and deletes
+             *          all retired objects.
+             */
+
+            static void Synchronize();
+
+            /**
+             * @fn  static std::size_t Rcu::GetRetiredCount();
+             *
+             * @brief   Returns the number of retired objects not yet deleted.
+             *
+             * @return  The number of retired objects.
+             */
+
+            static std::size_t GetRetiredCount();
+
+        private:
+            Rcu();
+        };
+
+
+        /**
+         * @class   ScopedRcuReadLock
+         *
+         * @brief   A class that simplifies reading from RcuPtr objects. The constructor enters a read
+         *          section and the destructor leaves it.
+         *
+         * @ingroup BaseCore
+         */
+
+        class TECHNOSOFTWARE_API ScopedRcuReadLock
+        {
+        public:
+            ScopedRcuReadLock();
+            ~ScopedRcuReadLock();
+
+        private:
+            ScopedRcuReadLock(const ScopedRcuReadLock&);
+            ScopedRcuReadLock& operator = (const ScopedRcuReadLock&);
+        };
+
+
+        /**
+         * @class   RcuPtr
+         *
+         * @brief   Owns an object which is read often and replaced rarely, like a handle table or a
+         *          browse cache, and shares it with readers without locking.
+         *
+         *          Readers call Get() inside a read section (see ScopedRcuReadLock) and may use the
+         *          object until they leave the read section. A writer never modifies the current object
+         *          but replaces it, either with Store() or with Update() which modifies a copy; the
+         *          previous object is deleted through Rcu once all readers are done with it.
+         *
+         * @tparam  T   The type of the owned object.
+         *
+         * @ingroup BaseCore
+         */
+
+        template <class T>
+        class RcuPtr
+        {
+        public:
+
+            /**
+             * @fn  RcuPtr::RcuPtr();
+             *
+             * @brief   Creates an RcuPtr which owns no object.
+             */
+
+            RcuPtr() :
+                ptr_(0)
+            {
+            }
+
+            /**
+             * @fn  explicit RcuPtr::RcuPtr(T* object);
+             *
+             * @brief   Creates an RcuPtr which takes ownership of the given object.
+             *
+             * @param [in]  object  The object, may be null.
+             */
+
+            explicit RcuPtr(T* object) :
+                ptr_(object)
+            {
+            }
+
+            /**
+             * @fn  RcuPtr::~RcuPtr();
+             *
+             * @brief   Retires the owned object.
+             */
+
+            ~RcuPtr()
+            {
+                Rcu::Retire(ptr_.load(std::memory_order_relaxed), &RcuPtr::Delete);
+            }
+
+            /**
+             * @fn  T* RcuPtr::Get() const;
+             *
+             * @brief   Returns the current object. Must be called inside a read section, the object may
+             *          be deleted as soon as the read section is left.
+             *
+             * @return  The current object, may be null.
+             */
+
+            T* Get() const
+            {
+                return ptr_.load(std::memory_order_acquire);
+            }
+
+            /**
+             * @fn  void RcuPtr::Store(T* object);
+             *
+             * @brief   Replaces the current object and retires the previous one.
+             *
+             * @param [in]  object  The new object, may be null.
+             */
+
+            void Store(T* object)
+            {
+                T* previous = ptr_.exchange(object, std::memory_order_acq_rel);
+                Rcu::Retire(previous, &RcuPtr::Delete);
+            }
+
+            /**
+             * @fn  template <class F> void RcuPtr::Update(F function);
+             *
+             * @brief   Replaces the current object with a modified copy. The function is called with a
+             *          copy of the current object; if another writer replaced the object in the meantime,
+             *          the copy is discarded and the function is called again with a copy of the new
+             *          object. The RcuPtr must own an object.
+             *
+             * @param   function    A function or functor called with a T& to the copy.
+             */
+
+            template <class F>
+            void Update(F function)
+            {
+                ScopedRcuReadLock lock;
+                T* current = ptr_.load(std::memory_order_acquire);
+                for (;;)
+                {
+                    technosoftware_check_ptr(current);
+                    T* copy = new T(*current);
+                    function(*copy);
+                    if (ptr_.compare_exchange_strong(current, copy, std::memory_order_acq_rel, std::memory_order_acquire))
+                    {
+                        Rcu::Retire(current, &RcuPtr::Delete);
+                        return;
+                    }
+                    delete copy;
+                }
+            }
+
+        private:
+            RcuPtr(const RcuPtr&);
+            RcuPtr& operator = (const RcuPtr&);
+
+            static void Delete(void* object)
+            {
+                delete static_cast<T*>(object);
+            }
+
+            std::atomic<T*> ptr_;
+        };
+
+
+        //
+        // inlines
+        //
+
+        inline ScopedRcuReadLock::ScopedRcuReadLock()
+        {
+            Rcu::ReadLock();
+        }
+
+
+        inline ScopedRcuReadLock::~ScopedRcuReadLock()
+        {
+            Rcu::ReadUnlock();
+        }
+    }
+}
+
+#endif /* TECHNOSOFTWARE_RCUPTR_H */
@@ -0,0 +1,136 @@
+/*
+ * Copyright (c) 2011-2021 Technosoftware GmbH. All rights reserved
+ * Web: https://technosoftware.com
+ *
+ * Purpose:
+ * Definition of the RefCountedObject class.
+ *
+ * The source code in this file is covered under a dual-license scenario:
+ *   - Owner of a purchased license: SCLA 1.0
+ *   - GPL V3: everybody else
+ *
+ * SCLA license terms accompanied with this source code.
+ * See SCLA 1.0: https://technosoftware.com/license/Source_Code_License_Agreement.pdf
+ *
+ * GNU General Public License as published by the Free Software Foundation;
+ * version 3 of the License are accompanied with this source code.
+ * See https://technosoftware.com/license/GPLv3License.txt
+ *
+ * This source code is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#ifndef TECHNOSOFTWARE_REFCOUNTEDOBJECT_H
+#define TECHNOSOFTWARE_REFCOUNTEDOBJECT_H
+
+#include "Base/Base.h"
+
+#include <atomic>
+
+namespace Technosoftware
+{
+    namespace Base
+    {
+        /**
+         * @class   RefCountedObject
+         *
+         * @brief   A base class for objects which keep their reference count in the object itself and
+         *          are shared with AutoPtr, like batches of values or events passed to several callback
+         *          threads.
+         *
+         *          Compared to SharedPtr, an AutoPtr to a RefCountedObject is a single pointer, copying
+         *          it touches only the object and no separate counter has to be allocated. The count is
+         *          incremented with relaxed ordering; the decrement which drops it to zero synchronizes
+         *          with all other decrements before the object is deleted.
+         *
+         *          Objects are created with a reference count of one and deleted by Release(); the
+         *          destructor is protected so that they can't be deleted directly.
+         *
+         * @ingroup BaseCore
+         */
+
+        class TECHNOSOFTWARE_API RefCountedObject
+        {
+        public:
+
+            /**
+             * @fn  RefCountedObject::RefCountedObject();
+             *
+             * @brief   Creates the RefCountedObject with a reference count of one.
+             */
+
+            RefCountedObject();
+
+            /**
+             * @fn  void RefCountedObject::Duplicate() const;
+             *
+             * @brief   Increments the reference count.
+             */
+
+            void Duplicate() const;
+
+            /**
+             * @fn  void RefCountedObject::Release() const;
+             *
+             * @brief   Decrements the reference count and deletes the object if the count reaches zero.
+             */
+
+            void Release() const;
+
+            /**
+             * @fn  int RefCountedObject::ReferenceCount() const;
+             *
+             * @brief   Returns the reference count.
+             *
+             * @return  The reference count.
+             */
+
+            int ReferenceCount() const;
+
+        protected:
+
+            /**
+             * @fn  virtual RefCountedObject::~RefCountedObject();
+             *
+             * @brief   Destroys the RefCountedObject.
+             */
+
+            virtual ~RefCountedObject();
+
+        private:
+            RefCountedObject(const RefCountedObject&);
+            RefCountedObject& operator = (const RefCountedObject&);
+
+            mutable std::atomic<int> counter_;
+        };
+
+
+        //
+        // inlines
+        //
+
+        inline void RefCountedObject::Duplicate() const
+        {
+            counter_.fetch_add(1, std::memory_order_relaxed);
+        }
+
+
+        inline void RefCountedObject::Release() const
+        {
+            if (counter_.fetch_sub(1, std::memory_order_release) == 1)
+            {
+                std::atomic_thread_fence(std::memory_order_acquire);
+                delete this;
+            }
+        }
+
+
+        inline int RefCountedObject::ReferenceCount() const
+        {
+            return counter_.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+#endif /* TECHNOSOFTWARE_REFCOUNTEDOBJECT_H */
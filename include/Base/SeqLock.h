@@ -0,0 +1,268 @@
+/*
+ * Copyright (c) 2011-2021 Technosoftware GmbH. All rights reserved
+ * Web: https://technosoftware.com
+ *
+ * Purpose:
+ * Definition of the SeqLock template.
+ *
+ * The source code in this file is covered under a dual-license scenario:
+ *   - Owner of a purchased license: SCLA 1.0
+ *   - GPL V3: everybody else
+ *
+ * SCLA license terms accompanied with this source code.
+ * See SCLA 1.0: https://technosoftware.com/license/Source_Code_License_Agreement.pdf
+ *
+ * GNU General Public License as published by the Free Software Foundation;
+ * version 3 of the License are accompanied with this source code.
+ * See https://technosoftware.com/license/GPLv3License.txt
+ *
+ * This source code is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#ifndef TECHNOSOFTWARE_SEQLOCK_H
+#define TECHNOSOFTWARE_SEQLOCK_H
+
+#include "Base/Base.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+#include <thread>
+#include <type_traits>
+
+namespace Technosoftware
+{
+    namespace Base
+    {
+        /**
+         * @class   SeqLock
+         *
+         * @brief   A sequence lock protecting a small value which is read often and written rarely,
+         *          like a server status or a set of statistics.
+         *
+         *          Readers never write to shared memory: they copy the value and check a sequence
+         *          counter before and after the copy, and retry if a writer was active in between.
+         *          A reader therefore never blocks a writer and never invalidates the cache line of
+         *          other readers, which an RWLock does with every ReadLock() and Unlock(). Writers
+         *          are serialized by the sequence counter itself and spin while another writer is
+         *          active.
+         *
+         *          The value is stored as an array of atomic words so that a copy overlapping a write
+         *          is not a data race; the type must be trivially copyable. A reader copies the whole
+         *          value, so the type should be small (a few cache lines at most). Larger structures
+         *          should be shared with an RcuPtr.
+         *
+         * @tparam  T   The value type, must be trivially copyable.
+         *
+         * @ingroup BaseCore
+         */
+
+        template <class T>
+        class SeqLock
+        {
+        public:
+            typedef T ValueType;
+
+            /**
+             * @fn  SeqLock::SeqLock();
+             *
+             * @brief   Creates a SeqLock holding a value initialized T.
+             */
+
+            SeqLock() :
+                sequence_(0)
+            {
+                Put(T());
+            }
+
+            /**
+             * @fn  explicit SeqLock::SeqLock(const T& value);
+             *
+             * @brief   Creates a SeqLock holding the given value.
+             *
+             * @param   value   The initial value.
+             */
+
+            explicit SeqLock(const T& value) :
+                sequence_(0)
+            {
+                Put(value);
+            }
+
+            /**
+             * @fn  T SeqLock::Load() const;
+             *
+             * @brief   Returns a consistent copy of the value. Spins while a writer is active.
+             *
+             * @return  The value.
+             */
+
+            T Load() const
+            {
+                T value;
+                Load(value);
+                return value;
+            }
+
+            /**
+             * @fn  void SeqLock::Load(T& value) const;
+             *
+             * @brief   Copies a consistent snapshot of the value. Spins while a writer is active.
+             *
+             * @param [out] value   Receives the value.
+             */
+
+            void Load(T& value) const
+            {
+                unsigned int spins = 0;
+                while (!TryLoad(value))
+                {
+                    Backoff(spins);
+                }
+            }
+
+            /**
+             * @fn  bool SeqLock::TryLoad(T& value) const;
+             *
+             * @brief   Tries to copy a consistent snapshot of the value.
+             *
+             * @param [out] value   Receives the value if successful, is left unchanged otherwise.
+             *
+             * @return  true if successful, false if a writer was active during the copy.
+             */
+
+            bool TryLoad(T& value) const
+            {
+                std::size_t before = sequence_.load(std::memory_order_acquire);
+                if (before & 1)
+                {
+                    return false;
+                }
+                Word copy[WORD_COUNT];
+                for (std::size_t i = 0; i < WORD_COUNT; ++i)
+                {
+                    copy[i] = words_[i].load(std::memory_order_relaxed);
+                }
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (sequence_.load(std::memory_order_relaxed) != before)
+                {
+                    return false;
+                }
+                std::memcpy(&value, copy, sizeof(T));
+                return true;
+            }
+
+            /**
+             * @fn  void SeqLock::Store(const T& value);
+             *
+             * @brief   Replaces the value. Spins while another writer is active.
+             *
+             * @param   value   The new value.
+             */
+
+            void Store(const T& value)
+            {
+                std::size_t sequence = BeginWrite();
+                Put(value);
+                sequence_.store(sequence + 2, std::memory_order_release);
+            }
+
+            /**
+             * @fn  template <class F> void SeqLock::Update(F function);
+             *
+             * @brief   Modifies the value in place. Other writers are excluded while the function runs,
+             *          readers retry until it has returned; the function should therefore be short.
+             *
+             * @param   function    A function or functor called with a T& to the current value.
+             */
+
+            template <class F>
+            void Update(F function)
+            {
+                std::size_t sequence = BeginWrite();
+                // No other thread stores the words while the sequence is odd.
+                Word copy[WORD_COUNT];
+                for (std::size_t i = 0; i < WORD_COUNT; ++i)
+                {
+                    copy[i] = words_[i].load(std::memory_order_relaxed);
+                }
+                T value;
+                std::memcpy(&value, copy, sizeof(T));
+                function(value);
+                Put(value);
+                sequence_.store(sequence + 2, std::memory_order_release);
+            }
+
+            /**
+             * @fn  std::size_t SeqLock::GetSequence() const;
+             *
+             * @brief   Returns the sequence counter, which is incremented by two with every write. Can
+             *          be used to detect if the value has changed since it was last read.
+             *
+             * @return  The sequence counter.
+             */
+
+            std::size_t GetSequence() const
+            {
+                return sequence_.load(std::memory_order_acquire) & ~std::size_t(1);
+            }
+
+        private:
+            SeqLock(const SeqLock&);
+            SeqLock& operator = (const SeqLock&);
+
+            static_assert(std::is_trivially_copyable<T>::value, "SeqLock requires a trivially copyable type");
+
+            typedef std::size_t Word;
+
+            enum
+            {
+                WORD_COUNT = (sizeof(T) + sizeof(Word) - 1) / sizeof(Word)
+            };
+
+            std::size_t BeginWrite()
+            {
+                unsigned int spins = 0;
+                std::size_t sequence = sequence_.load(std::memory_order_relaxed);
+                for (;;)
+                {
+                    if ((sequence & 1) == 0 &&
+                        sequence_.compare_exchange_weak(sequence, sequence + 1, std::memory_order_acquire, std::memory_order_relaxed))
+                    {
+                        break;
+                    }
+                    Backoff(spins);
+                    sequence = sequence_.load(std::memory_order_relaxed);
+                }
+                // Readers seeing any of the following stores must also see the odd sequence.
+                std::atomic_thread_fence(std::memory_order_release);
+                return sequence;
+            }
+
+            void Put(const T& value)
+            {
+                Word copy[WORD_COUNT] = {};
+                std::memcpy(copy, &value, sizeof(T));
+                for (std::size_t i = 0; i < WORD_COUNT; ++i)
+                {
+                    words_[i].store(copy[i], std::memory_order_relaxed);
+                }
+            }
+
+            static void Backoff(unsigned int& spins)
+            {
+                if (++spins > 64)
+                {
+                    std::this_thread::yield();
+                }
+            }
+
+            std::atomic<std::size_t>    sequence_;              // Odd while a writer is active
+            std::atomic<Word>           words_[WORD_COUNT];
+        };
+    }
+}
+
+#endif /* TECHNOSOFTWARE_SEQLOCK_H */
@@ -0,0 +1,278 @@
+/*
+ * Copyright (c) 2011-2021 Technosoftware GmbH. All rights reserved
+ * Web: https://technosoftware.com
+ *
+ * Purpose:
+ * Definition of the ShardedCounter class.
+ *
+ * The source code in this file is covered under a dual-license scenario:
+ *   - Owner of a purchased license: SCLA 1.0
+ *   - GPL V3: everybody else
+ *
+ * SCLA license terms accompanied with this source code.
+ * See SCLA 1.0: https://technosoftware.com/license/Source_Code_License_Agreement.pdf
+ *
+ * GNU General Public License as published by the Free Software Foundation;
+ * version 3 of the License are accompanied with this source code.
+ * See https://technosoftware.com/license/GPLv3License.txt
+ *
+ * This source code is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#ifndef TECHNOSOFTWARE_SHARDEDCOUNTER_H
+#define TECHNOSOFTWARE_SHARDEDCOUNTER_H
+
+#include "Base/Base.h"
+
+#include <atomic>
+#include <cstddef>
+
+namespace Technosoftware
+{
+    namespace Base
+    {
+        /**
+         * @class   ShardedCounter
+         *
+         * @brief   A counter for statistics which are incremented by many threads at high rates, like
+         *          the number of data changes, callbacks or errors.
+         *
+         *          An AtomicCounter is a single variable, all threads incrementing it compete for the
+         *          same cache line. A ShardedCounter keeps one slot per cache line for each of up to
+         *          MAX_SHARDS threads; a thread always increments the same slot with a relaxed atomic
+         *          add, which does not touch the cache lines of the other threads. Reading the value
+         *          adds up all slots and is therefore more expensive than an increment.
+         *
+         *          The number of slots is the number of processors rounded up to a power of two. Threads
+         *          are assigned to the slots round robin when they first use any ShardedCounter; with
+         *          more threads than slots, threads share a slot and the counter stays exact.
+         *
+         *          Unlike AtomicCounter, the increment and decrement operators do not return the value,
+         *          and a value read while other threads increment the counter is not a snapshot of a
+         *          single point in time.
+         *
+         * @ingroup BaseCore
+         */
+
+        class TECHNOSOFTWARE_API ShardedCounter
+        {
+        public:
+
+            /**
+             * @typedef long long ValueType
+             *
+             * @brief   The underlying integer type.
+             */
+
+            typedef long long ValueType;
+
+            enum
+            {
+                CACHE_LINE_SIZE = 64,
+                MAX_SHARDS      = 64
+            };
+
+            /**
+             * @fn  ShardedCounter::ShardedCounter();
+             *
+             * @brief   Creates a new ShardedCounter and initializes it to zero.
+             */
+
+            ShardedCounter();
+
+            /**
+             * @fn  explicit ShardedCounter::ShardedCounter(ValueType initialValue);
+             *
+             * @brief   Creates a new ShardedCounter and initializes it with the given value.
+             *
+             * @param   initialValue    The initial value.
+             */
+
+            explicit ShardedCounter(ValueType initialValue);
+
+            /**
+             * @fn  ShardedCounter::~ShardedCounter();
+             *
+             * @brief   Destroys the ShardedCounter.
+             */
+
+            ~ShardedCounter();
+
+            /**
+             * @fn  ShardedCounter& ShardedCounter::operator= (ValueType value);
+             *
+             * @brief   Assigns a value to the counter. Increments of other threads during the assignment
+             *          may be lost.
+             *
+             * @param   value   The value.
+             *
+             * @return  A reference to this object.
+             */
+
+            ShardedCounter& operator = (ValueType value);
+
+            /**
+             * @fn  operator ShardedCounter::ValueType () const;
+             *
+             * @brief   Returns the value of the counter.
+             *
+             * @return  The sum of all slots.
+             */
+
+            operator ValueType () const;
+
+            /**
+             * @fn  ValueType ShardedCounter::Value() const;
+             *
+             * @brief   Returns the value of the counter.
+             *
+             * @return  The sum of all slots.
+             */
+
+            ValueType Value() const;
+
+            /**
+             * @fn  void ShardedCounter::operator++ ();
+             *
+             * @brief   Increments the counter.
+             */
+
+            void operator ++ (); // prefix
+
+            /**
+             * @fn  void ShardedCounter::operator++ (int);
+             *
+             * @brief   Increments the counter.
+             */
+
+            void operator ++ (int); // postfix
+
+            /**
+             * @fn  void ShardedCounter::operator-- ();
+             *
+             * @brief   Decrements the counter.
+             */
+
+            void operator -- (); // prefix
+
+            /**
+             * @fn  void ShardedCounter::operator-- (int);
+             *
+             * @brief   Decrements the counter.
+             */
+
+            void operator -- (int); // postfix
+
+            /**
+             * @fn  void ShardedCounter::Add(ValueType value);
+             *
+             * @brief   Adds a value to the counter.
+             *
+             * @param   value   The value to add, may be negative.
+             */
+
+            void Add(ValueType value);
+
+            /**
+             * @fn  bool ShardedCounter::operator! () const;
+             *
+             * @brief   Returns true if the counter is zero, false otherwise.
+             *
+             * @return  The logical inverse of this value.
+             */
+
+            bool operator ! () const;
+
+            /**
+             * @fn  std::size_t ShardedCounter::GetShardCount() const;
+             *
+             * @brief   Returns the number of slots.
+             *
+             * @return  The number of slots, a power of two.
+             */
+
+            std::size_t GetShardCount() const;
+
+        private:
+            ShardedCounter(const ShardedCounter&);
+            ShardedCounter& operator = (const ShardedCounter&);
+
+            struct Shard
+            {
+                std::atomic<ValueType>  value;
+                char                    padding[CACHE_LINE_SIZE - sizeof(std::atomic<ValueType>)];
+            };
+
+            void Init(ValueType initialValue);
+            Shard& GetShard();
+
+            static unsigned int ThreadIndex();
+
+            char*       memory_;        // Allocation holding the cache line aligned slots
+            Shard*      shards_;
+            std::size_t mask_;          // Number of slots - 1
+        };
+
+
+        //
+        // inlines
+        //
+
+        inline ShardedCounter::Shard& ShardedCounter::GetShard()
+        {
+            return shards_[ThreadIndex() & mask_];
+        }
+
+
+        inline void ShardedCounter::operator ++ () // prefix
+        {
+            GetShard().value.fetch_add(1, std::memory_order_relaxed);
+        }
+
+
+        inline void ShardedCounter::operator ++ (int) // postfix
+        {
+            GetShard().value.fetch_add(1, std::memory_order_relaxed);
+        }
+
+
+        inline void ShardedCounter::operator -- () // prefix
+        {
+            GetShard().value.fetch_sub(1, std::memory_order_relaxed);
+        }
+
+
+        inline void ShardedCounter::operator -- (int) // postfix
+        {
+            GetShard().value.fetch_sub(1, std::memory_order_relaxed);
+        }
+
+
+        inline void ShardedCounter::Add(ValueType value)
+        {
+            GetShard().value.fetch_add(value, std::memory_order_relaxed);
+        }
+
+
+        inline ShardedCounter::operator ShardedCounter::ValueType () const
+        {
+            return Value();
+        }
+
+
+        inline bool ShardedCounter::operator ! () const
+        {
+            return Value() == 0;
+        }
+
+
+        inline std::size_t ShardedCounter::GetShardCount() const
+        {
+            return mask_ + 1;
+        }
+    }
+}
+
+#endif /* TECHNOSOFTWARE_SHARDEDCOUNTER_H */
@@ -32,6 +32,11 @@
 #include "Base/Exception.h"
 #include "Base/AtomicCounter.h"
 #include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
 
 namespace Technosoftware
 {
@@ -42,33 +47,58 @@ namespace Technosoftware
          *
          * @brief    Simple ReferenceCounter object, does not delete itself when count reaches 0.
          *
+         *           Copies of a SharedPtr only need the increment to be atomic, it is done with relaxed
+         *           ordering. The decrement which drops the count to zero synchronizes with all other
+         *           decrements, so that the object is deleted after all uses of it in other threads.
+         *
          * @ingroup BaseCore
          */
 
         class ReferenceCounter
         {
         public:
-            ReferenceCounter() : atomicCounter_(1)
+            ReferenceCounter() : counter_(1), destroy_(0)
             {
             }
 
             void duplicate()
             {
-                ++atomicCounter_;
+                counter_.fetch_add(1, std::memory_order_relaxed);
             }
 
             int release()
             {
-                return --atomicCounter_;
+                int count = counter_.fetch_sub(1, std::memory_order_release) - 1;
+                if (count == 0)
+                {
+                    std::atomic_thread_fence(std::memory_order_acquire);
+                }
+                return count;
             }
 
             int referenceCount() const
             {
-                return atomicCounter_.Value();
+                return counter_.load(std::memory_order_relaxed);
+            }
+
+        protected:
+            typedef void (*Destroy)(ReferenceCounter*);
+
+            /// For counters allocated together with their object (see MakeShared()). The count starts
+            /// at zero and is taken by the first SharedPtr, the destroy function deletes the object and
+            /// the counter when the count reaches zero.
+            explicit ReferenceCounter(Destroy destroy) : counter_(0), destroy_(destroy)
+            {
             }
 
         private:
-            AtomicCounter atomicCounter_;
+            ReferenceCounter(const ReferenceCounter&);
+            ReferenceCounter& operator = (const ReferenceCounter&);
+
+            std::atomic<int> counter_;
+            Destroy          destroy_;
+
+            template <class C, class RC, class RP> friend class SharedPtr;
         };
 
 
@@ -112,6 +142,9 @@ namespace Technosoftware
             }
         };
 
+        template <class C, template <std::size_t> class A> class SharedBlock;
+
+
         /**
          * @class   SharedPtr
          *
@@ -452,14 +485,32 @@ namespace Technosoftware
                 int i = counter_->release();
                 if (i == 0)
                 {
-                    RP::release(ptr_);
+                    Dispose(counter_, ptr_);
                     ptr_ = 0;
-
-                    delete counter_;
                     counter_ = 0;
                 }
             }
 
+            static void Dispose(ReferenceCounter* pCounter, C* ptr)
+            {
+                if (pCounter->destroy_)
+                {
+                    pCounter->destroy_(pCounter);
+                }
+                else
+                {
+                    RP::release(ptr);
+                    delete pCounter;
+                }
+            }
+
+            template <class OtherRC>
+            static void Dispose(OtherRC* pCounter, C* ptr)
+            {
+                RP::release(ptr);
+                delete pCounter;
+            }
+
             SharedPtr(RC* pCounter, C* ptr) : counter_(pCounter), ptr_(ptr)
                 /// for cast operation
             {
@@ -472,6 +523,7 @@ namespace Technosoftware
             C*  ptr_;
 
             template <class OtherC, class OtherRC, class OtherRP> friend class SharedPtr;
+            template <class OtherC, template <std::size_t> class A> friend class SharedBlock;
         };
 
 
@@ -480,6 +532,212 @@ namespace Technosoftware
         {
             p1.swap(p2);
         }
+
+
+        /**
+         * @class   NewAllocator
+         *
+         * @brief   The default allocator for MakeShared(), which uses the global operator new.
+         *
+         * @tparam  Size    The size of the allocated blocks.
+         *
+         * @ingroup BaseCore
+         */
+
+        template <std::size_t Size>
+        class NewAllocator
+        {
+        public:
+            static void* Allocate()
+            {
+                return ::operator new(Size);
+            }
+
+            static void Deallocate(void* ptr)
+            {
+                ::operator delete(ptr);
+            }
+        };
+
+
+        /**
+         * @class   PoolAllocator
+         *
+         * @brief   An allocator for MakeShared() which keeps up to MAX_CACHED freed blocks of one size
+         *          per thread and reuses them without locking. Blocks freed by another thread than the
+         *          one which allocated them go to the cache of the freeing thread. The cache of a thread
+         *          is released when the thread exits.
+         *
+         *          Used for objects which are created and destroyed at high rates, like the values
+         *          passed to callbacks.
+         *
+         * @tparam  Size    The size of the allocated blocks.
+         *
+         * @ingroup BaseCore
+         */
+
+        template <std::size_t Size>
+        class PoolAllocator
+        {
+        public:
+            enum
+            {
+                MAX_CACHED = 64
+            };
+
+            static void* Allocate()
+            {
+                Cache& cache = cache_;
+                if (cache.head)
+                {
+                    Node* node = cache.head;
+                    cache.head = node->next;
+                    --cache.count;
+                    return node;
+                }
+                return ::operator new(Size);
+            }
+
+            static void Deallocate(void* ptr)
+            {
+                Cache& cache = cache_;
+                if (cache.count < MAX_CACHED)
+                {
+                    Node* node = static_cast<Node*>(ptr);
+                    node->next = cache.head;
+                    cache.head = node;
+                    ++cache.count;
+                }
+                else
+                {
+                    ::operator delete(ptr);
+                }
+            }
+
+        private:
+            struct Node
+            {
+                Node* next;
+            };
+
+            static_assert(Size >= sizeof(Node), "PoolAllocator block size too small");
+
+            struct Cache
+            {
+                Node*       head;
+                std::size_t count;
+
+                Cache() : head(0), count(0)
+                {
+                }
+
+                ~Cache()
+                {
+                    while (head)
+                    {
+                        Node* node = head;
+                        head = node->next;
+                        ::operator delete(node);
+                    }
+                }
+            };
+
+            static thread_local Cache cache_;
+        };
+
+        template <std::size_t Size>
+        thread_local typename PoolAllocator<Size>::Cache PoolAllocator<Size>::cache_;
+
+
+        /**
+         * @class   SharedBlock
+         *
+         * @brief   The reference counter and the object of a SharedPtr created by MakeShared(), in a
+         *          single allocation. Used only internally.
+         *
+         * @tparam  C   The type of the object.
+         * @tparam  A   The allocator, NewAllocator or PoolAllocator.
+         *
+         * @ingroup BaseCore
+         */
+
+        template <class C, template <std::size_t> class A>
+        class SharedBlock : public ReferenceCounter
+        {
+        public:
+            template <class... Args>
+            static SharedPtr<C> Create(Args&&... args)
+            {
+                typedef A<sizeof(SharedBlock)> Allocator;
+                void* memory = Allocator::Allocate();
+                SharedBlock* block = new (memory) SharedBlock;
+                C* ptr;
+                try
+                {
+                    ptr = new (&block->storage_) C(std::forward<Args>(args)...);
+                }
+                catch (...)
+                {
+                    block->~SharedBlock();
+                    Allocator::Deallocate(memory);
+                    throw;
+                }
+                return SharedPtr<C>(block, ptr);
+            }
+
+        private:
+            SharedBlock() : ReferenceCounter(&SharedBlock::Destroy)
+            {
+            }
+
+            static void Destroy(ReferenceCounter* pCounter)
+            {
+                typedef A<sizeof(SharedBlock)> Allocator;
+                SharedBlock* block = static_cast<SharedBlock*>(pCounter);
+                reinterpret_cast<C*>(&block->storage_)->~C();
+                block->~SharedBlock();
+                Allocator::Deallocate(block);
+            }
+
+            typename std::aligned_storage<sizeof(C), std::alignment_of<C>::value>::type storage_;
+        };
+
+
+        /**
+         * @fn  template <class C, class... Args> SharedPtr<C> MakeShared(Args&&... args)
+         *
+         * @brief   Creates an object and returns a SharedPtr owning it. The reference counter is
+         *          allocated together with the object, which saves one allocation compared to
+         *          SharedPtr<C>(new C(...)) and keeps the counter in the cache line of the object.
+         *
+         * @param   args    The arguments passed to the constructor of C.
+         *
+         * @return  A SharedPtr&lt;C&gt; with a reference count of one.
+         */
+
+        template <class C, class... Args>
+        inline SharedPtr<C> MakeShared(Args&&... args)
+        {
+            return SharedBlock<C, NewAllocator>::Create(std::forward<Args>(args)...);
+        }
+
+
+        /**
+         * @fn  template <class C, template <std::size_t> class A, class... Args> SharedPtr<C> MakeShared(Args&&... args)
+         *
+         * @brief   Creates an object with the given allocator, e.g. MakeShared&lt;C, PoolAllocator&gt;(...),
+         *          and returns a SharedPtr owning it.
+         *
+         * @param   args    The arguments passed to the constructor of C.
+         *
+         * @return  A SharedPtr&lt;C&gt; with a reference count of one.
+         */
+
+        template <class C, template <std::size_t> class A, class... Args>
+        inline SharedPtr<C> MakeShared(Args&&... args)
+        {
+            return SharedBlock<C, A>::Create(std::forward<Args>(args)...);
+        }
     }
 }
 
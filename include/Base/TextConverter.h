@@ -29,6 +29,7 @@
 #define TECHNOSOFTWARE_TEXTCONVERTER_H
 
 #include "Base/Base.h"
+#include <atomic>
 
 namespace Technosoftware
 {
@@ -41,6 +42,13 @@ namespace Technosoftware
          *
          * @brief   A TextConverter converts strings from one encoding into another.
          *
+         *          If the input encoding uses one byte per character (e.g. Latin-1 or Windows-1252), the
+         *          output for all 256 byte values is computed by the first conversion and later
+         *          conversions only look up the table. If both encodings encode the ASCII characters as
+         *          themselves, runs of ASCII characters are copied unchanged. Both shortcuts are used only
+         *          for conversions without a transform function, except that single byte input is always
+         *          decoded with the character map of the encoding.
+         *
          * @ingroup BaseText
          */
 
@@ -142,9 +150,29 @@ namespace Technosoftware
             TextConverter(const TextConverter&);
             TextConverter& operator = (const TextConverter&);
 
+            struct ByteSequence
+            {
+                unsigned char   bytes[4];           // Output for one input byte, at most MAX_SEQUENCE_LENGTH
+                unsigned char   length;
+                unsigned char   error;              // 1 if the input byte is malformed
+            };
+
+            struct ByteTable
+            {
+                std::size_t     maxSequenceLength;  // Longest output sequence in the table
+                ByteSequence    sequences[256];     // Output for each input byte
+            };
+
+            const ByteTable* GetByteTable();
+            int ConvertSingleByte(const unsigned char* it, const unsigned char* end, std::string& destination, Transform trans);
+            int ConvertMultiByte(const unsigned char* it, const unsigned char* end, std::string& destination, Transform trans, bool iteratorRules);
+
             const TextEncoding& inEncoding_;
             const TextEncoding& outEncoding_;
             int                 defaultChar_;
+            bool                singleByteInput_;   // Every input byte is a character of its own
+            bool                asciiCompatible_;   // ASCII is encoded as itself in both encodings
+            std::atomic<const ByteTable*> byteTable_;   // Built by GetByteTable() if singleByteInput_
         };
     }
 }
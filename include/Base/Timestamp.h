@@ -381,6 +381,38 @@ namespace Technosoftware
              */
 
             void ToFileTime(DWORD& fileTimeLow, DWORD& fileTimeHigh) const;
+
+            /**
+             * @fn  static void Timestamp::FromFileTimes(const FILETIME* fileTimes, std::size_t count, Timestamp* timestamps);
+             *
+             * @brief   Converts an array of FILETIME values to timestamps. The result is the same as
+             *          calling FromFileTime() for each value.
+             *          
+             *          On 32 bit x86 runs of values with the same high part, which is the case for samples
+             *          within about seven minutes, are converted with SSE2 and 32 bit arithmetic instead of
+             *          64 bit divisions.
+             *
+             * @param           fileTimes   The FILETIME values.
+             * @param           count       The number of values.
+             * @param [out]     timestamps  Receives count timestamps.
+             */
+
+            static void FromFileTimes(const FILETIME* fileTimes, std::size_t count, Timestamp* timestamps);
+
+            /**
+             * @fn  static void Timestamp::ToFileTimes(const Timestamp* timestamps, std::size_t count, FILETIME* fileTimes);
+             *
+             * @brief   Converts an array of timestamps to FILETIME values. The result is the same as
+             *          calling ToFileTime() for each timestamp.
+             *          
+             *          On 32 bit x86 two values at a time are converted with SSE2.
+             *
+             * @param           timestamps  The timestamps.
+             * @param           count       The number of timestamps.
+             * @param [out]     fileTimes   Receives count FILETIME values.
+             */
+
+            static void ToFileTimes(const Timestamp* timestamps, std::size_t count, FILETIME* fileTimes);
 #endif
 
         private:
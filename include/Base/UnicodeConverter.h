@@ -195,6 +195,97 @@ namespace Technosoftware
 
             static void Convert(const UTF32Char* utf32String, std::string& utf8String);
 
+            static const std::size_t INVALID_LENGTH = static_cast<std::size_t>(-1);
+
+            /**
+             * @fn  static std::size_t UnicodeConverter::UTF16Length(const char* utf8String, std::size_t length) noexcept;
+             *
+             * @brief   Validates an UTF-8 encoded character sequence and computes the number of UTF-16 code
+             *          units needed for it. Overlong sequences, surrogates and code points above U+10FFFF
+             *          are invalid. ASCII characters are checked 16 at a time where SSE2 is available.
+             *
+             * @param   utf8String  The UTF 8 string.
+             * @param   length      The length in bytes.
+             *
+             * @return  The number of UTF-16 code units or INVALID_LENGTH if the sequence is not valid.
+             */
+
+            static std::size_t UTF16Length(const char* utf8String, std::size_t length) noexcept;
+
+            /**
+             * @fn  static std::size_t UnicodeConverter::UTF8Length(const UTF16Char* utf16String, std::size_t length) noexcept;
+             *
+             * @brief   Validates an UTF-16 encoded character sequence and computes the number of bytes
+             *          needed for its UTF-8 encoding. Unpaired surrogates are invalid.
+             *
+             * @param   utf16String The UTF 16 string.
+             * @param   length      The length in code units.
+             *
+             * @return  The number of bytes or INVALID_LENGTH if the sequence is not valid.
+             */
+
+            static std::size_t UTF8Length(const UTF16Char* utf16String, std::size_t length) noexcept;
+
+            /**
+             * @fn  static std::size_t UnicodeConverter::Transcode(const char* utf8String, std::size_t length, UTF16Char* utf16String) noexcept;
+             *
+             * @brief   Converts a valid UTF-8 encoded character sequence into UTF-16. Runs of ASCII
+             *          characters are widened 16 at a time where SSE2 is available.
+             *
+             * @param           utf8String  The UTF 8 string, validated with UTF16Length().
+             * @param           length      The length in bytes.
+             * @param [out]     utf16String Receives UTF16Length() code units. Not zero terminated.
+             *
+             * @return  The number of code units written.
+             */
+
+            static std::size_t Transcode(const char* utf8String, std::size_t length, UTF16Char* utf16String) noexcept;
+
+            /**
+             * @fn  static std::size_t UnicodeConverter::Transcode(const UTF16Char* utf16String, std::size_t length, char* utf8String) noexcept;
+             *
+             * @brief   Converts a valid UTF-16 encoded character sequence into UTF-8. Runs of ASCII
+             *          characters are narrowed 16 at a time where SSE2 is available.
+             *
+             * @param           utf16String The UTF 16 string, validated with UTF8Length().
+             * @param           length      The length in code units.
+             * @param [out]     utf8String  Receives UTF8Length() bytes. Not zero terminated.
+             *
+             * @return  The number of bytes written.
+             */
+
+            static std::size_t Transcode(const UTF16Char* utf16String, std::size_t length, char* utf8String) noexcept;
+
+            /**
+             * @fn  static bool UnicodeConverter::TryConvert(const char* utf8String, std::size_t length, UTF16String& utf16String);
+             *
+             * @brief   Converts an UTF-8 encoded character sequence into an UTF-16 encoded wide string with
+             *          a single allocation.
+             *
+             * @param           utf8String  The UTF 8 string.
+             * @param           length      The length in bytes.
+             * @param [out]     utf16String The UTF 16 string. Cleared if the sequence is not valid.
+             *
+             * @return  false if the sequence is not valid UTF-8.
+             */
+
+            static bool TryConvert(const char* utf8String, std::size_t length, UTF16String& utf16String);
+
+            /**
+             * @fn  static bool UnicodeConverter::TryConvert(const UTF16Char* utf16String, std::size_t length, std::string& utf8String);
+             *
+             * @brief   Converts an UTF-16 encoded character sequence into an UTF-8 encoded string with a
+             *          single allocation.
+             *
+             * @param           utf16String The UTF 16 string.
+             * @param           length      The length in code units.
+             * @param [out]     utf8String  The UTF 8 string. Cleared if the sequence is not valid.
+             *
+             * @return  false if the sequence is not valid UTF-16.
+             */
+
+            static bool TryConvert(const UTF16Char* utf16String, std::size_t length, std::string& utf8String);
+
             template <typename F, typename T>
             static void toUTF32(const F& f, T& t)
             {
@@ -0,0 +1,193 @@
+/*
+ * Copyright (c) 2011-2021 Technosoftware GmbH. All rights reserved
+ * Web: https://www.technosoftware.com
+ *
+ * The source code in this file is covered under a dual-license scenario:
+ *   - Owner of a purchased license: SCLA 1.0
+ *   - GPL V3: everybody else
+ *
+ * SCLA license terms accompanied with this source code.
+ * See SCLA 1.0: https://technosoftware.com/license/Source_Code_License_Agreement.pdf
+ *
+ * GNU General Public License as published by the Free Software Foundation;
+ * version 3 of the License are accompanied with this source code.
+ * See https://technosoftware.com/license/GPLv3License.txt
+ *
+ * This source code is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#ifndef TECHNOSOFTWARE_DADATACAPTURE_H
+#define TECHNOSOFTWARE_DADATACAPTURE_H
+
+#include "DaAeHdaClient/ClientBase.h"
+#include "DaAeHdaClient/OpcBase.h"
+#include "DaAeHdaClient/Da/DaCommon.h"
+#include "Base/Status.h"
+#include "Base/Mutex.h"
+#include "Base/ChainBuffer.h"
+
+#include <stdio.h>
+
+namespace Technosoftware
+{
+    namespace DaAeHdaClient
+    {
+        class DaGroup;
+
+        /**
+         * @class   DaDataCaptureWriter
+         *
+         * @brief   Records the data change notifications of groups in a binary capture file.
+         *
+         *          A capture writer is attached to one or more groups with DaGroup::SetDataCapture().
+         *          Each notification received by the data callback of the group is appended to the file
+         *          before it is dispatched: transaction id, master quality and error, and for each item
+         *          the client handle, quality, time stamp, error and value. Items and groups are recorded
+         *          with the client handles supplied by the user so that a capture can be replayed in
+         *          another session with DaDataCaptureReplayer.
+         *
+         *          Scalar values, strings and one-dimensional arrays of scalar values are recorded; values
+         *          passed by reference are recorded as the referenced value. Values of other types, e.g.
+         *          arrays of strings or variants, are recorded as VT_EMPTY and counted by
+         *          GetDroppedValueCount().
+         *
+         * @ingroup  DAClient
+         */
+
+        class OPCCLIENTSDK_API DaDataCaptureWriter
+        {
+        public:
+
+            /**
+             * @fn  DaDataCaptureWriter::DaDataCaptureWriter(const char* fileName) noexcept(false);
+             *
+             * @brief   Creates the capture file. An existing file is overwritten.
+             *
+             * @exception   Technosoftware::Base::Exception Thrown when the file cannot be created.
+             *
+             * @param   fileName    The name of the capture file.
+             */
+
+            DaDataCaptureWriter(const char* fileName) noexcept(false);
+
+            /**
+             * @fn  DaDataCaptureWriter::~DaDataCaptureWriter() noexcept;
+             *
+             * @brief   Flushes and closes the capture file.
+             */
+
+            ~DaDataCaptureWriter() noexcept;
+
+            /**
+             * @fn  uint64_t DaDataCaptureWriter::GetRecordCount() const noexcept
+             *
+             * @brief   The number of notifications recorded so far.
+             *
+             * @return  An uint64_t.
+             */
+
+            uint64_t GetRecordCount() const noexcept { return records_; }
+
+            /**
+             * @fn  uint64_t DaDataCaptureWriter::GetDroppedValueCount() const noexcept
+             *
+             * @brief   The number of item values which could not be recorded and were stored as VT_EMPTY.
+             *
+             * @return  An uint64_t.
+             */
+
+            uint64_t GetDroppedValueCount() const noexcept { return droppedValues_; }
+
+            /**
+             * @fn  void DaDataCaptureWriter::Flush() noexcept;
+             *
+             * @brief   Writes all buffered records to the file.
+             */
+
+            void Flush() noexcept;
+
+        protected:
+            friend class CComOPCDataCallbackImpl;
+
+            void Write(DWORD transactionId, Base::ClientHandle groupClientHandle, HRESULT masterQuality, HRESULT masterError,
+                DWORD count, OPCHANDLE* clientItems, VARIANT* values, WORD* qualities, FILETIME* timeStamps, HRESULT* errors) noexcept;
+
+        private:
+            DaDataCaptureWriter(const DaDataCaptureWriter&);
+            DaDataCaptureWriter& operator = (const DaDataCaptureWriter&);
+
+            FILE*                       file_;
+            uint64_t                    records_;
+            uint64_t                    droppedValues_;
+            Base::ChainBuffer           record_;        // Reused record buffer
+            Base::FastMutex             mutex_;         // Groups may be notified concurrently
+        };
+
+        /**
+         * @class   DaDataCaptureReplayer
+         *
+         * @brief   Replays a capture file recorded with DaDataCaptureWriter.
+         *
+         *          The recorded notifications are passed to the data callback of a group exactly as if they
+         *          had been received from the server, so the same item lookup, result update and user
+         *          dispatch code is executed. Recorded items are mapped to the items of the target group by
+         *          their client handles; notifications for unknown client handles are dropped.
+         *
+         * @ingroup  DAClient
+         */
+
+        class OPCCLIENTSDK_API DaDataCaptureReplayer
+        {
+        public:
+
+            /**
+             * @fn  DaDataCaptureReplayer::DaDataCaptureReplayer(const char* fileName) noexcept(false);
+             *
+             * @brief   Opens a capture file.
+             *
+             * @exception   Technosoftware::Base::Exception Thrown when the file cannot be opened or is not a
+             *                                              capture file.
+             *
+             * @param   fileName    The name of the capture file.
+             */
+
+            DaDataCaptureReplayer(const char* fileName) noexcept(false);
+
+            /**
+             * @fn  DaDataCaptureReplayer::~DaDataCaptureReplayer() noexcept;
+             *
+             * @brief   Closes the capture file.
+             */
+
+            ~DaDataCaptureReplayer() noexcept;
+
+            /**
+             * @fn  Base::Status DaDataCaptureReplayer::Replay(DaGroup* group, bool realTime, uint64_t* replayedRecords = nullptr);
+             *
+             * @brief   Replays all records of the capture file through the data callback of a group.
+             *
+             *          The group must have a Data Change Subscription. The group must not record to a capture
+             *          writer while it replays.
+             *
+             * @param [in,out]  group           The group whose data callback receives the notifications.
+             * @param           realTime        true to keep the recorded time between notifications, false
+             *                                  to replay as fast as possible.
+             * @param [out]     replayedRecords (Optional) Receives the number of replayed notifications.
+             *
+             * @return  A Technosoftware::Base::Status.
+             */
+
+            Base::Status Replay(DaGroup* group, bool realTime, uint64_t* replayedRecords = nullptr);
+
+        private:
+            DaDataCaptureReplayer(const DaDataCaptureReplayer&);
+            DaDataCaptureReplayer& operator = (const DaDataCaptureReplayer&);
+
+            FILE*                       file_;
+        };
+    }
+}
+
+#endif // TECHNOSOFTWARE_DADATACAPTURE_H
@@ -37,6 +37,8 @@ namespace Technosoftware
         class DaItem;
         class DaIDataCallback;
         class DaGroupImpl;
+        class DaValueHistory;
+        class DaDataCaptureWriter;
 
 
         /**
@@ -224,6 +226,22 @@ namespace Technosoftware
                                     vector<DaItem*>& items,
                                     const std::function<void(const DaItemDefinition&, Base::Status)>& errorHandler = {});
 
+            /**
+             * @fn  Base::Status DaGroup::RemoveItems(vector<DaItem*>& items);
+             *
+             * @brief   Removes items from the group object.
+             *
+             *          This method can partly be successful. The DaItem instances of all items removed
+             *          successfully from the server are deleted and erased from the list. On return the list
+             *          only contains the items which could not be removed.
+             *
+             * @param [in,out]  items   List of items to be removed.
+             *
+             * @return  An Technosoftware::Base::Status.
+             */
+
+            Base::Status RemoveItems(vector<DaItem*>& items);
+
             /**
              * @fn  Base::Status DaGroup::Read(vector<DaItem*>& items, bool fromCache = true);
              *
@@ -399,7 +417,58 @@ namespace Technosoftware
 
             Base::Status Refresh(uint32_t transactionId, uint32_t* cancelId, bool fromCache = true);
 
+            /**
+             * @fn  Base::Status DaGroup::SetValueHistory(uint32_t depth, uint32_t maxItems);
+             *
+             * @brief   Enables, changes or disables the value history of the items of this group.
+             *
+             *          If enabled, every data change notification appends the value, quality and time stamp
+             *          of each item to a ring with the last depth samples of the item. The rings can be read
+             *          without locks from any thread with GetValueHistory(). The value history can only be
+             *          changed while the group has no Data Change Subscription; otherwise this method returns
+             *          a Technosoftware::Base::Status with result code E_FAIL.
+             *
+             * @param   depth       The number of samples kept per item. Use 0 to disable the value history.
+             * @param   maxItems    The maximum number of items with a history. Items exceeding this number
+             *                      don't have a history.
+             *
+             * @return  A Technosoftware::Base::Status.
+             */
+
+            Base::Status SetValueHistory(uint32_t depth, uint32_t maxItems);
+
+            /**
+             * @fn  DaValueHistory* DaGroup::GetValueHistory() const noexcept;
+             *
+             * @brief   The value history of the items of this group.
+             *
+             *          The returned object is valid until the value history is changed or the group is
+             *          destroyed.
+             *
+             * @return  null if the value history is not enabled, else the value history.
+             */
+
+            DaValueHistory* GetValueHistory() const noexcept;
+
+            /**
+             * @fn  Base::Status DaGroup::SetDataCapture(DaDataCaptureWriter* dataCapture);
+             *
+             * @brief   Starts or stops recording the data change notifications of this group.
+             *
+             *          The notifications are recorded before they are passed to the data callback. The
+             *          capture writer may be shared by several groups and must not be destroyed before it
+             *          is detached or the group is destroyed. A notification which is being recorded when
+             *          the writer is detached is completed before this function returns.
+             *
+             * @param [in,out]  dataCapture The capture writer. Use null to stop recording.
+             *
+             * @return  A Technosoftware::Base::Status.
+             */
+
+            Base::Status SetDataCapture(DaDataCaptureWriter* dataCapture);
+
         protected:
+            friend class DaDataCaptureReplayer;
             OpcAutoPtr<DaGroupImpl> impl_;
         };
     }
@@ -23,6 +23,7 @@
 
 #include "DaAeHdaClient/ClientBase.h"
 #include "DaAeHdaClient/OpcBase.h"
+#include "DaAeHdaClient/Da/DaVariantTraits.h"
 #include "Base/Handles.h"
 #include "Base/Status.h"
 #include <Base/Timestamp.h>
@@ -277,6 +278,69 @@ namespace Technosoftware
 
                 Base::Status GetResult() const noexcept { return result_; }
 
+                /**
+                 * @fn  template <typename T> bool DaReadResult::TryGet(T& value) const noexcept
+                 *
+                 * @brief   Gets the value if the VARIANT has exactly the type of T, see DaVariantTraits.
+                 *
+                 *          The type check is resolved at compile time; no conversion takes place.
+                 *
+                 * @param [out]     value   Receives the value.
+                 *
+                 * @return  false if the VARIANT has another type.
+                 */
+
+                template <typename T> bool TryGet(T& value) const noexcept
+                {
+                    if (value_.vt != DaVariantTraits<T>::Type) return false;
+                    value = DaVariantTraits<T>::Get(value_);
+                    return true;
+                }
+
+                /**
+                 * @fn  template <typename T> bool DaReadResult::GetAs(T& value) const noexcept
+                 *
+                 * @brief   Gets the value of any numeric scalar type converted to T, e.g. GetAs<double>().
+                 *
+                 *          Uses DaVariantToNumber() instead of VariantChangeType(), so strings are not
+                 *          converted.
+                 *
+                 * @param [out]     value   Receives the converted value.
+                 *
+                 * @return  false if the VARIANT is not a numeric scalar.
+                 */
+
+                template <typename T> bool GetAs(T& value) const noexcept
+                {
+                    return DaVariantToNumber(value_, value);
+                }
+
+                /**
+                 * @fn  template <typename T> bool DaReadResult::GetArray(const T*& elements, uint32_t& count) const noexcept
+                 *
+                 * @brief   Gets the elements of a one-dimensional array value of type VT_ARRAY | T without
+                 *          copying them.
+                 *
+                 *          The elements are owned by the read result and are valid until the next read or
+                 *          data change notification of the item updates the value.
+                 *
+                 * @param [out]     elements    Receives the address of the first element.
+                 * @param [out]     count       Receives the number of elements.
+                 *
+                 * @return  false if the value is no one-dimensional array of type T.
+                 */
+
+                template <typename T> bool GetArray(const T*& elements, uint32_t& count) const noexcept
+                {
+                    static_assert(DaVariantTraits<T>::Direct, "Array elements of this type can't be accessed directly");
+                    if (value_.vt != (VT_ARRAY | DaVariantTraits<T>::Type)) return false;
+                    const SAFEARRAY* array = value_.parray;
+                    if (!array || array->cDims != 1 || array->cbElements != sizeof(T)) return false;
+                    elements = static_cast<const T*>(array->pvData);
+                    count = array->rgsabound[0].cElements;
+                    return true;
+                }
+
             protected:
                 friend class DaItem;                // Access to c'tor, d'tor and Set()
                 friend class DaGroupImpl;           // Access to Attach()
@@ -522,6 +586,9 @@ namespace Technosoftware
 
         protected:
             friend class DaGroupImpl;
+            friend class DaValueHistory;
+            friend class CComOPCDataCallbackImpl;
+            friend class DaDataCaptureReplayer;
             VARIANT                         writeValue_;
 
             // Results of I/O Operations
@@ -531,6 +598,7 @@ namespace Technosoftware
             DaWriteResult                   writeAsyncResult_;
             Base::Status                    asyncCommandResult_;
             unsigned long                   internalClientHandle_;
+            uint32_t                        valueHistorySlot_;      // Ring in DaValueHistory of the parent group
 
         private:
             uint16_t                        canonicalDataType_;
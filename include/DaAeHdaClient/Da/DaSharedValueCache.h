@@ -0,0 +1,231 @@
+/*
+ * Copyright (c) 2011-2021 Technosoftware GmbH. All rights reserved
+ * Web: https://www.technosoftware.com
+ *
+ * The source code in this file is covered under a dual-license scenario:
+ *   - Owner of a purchased license: SCLA 1.0
+ *   - GPL V3: everybody else
+ *
+ * SCLA license terms accompanied with this source code.
+ * See SCLA 1.0: https://technosoftware.com/license/Source_Code_License_Agreement.pdf
+ *
+ * GNU General Public License as published by the Free Software Foundation;
+ * version 3 of the License are accompanied with this source code.
+ * See https://technosoftware.com/license/GPLv3License.txt
+ *
+ * This source code is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#ifndef TECHNOSOFTWARE_DASHAREDVALUECACHE_H
+#define TECHNOSOFTWARE_DASHAREDVALUECACHE_H
+
+#include "DaAeHdaClient/ClientBase.h"
+#include "DaAeHdaClient/OpcBase.h"
+#include "DaAeHdaClient/Da/DaItem.h"
+#include "DaAeHdaClient/Da/DaValueHistory.h"
+#include "Base/Status.h"
+
+namespace Technosoftware
+{
+    namespace DaAeHdaClient
+    {
+        struct DaSharedValueCacheHeader;
+        struct DaSharedValueCacheEntry;
+
+        /**
+         * @class   DaSharedValuePublisher
+         *
+         * @brief   Publishes the current values of items in a named shared memory table.
+         *
+         *          The publisher is a data callback which writes every received value to the entry of
+         *          the table with the index given by the client handle of the item. Client handles must
+         *          therefore be stable indices below the capacity of the table; items with other client
+         *          handles are ignored. Other processes read the table with a DaSharedValueReader, so
+         *          only one process needs to subscribe the items at the OPC server.
+         *
+         *          Each entry is protected by a sequence counter. The publisher never waits for readers
+         *          and readers never take a lock.
+         *
+         *          All notifications are forwarded to an optional user callback after the table has been
+         *          updated.
+         *
+         * @ingroup  DAClient
+         */
+
+        class OPCCLIENTSDK_API DaSharedValuePublisher : public DaIDataCallback
+        {
+        public:
+
+            /**
+             * @fn  DaSharedValuePublisher::DaSharedValuePublisher(const char* name, uint32_t capacity, DaIDataCallback* userDataCallback = nullptr) noexcept(false);
+             *
+             * @brief   Creates the named shared memory table.
+             *
+             *          If readers still hold the table of a publisher which has terminated, e.g. before the
+             *          client is restarted, the table is taken over and all entries are reset. Its size can't
+             *          change while it is held, so the capacity must not exceed the capacity of the old table.
+             *
+             * @exception   Technosoftware::Base::Exception Thrown when an exception error condition occurs,
+             *                                              e.g. if another running publisher uses the name.
+             *
+             * @param           name                The name of the shared memory, e.g. "Local\\OpcValues".
+             *                                      Must not be used by another publisher.
+             * @param           capacity            The number of entries of the table.
+             * @param [in,out]  userDataCallback    (Optional) Address of a callback which receives all
+             *                                      notifications after the table has been updated.
+             */
+
+            DaSharedValuePublisher(const char* name, uint32_t capacity, DaIDataCallback* userDataCallback = nullptr) noexcept(false);
+
+            /**
+             * @fn  DaSharedValuePublisher::~DaSharedValuePublisher() noexcept;
+             *
+             * @brief   Unmaps the table. The shared memory is released by the system when the last reader
+             *          has closed it too.
+             */
+
+            ~DaSharedValuePublisher() noexcept;
+
+            /**
+             * @fn  uint32_t DaSharedValuePublisher::GetCapacity() const noexcept;
+             *
+             * @brief   The number of entries of the table.
+             *
+             * @return  An uint32_t.
+             */
+
+            uint32_t GetCapacity() const noexcept;
+
+            /**
+             * @fn  Base::Status DaSharedValuePublisher::SetItemIdentifier(uint32_t index, const char* itemIdentifier);
+             *
+             * @brief   Stores the item identifier of an entry so that readers can look up its index with
+             *          DaSharedValueReader::FindIndex().
+             *
+             * @param   index           The index of the entry.
+             * @param   itemIdentifier  The item identifier. Longer identifiers are truncated.
+             *
+             * @return  A Technosoftware::Base::Status.
+             */
+
+            Base::Status SetItemIdentifier(uint32_t index, const char* itemIdentifier);
+
+            /**
+             * @fn  void DaSharedValuePublisher::Publish(uint32_t index, const VARIANT* value, Base::Timestamp timeStamp, uint16_t quality) noexcept;
+             *
+             * @brief   Writes a value to an entry of the table.
+             *
+             *          This method is called by the data callback but can also be used to publish values
+             *          from other sources.
+             *
+             * @param   index       The index of the entry.
+             * @param   value       The value. Only scalar values are published, see DaValueSample.
+             * @param   timeStamp   The time stamp (UTC).
+             * @param   quality     The quality.
+             */
+
+            void Publish(uint32_t index, const VARIANT* value, Base::Timestamp timeStamp, uint16_t quality) noexcept;
+
+            // DaIDataCallback functions
+            void DataChange(uint32_t transactionId, DaGroup* group, bool allQualitiesGood, bool allResultsOk, uint32_t numberOfItems, DaItem** items);
+            void ReadComplete(uint32_t transactionId, DaGroup* group, bool allQualitiesGood, bool allResultsOk, uint32_t numberOfItems, DaItem** items);
+            void WriteComplete(uint32_t transactionId, DaGroup* group, bool allResultsOk, uint32_t numberOfItems, DaItem** items);
+            void CancelComplete(uint32_t transactionId, DaGroup* group);
+
+        private:
+            DaSharedValuePublisher(const DaSharedValuePublisher&);
+            DaSharedValuePublisher& operator = (const DaSharedValuePublisher&);
+
+            void PublishItems(uint32_t numberOfItems, DaItem** items) noexcept;
+
+            void*                       mapping_;
+            DaSharedValueCacheHeader*   header_;
+            DaIDataCallback*            userDataCallback_;
+        };
+
+        /**
+         * @class   DaSharedValueReader
+         *
+         * @brief   Reads the values published by a DaSharedValuePublisher of another process.
+         *
+         *          The table is mapped read-only. Reads are lock-free and do not involve the OPC server.
+         *
+         * @ingroup  DAClient
+         */
+
+        class OPCCLIENTSDK_API DaSharedValueReader
+        {
+        public:
+
+            /**
+             * @fn  DaSharedValueReader::DaSharedValueReader(const char* name) noexcept(false);
+             *
+             * @brief   Opens the named shared memory table of a publisher.
+             *
+             * @exception   Technosoftware::Base::Exception Thrown when an exception error condition occurs,
+             *                                              e.g. if there is no publisher with this name.
+             *
+             * @param   name    The name of the shared memory passed to the publisher.
+             */
+
+            DaSharedValueReader(const char* name) noexcept(false);
+
+            /**
+             * @fn  DaSharedValueReader::~DaSharedValueReader() noexcept;
+             *
+             * @brief   Unmaps the table.
+             */
+
+            ~DaSharedValueReader() noexcept;
+
+            /**
+             * @fn  uint32_t DaSharedValueReader::GetCapacity() const noexcept;
+             *
+             * @brief   The number of entries of the table.
+             *
+             * @return  An uint32_t.
+             */
+
+            uint32_t GetCapacity() const noexcept;
+
+            /**
+             * @fn  bool DaSharedValueReader::Read(uint32_t index, DaValueSample& sample) const noexcept;
+             *
+             * @brief   Reads the current value of an entry.
+             *
+             * @param           index   The index of the entry.
+             * @param [out]     sample  Receives the value, quality and time stamp.
+             *
+             * @return  false if the index is invalid, no value has been published yet or the entry could
+             *          not be read consistently because the publisher keeps updating it.
+             */
+
+            bool Read(uint32_t index, DaValueSample& sample) const noexcept;
+
+            /**
+             * @fn  bool DaSharedValueReader::FindIndex(const char* itemIdentifier, uint32_t& index) const noexcept;
+             *
+             * @brief   Looks up the index of an entry by the item identifier set by the publisher.
+             *
+             * @param           itemIdentifier  The item identifier.
+             * @param [out]     index           Receives the index of the entry.
+             *
+             * @return  true if found, false if not.
+             */
+
+            bool FindIndex(const char* itemIdentifier, uint32_t& index) const noexcept;
+
+        private:
+            DaSharedValueReader(const DaSharedValueReader&);
+            DaSharedValueReader& operator = (const DaSharedValueReader&);
+
+            void*                       mapping_;
+            const DaSharedValueCacheHeader* header_;
+            uint32_t                    viewCapacity_;      // Number of entries which fit into the mapped view
+        };
+    }
+}
+
+#endif // TECHNOSOFTWARE_DASHAREDVALUECACHE_H
@@ -0,0 +1,246 @@
+/*
+ * Copyright (c) 2011-2021 Technosoftware GmbH. All rights reserved
+ * Web: https://www.technosoftware.com
+ *
+ * The source code in this file is covered under a dual-license scenario:
+ *   - Owner of a purchased license: SCLA 1.0
+ *   - GPL V3: everybody else
+ *
+ * SCLA license terms accompanied with this source code.
+ * See SCLA 1.0: https://technosoftware.com/license/Source_Code_License_Agreement.pdf
+ *
+ * GNU General Public License as published by the Free Software Foundation;
+ * version 3 of the License are accompanied with this source code.
+ * See https://technosoftware.com/license/GPLv3License.txt
+ *
+ * This source code is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#ifndef TECHNOSOFTWARE_DASUBSCRIPTIONMANAGER_H
+#define TECHNOSOFTWARE_DASUBSCRIPTIONMANAGER_H
+
+#include "DaAeHdaClient/ClientBase.h"
+#include "DaAeHdaClient/OpcBase.h"
+#include "DaAeHdaClient/Da/DaCommon.h"
+#include "Base/Handles.h"
+#include "Base/Status.h"
+
+#include <functional>
+
+namespace Technosoftware
+{
+    namespace DaAeHdaClient
+    {
+        class DaServer;
+        class DaItem;
+        class DaIDataCallback;
+        class DaSubscriptionManagerImpl;
+
+        /**
+         * @struct  DaSubscriptionItem
+         *
+         * @brief   Describes one item to be subscribed by a DaSubscriptionManager.
+         *
+         * @ingroup  DAClient
+         */
+
+        typedef struct DaSubscriptionItem {
+
+            /** @brief   Identifier for the item. */
+
+            const char*             ItemIdentifier;
+
+            /** @brief   The client handle of the item. Must be unique within the subscription manager. */
+
+            Base::ClientHandle      ClientHandle;
+
+            /** @brief   The desired update rate in milliseconds. */
+
+            uint32_t                RequestedUpdateRate;
+
+            /** @brief   The percent deadband. 0.0 means every change is reported. */
+
+            float                   PercentDeadband;
+
+        } DaSubscriptionItem;
+
+        /**
+         * @class   DaSubscriptionManager
+         *
+         * @brief   Distributes a flat list of subscribed items over automatically managed DaGroup objects.
+         *
+         *          Items are bucketed by the revised update rate the server grants for their requested
+         *          update rate and by their percent deadband. Each bucket consists of as many groups as
+         *          needed so that no group holds more than the configured maximum number of items, and new
+         *          items are spread evenly over the groups of their bucket. Removing items compacts the
+         *          buckets again so that no superfluous groups remain.
+         *
+         *          All notifications of all managed groups are forwarded to one user data callback. The
+         *          items passed to the callback can be identified with DaItem::GetClientHandle(). Compacting
+         *          a bucket moves items to new DaItem instances; the instances passed to a callback stay
+         *          valid until the callback has returned but must not be kept beyond it.
+         *
+         *          The subscription manager must be destroyed before its DaServer object.
+         *
+         * @ingroup  DAClient
+         */
+
+        class OPCCLIENTSDK_API DaSubscriptionManager
+        {
+        public:
+
+            /**
+             * @fn  DaSubscriptionManager::DaSubscriptionManager(DaServer* server, DaIDataCallback* userDataCallback, uint32_t maxItemsPerGroup = 1000) noexcept(false);
+             *
+             * @brief   Constructs a DaSubscriptionManager object.
+             *
+             * @exception   Technosoftware::Base::Exception Thrown when an exception error condition occurs.
+             *
+             * @param [in,out]  server              Address of a connected DaServer object used to create the
+             *                                      groups.
+             * @param [in,out]  userDataCallback    Address of the object which receives the notifications of
+             *                                      all managed groups.
+             * @param           maxItemsPerGroup    (Optional) The maximum number of items in one group.
+             */
+
+            DaSubscriptionManager(DaServer* server, DaIDataCallback* userDataCallback, uint32_t maxItemsPerGroup = 1000) noexcept(false);
+
+            /**
+             * @fn  DaSubscriptionManager::~DaSubscriptionManager() noexcept;
+             *
+             * @brief   Destroys the DaSubscriptionManager object and removes all managed groups and items.
+             */
+
+            ~DaSubscriptionManager() noexcept;
+
+            /**
+             * @fn  Base::Status DaSubscriptionManager::AddItems(const vector<DaSubscriptionItem>& items, const std::function<void(const DaSubscriptionItem&, Base::Status)>& errorHandler = {});
+             *
+             * @brief   Subscribes items.
+             *
+             *          This method can partly be successful. Groups are created as required.
+             *
+             * @param   items           The items to be subscribed.
+             * @param   errorHandler    Address of an optional Error Handler. This handler is called for all
+             *                          items which cannot be added successfully.
+             *
+             * @return  An Technosoftware::Base::Status.
+             */
+
+            Base::Status AddItems(const vector<DaSubscriptionItem>& items,
+                                  const std::function<void(const DaSubscriptionItem&, Base::Status)>& errorHandler = {});
+
+            /**
+             * @fn  Base::Status DaSubscriptionManager::RemoveItems(const vector<Base::ClientHandle>& clientHandles);
+             *
+             * @brief   Unsubscribes the items with the specified client handles and compacts the affected
+             *          groups.
+             *
+             * @param   clientHandles   The client handles of the items to be removed.
+             *
+             * @return  An Technosoftware::Base::Status.
+             */
+
+            Base::Status RemoveItems(const vector<Base::ClientHandle>& clientHandles);
+
+            /**
+             * @fn  void DaSubscriptionManager::RemoveAllItems() noexcept;
+             *
+             * @brief   Unsubscribes all items and removes all managed groups.
+             */
+
+            void RemoveAllItems() noexcept;
+
+            /**
+             * @fn  Base::Status DaSubscriptionManager::Rebalance();
+             *
+             * @brief   Compacts all buckets so that each uses the minimum number of groups.
+             *
+             *          This is done automatically by RemoveItems() and only needs to be called after the
+             *          maximum number of items per group has been decreased.
+             *
+             * @return  An Technosoftware::Base::Status.
+             */
+
+            Base::Status Rebalance();
+
+            /**
+             * @fn  void DaSubscriptionManager::SetMaxItemsPerGroup(uint32_t maxItemsPerGroup) noexcept;
+             *
+             * @brief   Sets the maximum number of items in one group. Existing groups are not changed until
+             *          the next call of Rebalance().
+             *
+             * @param   maxItemsPerGroup    The maximum number of items in one group.
+             */
+
+            void SetMaxItemsPerGroup(uint32_t maxItemsPerGroup) noexcept;
+
+            /**
+             * @fn  uint32_t DaSubscriptionManager::GetMaxItemsPerGroup() const noexcept;
+             *
+             * @brief   The maximum number of items in one group.
+             *
+             * @return  An uint32_t.
+             */
+
+            uint32_t GetMaxItemsPerGroup() const noexcept;
+
+            /**
+             * @fn  uint32_t DaSubscriptionManager::GetGroupCount() const noexcept;
+             *
+             * @brief   The number of groups currently managed.
+             *
+             * @return  An uint32_t.
+             */
+
+            uint32_t GetGroupCount() const noexcept;
+
+            /**
+             * @fn  uint32_t DaSubscriptionManager::GetItemCount() const noexcept;
+             *
+             * @brief   The number of items currently subscribed.
+             *
+             * @return  An uint32_t.
+             */
+
+            uint32_t GetItemCount() const noexcept;
+
+            /**
+             * @fn  Base::Status DaSubscriptionManager::AccessItem(Base::ClientHandle clientHandle, const std::function<void(DaGroup*, DaItem*)>& function) const;
+             *
+             * @brief   Calls a function with the current group and item instance of the item with the
+             *          specified client handle.
+             *
+             *          The function is called while the subscription manager is locked, so the instances
+             *          cannot be moved by a compaction while it runs. They must not be used after the
+             *          function has returned. The function must not call the subscription manager.
+             *
+             * @param   clientHandle    The client handle of the item.
+             * @param   function        The function called with the group and the item instance.
+             *
+             * @return  An Technosoftware::Base::Status. E_INVALIDARG if the item is not subscribed.
+             */
+
+            Base::Status AccessItem(Base::ClientHandle clientHandle, const std::function<void(DaGroup*, DaItem*)>& function) const;
+
+            /**
+             * @fn  Base::Status DaSubscriptionManager::SetActive(bool active = true);
+             *
+             * @brief   Sets the active state of all managed groups.
+             *
+             * @param   active  (Optional) true to activate and false to deactivate the groups.
+             *
+             * @return  An Technosoftware::Base::Status.
+             */
+
+            Base::Status SetActive(bool active = true);
+
+        protected:
+            OpcAutoPtr<DaSubscriptionManagerImpl> impl_;
+        };
+    }
+}
+
+#endif // TECHNOSOFTWARE_DASUBSCRIPTIONMANAGER_H
@@ -0,0 +1,224 @@
+/*
+ * Copyright (c) 2011-2021 Technosoftware GmbH. All rights reserved
+ * Web: https://www.technosoftware.com
+ *
+ * The source code in this file is covered under a dual-license scenario:
+ *   - Owner of a purchased license: SCLA 1.0
+ *   - GPL V3: everybody else
+ *
+ * SCLA license terms accompanied with this source code.
+ * See SCLA 1.0: https://technosoftware.com/license/Source_Code_License_Agreement.pdf
+ *
+ * GNU General Public License as published by the Free Software Foundation;
+ * version 3 of the License are accompanied with this source code.
+ * See https://technosoftware.com/license/GPLv3License.txt
+ *
+ * This source code is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#ifndef TECHNOSOFTWARE_DAVALUEHISTORY_H
+#define TECHNOSOFTWARE_DAVALUEHISTORY_H
+
+#include "DaAeHdaClient/ClientBase.h"
+#include "DaAeHdaClient/OpcBase.h"
+#include "Base/Timestamp.h"
+#include "Base/Mutex.h"
+
+#include <atomic>
+
+namespace Technosoftware
+{
+    namespace DaAeHdaClient
+    {
+        class DaItem;
+        class DaGroupImpl;
+
+        /**
+         * @struct  DaValueSample
+         *
+         * @brief   One entry of the value history of an item.
+         *
+         *          Only scalar values which fit into 8 bytes are kept (integer, real, currency, date,
+         *          boolean and error types). For all other data types only time stamp and quality are
+         *          stored and DataType is VT_EMPTY.
+         *
+         * @ingroup  DAClient
+         */
+
+        typedef struct DaValueSample {
+
+            /** @brief   The time stamp (UTC) as microseconds since the Unix epoch. */
+
+            Base::Timestamp::TimeVal    TimeStamp;
+
+            /** @brief   The quality associated with the value. */
+
+            uint16_t                    Quality;
+
+            /** @brief   The data type of the value. */
+
+            VARTYPE                     DataType;
+
+            /** @brief   Reserved. */
+
+            uint32_t                    Reserved;
+
+            /** @brief   The value as stored in VARIANT::llVal. Bytes beyond the size of the data type are 0. */
+
+            int64_t                     Value;
+
+        } DaValueSample;
+
+        /**
+         * @class   DaValueHistory
+         *
+         * @brief   Keeps the last values of the items of a group in fixed-size rings.
+         *
+         *          The rings of all items are stored in one contiguous memory block. Every data change
+         *          notification of the group appends a sample to the ring of the item. Reads don't take
+         *          locks: each ring is protected by a sequence counter and a reader simply retries if the
+         *          ring was updated while it was copied. The only writer is the data callback of the group.
+         *
+         *          A value history is enabled with DaGroup::SetValueHistory().
+         *
+         * @ingroup  DAClient
+         */
+
+        class OPCCLIENTSDK_API DaValueHistory
+        {
+        public:
+
+            /**
+             * @fn  DaValueHistory::DaValueHistory(uint32_t maxItems, uint32_t depth) noexcept(false);
+             *
+             * @brief   Constructs a DaValueHistory object.
+             *
+             * @exception   Technosoftware::Base::Exception Thrown when an exception error condition occurs.
+             *
+             * @param   maxItems    The maximum number of items with a history.
+             * @param   depth       The number of samples kept per item.
+             */
+
+            DaValueHistory(uint32_t maxItems, uint32_t depth) noexcept(false);
+
+            /**
+             * @fn  DaValueHistory::~DaValueHistory() noexcept;
+             *
+             * @brief   Destroys a DaValueHistory object.
+             */
+
+            ~DaValueHistory() noexcept;
+
+            /**
+             * @fn  uint32_t DaValueHistory::GetDepth() const noexcept
+             *
+             * @brief   The number of samples kept per item.
+             *
+             * @return  An uint32_t.
+             */
+
+            uint32_t GetDepth() const noexcept { return depth_; }
+
+            /**
+             * @fn  uint32_t DaValueHistory::GetMaxItems() const noexcept
+             *
+             * @brief   The maximum number of items with a history.
+             *
+             * @return  An uint32_t.
+             */
+
+            uint32_t GetMaxItems() const noexcept { return maxItems_; }
+
+            /**
+             * @fn  bool DaValueHistory::GetLatest(const DaItem* item, DaValueSample& sample) const noexcept;
+             *
+             * @brief   Returns the latest sample of an item.
+             *
+             * @param           item    The item.
+             * @param [out]     sample  Receives the latest sample.
+             *
+             * @return  false if the item has no history or no sample has been received yet.
+             */
+
+            bool GetLatest(const DaItem* item, DaValueSample& sample) const noexcept;
+
+            /**
+             * @fn  uint32_t DaValueHistory::GetLast(const DaItem* item, DaValueSample* samples, uint32_t count) const noexcept;
+             *
+             * @brief   Returns the last samples of an item, the oldest first.
+             *
+             * @param           item    The item.
+             * @param [out]     samples Address of an array which receives up to count samples.
+             * @param           count   The size of the array.
+             *
+             * @return  The number of samples stored in samples.
+             */
+
+            uint32_t GetLast(const DaItem* item, DaValueSample* samples, uint32_t count) const noexcept;
+
+            /**
+             * @fn  static void DaValueHistory::ToVariant(const DaValueSample& sample, VARIANT* value) noexcept;
+             *
+             * @brief   Converts the value of a sample to a VARIANT.
+             *
+             * @param           sample  The sample.
+             * @param [out]     value   The VARIANT to be initialized. It must not hold a value which needs to be
+             *                          cleared.
+             */
+
+            static void ToVariant(const DaValueSample& sample, VARIANT* value) noexcept;
+
+            /**
+             * @fn  static bool DaValueHistory::FromVariant(const VARIANT* value, DaValueSample& sample) noexcept;
+             *
+             * @brief   Stores a VARIANT in the DataType and Value members of a sample.
+             *
+             * @param           value   The value.
+             * @param [out]     sample  The sample.
+             *
+             * @return  false if the value is not a scalar value and VT_EMPTY was stored instead.
+             */
+
+            static bool FromVariant(const VARIANT* value, DaValueSample& sample) noexcept;
+
+        protected:
+            friend class DaItem;
+            friend class DaGroupImpl;
+            friend class CComOPCDataCallbackImpl;
+
+            static const uint32_t NoSlot = 0xFFFFFFFF;
+            static const size_t   HeaderSize = sizeof(DaValueSample);    // Keeps the samples 8 byte aligned
+
+            struct SlotHeader
+            {
+                std::atomic<uint32_t>   sequence;       // Odd while the writer updates the ring
+                uint64_t                written;        // Total number of samples written
+            };
+
+            uint32_t AllocateSlot() noexcept;
+            void ReleaseSlot(uint32_t slot) noexcept;
+            void Record(uint32_t slot, const VARIANT* value, const FILETIME* timeStamp, uint16_t quality) noexcept;
+            uint32_t Read(uint32_t slot, DaValueSample* samples, uint32_t count) const noexcept;
+
+            SlotHeader* GetSlot(uint32_t slot) const noexcept { return reinterpret_cast<SlotHeader*>(arena_ + (size_t)slot * stride_); }
+            DaValueSample* GetSamples(SlotHeader* header) const noexcept { return reinterpret_cast<DaValueSample*>(reinterpret_cast<unsigned char*>(header) + HeaderSize); }
+
+        private:
+            DaValueHistory(const DaValueHistory&);
+            DaValueHistory& operator = (const DaValueHistory&);
+
+            uint32_t                maxItems_;
+            uint32_t                depth_;
+            size_t                  stride_;
+            unsigned char*          memory_;
+            unsigned char*          arena_;         // memory_ aligned to the cache line size
+            uint32_t*               freeSlots_;
+            uint32_t                freeSlotCount_;
+            Base::FastMutex         mutex_;
+        };
+    }
+}
+
+#endif // TECHNOSOFTWARE_DAVALUEHISTORY_H
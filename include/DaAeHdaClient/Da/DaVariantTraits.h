@@ -0,0 +1,114 @@
+/*
+ * Copyright (c) 2011-2021 Technosoftware GmbH. All rights reserved
+ * Web: https://www.technosoftware.com
+ *
+ * The source code in this file is covered under a dual-license scenario:
+ *   - Owner of a purchased license: SCLA 1.0
+ *   - GPL V3: everybody else
+ *
+ * SCLA license terms accompanied with this source code.
+ * See SCLA 1.0: https://technosoftware.com/license/Source_Code_License_Agreement.pdf
+ *
+ * GNU General Public License as published by the Free Software Foundation;
+ * version 3 of the License are accompanied with this source code.
+ * See https://technosoftware.com/license/GPLv3License.txt
+ *
+ * This source code is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#ifndef TECHNOSOFTWARE_DAVARIANTTRAITS_H
+#define TECHNOSOFTWARE_DAVARIANTTRAITS_H
+
+#include "DaAeHdaClient/ClientBase.h"
+#include "DaAeHdaClient/OpcBase.h"
+
+namespace Technosoftware
+{
+    namespace DaAeHdaClient
+    {
+        /**
+         * @struct  DaVariantTraits
+         *
+         * @brief   Maps a C++ type to the VARTYPE which stores it without conversion.
+         *
+         *          Specializations exist for the scalar types of OPC DA. Type is the VARTYPE, Get()
+         *          returns the value of a VARIANT of this type and Direct is true if an element of a
+         *          SAFEARRAY of this type has the memory layout of the C++ type.
+         *
+         * @ingroup  DAClient
+         */
+
+        template <typename T> struct DaVariantTraits;
+
+#define TECHNOSOFTWARE_DA_VARIANT_TRAITS(CPPTYPE, VTYPE, MEMBER)                                                \
+        template <> struct DaVariantTraits<CPPTYPE>                                                             \
+        {                                                                                                       \
+            static const VARTYPE Type = VTYPE;                                                                  \
+            static const bool Direct = true;                                                                    \
+            static CPPTYPE Get(const VARIANT& value) noexcept { return (CPPTYPE)value.MEMBER; }                 \
+        };
+
+        TECHNOSOFTWARE_DA_VARIANT_TRAITS(int8_t,            VT_I1,  cVal)
+        TECHNOSOFTWARE_DA_VARIANT_TRAITS(uint8_t,           VT_UI1, bVal)
+        TECHNOSOFTWARE_DA_VARIANT_TRAITS(int16_t,           VT_I2,  iVal)
+        TECHNOSOFTWARE_DA_VARIANT_TRAITS(uint16_t,          VT_UI2, uiVal)
+        TECHNOSOFTWARE_DA_VARIANT_TRAITS(int32_t,           VT_I4,  lVal)
+        TECHNOSOFTWARE_DA_VARIANT_TRAITS(uint32_t,          VT_UI4, ulVal)
+        TECHNOSOFTWARE_DA_VARIANT_TRAITS(long,              VT_I4,  lVal)
+        TECHNOSOFTWARE_DA_VARIANT_TRAITS(unsigned long,     VT_UI4, ulVal)
+        TECHNOSOFTWARE_DA_VARIANT_TRAITS(int64_t,           VT_I8,  llVal)
+        TECHNOSOFTWARE_DA_VARIANT_TRAITS(uint64_t,          VT_UI8, ullVal)
+        TECHNOSOFTWARE_DA_VARIANT_TRAITS(float,             VT_R4,  fltVal)
+        TECHNOSOFTWARE_DA_VARIANT_TRAITS(double,            VT_R8,  dblVal)
+        TECHNOSOFTWARE_DA_VARIANT_TRAITS(CY,                VT_CY,  cyVal)
+
+#undef TECHNOSOFTWARE_DA_VARIANT_TRAITS
+
+        // Elements of a VT_BOOL array are VARIANT_BOOL, so bool has no direct array view.
+        template <> struct DaVariantTraits<bool>
+        {
+            static const VARTYPE Type = VT_BOOL;
+            static const bool Direct = false;
+            static bool Get(const VARIANT& value) noexcept { return value.boolVal != VARIANT_FALSE; }
+        };
+
+        /**
+         * @fn  template <typename T> inline bool DaVariantToNumber(const VARIANT& value, T& number) noexcept
+         *
+         * @brief   Converts a VARIANT with a numeric scalar type to a number with a static cast.
+         *
+         *          Unlike VariantChangeType() no string is parsed and nothing is allocated.
+         *
+         * @param           value   The value.
+         * @param [out]     number  Receives the converted value.
+         *
+         * @return  false if the VARIANT is not a numeric scalar (e.g. VT_BSTR, VT_EMPTY or an array).
+         */
+
+        template <typename T> inline bool DaVariantToNumber(const VARIANT& value, T& number) noexcept
+        {
+            switch (value.vt) {
+            case VT_I1:     number = static_cast<T>(value.cVal);    return true;
+            case VT_UI1:    number = static_cast<T>(value.bVal);    return true;
+            case VT_I2:     number = static_cast<T>(value.iVal);    return true;
+            case VT_UI2:    number = static_cast<T>(value.uiVal);   return true;
+            case VT_I4:     number = static_cast<T>(value.lVal);    return true;
+            case VT_UI4:    number = static_cast<T>(value.ulVal);   return true;
+            case VT_INT:    number = static_cast<T>(value.intVal);  return true;
+            case VT_UINT:   number = static_cast<T>(value.uintVal); return true;
+            case VT_I8:     number = static_cast<T>(value.llVal);   return true;
+            case VT_UI8:    number = static_cast<T>(value.ullVal);  return true;
+            case VT_R4:     number = static_cast<T>(value.fltVal);  return true;
+            case VT_R8:     number = static_cast<T>(value.dblVal);  return true;
+            case VT_DATE:   number = static_cast<T>(value.date);    return true;
+            case VT_CY:     number = static_cast<T>(value.cyVal.int64 / 10000.0); return true;
+            case VT_BOOL:   number = static_cast<T>(value.boolVal != VARIANT_FALSE ? 1 : 0); return true;
+            default:        return false;
+            }
+        }
+    }
+}
+
+#endif // TECHNOSOFTWARE_DAVARIANTTRAITS_H
@@ -31,6 +31,10 @@
 #include "Da\DaBrowser.h"
 #include "Da\DaGroup.h"
 #include "Da\DaItem.h"
+#include "Da\DaSubscriptionManager.h"
+#include "Da\DaValueHistory.h"
+#include "Da\DaSharedValueCache.h"
+#include "Da\DaDataCapture.h"
 
 #ifdef _WIN64                                    // Common macros and definitions for OPC Alarm & Events
 #include "Classic/inc64/opcaedef.h"
@@ -0,0 +1,155 @@
+/*
+ * Copyright (c) 2011-2021 Technosoftware GmbH. All rights reserved
+ * Web: https://technosoftware.com
+ *
+ * The source code in this file is covered under a dual-license scenario:
+ *   - Owner of a purchased license: SCLA 1.0
+ *   - GPL V3: everybody else
+ *
+ * SCLA license terms accompanied with this source code.
+ * See SCLA 1.0: https://technosoftware.com/license/Source_Code_License_Agreement.pdf
+ *
+ * GNU General Public License as published by the Free Software Foundation;
+ * version 3 of the License are accompanied with this source code.
+ * See https://technosoftware.com/license/GPLv3License.txt
+ *
+ * This source code is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#include "Base/ChainBuffer.h"
+
+#include <new>
+
+namespace Technosoftware
+{
+    namespace Base
+    {
+        ChainBuffer::ChainBuffer(std::size_t segmentSize) :
+            head_(0),
+            tail_(0),
+            size_(0),
+            segmentSize_(segmentSize > 0 ? segmentSize : static_cast<std::size_t>(DEFAULT_SEGMENT_SIZE))
+        {
+        }
+
+
+        ChainBuffer::~ChainBuffer()
+        {
+            while (head_)
+            {
+                Segment* segment = head_;
+                head_ = segment->next;
+                ::operator delete(segment);
+            }
+        }
+
+
+        char* ChainBuffer::NextSegment(std::size_t length)
+        {
+            // Reuse the segments kept by Clear(); a segment too small for the reservation is freed.
+            Segment* previous = tail_;
+            Segment* next = tail_ ? tail_->next : head_;
+            while (next && next->capacity < length)
+            {
+                Segment* small = next;
+                next = small->next;
+                ::operator delete(small);
+            }
+
+            if (!next)
+            {
+                std::size_t capacity = length > segmentSize_ ? length : segmentSize_;
+                next = static_cast<Segment*>(::operator new(sizeof(Segment) + capacity));
+                next->next = 0;
+                next->capacity = capacity;
+                next->used = 0;
+            }
+
+            if (previous)
+            {
+                previous->next = next;
+            }
+            else
+            {
+                head_ = next;
+            }
+            tail_ = next;
+            return next->Data();
+        }
+
+
+        void ChainBuffer::AppendSegments(const char* source, std::size_t length)
+        {
+            while (length > 0)
+            {
+                std::size_t room = tail_ ? tail_->capacity - tail_->used : 0;
+                if (room == 0)
+                {
+                    NextSegment(length < segmentSize_ ? length : segmentSize_);
+                    room = tail_->capacity;
+                }
+                std::size_t n = length < room ? length : room;
+                std::memcpy(tail_->Data() + tail_->used, source, n);
+                tail_->used += n;
+                size_ += n;
+                source += n;
+                length -= n;
+            }
+        }
+
+
+        void ChainBuffer::Clear()
+        {
+            for (Segment* segment = head_; segment; segment = segment->next)
+            {
+                segment->used = 0;
+                if (segment == tail_)
+                {
+                    break;
+                }
+            }
+            tail_ = 0;
+            size_ = 0;
+        }
+
+
+        std::size_t ChainBuffer::GetSegmentCount() const
+        {
+            std::size_t count = 0;
+            ForEachSegment([&count](const char*, std::size_t) { ++count; return true; });
+            return count;
+        }
+
+
+        std::size_t ChainBuffer::Gather(ChainBuffer::IoVec* vectors, std::size_t count) const
+        {
+            std::size_t filled = 0;
+            ForEachSegment([vectors, count, &filled](const char* data, std::size_t length)
+            {
+                if (filled == count)
+                {
+                    return false;
+                }
+                vectors[filled].base = const_cast<char*>(data);
+                vectors[filled].length = length;
+                ++filled;
+                return true;
+            });
+            return filled;
+        }
+
+
+        void ChainBuffer::CopyTo(void* destination) const
+        {
+            char* target = static_cast<char*>(destination);
+            ForEachSegment([&target](const char* data, std::size_t length)
+            {
+                std::memcpy(target, data, length);
+                target += length;
+                return true;
+            });
+        }
+    }
+}
@@ -0,0 +1,177 @@
+/*
+ * Copyright (c) 2011-2021 Technosoftware GmbH. All rights reserved
+ * Web: https://www.technosoftware.com
+ *
+ * The source code in this file is covered under a dual-license scenario:
+ *   - Owner of a purchased license: SCLA 1.0
+ *   - GPL V3: everybody else
+ *
+ * SCLA license terms accompanied with this source code.
+ * See SCLA 1.0: https://technosoftware.com/license/Source_Code_License_Agreement.pdf
+ *
+ * GNU General Public License as published by the Free Software Foundation;
+ * version 3 of the License are accompanied with this source code.
+ * See https://technosoftware.com/license/GPLv3License.txt
+ *
+ * This source code is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#include "Base/CompiledDateTimeFormat.h"
+#include "Base/DateTime.h"
+
+#include <cstring>
+
+namespace Technosoftware
+{
+    namespace Base
+    {
+        namespace
+        {
+            int SubSecondWidth(char field)
+            {
+                switch (field)
+                {
+                case 'i': return 3;
+                case 'c': return 1;
+                default:  return 6;         // 'F'
+                }
+            }
+
+            inline void WriteDigits(char* p, unsigned value, int width)
+            {
+                p += width;
+                while (width-- > 0)
+                {
+                    *--p = (char)('0' + value % 10);
+                    value /= 10;
+                }
+            }
+        }
+
+
+        CompiledDateTimeFormat::CompiledDateTimeFormat(const std::string& fmt, int timeZoneDifferential):
+            timeZoneDifferential_(timeZoneDifferential),
+            cachedSecond_(0),
+            cacheValid_(false)
+        {
+            Segment segment;
+            segment.field = 0;
+
+            std::string::const_iterator it = fmt.begin();
+            std::string::const_iterator end = fmt.end();
+            while (it != end)
+            {
+                if (*it == '%')
+                {
+                    if (++it == end) break;
+                    char field = *it++;
+                    if (field == 'i' || field == 'c' || field == 'F' || field == 's')
+                    {
+                        if (field == 's')
+                        {
+                            segment.format += "%S.";
+                            field = 'F';
+                        }
+                        if (!segment.format.empty())
+                        {
+                            segments_.push_back(segment);
+                            segment.format.clear();
+                        }
+                        Segment subSecond;
+                        subSecond.field = field;
+                        segments_.push_back(subSecond);
+                    }
+                    else
+                    {
+                        segment.format += '%';
+                        segment.format += field;
+                    }
+                }
+                else segment.format += *it++;
+            }
+            if (!segment.format.empty()) segments_.push_back(segment);
+        }
+
+
+        CompiledDateTimeFormat::~CompiledDateTimeFormat()
+        {
+        }
+
+
+        std::size_t CompiledDateTimeFormat::Format(const Timestamp& timestamp, char* buffer, std::size_t size)
+        {
+            Timestamp::TimeVal tv = timestamp.GetEpochMicroseconds();
+            Timestamp::TimeVal second = tv / Timestamp::GetResolution();
+            Timestamp::TimeVal microsecond = tv % Timestamp::GetResolution();
+            if (microsecond < 0)
+            {
+                microsecond += Timestamp::GetResolution();
+                --second;
+            }
+
+            if (!cacheValid_ || second != cachedSecond_) Render(second);
+
+            if (cache_.size() > size) return 0;
+            std::memcpy(buffer, cache_.data(), cache_.size());
+            WriteSubSecondFields(buffer, microsecond);
+            return cache_.size();
+        }
+
+
+        void CompiledDateTimeFormat::Append(std::string& str, const Timestamp& timestamp)
+        {
+            char buffer[256];
+            std::size_t n = Format(timestamp, buffer, sizeof(buffer));
+            if (n > 0 || cache_.empty())
+            {
+                str.append(buffer, n);
+            }
+            else
+            {
+                std::size_t offset = str.size();
+                str.append(cache_.size(), '\0');
+                Format(timestamp, &str[offset], cache_.size());
+            }
+        }
+
+
+        void CompiledDateTimeFormat::Render(Timestamp::TimeVal second)
+        {
+            DateTime dateTime(Timestamp(second * Timestamp::GetResolution()));
+
+            cache_.clear();
+            subSecondFields_.clear();
+            for (std::vector<Segment>::const_iterator it = segments_.begin(); it != segments_.end(); ++it)
+            {
+                if (it->field)
+                {
+                    SubSecondField field;
+                    field.offset = cache_.size();
+                    field.field = it->field;
+                    subSecondFields_.push_back(field);
+                    cache_.append(SubSecondWidth(it->field), '0');
+                }
+                else DateTimeFormatter::Append(cache_, dateTime, it->format, timeZoneDifferential_);
+            }
+
+            cachedSecond_ = second;
+            cacheValid_ = true;
+        }
+
+
+        void CompiledDateTimeFormat::WriteSubSecondFields(char* buffer, Timestamp::TimeVal microsecond) const
+        {
+            for (std::vector<SubSecondField>::const_iterator it = subSecondFields_.begin(); it != subSecondFields_.end(); ++it)
+            {
+                switch (it->field)
+                {
+                case 'i': WriteDigits(buffer + it->offset, (unsigned)(microsecond / 1000), 3); break;
+                case 'c': WriteDigits(buffer + it->offset, (unsigned)(microsecond / 100000), 1); break;
+                default:  WriteDigits(buffer + it->offset, (unsigned)microsecond, 6); break;
+                }
+            }
+        }
+    }
+}
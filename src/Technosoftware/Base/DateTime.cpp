@@ -34,6 +34,24 @@ namespace Technosoftware
 {
     namespace Base
     {
+        namespace
+        {
+            const Int64 UTC_TICKS_PER_DAY = Int64(864000000000);     // 100 nanosecond ticks
+            const Int64 UTC_EPOCH_DAYS = 141427;                     // Days from October 15, 1582 to January 1, 1970
+
+            // Compile time constants, so that divisions can be replaced by multiplications
+            const Int64 MICROSECONDS_PER_MILLISECOND = 1000;
+            const Int64 MICROSECONDS_PER_SECOND = 1000 * MICROSECONDS_PER_MILLISECOND;
+            const Int64 MICROSECONDS_PER_MINUTE = 60 * MICROSECONDS_PER_SECOND;
+            const Int64 MICROSECONDS_PER_HOUR = 60 * MICROSECONDS_PER_MINUTE;
+            const Int64 MICROSECONDS_PER_DAY = 24 * MICROSECONDS_PER_HOUR;
+
+            inline Int64 FloorDiv(Int64 value, Int64 divisor)
+            {
+                Int64 q = value / divisor;
+                return (value % divisor < 0) ? q - 1 : q;
+            }
+        }
 
 
         inline double DateTime::ToJulianDay(Timestamp::UtcTimeVal utcTime)
@@ -53,16 +71,14 @@ namespace Technosoftware
         {
             Timestamp now;
             utcTime_ = now.GetUtcTime();
-            ComputeGregorian(GetJulianDay());
-            ComputeDaytime();
+            ComputeFields();
         }
 
 
         DateTime::DateTime(const Timestamp& timestamp) :
             utcTime_(timestamp.GetUtcTime())
         {
-            ComputeGregorian(GetJulianDay());
-            ComputeDaytime();
+            ComputeFields();
         }
 
 
@@ -85,7 +101,7 @@ namespace Technosoftware
             technosoftware_assert(millisecond >= 0 && millisecond <= 999);
             technosoftware_assert(microsecond >= 0 && microsecond <= 999);
 
-            utcTime_ = ToUtcTime(ToJulianDay(year, month, day)) + 10 * (hour*Timespan::HOURS + minute*Timespan::MINUTES + second*Timespan::SECONDS + millisecond*Timespan::MILLISECONDS + microsecond);
+            utcTime_ = (DaysFromCivil(year, month, day) + UTC_EPOCH_DAYS) * UTC_TICKS_PER_DAY + 10 * (hour*Timespan::HOURS + minute*Timespan::MINUTES + second*Timespan::SECONDS + millisecond*Timespan::MILLISECONDS + microsecond);
         }
 
 
@@ -99,8 +115,7 @@ namespace Technosoftware
         DateTime::DateTime(Timestamp::UtcTimeVal utcTime, Timestamp::TimeDiff diff) :
             utcTime_(utcTime + diff * 10)
         {
-            ComputeGregorian(GetJulianDay());
-            ComputeDaytime();
+            ComputeFields();
         }
 
 
@@ -144,8 +159,7 @@ namespace Technosoftware
         DateTime& DateTime::operator = (const Timestamp& timestamp)
         {
             utcTime_ = timestamp.GetUtcTime();
-            ComputeGregorian(GetJulianDay());
-            ComputeDaytime();
+            ComputeFields();
             return *this;
         }
 
@@ -169,7 +183,7 @@ namespace Technosoftware
             technosoftware_assert(millisecond >= 0 && millisecond <= 999);
             technosoftware_assert(microsecond >= 0 && microsecond <= 999);
 
-            utcTime_ = ToUtcTime(ToJulianDay(year, month, day)) + 10 * (hour*Timespan::HOURS + minute*Timespan::MINUTES + second*Timespan::SECONDS + millisecond*Timespan::MILLISECONDS + microsecond);
+            utcTime_ = (DaysFromCivil(year, month, day) + UTC_EPOCH_DAYS) * UTC_TICKS_PER_DAY + 10 * (hour*Timespan::HOURS + minute*Timespan::MINUTES + second*Timespan::SECONDS + millisecond*Timespan::MILLISECONDS + microsecond);
             year_ = year;
             month_ = month;
             day_ = day;
@@ -199,17 +213,15 @@ namespace Technosoftware
 
         int DateTime::GetDayOfWeek() const
         {
-            return int((std::floor(GetJulianDay() + 1.5))) % 7;
+            // January 1, 1970 was a Thursday
+            Int64 days = FloorDiv(utcTime_, UTC_TICKS_PER_DAY) - UTC_EPOCH_DAYS;
+            return int(days - FloorDiv(days + 4, 7) * 7 + 4);
         }
 
 
         int DateTime::GetDayOfYear() const
         {
-            int doy = 0;
-            for (int month = 1; month < month_; ++month)
-                doy += GetDaysOfMonth(year_, month);
-            doy += day_;
-            return doy;
+            return int(DaysFromCivil(year_, month_, day_) - DaysFromCivil(year_, 1, 1)) + 1;
         }
 
 
@@ -240,6 +252,55 @@ namespace Technosoftware
         }
 
 
+        Int64 DateTime::DaysFromCivil(int year, int month, int day)
+        {
+            year -= month <= 2;
+            Int64 era = (year >= 0 ? year : year - 399) / 400;
+            Int64 yoe = year - era * 400;                                   // [0, 399]
+            Int64 doy = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1; // [0, 365]
+            Int64 doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;              // [0, 146096]
+            return era * 146097 + doe - 719468;
+        }
+
+
+        void DateTime::CivilFromDays(Int64 days, int& year, int& month, int& day)
+        {
+            days += 719468;
+            Int64 era = (days >= 0 ? days : days - 146096) / 146097;
+            Int64 doe = days - era * 146097;                                // [0, 146096]
+            Int64 yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365; // [0, 399]
+            Int64 doy = doe - (365 * yoe + yoe / 4 - yoe / 100);            // [0, 365]
+            Int64 mp = (5 * doy + 2) / 153;                                 // [0, 11]
+            day = int(doy - (153 * mp + 2) / 5 + 1);
+            month = int(mp < 10 ? mp + 3 : mp - 9);
+            year = int(yoe + era * 400 + (month <= 2));
+        }
+
+
+        void DateTime::Decompose(const Timestamp* timestamps, std::size_t count, Fields* fields)
+        {
+            for (std::size_t i = 0; i < count; i++)
+            {
+                Int64 tv = timestamps[i].GetEpochMicroseconds();
+                Int64 days = FloorDiv(tv, MICROSECONDS_PER_DAY);
+                Int64 time = tv - days * MICROSECONDS_PER_DAY;          // [0, MICROSECONDS_PER_DAY)
+
+                int year, month, day;
+                CivilFromDays(days, year, month, day);
+
+                Fields& f = fields[i];
+                f.year = short(year);
+                f.month = short(month);
+                f.day = short(day);
+                f.hour = short(time / MICROSECONDS_PER_HOUR);
+                f.minute = short((time / MICROSECONDS_PER_MINUTE) % 60);
+                f.second = short((time / MICROSECONDS_PER_SECOND) % 60);
+                f.millisecond = short((time / MICROSECONDS_PER_MILLISECOND) % 1000);
+                f.microsecond = short(time % 1000);
+            }
+        }
+
+
         int DateTime::GetWeek(int firstDayOfWeek) const
         {
             technosoftware_assert(firstDayOfWeek >= 0 && firstDayOfWeek <= 6);
@@ -284,8 +345,7 @@ namespace Technosoftware
         DateTime& DateTime::operator += (const Timespan& span)
         {
             utcTime_ += span.GetTotalMicroseconds() * 10;
-            ComputeGregorian(GetJulianDay());
-            ComputeDaytime();
+            ComputeFields();
             return *this;
         }
 
@@ -293,8 +353,7 @@ namespace Technosoftware
         DateTime& DateTime::operator -= (const Timespan& span)
         {
             utcTime_ -= span.GetTotalMicroseconds() * 10;
-            ComputeGregorian(GetJulianDay());
-            ComputeDaytime();
+            ComputeFields();
             return *this;
         }
 
@@ -402,6 +461,24 @@ namespace Technosoftware
         }
 
 
+        void DateTime::ComputeFields()
+        {
+            Int64 days = FloorDiv(utcTime_, UTC_TICKS_PER_DAY);
+            Int64 time = (utcTime_ - days * UTC_TICKS_PER_DAY) / 10;    // Microseconds of the day
+
+            int year, month, day;
+            CivilFromDays(days - UTC_EPOCH_DAYS, year, month, day);
+            year_ = short(year);
+            month_ = short(month);
+            day_ = short(day);
+            hour_ = short(time / MICROSECONDS_PER_HOUR);
+            minute_ = short((time / MICROSECONDS_PER_MINUTE) % 60);
+            second_ = short((time / MICROSECONDS_PER_SECOND) % 60);
+            millisecond_ = short((time / MICROSECONDS_PER_MILLISECOND) % 1000);
+            microsecond_ = short(time % 1000);
+        }
+
+
         void DateTime::ComputeDaytime()
         {
             Timespan span(utcTime_ / 10);
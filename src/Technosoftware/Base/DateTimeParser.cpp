@@ -30,6 +30,7 @@
 #include "Base/DateTime.h"
 #include "Base/Exception.h"
 #include "Base/Ascii.h"
+#include <cstring>
 
 namespace Technosoftware
 {
@@ -403,6 +404,202 @@ namespace Technosoftware
             }
             else throw SyntaxException("Not a valid AM/PM designator", ampm);
         }
+
+
+        namespace
+        {
+            const UInt64 SWAR_ZEROS = 0x3030303030303030ULL;
+            const UInt64 SWAR_LIMIT = 0x4646464646464646ULL;      // '9' + 0x46 is the largest value below 0x80
+            const UInt64 SWAR_HIGH_BITS = 0x8080808080808080ULL;
+
+            //
+            // Checks eight characters at once: the bytes selected by digitMask must be ASCII digits, all other
+            // bytes must be equal to the corresponding bytes of separators.
+            //
+            inline bool MatchPattern8(const char* p, UInt64 digitMask, UInt64 separators)
+            {
+                UInt64 x;
+                std::memcpy(&x, p, sizeof(x));
+#if defined(TECHNOSOFTWARE_ARCH_LITTLE_ENDIAN)
+                if ((x & ~digitMask) != separators) return false;
+                UInt64 t = (x & digitMask) | (SWAR_ZEROS & ~digitMask);
+                return (((t + SWAR_LIMIT) | (t - SWAR_ZEROS)) & SWAR_HIGH_BITS) == 0;
+#else
+                for (int i = 0; i < 8; i++)
+                {
+                    if ((digitMask >> (8 * i)) & 0xFF)
+                    {
+                        if (!Ascii::IsDigit(p[i])) return false;
+                    }
+                    else if (p[i] != (char)(separators >> (8 * i))) return false;
+                }
+                return true;
+#endif
+            }
+
+            inline int Digits2(const char* p)
+            {
+                return (p[0] - '0') * 10 + (p[1] - '0');
+            }
+
+            inline bool IsDigit(char c)
+            {
+                return c >= '0' && c <= '9';
+            }
+
+            //
+            // Masks for "YYYY-MM-" and "DDThh:mm" (little endian byte order, first character in the lowest byte)
+            //
+            const UInt64 DATE_DIGITS = 0x00FFFF00FFFFFFFFULL;
+            const UInt64 DATE_SEPARATORS = 0x2D00002D00000000ULL;
+            const UInt64 TIME_DIGITS = 0xFFFF00FFFF00FFFFULL;
+
+            const Int64 UTC_EPOCH_SECONDS = Int64(141427) * 86400;    // Seconds from October 15, 1582 to January 1, 1970
+        }
+
+
+        bool DateTimeParser::ParseISO8601(const char* str, std::size_t length, Timestamp::UtcTimeVal& utcTime) noexcept
+        {
+            if (!str || length < 10) return false;
+
+            //
+            // Date: YYYY-MM-DD
+            //
+            if (length >= 16)
+            {
+                // "YYYY-MM-" and "DDThh:mm" (or "DD hh:mm")
+                UInt64 timeSeparators = 0x00003A0000000000ULL | ((UInt64)(unsigned char)str[10] << 16);
+                if (str[10] != 'T' && str[10] != 't' && str[10] != ' ') return false;
+                if (!MatchPattern8(str, DATE_DIGITS, DATE_SEPARATORS)) return false;
+                if (!MatchPattern8(str + 8, TIME_DIGITS, timeSeparators)) return false;
+            }
+            else
+            {
+                for (int i = 0; i < 10; i++)
+                {
+                    if (i == 4 || i == 7)
+                    {
+                        if (str[i] != '-') return false;
+                    }
+                    else if (!IsDigit(str[i])) return false;
+                }
+                if (length != 10) return false;     // Only a date can be shorter than YYYY-MM-DDThh:mm
+            }
+
+            int year = Digits2(str) * 100 + Digits2(str + 2);
+            int month = Digits2(str + 5);
+            int day = Digits2(str + 8);
+            if (month < 1 || month > 12 || day < 1 || day > DateTime::GetDaysOfMonth(year, month)) return false;
+
+            Int64 seconds = DateTime::DaysFromCivil(year, month, day) * 86400;
+            Int64 ticks = 0;
+            if (length == 10)
+            {
+                utcTime = (seconds + UTC_EPOCH_SECONDS) * 10000000;
+                return true;
+            }
+
+            //
+            // Time: hh:mm[:ss[.f...]]
+            //
+            int hour = Digits2(str + 11);
+            int minute = Digits2(str + 14);
+            if (hour > 23 || minute > 59) return false;
+            seconds += hour * 3600 + minute * 60;
+
+            std::size_t pos = 16;
+            if (pos < length && str[pos] == ':')
+            {
+                if (pos + 3 > length || !IsDigit(str[pos + 1]) || !IsDigit(str[pos + 2])) return false;
+                int second = Digits2(str + pos + 1);
+                if (second > 60) return false;              // Allow leap seconds
+                seconds += second;
+                pos += 3;
+
+                if (pos < length && (str[pos] == '.' || str[pos] == ','))
+                {
+                    ++pos;
+                    std::size_t start = pos;
+                    int scale = 10000000;
+                    while (pos < length && IsDigit(str[pos]))
+                    {
+                        scale /= 10;
+                        ticks += (str[pos] - '0') * scale;      // Digits beyond the seventh add 0
+                        ++pos;
+                    }
+                    if (pos == start) return false;
+                }
+            }
+
+            //
+            // Time zone designator
+            //
+            if (pos < length)
+            {
+                char c = str[pos++];
+                if (c == 'Z' || c == 'z')
+                {
+                    if (pos != length) return false;
+                }
+                else if (c == '+' || c == '-')
+                {
+                    if (pos + 2 > length || !IsDigit(str[pos]) || !IsDigit(str[pos + 1])) return false;
+                    int tzdHours = Digits2(str + pos);
+                    int tzdMinutes = 0;
+                    pos += 2;
+                    if (pos < length && str[pos] == ':') ++pos;
+                    if (pos < length)
+                    {
+                        if (pos + 2 != length || !IsDigit(str[pos]) || !IsDigit(str[pos + 1])) return false;
+                        tzdMinutes = Digits2(str + pos);
+                    }
+                    else if (str[pos - 1] == ':') return false;
+                    if (tzdHours > 23 || tzdMinutes > 59) return false;
+
+                    int tzd = tzdHours * 3600 + tzdMinutes * 60;
+                    seconds -= (c == '+') ? tzd : -tzd;
+                }
+                else return false;
+            }
+
+            utcTime = (seconds + UTC_EPOCH_SECONDS) * 10000000 + ticks;
+            return true;
+        }
+
+
+        bool DateTimeParser::ParseISO8601(const char* str, std::size_t length, Timestamp& timestamp) noexcept
+        {
+            Timestamp::UtcTimeVal utcTime;
+            if (!ParseISO8601(str, length, utcTime)) return false;
+
+            // Truncate towards the past like Timestamp::FromUtcTime() does for positive values
+            Timestamp::UtcTimeVal epoch = UTC_EPOCH_SECONDS * 10000000;
+            Timestamp::UtcTimeVal ticks = utcTime - epoch;
+            Timestamp::TimeVal tv = ticks / 10;
+            if (ticks % 10 < 0) --tv;
+            timestamp = Timestamp(tv);
+            return true;
+        }
+
+
+        bool DateTimeParser::ParseISO8601(const std::string& str, Timestamp& timestamp) noexcept
+        {
+            return ParseISO8601(str.data(), str.size(), timestamp);
+        }
+
+
+        std::size_t DateTimeParser::ParseISO8601(const std::string* strings, std::size_t count, Timestamp* timestamps, bool* valid) noexcept
+        {
+            std::size_t parsed = 0;
+            for (std::size_t i = 0; i < count; i++)
+            {
+                bool ok = ParseISO8601(strings[i].data(), strings[i].size(), timestamps[i]);
+                if (ok) ++parsed;
+                else timestamps[i] = Timestamp(0);
+                if (valid) valid[i] = ok;
+            }
+            return parsed;
+        }
     }
 
 }
@@ -27,20 +27,77 @@
 
 #include "Base/Hash.h"
 
+#include <cstring>
+
 namespace Technosoftware
 {
     namespace Base
     {
+        namespace
+        {
+            const UInt64 PRIME_1 = 0x9E3779B185EBCA87ULL;
+            const UInt64 PRIME_2 = 0xC2B2AE3D27D4EB4FULL;
+            const UInt64 PRIME_3 = 0x165667B19E3779F9ULL;
+            const UInt64 PRIME_4 = 0x85EBCA77C2B2AE63ULL;
+            const UInt64 PRIME_5 = 0x27D4EB2F165667C5ULL;
+
+            inline UInt64 RotateLeft(UInt64 value, int bits)
+            {
+                return (value << bits) | (value >> (64 - bits));
+            }
+
+            inline UInt64 Read64(const char* p)
+            {
+                UInt64 value;
+                std::memcpy(&value, p, sizeof(value));
+                return value;
+            }
+
+            inline UInt32 Read32(const char* p)
+            {
+                UInt32 value;
+                std::memcpy(&value, p, sizeof(value));
+                return value;
+            }
+        }
+
+
         std::size_t hash(const std::string& str)
         {
-            std::size_t h = 0;
-            std::string::const_iterator it = str.begin();
-            std::string::const_iterator end = str.end();
-            while (it != end)
+            return hash(str.data(), str.size());
+        }
+
+
+        std::size_t hash(const char* str, std::size_t length)
+        {
+            // xxHash64 without the 32 byte stripes; keys of maps are short
+            const char* p = str;
+            const char* end = str + length;
+            UInt64 h = PRIME_5 + static_cast<UInt64>(length);
+
+            while (end - p >= 8)
+            {
+                UInt64 k = RotateLeft(Read64(p) * PRIME_2, 31) * PRIME_1;
+                h = RotateLeft(h ^ k, 27) * PRIME_1 + PRIME_4;
+                p += 8;
+            }
+            if (end - p >= 4)
             {
-                h = h * 0xf4243 ^ *it++;
+                h = RotateLeft(h ^ (static_cast<UInt64>(Read32(p)) * PRIME_1), 23) * PRIME_2 + PRIME_3;
+                p += 4;
             }
-            return h;
+            while (p != end)
+            {
+                h = RotateLeft(h ^ (static_cast<UInt64>(static_cast<unsigned char>(*p)) * PRIME_5), 11) * PRIME_1;
+                ++p;
+            }
+
+            h ^= h >> 33;
+            h *= PRIME_2;
+            h ^= h >> 29;
+            h *= PRIME_3;
+            h ^= h >> 32;
+            return static_cast<std::size_t>(h);
         }
     }
 }
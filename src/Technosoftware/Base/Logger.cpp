@@ -39,6 +39,7 @@
 #include <map>
 #include <list>
 #include <algorithm>
+#include <atomic>
 
 
 #if defined(TECHNOSOFTWARE_OS_FAMILY_WINDOWS)
@@ -61,6 +62,7 @@
 #include <dirent.h>
 #include <fcntl.h>
 #include <semaphore.h>
+#include <sys/mman.h>
 #endif
 
 
@@ -114,21 +116,42 @@ const static char LOG_COLOR[LOG_LEVEL_FATAL + 1][50] = {
 class LoggerFileHandler
 {
 public:
-    LoggerFileHandler(){ _file = NULL; }
+    LoggerFileHandler()
+    {
+        _file = NULL;
+        _mapped = false;
+#ifdef WIN32
+        _hFile = INVALID_HANDLE_VALUE;
+        _hMapping = NULL;
+#else
+        _fd = -1;
+#endif
+        _view = NULL;
+        _viewOffset = 0;
+        _viewUsed = 0;
+        _segmentSize = 0;
+    }
     ~LoggerFileHandler(){ close(); }
-    inline bool isOpen(){ return _file != NULL; }
+    inline bool isOpen(){ return _file != NULL || _mapped; }
     inline bool open(const char *path, const char * mod)
     {
-        if (_file != NULL){fclose(_file);_file = NULL;}
+        close();
         _file = fopen(path, mod);
         return _file != NULL;
     }
+    bool openMapped(const char *path, size_t segmentSize);
     inline void close()
     {
         if (_file != NULL){fclose(_file);_file = NULL;}
+        if (_mapped){closeMapped();}
     }
     inline void write(const char * data, size_t len)
     {
+        if (_mapped)
+        {
+            writeMapped(data, len);
+            return;
+        }
         if (_file && len > 0)
         {
             if (fwrite(data, 1, len, _file) != len)
@@ -137,6 +160,7 @@ public:
             }
         }
     }
+    //! mapped pages are visible to readers without flushing.
     inline void flush(){ if (_file) fflush(_file); }
 
     inline std::string readLine()
@@ -150,8 +174,44 @@ public:
     }
     inline const std::string readContent();
 	inline bool removeFile(const std::string & path) { return ::remove(path.c_str()) == 0; }
+private:
+    inline void writeMapped(const char * data, size_t len)
+    {
+        while (len > 0)
+        {
+            if (_viewUsed == _segmentSize && !mapSegment(_viewOffset + _segmentSize))
+            {
+                closeMapped();
+                return;
+            }
+            size_t chunk = _segmentSize - _viewUsed;
+            if (chunk > len)
+            {
+                chunk = len;
+            }
+            memcpy(_view + _viewUsed, data, chunk);
+            _viewUsed += chunk;
+            data += chunk;
+            len -= chunk;
+        }
+    }
+    bool mapSegment(unsigned long long offset);
+    void unmapSegment();
+    void closeMapped();
 public:
     FILE *_file;
+private:
+    bool _mapped;
+#ifdef WIN32
+    HANDLE _hFile;
+    HANDLE _hMapping;
+#else
+    int _fd;
+#endif
+    char * _view;
+    unsigned long long _viewOffset; //file offset of the mapped segment
+    size_t _viewUsed; //bytes written into the mapped segment
+    size_t _segmentSize;
 };
 
 
@@ -159,7 +219,7 @@ public:
 //! UTILITY
 //////////////////////////////////////////////////////////////////////////
 static tm timeToTm(time_t t);
-static bool isSameDay(time_t t1, time_t t2);
+static unsigned long long currentMicroseconds();
 
 static void fixPath(std::string &path);
 static void trimLogConfig(std::string &str, std::string extIgnore = std::string());
@@ -289,16 +349,19 @@ enum LogDataType
     LDT_SET_LOGGER_LIMITSIZE,
 	LDT_SET_LOGGER_MONTHDIR,
 	LDT_SET_LOGGER_RESERVETIME,
+	LDT_SET_LOGGER_MMAP,
+	LDT_SET_LOGGER_COMPRESS,
+	LDT_SET_LOGGER_RESERVESIZE,
 	//    LDT_SET_LOGGER_,
 };
 
 
 //////////////////////////////////////////////////////////////////////////
-//! LoggerInfo
+//! LoggerConfig
 //////////////////////////////////////////////////////////////////////////
-struct LoggerInfo 
+//! attributes of a logger. a published config is never changed, the setters publish a copy.
+struct LoggerConfig
 {
-    //! attribute
     std::string _key;   //logger key
     std::string _name;    // one logger one name.
     std::string _path;    //path for log file.
@@ -310,16 +373,11 @@ struct LoggerInfo
     bool _enable;        //logger is enable 
     bool _fileLine;        //enable/disable the log's suffix.(file name:line number)
 	time_t _logReserveTime; //log file reserve time. unit is time second.
-    //! runtime info
-    time_t _curFileCreateTime;    //file create time
-    unsigned int _curFileIndex; //rolling file index
-    unsigned int _curWriteLen;  //current file length
-    LoggerFileHandler    _handle;        //file handle.
-	//!history
-	std::list<std::pair<time_t, std::string> > _historyLogs;
+    bool _mmap;         //write the file through mapped segments
+    bool _compress;     //compress the closed files
+    unsigned int _reserveSize; //reserve size of the closed files, unit Million byte.
 
-    
-    LoggerInfo()
+    LoggerConfig()
     {
         _enable = false; 
         _path = LOGGER_DEFAULT_PATH; 
@@ -331,14 +389,672 @@ struct LoggerInfo
         _limitsize = LOGGER_DEFAULT_LIMITSIZE;
         _fileLine = LOGGER_DEFAULT_SHOWSUFFIX;
 
+        _mmap = LOGGER_DEFAULT_MMAP;
+        _compress = LOGGER_DEFAULT_COMPRESS;
+        _reserveSize = LOGGER_DEFAULT_RESERVESIZE;
+		_logReserveTime = 0;
+    }
+};
+
+//! filter level of a disabled logger, above all log levels.
+const int LOGGER_FILTER_DISABLED = LOG_LEVEL_FATAL + 1;
+
+//! the part of the config checked by the logging threads, one cache line per logger
+//! so that the checks never share a line with data written by other threads.
+struct alignas(64) LoggerFilter
+{
+    std::atomic<int> _level;        //lowest level written, LOGGER_FILTER_DISABLED if the logger is disabled
+    std::atomic<bool> _display;
+    std::atomic<bool> _fileLine;
+
+    LoggerFilter()
+    {
+        _level = LOGGER_FILTER_DISABLED;
+        _display = false;
+        _fileLine = false;
+    }
+};
+
+
+//////////////////////////////////////////////////////////////////////////
+//! LoggerInfo
+//////////////////////////////////////////////////////////////////////////
+struct LoggerInfo 
+{
+    //! the current config, replaced by the setters.
+    std::atomic<const LoggerConfig *> _config;
+    //! runtime info, used by the logger thread only
+    const LoggerConfig * _applied;  //config of the current pass of the logger thread
+    bool _fileError;                //the log file can not be opened with the applied config
+    time_t _curFileCreateTime;    //file create time
+    time_t _curFileDayBegin;      //local day of the file create time
+    time_t _curFileDayEnd;
+    std::string _curDirectory;    //directory known to exist
+    std::string _curFilePath;     //the file is archived when the next one is opened
+    unsigned int _curFileIndex; //rolling file index
+    unsigned int _curWriteLen;  //current file length
+    LoggerFileHandler    _handle;        //file handle.
+
+    
+    LoggerInfo()
+    {
+        _config = NULL;
+        _applied = NULL;
+        _fileError = false;
         _curFileCreateTime = 0;
+        _curFileDayBegin = 0;
+        _curFileDayEnd = 0;
         _curFileIndex = 0;
         _curWriteLen = 0;
-		_logReserveTime = 0;
     }
 };
 
 
+//////////////////////////////////////////////////////////////////////////
+//! LoggerBinaryRing
+//////////////////////////////////////////////////////////////////////////
+//! header of a binary log record, followed by the arguments.
+struct LoggerBinaryRecord
+{
+    unsigned int _size;                 // record size including the header, multiple of 8
+    LoggerId _id;                       // dest logger id, LOGGER_INVALID_LOGGER_ID for padding
+    const LoggerFormatSite * _site;     // the log statement
+    unsigned long long _time;           // create time in microseconds since 1970
+};
+
+//! single producer single consumer byte ring of one logging thread.
+//! the producer reserves a contiguous record and publishes it with commit,
+//! the logger thread reads the records in order and releases them.
+class LoggerBinaryRing
+{
+public:
+    LoggerBinaryRing()
+    {
+        _buffer = new char[LOGGER_BINARY_RING_SIZE];
+        _head = 0;
+        _tail = 0;
+        _closed = false;
+        _discard = 0;
+    }
+    ~LoggerBinaryRing(){ delete[] _buffer; }
+
+    //! producer: returns LOGGER_BINARY_RECORD_SIZE contiguous bytes or NULL if the ring is full.
+    LoggerBinaryRecord * reserve()
+    {
+        size_t head = _head.load(std::memory_order_relaxed);
+        size_t tail = _tail.load(std::memory_order_acquire);
+        size_t offset = head & (LOGGER_BINARY_RING_SIZE - 1);
+        size_t contiguous = LOGGER_BINARY_RING_SIZE - offset;
+        size_t needed = contiguous < LOGGER_BINARY_RECORD_SIZE ? contiguous + LOGGER_BINARY_RECORD_SIZE : LOGGER_BINARY_RECORD_SIZE;
+        if (LOGGER_BINARY_RING_SIZE - (head - tail) < needed)
+        {
+            _discard.fetch_add(1, std::memory_order_relaxed);
+            return NULL;
+        }
+        if (contiguous < LOGGER_BINARY_RECORD_SIZE)
+        {
+            //skip the end of the buffer
+            LoggerBinaryRecord * padding = (LoggerBinaryRecord *)(_buffer + offset);
+            padding->_size = (unsigned int)contiguous;
+            padding->_id = LOGGER_INVALID_LOGGER_ID;
+            _head.store(head + contiguous, std::memory_order_release);
+            offset = 0;
+        }
+        return (LoggerBinaryRecord *)(_buffer + offset);
+    }
+
+    //! producer: publishes the reserved record. returns true if the ring became half full.
+    bool commit(LoggerBinaryRecord * record, size_t size)
+    {
+        //a zero type ends the arguments before the alignment
+        size_t aligned = (size + 7) & ~(size_t)7;
+        memset((char *)record + size, 0, aligned - size);
+        size = aligned;
+        record->_size = (unsigned int)size;
+        size_t head = _head.load(std::memory_order_relaxed);
+        size_t used = head - _tail.load(std::memory_order_relaxed);
+        _head.store(head + size, std::memory_order_release);
+        return used < LOGGER_BINARY_RING_SIZE / 2 && used + size >= LOGGER_BINARY_RING_SIZE / 2;
+    }
+
+    //! consumer: returns the oldest record or NULL.
+    const LoggerBinaryRecord * front()
+    {
+        size_t tail = _tail.load(std::memory_order_relaxed);
+        if (tail == _head.load(std::memory_order_acquire))
+        {
+            return NULL;
+        }
+        return (const LoggerBinaryRecord *)(_buffer + (tail & (LOGGER_BINARY_RING_SIZE - 1)));
+    }
+
+    //! consumer: returns the oldest log record, the padding before it is released, or NULL.
+    const LoggerBinaryRecord * frontLog()
+    {
+        const LoggerBinaryRecord * record = NULL;
+        while ((record = front()) != NULL && record->_id == LOGGER_INVALID_LOGGER_ID)
+        {
+            pop(record);
+        }
+        return record;
+    }
+
+    //! consumer: releases the record returned by front.
+    void pop(const LoggerBinaryRecord * record)
+    {
+        _tail.store(_tail.load(std::memory_order_relaxed) + record->_size, std::memory_order_release);
+    }
+
+    std::atomic<bool> _closed;                   // the owning thread has exited
+    std::atomic<unsigned long long> _discard;    // records dropped because the ring was full
+private:
+    char * _buffer;
+    std::atomic<size_t> _head;                   // written by the producer
+    std::atomic<size_t> _tail;                   // written by the logger thread
+};
+
+//! set when the ring owner of the thread is destroyed. trivially destructible, so that it stays
+//! valid for thread_local destructors running after the owner; they log through the text path.
+static thread_local bool g_binaryRingDestroyed = false;
+
+//! marks the ring of an exiting thread, the logger thread frees it when it is empty.
+struct LoggerBinaryRingOwner
+{
+    LoggerBinaryRing * _ring;
+    LoggerBinaryRingOwner(){ _ring = NULL; }
+    ~LoggerBinaryRingOwner()
+    {
+        if (_ring) _ring->_closed.store(true, std::memory_order_release);
+        _ring = NULL;
+        g_binaryRingDestroyed = true;
+    }
+};
+
+static thread_local LoggerBinaryRingOwner g_binaryRing;
+
+//! date and time text of the last second a thread has logged, "YYYY-MM-DD HH:MM:SS."
+struct LoggerTimeCache
+{
+    time_t _second;
+    int _len;
+    char _text[64];
+    LoggerTimeCache(){ _second = 0; _len = 0; }
+};
+
+static thread_local LoggerTimeCache g_timeCache;
+
+
+//////////////////////////////////////////////////////////////////////////
+//! LZ block compression
+//////////////////////////////////////////////////////////////////////////
+//! a block is a sequence of a token (literal length << 4 | match length - 4), the literal length
+//! extension, the literals, the 16 bit little endian match offset and the match length extension,
+//! as in the LZ4 block format. the last sequence has no match.
+const int LZ_MIN_MATCH = 4;
+const int LZ_HASH_LOG = 12;
+const int LZ_LAST_LITERALS = 5;         //the last bytes are always literals
+const int LZ_MATCH_FIND_LIMIT = 12;     //the last match starts before this distance to the end
+const int LZ_MAX_OFFSET = 65535;
+const int LZ_SKIP_TRIGGER = 6;          //step faster through data without matches
+
+static inline int lzCompressBound(int sourceLen){ return sourceLen + sourceLen / 255 + 16; }
+
+static inline unsigned int lzRead32(const unsigned char * p)
+{
+    unsigned int v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline unsigned int lzHash(unsigned int v){ return (v * 2654435761U) >> (32 - LZ_HASH_LOG); }
+
+static inline unsigned char * lzWriteLength(unsigned char * op, size_t len)
+{
+    while (len >= 255)
+    {
+        *op++ = 255;
+        len -= 255;
+    }
+    *op++ = (unsigned char)len;
+    return op;
+}
+
+static inline bool lzReadLength(const unsigned char *& ip, const unsigned char * end, size_t & len)
+{
+    unsigned char b;
+    do
+    {
+        if (ip >= end)
+        {
+            return false;
+        }
+        b = *ip++;
+        len += b;
+    } while (b == 255);
+    return true;
+}
+
+//! compresses sourceLen bytes into dest, which holds at least lzCompressBound(sourceLen) bytes.
+static int lzCompressBlock(const char * source, int sourceLen, char * dest)
+{
+    const unsigned char * src = (const unsigned char *)source;
+    const unsigned char * ip = src;
+    const unsigned char * anchor = src;
+    const unsigned char * end = src + sourceLen;
+    const unsigned char * matchLimit = end - LZ_LAST_LITERALS;
+    const unsigned char * findLimit = end - LZ_MATCH_FIND_LIMIT;
+    unsigned char * op = (unsigned char *)dest;
+    int table[1 << LZ_HASH_LOG];
+    memset(table, 0xff, sizeof(table));
+
+    if (sourceLen > LZ_MATCH_FIND_LIMIT)
+    {
+        unsigned int misses = 0;
+        while (ip < findLimit)
+        {
+            unsigned int h = lzHash(lzRead32(ip));
+            int candidate = table[h];
+            table[h] = (int)(ip - src);
+            if (candidate < 0 || (ip - src) - candidate > LZ_MAX_OFFSET || lzRead32(src + candidate) != lzRead32(ip))
+            {
+                ip += 1 + (misses++ >> LZ_SKIP_TRIGGER);
+                continue;
+            }
+            misses = 0;
+            const unsigned char * match = src + candidate;
+            while (ip > anchor && match > src && ip[-1] == match[-1])
+            {
+                ip--;
+                match--;
+            }
+            const unsigned char * matchEnd = ip + LZ_MIN_MATCH;
+            const unsigned char * ref = match + LZ_MIN_MATCH;
+            while (matchEnd < matchLimit && *matchEnd == *ref)
+            {
+                matchEnd++;
+                ref++;
+            }
+
+            size_t literals = ip - anchor;
+            size_t matchLen = matchEnd - ip - LZ_MIN_MATCH;
+            unsigned char * token = op++;
+            *token = (unsigned char)(((literals >= 15 ? 15 : literals) << 4) | (matchLen >= 15 ? 15 : matchLen));
+            if (literals >= 15)
+            {
+                op = lzWriteLength(op, literals - 15);
+            }
+            memcpy(op, anchor, literals);
+            op += literals;
+            size_t offset = ip - match;
+            *op++ = (unsigned char)offset;
+            *op++ = (unsigned char)(offset >> 8);
+            if (matchLen >= 15)
+            {
+                op = lzWriteLength(op, matchLen - 15);
+            }
+
+            ip = matchEnd;
+            anchor = ip;
+            if (ip < findLimit)
+            {
+                table[lzHash(lzRead32(ip - 2))] = (int)(ip - 2 - src);
+            }
+        }
+    }
+
+    size_t literals = end - anchor;
+    unsigned char * token = op++;
+    *token = (unsigned char)((literals >= 15 ? 15 : literals) << 4);
+    if (literals >= 15)
+    {
+        op = lzWriteLength(op, literals - 15);
+    }
+    memcpy(op, anchor, literals);
+    op += literals;
+    return (int)(op - (unsigned char *)dest);
+}
+
+//! returns the number of bytes written to dest or -1 if the block is corrupt.
+static int lzDecompressBlock(const char * source, int sourceLen, char * dest, int destCapacity)
+{
+    const unsigned char * ip = (const unsigned char *)source;
+    const unsigned char * end = ip + sourceLen;
+    unsigned char * op = (unsigned char *)dest;
+    unsigned char * begin = op;
+    unsigned char * limit = op + destCapacity;
+    while (ip < end)
+    {
+        unsigned int token = *ip++;
+        size_t literals = token >> 4;
+        if (literals == 15 && !lzReadLength(ip, end, literals))
+        {
+            return -1;
+        }
+        if ((size_t)(end - ip) < literals || (size_t)(limit - op) < literals)
+        {
+            return -1;
+        }
+        memcpy(op, ip, literals);
+        op += literals;
+        ip += literals;
+        if (ip == end)
+        {
+            break;
+        }
+
+        if (end - ip < 2)
+        {
+            return -1;
+        }
+        size_t offset = ip[0] | ((size_t)ip[1] << 8);
+        ip += 2;
+        size_t matchLen = token & 15;
+        if (matchLen == 15 && !lzReadLength(ip, end, matchLen))
+        {
+            return -1;
+        }
+        matchLen += LZ_MIN_MATCH;
+        if (offset == 0 || offset > (size_t)(op - begin) || (size_t)(limit - op) < matchLen)
+        {
+            return -1;
+        }
+        const unsigned char * match = op - offset;
+        if (offset >= matchLen)
+        {
+            memcpy(op, match, matchLen);
+            op += matchLen;
+        }
+        else
+        {
+            while (matchLen-- > 0)
+            {
+                *op++ = *match++;
+            }
+        }
+    }
+    return (int)(op - begin);
+}
+
+//! a compressed log file starts with the magic, followed by blocks of an 8 byte header
+//! (uncompressed size, stored size) and the data. equal sizes mark a stored block,
+//! an empty header ends the file.
+static const char LOGGER_ARCHIVE_MAGIC[8] = { 'L', 'O', 'G', 'L', 'Z', 'B', '0', '1' };
+
+//! the length of the complete lines at the begin of data, or len if there is no line end.
+static size_t completeLines(const char * data, size_t len)
+{
+    for (size_t i = len; i > 0; i--)
+    {
+        if (data[i - 1] == '\n')
+        {
+            return i;
+        }
+    }
+    return len;
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+//! LoggerArchiver
+//////////////////////////////////////////////////////////////////////////
+//! a log file closed by the logger thread.
+struct LoggerArchiveJob
+{
+    LoggerId _id;
+    std::string _path;
+    std::string _index;             // index file of the logger
+    time_t _begin;                  // time of the first and the last log
+    time_t _end;
+    bool _compress;
+    time_t _reserveTime;
+    unsigned int _reserveSize;
+};
+
+struct LoggerArchivedFile
+{
+    std::string _path;
+    time_t _begin;
+    time_t _end;
+    unsigned long long _textSize;
+    unsigned long long _diskSize;
+};
+
+//! compresses closed log files, applies the retention and writes the index files.
+//! runs with low priority, the logger thread only queues the jobs.
+class LoggerArchiver : public ThreadHelper
+{
+public:
+    LoggerArchiver()
+    {
+        _runing = false;
+        for (int i = 0; i < LOGGER_LOGGER_MAX; i++)
+        {
+            _historySize[i] = 0;
+        }
+    }
+    bool start();
+    void stop();
+    void push(const LoggerArchiveJob & job);
+    virtual void run();
+private:
+    bool popJob(LoggerArchiveJob & job);
+    void archive(const LoggerArchiveJob & job);
+    bool compress(const std::string & path, const std::string & archivePath, unsigned long long & textSize, unsigned long long & diskSize);
+    void retain(const LoggerArchiveJob & job);
+    void writeIndex(LoggerId id, const std::string & index);
+
+    std::atomic<bool> _runing;
+    SemHelper _semaphore;
+    LockHelper _jobLock;
+    std::list<LoggerArchiveJob> _jobs;
+    //! closed files per logger, the oldest first. used by the archiver thread only.
+    std::list<LoggerArchivedFile> _history[LOGGER_LOGGER_MAX];
+    unsigned long long _historySize[LOGGER_LOGGER_MAX];
+};
+
+bool LoggerArchiver::start()
+{
+    _semaphore.create(0);
+    _runing = true;
+    if (!ThreadHelper::start())
+    {
+        _runing = false;
+        return false;
+    }
+    return true;
+}
+
+void LoggerArchiver::stop()
+{
+    if (_runing)
+    {
+        //files which are still queued are left as they are
+        _runing = false;
+        _semaphore.post();
+        wait();
+    }
+}
+
+void LoggerArchiver::push(const LoggerArchiveJob & job)
+{
+    {
+        AutoLock l(_jobLock);
+        _jobs.push_back(job);
+    }
+    _semaphore.post();
+}
+
+bool LoggerArchiver::popJob(LoggerArchiveJob & job)
+{
+    AutoLock l(_jobLock);
+    if (_jobs.empty())
+    {
+        return false;
+    }
+    job = _jobs.front();
+    _jobs.pop_front();
+    return true;
+}
+
+void LoggerArchiver::run()
+{
+#ifdef WIN32
+    SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_LOWEST);
+#elif defined(__APPLE__)
+    pthread_set_qos_class_self_np(QOS_CLASS_BACKGROUND, 0);
+#elif defined(SCHED_IDLE)
+    sched_param param;
+    param.sched_priority = 0;
+    pthread_setschedparam(pthread_self(), SCHED_IDLE, &param);
+#endif
+    LoggerArchiveJob job;
+    while (_runing)
+    {
+        _semaphore.wait(1000);
+        while (_runing && popJob(job))
+        {
+            archive(job);
+        }
+    }
+}
+
+void LoggerArchiver::archive(const LoggerArchiveJob & job)
+{
+    LoggerArchivedFile file;
+    file._path = job._path;
+    file._begin = job._begin;
+    file._end = job._end;
+    file._textSize = 0;
+    file._diskSize = 0;
+    if (job._compress)
+    {
+        std::string archivePath = job._path + LOGGER_ARCHIVE_EXTENSION;
+        if (compress(job._path, archivePath, file._textSize, file._diskSize))
+        {
+            ::remove(job._path.c_str());
+            file._path = archivePath;
+        }
+        else
+        {
+            ::remove(archivePath.c_str());
+        }
+    }
+    if (file._path == job._path)
+    {
+        FILE * f = fopen(job._path.c_str(), "rb");
+        if (f == NULL)
+        {
+            return;
+        }
+        fseek(f, 0, SEEK_END);
+        file._textSize = (unsigned long long)ftell(f);
+        file._diskSize = file._textSize;
+        fclose(f);
+    }
+    _history[job._id].push_back(file);
+    _historySize[job._id] += file._diskSize;
+    retain(job);
+    writeIndex(job._id, job._index);
+}
+
+bool LoggerArchiver::compress(const std::string & path, const std::string & archivePath, unsigned long long & textSize, unsigned long long & diskSize)
+{
+    FILE * in = fopen(path.c_str(), "rb");
+    if (in == NULL)
+    {
+        return false;
+    }
+    FILE * out = fopen(archivePath.c_str(), "wb");
+    if (out == NULL)
+    {
+        fclose(in);
+        return false;
+    }
+    std::vector<char> text(LOGGER_ARCHIVE_BLOCK_SIZE);
+    std::vector<char> packed(8 + lzCompressBound(LOGGER_ARCHIVE_BLOCK_SIZE));
+    bool ok = fwrite(LOGGER_ARCHIVE_MAGIC, 1, sizeof(LOGGER_ARCHIVE_MAGIC), out) == sizeof(LOGGER_ARCHIVE_MAGIC);
+    diskSize = sizeof(LOGGER_ARCHIVE_MAGIC);
+    textSize = 0;
+    size_t fill = 0;
+    bool eof = false;
+    while (ok && (!eof || fill > 0))
+    {
+        if (!eof)
+        {
+            size_t ret = fread(&text[fill], 1, text.size() - fill, in);
+            fill += ret;
+            eof = fill < text.size();
+        }
+        if (fill == 0)
+        {
+            break;
+        }
+        //blocks end with complete lines unless a line is longer than a block
+        size_t len = eof ? fill : completeLines(&text[0], fill);
+        unsigned int header[2];
+        header[0] = (unsigned int)len;
+        header[1] = (unsigned int)lzCompressBlock(&text[0], (int)len, &packed[8]);
+        if (header[1] >= header[0])
+        {
+            header[1] = header[0];
+            memcpy(&packed[8], &text[0], len);
+        }
+        memcpy(&packed[0], header, sizeof(header));
+        ok = fwrite(&packed[0], 1, 8 + header[1], out) == 8 + header[1];
+        diskSize += 8 + header[1];
+        textSize += len;
+        memmove(&text[0], &text[len], fill - len);
+        fill -= len;
+    }
+    unsigned int last[2] = { 0, 0 };
+    ok = ok && !ferror(in) && fwrite(last, 1, sizeof(last), out) == sizeof(last);
+    diskSize += sizeof(last);
+    fclose(in);
+    ok = fclose(out) == 0 && ok;
+    return ok;
+}
+
+void LoggerArchiver::retain(const LoggerArchiveJob & job)
+{
+    std::list<LoggerArchivedFile> & history = _history[job._id];
+    unsigned long long reserveSize = (unsigned long long)job._reserveSize * 1024 * 1024;
+    time_t now = time(NULL);
+    while (history.size() > LOGGER_FORCE_RESERVE_FILE_COUNT)
+    {
+        const LoggerArchivedFile & oldest = history.front();
+        bool expired = job._reserveTime > 0 && oldest._end < now - job._reserveTime;
+        bool oversize = reserveSize > 0 && _historySize[job._id] > reserveSize;
+        if (!expired && !oversize)
+        {
+            break;
+        }
+        ::remove(oldest._path.c_str());
+        _historySize[job._id] -= oldest._diskSize;
+        history.pop_front();
+    }
+}
+
+void LoggerArchiver::writeIndex(LoggerId id, const std::string & index)
+{
+    FILE * f = fopen(index.c_str(), "wb");
+    if (f == NULL)
+    {
+        return;
+    }
+    const std::list<LoggerArchivedFile> & history = _history[id];
+    for (std::list<LoggerArchivedFile>::const_iterator iter = history.begin(); iter != history.end(); ++iter)
+    {
+        tm begin = timeToTm(iter->_begin);
+        tm end = timeToTm(iter->_end);
+        fprintf(f, "%04d%02d%02d%02d%02d%02d %04d%02d%02d%02d%02d%02d %llu %llu %s\r\n",
+            begin.tm_year + 1900, begin.tm_mon + 1, begin.tm_mday, begin.tm_hour, begin.tm_min, begin.tm_sec,
+            end.tm_year + 1900, end.tm_mon + 1, end.tm_mday, end.tm_hour, end.tm_min, end.tm_sec,
+            iter->_textSize, iter->_diskSize, iter->_path.c_str());
+    }
+    fclose(f);
+}
+
+
 //////////////////////////////////////////////////////////////////////////
 //! LogerManager
 //////////////////////////////////////////////////////////////////////////
@@ -372,7 +1088,11 @@ public:
     virtual bool setLoggerLimitsize(LoggerId id, unsigned int limitsize);
     virtual bool setLoggerMonthdir(LoggerId id, bool enable);
 	virtual bool setLoggerReserveTime(LoggerId id, time_t sec);
+    virtual bool setLoggerMmap(LoggerId id, bool enable);
+    virtual bool setLoggerCompress(LoggerId id, bool enable);
+    virtual bool setLoggerReserveSize(LoggerId id, unsigned int reserveSize);
     virtual bool setAutoUpdate(int interval);
+    virtual bool setCoarseClock(bool enable);
     virtual bool updateConfig();
     virtual bool isLoggerEnable(LoggerId id);
     virtual unsigned long long getStatusTotalWriteCount(){return _ullStatusTotalWriteFileCount;}
@@ -380,14 +1100,23 @@ public:
     virtual unsigned long long getStatusTotalPushQueue() { return _ullStatusTotalPushLog; }
     virtual unsigned long long getStatusTotalPopQueue() { return _ullStatusTotalPopLog; }
     virtual unsigned int getStatusActiveLoggers();
+    virtual unsigned long long getStatusTotalDiscardBinary();
 protected:
     virtual LogData * makeLogData(LoggerId id, int level);
     virtual void freeLogData(LogData * log);
+    virtual char * beginBinaryLog(LoggerId id, const LoggerFormatSite * site, int & capacity);
+    virtual void commitBinaryLog(char * args, int length);
+    LogData * allocLogData();
+    void formatLogHeader(LogData * pLog, LoggerId id, int level, unsigned long long now);
+    void appendLogSuffix(LogData * pLog, const char * file, int line);
+    LogData * renderBinaryLog(const LoggerBinaryRecord * record);
+    bool popLogs(int * needFlush);
+    void outputLog(LogData * pLog, int * needFlush);
     void showColorText(const char *text, int level = LOG_LEVEL_DEBUG);
-    bool onHotChange(LoggerId id, LogDataType ldt, int num, const std::string & text);
+    void publishConfig(LoggerId id, LoggerConfig * config);
+    void refreshConfigs();
     bool openLogger(LogData * log);
     bool closeLogger(LoggerId id);
-    bool popLog(LogData *& log);
     virtual void run();
 private:
 
@@ -412,12 +1141,30 @@ private:
     // the last used id of _loggers
     LoggerId    _lastId; 
     LoggerInfo _loggers[LOGGER_LOGGER_MAX];
+    //! level, enable and display of each logger for the logging threads
+    LoggerFilter _filters[LOGGER_LOGGER_MAX];
+
+    //! serializes the setters. the replaced configs are freed by the logger thread between
+    //! two passes, when it does not use any config.
+    LockHelper    _configLock;
+    std::vector<const LoggerConfig *> _retiredConfigs;
 
     //! log queue
     LockHelper    _logLock;
     std::queue<LogData *> _logs;
+    std::atomic<size_t> _logsSize;  //size of _logs, read without the lock
     std::vector<LogData*> _freeLogDatas;
 
+    //! binary log rings of the logging threads
+    LockHelper    _ringLock;
+    std::vector<LoggerBinaryRing *> _binaryRings;
+    unsigned long long _ullStatusTotalDiscardBinary;   //discards of freed rings
+    //! wakes the logger thread before a binary log ring runs full
+    SemHelper     _wakeup;
+
+    //! compresses and removes the closed log files
+    LoggerArchiver _archiver;
+
     //show color lock
     LockHelper _scLock;
     //status statistics
@@ -437,28 +1184,164 @@ private:
 
 
 
-//////////////////////////////////////////////////////////////////////////
-//! LoggerFileHandler
-//////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////
+//! LoggerFileHandler
+//////////////////////////////////////////////////////////////////////////
+
+const std::string LoggerFileHandler::readContent()
+{
+    std::string content;
+
+    if (!_file)
+    {
+        return content;
+    }
+    char buf[BUFSIZ];
+    size_t ret = 0;
+    do  
+    {
+        ret = fread(buf, sizeof(char), BUFSIZ, _file);
+        content.append(buf, ret);
+    }
+    while (ret == BUFSIZ);
+
+    return content;
+}
+
+//! opens or creates the file for appending through mapped segments of segmentSize bytes.
+//! the file is extended by a whole segment at a time and truncated to its content on close.
+bool LoggerFileHandler::openMapped(const char *path, size_t segmentSize)
+{
+    close();
+    unsigned long long size = 0;
+#ifdef WIN32
+    _hFile = CreateFileA(path, GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+        NULL, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (_hFile == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(_hFile, &fileSize))
+    {
+        CloseHandle(_hFile);
+        _hFile = INVALID_HANDLE_VALUE;
+        return false;
+    }
+    size = (unsigned long long)fileSize.QuadPart;
+#else
+    _fd = ::open(path, O_RDWR | O_CREAT, 0644);
+    if (_fd < 0)
+    {
+        return false;
+    }
+    struct stat st;
+    if (fstat(_fd, &st) != 0)
+    {
+        ::close(_fd);
+        _fd = -1;
+        return false;
+    }
+    size = (unsigned long long)st.st_size;
+#endif
+    _mapped = true;
+    _segmentSize = segmentSize;
+    //continue an existing file in the segment containing its end
+    unsigned long long offset = size - size % segmentSize;
+    _viewOffset = offset;
+    _viewUsed = (size_t)(size - offset);
+    if (!mapSegment(offset))
+    {
+        closeMapped();
+        return false;
+    }
+    _viewUsed = (size_t)(size - offset);
+    return true;
+}
+
+bool LoggerFileHandler::mapSegment(unsigned long long offset)
+{
+    unmapSegment();
+#ifdef WIN32
+    unsigned long long end = offset + _segmentSize;
+    _hMapping = CreateFileMappingA(_hFile, NULL, PAGE_READWRITE, (DWORD)(end >> 32), (DWORD)end, NULL);
+    if (_hMapping == NULL)
+    {
+        return false;
+    }
+    _view = (char *)MapViewOfFile(_hMapping, FILE_MAP_WRITE, (DWORD)(offset >> 32), (DWORD)offset, _segmentSize);
+    if (_view == NULL)
+    {
+        CloseHandle(_hMapping);
+        _hMapping = NULL;
+        return false;
+    }
+#else
+#if defined(__linux__)
+    if (posix_fallocate(_fd, (off_t)offset, (off_t)_segmentSize) != 0)
+#else
+    if (ftruncate(_fd, (off_t)(offset + _segmentSize)) != 0)
+#endif
+    {
+        return false;
+    }
+    void * view = mmap(NULL, _segmentSize, PROT_READ | PROT_WRITE, MAP_SHARED, _fd, (off_t)offset);
+    if (view == MAP_FAILED)
+    {
+        return false;
+    }
+    _view = (char *)view;
+#endif
+    _viewOffset = offset;
+    _viewUsed = 0;
+    return true;
+}
 
-const std::string LoggerFileHandler::readContent()
+void LoggerFileHandler::unmapSegment()
 {
-    std::string content;
+    if (_view == NULL)
+    {
+        return;
+    }
+#ifdef WIN32
+    UnmapViewOfFile(_view);
+    CloseHandle(_hMapping);
+    _hMapping = NULL;
+#else
+    munmap(_view, _segmentSize);
+#endif
+    _view = NULL;
+}
 
-    if (!_file)
+void LoggerFileHandler::closeMapped()
+{
+    //cut the unused part of the last segment
+    unsigned long long length = _viewOffset + _viewUsed;
+    unmapSegment();
+#ifdef WIN32
+    if (_hFile != INVALID_HANDLE_VALUE)
     {
-        return content;
+        LARGE_INTEGER end;
+        end.QuadPart = (LONGLONG)length;
+        SetFilePointerEx(_hFile, end, NULL, FILE_BEGIN);
+        SetEndOfFile(_hFile);
+        CloseHandle(_hFile);
+        _hFile = INVALID_HANDLE_VALUE;
     }
-    char buf[BUFSIZ];
-    size_t ret = 0;
-    do  
+#else
+    if (_fd >= 0)
     {
-        ret = fread(buf, sizeof(char), BUFSIZ, _file);
-        content.append(buf, ret);
+        if (ftruncate(_fd, (off_t)length) != 0)
+        {
+            //the file keeps a zero filled tail
+        }
+        ::close(_fd);
+        _fd = -1;
     }
-    while (ret == BUFSIZ);
-
-    return content;
+#endif
+    _mapped = false;
+    _viewOffset = 0;
+    _viewUsed = 0;
 }
 
 
@@ -486,19 +1369,58 @@ struct tm timeToTm(time_t t)
 #endif
 }
 
-bool isSameDay(time_t t1, time_t t2)
+//! wall clock time of a coarse clock is its monotonic time plus this offset in microseconds
+static std::atomic<bool> g_coarseClock(false);
+static std::atomic<long long> g_coarseClockOffset(0);
+
+static unsigned long long preciseMicroseconds()
+{
+#ifdef WIN32
+    FILETIME ft;
+    GetSystemTimeAsFileTime(&ft);
+    unsigned long long now = ft.dwHighDateTime;
+    now <<= 32;
+    now |= ft.dwLowDateTime;
+    now /= 10;
+    now -= 11644473600000000ULL;
+    return now;
+#else
+    struct timeval tm;
+    gettimeofday(&tm, NULL);
+    return (unsigned long long)tm.tv_sec * 1000000 + tm.tv_usec;
+#endif
+}
+
+static unsigned long long coarseMonotonicMicroseconds()
+{
+#ifdef WIN32
+    return GetTickCount64() * 1000;
+#else
+    struct timespec ts;
+#ifdef CLOCK_MONOTONIC_COARSE
+    clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+#else
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+#endif
+    return (unsigned long long)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+#endif
+}
+
+//! align the coarse clock with the wall clock.
+static void adjustCoarseClock()
+{
+    g_coarseClockOffset.store((long long)(preciseMicroseconds() - coarseMonotonicMicroseconds()), std::memory_order_relaxed);
+}
+
+unsigned long long currentMicroseconds()
 {
-    tm tm1 = timeToTm(t1);
-    tm tm2 = timeToTm(t2);
-    if ( tm1.tm_year == tm2.tm_year
-        && tm1.tm_yday == tm2.tm_yday)
+    if (g_coarseClock.load(std::memory_order_relaxed))
     {
-        return true;
+        return coarseMonotonicMicroseconds() + g_coarseClockOffset.load(std::memory_order_relaxed);
     }
-    return false;
+    return preciseMicroseconds();
 }
 
-
 void fixPath(std::string &path)
 {
     if (path.empty()){return;}
@@ -570,7 +1492,7 @@ static std::pair<std::string, std::string> splitPairString(const std::string & s
     return std::make_pair(str.substr(0, pos), str.substr(pos+delimiter.length()));
 }
 
-static bool parseConfigLine(const std::string& line, int curLineNum, std::string & key, std::map<std::string, LoggerInfo> & outInfo)
+static bool parseConfigLine(const std::string& line, int curLineNum, std::string & key, std::map<std::string, LoggerConfig> & outInfo)
 {
     std::pair<std::string, std::string> kv = splitPairString(line, "=");
     if (kv.first.empty())
@@ -597,10 +1519,10 @@ static bool parseConfigLine(const std::string& line, int curLineNum, std::string
                 key = "Main";
             }
         }
-        std::map<std::string, LoggerInfo>::iterator iter = outInfo.find(key);
+        std::map<std::string, LoggerConfig>::iterator iter = outInfo.find(key);
         if (iter == outInfo.end())
         {
-            LoggerInfo li;
+            LoggerConfig li;
             li._enable = true;
             li._key = key;
             li._name = key;
@@ -614,7 +1536,7 @@ static bool parseConfigLine(const std::string& line, int curLineNum, std::string
     }
     trimLogConfig(kv.first);
     trimLogConfig(kv.second);
-    std::map<std::string, LoggerInfo>::iterator iter = outInfo.find(key);
+    std::map<std::string, LoggerConfig>::iterator iter = outInfo.find(key);
     if (iter == outInfo.end())
     {
 		printf("Logger configure warning: not found current logger name:[%s] at line:%d, key=%s, value=%s \r\n", 
@@ -736,10 +1658,39 @@ static bool parseConfigLine(const std::string& line, int curLineNum, std::string
 	{
 		iter->second._logReserveTime = atoi(kv.second.c_str());
 	}
+    //! write through mapped segments
+    else if (kv.first == "mmap")
+    {
+        if (kv.second == "false" || kv.second == "0")
+        {
+            iter->second._mmap = false;
+        }
+        else
+        {
+            iter->second._mmap = true;
+        }
+    }
+    //! compress the closed files
+    else if (kv.first == "compress")
+    {
+        if (kv.second == "false" || kv.second == "0")
+        {
+            iter->second._compress = false;
+        }
+        else
+        {
+            iter->second._compress = true;
+        }
+    }
+    //! reserve size of the closed files
+    else if (kv.first == "reservesize")
+    {
+        iter->second._reserveSize = atoi(kv.second.c_str());
+    }
     return true;
 }
 
-static bool parseConfigFromString(std::string content, std::map<std::string, LoggerInfo> & outInfo)
+static bool parseConfigFromString(std::string content, std::map<std::string, LoggerConfig> & outInfo)
 {
 
     std::string key;
@@ -1134,80 +2085,106 @@ LogerManager::LogerManager()
     _ullStatusTotalPopLog = 0;
     _ullStatusTotalWriteFileCount = 0;
     _ullStatusTotalWriteFileBytes = 0;
+    _ullStatusTotalDiscardBinary = 0;
+    
+    _logsSize = 0;
     
     _pid = getProcessID();
     _proName = getProcessName();
-    _loggers[LOGGER_MAIN_LOGGER_ID]._enable = true;
+    for (int i = 0; i < LOGGER_LOGGER_MAX; i++)
+    {
+        _loggers[i]._config = new LoggerConfig();
+    }
     _ids[LOGGER_MAIN_LOGGER_KEY] = LOGGER_MAIN_LOGGER_ID;
-    _loggers[LOGGER_MAIN_LOGGER_ID]._key = LOGGER_MAIN_LOGGER_KEY;
-    _loggers[LOGGER_MAIN_LOGGER_ID]._name = LOGGER_MAIN_LOGGER_KEY;
+    LoggerConfig * config = new LoggerConfig();
+    config->_enable = true;
+    config->_key = LOGGER_MAIN_LOGGER_KEY;
+    config->_name = LOGGER_MAIN_LOGGER_KEY;
+    publishConfig(LOGGER_MAIN_LOGGER_ID, config);
 
 }
 LogerManager::~LogerManager()
 {
     stop();
+    for (std::vector<LoggerBinaryRing *>::iterator iter = _binaryRings.begin(); iter != _binaryRings.end(); ++iter)
+    {
+        delete *iter;
+    }
+    for (std::vector<const LoggerConfig *>::iterator iter = _retiredConfigs.begin(); iter != _retiredConfigs.end(); ++iter)
+    {
+        delete *iter;
+    }
+    for (int i = 0; i < LOGGER_LOGGER_MAX; i++)
+    {
+        delete _loggers[i]._config.load();
+    }
 }
 
 
-LogData * LogerManager::makeLogData(LoggerId id, int level)
+LogData * LogerManager::allocLogData()
 {
     LogData * pLog = NULL;
-    if (true)
+    if (!_freeLogDatas.empty())
     {
+        AutoLock l(_logLock);
         if (!_freeLogDatas.empty())
         {
-            AutoLock l(_logLock);
-            if (!_freeLogDatas.empty())
-            {
-                pLog = _freeLogDatas.back();
-                _freeLogDatas.pop_back();
-            }
-        }
-        if (pLog == NULL)
-        {
-            pLog = new LogData();
+            pLog = _freeLogDatas.back();
+            _freeLogDatas.pop_back();
         }
     }
-    //append precise time to log
-    if (true)
+    if (pLog == NULL)
     {
-        pLog->_id = id;
-        pLog->_level = level;
-        pLog->_type = LDT_GENERAL;
-        pLog->_typeval = 0;
-        pLog->_contentLen = 0;
-#ifdef WIN32
-        FILETIME ft;
-        GetSystemTimeAsFileTime(&ft);
-        unsigned long long now = ft.dwHighDateTime;
-        now <<= 32;
-        now |= ft.dwLowDateTime;
-        now /= 10;
-        now -= 11644473600000000ULL;
-        now /= 1000;
-        pLog->_time = now / 1000;
-        pLog->_precise = (unsigned int)(now % 1000);
-#else
-        struct timeval tm;
-        gettimeofday(&tm, NULL);
-        pLog->_time = tm.tv_sec;
-        pLog->_precise = tm.tv_usec / 1000;
-#endif
+        pLog = new LogData();
     }
+    return pLog;
+}
+
+void LogerManager::formatLogHeader(LogData * pLog, LoggerId id, int level, unsigned long long now)
+{
+    pLog->_id = id;
+    pLog->_level = level;
+    pLog->_type = LDT_GENERAL;
+    pLog->_typeval = 0;
+    pLog->_contentLen = 0;
+    pLog->_time = (time_t)(now / 1000000);
+    pLog->_precise = (unsigned int)(now % 1000000);
 
-    //format log
-    if (true)
+    //format log, the date and time text is rendered once per second and thread
+    LoggerTimeCache & cache = g_timeCache;
+    if (cache._second != pLog->_time || cache._len == 0)
     {
         tm tt = timeToTm(pLog->_time);
-
-        pLog->_contentLen = sprintf(pLog->_content, "%d-%02d-%02d %02d:%02d:%02d.%03u %s ",
-            tt.tm_year + 1900, tt.tm_mon + 1, tt.tm_mday, tt.tm_hour, tt.tm_min, tt.tm_sec, pLog->_precise,
-            LOG_STRING[pLog->_level]);
-        if (pLog->_contentLen < 0)
+        cache._len = sprintf(cache._text, "%d-%02d-%02d %02d:%02d:%02d.",
+            tt.tm_year + 1900, tt.tm_mon + 1, tt.tm_mday, tt.tm_hour, tt.tm_min, tt.tm_sec);
+        if (cache._len < 0)
         {
-            pLog->_contentLen = 0;
+            cache._len = 0;
         }
-    }
+        cache._second = pLog->_time;
+    }
+    char * p = pLog->_content;
+    memcpy(p, cache._text, cache._len);
+    p += cache._len;
+    unsigned int millisecond = pLog->_precise / 1000;
+    p[0] = (char)('0' + millisecond / 100);
+    p[1] = (char)('0' + millisecond / 10 % 10);
+    p[2] = (char)('0' + millisecond % 10);
+    p[3] = ' ';
+    p += 4;
+    size_t levelLen = strlen(LOG_STRING[pLog->_level]);
+    memcpy(p, LOG_STRING[pLog->_level], levelLen);
+    p += levelLen;
+    *p++ = ' ';
+    *p = '\0';
+    pLog->_contentLen = (int)(p - pLog->_content);
+}
+
+LogData * LogerManager::makeLogData(LoggerId id, int level)
+{
+    LogData * pLog = allocLogData();
+    //append precise time to log
+    formatLogHeader(pLog, id, level, currentMicroseconds());
     return pLog;
 }
 void LogerManager::freeLogData(LogData * log)
@@ -1280,7 +2257,7 @@ bool LogerManager::configFromStringImpl(std::string content, bool isUpdate)
     _checksum = sum;
     
 
-    std::map<std::string, LoggerInfo> loggerMap;
+    std::map<std::string, LoggerConfig> loggerMap;
     if (!parseConfigFromString(content, loggerMap))
     {
         printf(" !!! !!! !!! !!!\r\n");
@@ -1288,7 +2265,7 @@ bool LogerManager::configFromStringImpl(std::string content, bool isUpdate)
 		printf(" !!! !!! !!! !!!\r\n");
         return false;
     }
-    for (std::map<std::string, LoggerInfo>::iterator iter = loggerMap.begin(); iter != loggerMap.end(); ++iter)
+    for (std::map<std::string, LoggerConfig>::iterator iter = loggerMap.begin(); iter != loggerMap.end(); ++iter)
     {
         LoggerId id = LOGGER_INVALID_LOGGER_ID;
         id = findLogger(iter->second._key.c_str());
@@ -1307,15 +2284,9 @@ bool LogerManager::configFromStringImpl(std::string content, bool isUpdate)
                 }
             }
         }
-        enableLogger(id, iter->second._enable);
-        setLoggerName(id, iter->second._name.c_str());
-        setLoggerPath(id, iter->second._path.c_str());
-        setLoggerLevel(id, iter->second._level);
-        setLoggerFileLine(id, iter->second._fileLine);
-        setLoggerDisplay(id, iter->second._display);
-        setLoggerOutFile(id, iter->second._outfile);
-        setLoggerLimitsize(id, iter->second._limitsize);
-        setLoggerMonthdir(id, iter->second._monthdir);
+        //! all attributes of the logger change at once
+        AutoLock l(_configLock);
+        publishConfig(id, new LoggerConfig(iter->second));
     }
     return true;
 }
@@ -1379,9 +2350,12 @@ LoggerId LogerManager::createLogger(const char* key)
         }
         newID = ++ _lastId;
         _ids[copyKey] = newID;
-        _loggers[newID]._enable = true;
-        _loggers[newID]._key = copyKey;
-        _loggers[newID]._name = copyKey;
+        LoggerConfig * config = new LoggerConfig();
+        config->_enable = true;
+        config->_key = copyKey;
+        config->_name = copyKey;
+        AutoLock l(_configLock);
+        publishConfig(newID, config);
     }
 
     return newID;
@@ -1396,6 +2370,8 @@ bool LogerManager::start()
         return false;
     }
     _semaphore.create(0);
+    _wakeup.create(0);
+    _archiver.start();
     bool ret = ThreadHelper::start();
     return ret && _semaphore.wait(3000);
 }
@@ -1406,97 +2382,343 @@ bool LogerManager::stop()
         showColorText("Logger stopping \r\n", LOG_LEVEL_FATAL);
         _runing = false;
         wait();
+        _archiver.stop();
+        return true;
+    }
+    return false;
+}
+bool LogerManager::prePushLog(LoggerId id, int level)
+{
+    //a disabled logger or level costs one load
+    if (id < 0 || id >= LOGGER_LOGGER_MAX || level < _filters[id]._level.load(std::memory_order_relaxed))
+    {
+        return false;
+    }
+    if (!_runing || _logsSize.load(std::memory_order_relaxed) > LOGGER_LOG_QUEUE_LIMIT_SIZE)
+    {
+        return false;
+    }
+    return true;
+}
+bool LogerManager::pushLog(LogData * pLog, const char * file, int line)
+{
+    // discard or filter log
+    if (pLog->_id < 0 || pLog->_id >= LOGGER_LOGGER_MAX || !_runing
+        || pLog->_level < _filters[pLog->_id]._level.load(std::memory_order_relaxed))
+    {
+        freeLogData(pLog);
+        return false;
+    }
+    appendLogSuffix(pLog, file, line);
+
+
+    if (_filters[pLog->_id]._display.load(std::memory_order_relaxed) && LOGGER_ALL_SYNCHRONOUS_OUTPUT)
+    {
+        showColorText(pLog->_content, pLog->_level);
+    }
+
+    if (LOGGER_ALL_DEBUGOUTPUT_DISPLAY && LOGGER_ALL_SYNCHRONOUS_OUTPUT)
+    {
+#ifdef WIN32
+        OutputDebugStringA(pLog->_content);
+#endif
+    }
+
+    if (LOGGER_ALL_SYNCHRONOUS_OUTPUT)
+    {
+        AutoLock l(_logLock);
+        refreshConfigs();
+        if (_loggers[pLog->_id]._applied->_outfile && openLogger(pLog))
+        {
+            _loggers[pLog->_id]._handle.write(pLog->_content, pLog->_contentLen);
+            closeLogger(pLog->_id);
+            _ullStatusTotalWriteFileCount++;
+            _ullStatusTotalWriteFileBytes += pLog->_contentLen;
+        }
+    }
+
+    if (LOGGER_ALL_SYNCHRONOUS_OUTPUT)
+    {
+        freeLogData(pLog);
         return true;
     }
-    return false;
+    
+    AutoLock l(_logLock);
+    _logs.push(pLog);
+    _logsSize.store(_logs.size(), std::memory_order_relaxed);
+    _ullStatusTotalPushLog ++;
+    return true;
+}
+
+void LogerManager::appendLogSuffix(LogData * pLog, const char * file, int line)
+{
+    if (_filters[pLog->_id]._fileLine.load(std::memory_order_relaxed) && file)
+    {
+        const char * pNameBegin = file + strlen(file);
+        do
+        {
+            if (*pNameBegin == '\\' || *pNameBegin == '/') { pNameBegin++; break; }
+            if (pNameBegin == file) { break; }
+            pNameBegin--;
+        } while (true);
+        LoggerStream ss(pLog->_content + pLog->_contentLen, LOGGER_LOG_BUF_SIZE - pLog->_contentLen); 
+        ss << " " << pNameBegin << ":" << line;
+        pLog->_contentLen += ss.getCurrentLen();
+    }
+    if (pLog->_contentLen < 3) pLog->_contentLen = 3;
+    if (pLog->_contentLen +3 <= LOGGER_LOG_BUF_SIZE ) pLog->_contentLen += 3;
+
+    pLog->_content[pLog->_contentLen - 1] = '\0';
+    pLog->_content[pLog->_contentLen - 2] = '\n';
+    pLog->_content[pLog->_contentLen - 3] = '\r';
+    pLog->_contentLen--; //clean '\0'
+}
+
+char * LogerManager::beginBinaryLog(LoggerId id, const LoggerFormatSite * site, int & capacity)
+{
+    if (g_binaryRingDestroyed)
+    {
+        //the thread is exiting and its ring may already be freed by the logger thread
+        capacity = -1;
+        return NULL;
+    }
+    LoggerBinaryRing * ring = g_binaryRing._ring;
+    if (ring == NULL)
+    {
+        ring = new LoggerBinaryRing();
+        {
+            AutoLock l(_ringLock);
+            _binaryRings.push_back(ring);
+        }
+        g_binaryRing._ring = ring;
+    }
+    LoggerBinaryRecord * record = ring->reserve();
+    if (record == NULL)
+    {
+        capacity = 0;
+        return NULL;
+    }
+    record->_id = id;
+    record->_site = site;
+    record->_time = currentMicroseconds();
+    capacity = LOGGER_BINARY_RECORD_SIZE - (int)sizeof(LoggerBinaryRecord);
+    return (char *)(record + 1);
+}
+
+void LogerManager::commitBinaryLog(char * args, int length)
+{
+    LoggerBinaryRecord * record = (LoggerBinaryRecord *)args - 1;
+    LoggerBinaryRing * ring = g_binaryRing._ring;
+    if (ring->commit(record, sizeof(LoggerBinaryRecord) + length))
+    {
+        _wakeup.post();
+    }
+    if (LOGGER_ALL_SYNCHRONOUS_OUTPUT)
+    {
+        //the logger thread does not read the rings, output on the calling thread
+        const LoggerBinaryRecord * front = NULL;
+        while ((front = ring->front()) != NULL)
+        {
+            if (front->_id != LOGGER_INVALID_LOGGER_ID)
+            {
+                LogData * pLog = renderBinaryLog(front);
+                pushLog(pLog, front->_site->_file, front->_site->_line);
+            }
+            ring->pop(front);
+        }
+    }
+}
+
+//! format the arguments of a binary log record as LoggerStream would have done.
+static void renderBinaryArgs(const char * args, const char * end, LoggerStream & ss)
+{
+    while (args < end)
+    {
+        unsigned char type = (unsigned char)*args++;
+        if (type == LBT_SIGNED)
+        {
+            long long v;
+            memcpy(&v, args, sizeof(v));
+            args += sizeof(v);
+            ss << v;
+        }
+        else if (type == LBT_UNSIGNED)
+        {
+            unsigned long long v;
+            memcpy(&v, args, sizeof(v));
+            args += sizeof(v);
+            ss << v;
+        }
+        else if (type == LBT_DOUBLE)
+        {
+            double v;
+            memcpy(&v, args, sizeof(v));
+            args += sizeof(v);
+            ss << v;
+        }
+        else if (type == LBT_CHAR)
+        {
+            ss << *args++;
+        }
+        else if (type == LBT_BOOL)
+        {
+            ss << (*args++ != 0);
+        }
+        else if (type == LBT_POINTER)
+        {
+            unsigned long long v;
+            memcpy(&v, args, sizeof(v));
+            args += sizeof(v);
+            ss << (const void *)(size_t)v;
+        }
+        else if (type == LBT_STRING || type == LBT_WSTRING || type == LBT_BINARY)
+        {
+            unsigned int len;
+            memcpy(&len, args, sizeof(len));
+            args += sizeof(len);
+            if (type == LBT_STRING)
+            {
+                ss.writeString(args, len);
+            }
+            else if (type == LBT_WSTRING)
+            {
+#ifdef WIN32
+                std::wstring str(len / sizeof(wchar_t), L'\0');
+                if (len > 0) memcpy(&str[0], args, len);
+                ss << str.c_str();
+#endif
+            }
+            else
+            {
+                unsigned long long origin;
+                memcpy(&origin, args, sizeof(origin));
+                args += sizeof(origin);
+                ss << LoggerBinary(args, (int)len, (const void *)(size_t)origin);
+            }
+            args += len;
+        }
+        else
+        {
+            break;
+        }
+    }
 }
-bool LogerManager::prePushLog(LoggerId id, int level)
+
+LogData * LogerManager::renderBinaryLog(const LoggerBinaryRecord * record)
 {
-    if (id < 0 || id > _lastId || !_runing || !_loggers[id]._enable)
-    {
-        return false;
-    }
-    if (level < _loggers[id]._level)
-    {
-        return false;
-    }
-    if (_logs.size() > LOGGER_LOG_QUEUE_LIMIT_SIZE)
-    {
-        return false;
-    }
-    return true;
+    const LoggerFormatSite * site = record->_site;
+    LogData * pLog = allocLogData();
+    formatLogHeader(pLog, record->_id, site->_level, record->_time);
+    LoggerStream ss(pLog->_content + pLog->_contentLen, LOGGER_LOG_BUF_SIZE - pLog->_contentLen);
+    renderBinaryArgs((const char *)(record + 1), (const char *)record + record->_size, ss);
+    pLog->_contentLen += ss.getCurrentLen();
+    return pLog;
 }
-bool LogerManager::pushLog(LogData * pLog, const char * file, int line)
-{
-    // discard log
-    if (pLog->_id < 0 || pLog->_id > _lastId || !_runing || !_loggers[pLog->_id]._enable)
-    {
-        freeLogData(pLog);
-        return false;
-    }
 
-    //filter log
-    if (pLog->_level < _loggers[pLog->_id]._level)
+//! outputs the queued text logs and the binary logs of all threads. every source is in the order
+//! of its logs, the sources are merged by the create time so that the file is in time order.
+bool LogerManager::popLogs(int * needFlush)
+{
+    std::queue<LogData *> logs;
     {
-        freeLogData(pLog);
-        return false;
+        AutoLock l(_logLock);
+        logs.swap(_logs);
+        _logsSize.store(0, std::memory_order_relaxed);
     }
-    if (_loggers[pLog->_id]._fileLine && file)
+    std::vector<LoggerBinaryRing *> rings;
+    if (!LOGGER_ALL_SYNCHRONOUS_OUTPUT)
     {
-        const char * pNameBegin = file + strlen(file);
-        do
-        {
-            if (*pNameBegin == '\\' || *pNameBegin == '/') { pNameBegin++; break; }
-            if (pNameBegin == file) { break; }
-            pNameBegin--;
-        } while (true);
-        LoggerStream ss(pLog->_content + pLog->_contentLen, LOGGER_LOG_BUF_SIZE - pLog->_contentLen); 
-        ss << " " << pNameBegin << ":" << line;
-        pLog->_contentLen += ss.getCurrentLen();
+        AutoLock l(_ringLock);
+        rings = _binaryRings;
     }
-    if (pLog->_contentLen < 3) pLog->_contentLen = 3;
-    if (pLog->_contentLen +3 <= LOGGER_LOG_BUF_SIZE ) pLog->_contentLen += 3;
-
-    pLog->_content[pLog->_contentLen - 1] = '\0';
-    pLog->_content[pLog->_contentLen - 2] = '\n';
-    pLog->_content[pLog->_contentLen - 3] = '\r';
-    pLog->_contentLen--; //clean '\0'
 
-
-    if (_loggers[pLog->_id]._display && LOGGER_ALL_SYNCHRONOUS_OUTPUT)
+    //the closed flag is read before the fronts, a closed ring is empty when its front is NULL
+    std::vector<bool> closed(rings.size());
+    std::vector<const LoggerBinaryRecord *> fronts(rings.size());
+    for (size_t i = 0; i < rings.size(); i++)
     {
-        showColorText(pLog->_content, pLog->_level);
+        closed[i] = rings[i]->_closed.load(std::memory_order_acquire);
+        fronts[i] = rings[i]->frontLog();
     }
 
-    if (LOGGER_ALL_DEBUGOUTPUT_DISPLAY && LOGGER_ALL_SYNCHRONOUS_OUTPUT)
+    bool popped = false;
+    while (true)
     {
-#ifdef WIN32
-        OutputDebugStringA(pLog->_content);
-#endif
+        size_t oldest = rings.size();
+        for (size_t i = 0; i < rings.size(); i++)
+        {
+            if (fronts[i] != NULL && (oldest == rings.size() || fronts[i]->_time < fronts[oldest]->_time))
+            {
+                oldest = i;
+            }
+        }
+
+        if (!logs.empty() && (oldest == rings.size()
+            || (unsigned long long)logs.front()->_time * 1000000 + logs.front()->_precise <= fronts[oldest]->_time))
+        {
+            LogData * pLog = logs.front();
+            logs.pop();
+            popped = true;
+            if (pLog->_id < 0 || pLog->_id > _lastId)
+            {
+                freeLogData(pLog);
+                continue;
+            }
+            const LoggerConfig * config = _loggers[pLog->_id]._applied;
+            _ullStatusTotalPopLog++;
+            if (!config->_enable || pLog->_level < config->_level)
+            {
+                freeLogData(pLog);
+                continue;
+            }
+            outputLog(pLog, needFlush);
+            continue;
+        }
+        if (oldest == rings.size())
+        {
+            break;
+        }
+
+        const LoggerBinaryRecord * record = fronts[oldest];
+        if (record->_id >= 0 && record->_id <= _lastId)
+        {
+            const LoggerConfig * config = _loggers[record->_id]._applied;
+            if (config->_enable && record->_site->_level >= config->_level)
+            {
+                LogData * pLog = renderBinaryLog(record);
+                appendLogSuffix(pLog, record->_site->_file, record->_site->_line);
+                _ullStatusTotalPushLog++;
+                _ullStatusTotalPopLog++;
+                outputLog(pLog, needFlush);
+            }
+        }
+        popped = true;
+        rings[oldest]->pop(record);
+        fronts[oldest] = rings[oldest]->frontLog();
     }
 
-    if (_loggers[pLog->_id]._outfile && LOGGER_ALL_SYNCHRONOUS_OUTPUT)
+    for (size_t i = 0; i < rings.size(); i++)
     {
-        AutoLock l(_logLock);
-        if (openLogger(pLog))
+        if (closed[i])
         {
-            _loggers[pLog->_id]._handle.write(pLog->_content, pLog->_contentLen);
-            closeLogger(pLog->_id);
-            _ullStatusTotalWriteFileCount++;
-            _ullStatusTotalWriteFileBytes += pLog->_contentLen;
+            AutoLock l(_ringLock);
+            _ullStatusTotalDiscardBinary += rings[i]->_discard.load(std::memory_order_relaxed);
+            _binaryRings.erase(std::find(_binaryRings.begin(), _binaryRings.end(), rings[i]));
+            delete rings[i];
         }
     }
+    return popped;
+}
 
-    if (LOGGER_ALL_SYNCHRONOUS_OUTPUT)
+unsigned long long LogerManager::getStatusTotalDiscardBinary()
+{
+    AutoLock l(_ringLock);
+    unsigned long long discard = _ullStatusTotalDiscardBinary;
+    for (std::vector<LoggerBinaryRing *>::iterator iter = _binaryRings.begin(); iter != _binaryRings.end(); ++iter)
     {
-        freeLogData(pLog);
-        return true;
+        discard += (*iter)->_discard.load(std::memory_order_relaxed);
     }
-    
-    AutoLock l(_logLock);
-    _logs.push(pLog);
-    _ullStatusTotalPushLog ++;
-    return true;
+    return discard;
 }
 
 //! 查找ID
@@ -1514,72 +2736,100 @@ LoggerId LogerManager::findLogger(const char * key)
 bool LogerManager::hotChange(LoggerId id, LogDataType ldt, int num, const std::string & text)
 {
     if (id <0 || id > _lastId) return false;
-    if (text.length() >= LOGGER_LOG_BUF_SIZE) return false;
-    if (!_runing || LOGGER_ALL_SYNCHRONOUS_OUTPUT)
-    {
-        return onHotChange(id, ldt, num, text);
-    }
-    LogData * pLog = makeLogData(id, LOGGER_DEFAULT_LEVEL);
-    pLog->_id = id;
-    pLog->_type = ldt;
-    pLog->_typeval = num;
-    memcpy(pLog->_content, text.c_str(), text.length());
-    pLog->_contentLen = (int)text.length();
-    AutoLock l(_logLock);
-    _logs.push(pLog);
-    return true;
+    AutoLock l(_configLock);
+    LoggerConfig * config = new LoggerConfig(*_loggers[id]._config.load(std::memory_order_relaxed));
+    if (ldt == LDT_ENABLE_LOGGER) config->_enable = num != 0;
+    else if (ldt == LDT_SET_LOGGER_NAME) config->_name = text;
+    else if (ldt == LDT_SET_LOGGER_PATH) config->_path = text;
+    else if (ldt == LDT_SET_LOGGER_LEVEL) config->_level = num;
+    else if (ldt == LDT_SET_LOGGER_FILELINE) config->_fileLine = num != 0;
+    else if (ldt == LDT_SET_LOGGER_DISPLAY) config->_display = num != 0;
+    else if (ldt == LDT_SET_LOGGER_OUTFILE) config->_outfile = num != 0;
+    else if (ldt == LDT_SET_LOGGER_LIMITSIZE) config->_limitsize = num;
+	else if (ldt == LDT_SET_LOGGER_MONTHDIR) config->_monthdir = num != 0;
+	else if (ldt == LDT_SET_LOGGER_RESERVETIME) config->_logReserveTime = num;
+	else if (ldt == LDT_SET_LOGGER_MMAP) config->_mmap = num != 0;
+	else if (ldt == LDT_SET_LOGGER_COMPRESS) config->_compress = num != 0;
+	else if (ldt == LDT_SET_LOGGER_RESERVESIZE) config->_reserveSize = (unsigned int)num;
+    publishConfig(id, config);
+	return true;
 }
 
-bool LogerManager::onHotChange(LoggerId id, LogDataType ldt, int num, const std::string & text)
+//! makes config the current config of the logger. the caller holds _configLock.
+void LogerManager::publishConfig(LoggerId id, LoggerConfig * config)
 {
-    if (id < LOGGER_MAIN_LOGGER_ID || id > _lastId)
+    if (config->_limitsize == 0)
     {
-        return false;
+        config->_limitsize = (unsigned int)-1;
+    }
+    if (config->_logReserveTime < 0)
+    {
+        config->_logReserveTime = 0;
+    }
+    if (!config->_path.empty())
+    {
+        char ch = config->_path.at(config->_path.length() - 1);
+        if (ch != '\\' && ch != '/')
+        {
+            config->_path.append("/");
+        }
+    }
+    LoggerFilter & filter = _filters[id];
+    filter._display.store(config->_display, std::memory_order_relaxed);
+    filter._fileLine.store(config->_fileLine, std::memory_order_relaxed);
+    filter._level.store(config->_enable ? config->_level : LOGGER_FILTER_DISABLED, std::memory_order_relaxed);
+    const LoggerConfig * old = _loggers[id]._config.exchange(config, std::memory_order_acq_rel);
+    if (old != NULL)
+    {
+        _retiredConfigs.push_back(old);
     }
-    LoggerInfo & logger = _loggers[id];
-    if (ldt == LDT_ENABLE_LOGGER) logger._enable = num != 0;
-    else if (ldt == LDT_SET_LOGGER_NAME) logger._name = text;
-    else if (ldt == LDT_SET_LOGGER_PATH) logger._path = text;
-    else if (ldt == LDT_SET_LOGGER_LEVEL) logger._level = num;
-    else if (ldt == LDT_SET_LOGGER_FILELINE) logger._fileLine = num != 0;
-    else if (ldt == LDT_SET_LOGGER_DISPLAY) logger._display = num != 0;
-    else if (ldt == LDT_SET_LOGGER_OUTFILE) logger._outfile = num != 0;
-    else if (ldt == LDT_SET_LOGGER_LIMITSIZE) logger._limitsize = num;
-	else if (ldt == LDT_SET_LOGGER_MONTHDIR) logger._monthdir = num != 0;
-	else if (ldt == LDT_SET_LOGGER_RESERVETIME) logger._logReserveTime = num >= 0 ? num : 0;
-	return true;
 }
 
-bool LogerManager::enableLogger(LoggerId id, bool enable) 
+//! called by the logger thread between two passes: takes the current configs and frees the
+//! replaced ones, which no thread can use any more. a file is closed when the new config
+//! changes where or how it is written.
+void LogerManager::refreshConfigs()
 {
-    if (id < 0 || id > _lastId) return false;
-    if (enable)
+    std::vector<const LoggerConfig *> retired;
     {
-        _loggers[id]._enable = true;
-        return true;
+        AutoLock l(_configLock);
+        retired.swap(_retiredConfigs);
     }
-    return hotChange(id, LDT_ENABLE_LOGGER, false, ""); 
-}
-bool LogerManager::setLoggerLevel(LoggerId id, int level) 
-{ 
-    if (id < 0 || id > _lastId) return false;
-    if (level <= _loggers[id]._level)
+    for (int i = 0; i < LOGGER_LOGGER_MAX; i++)
     {
-        _loggers[id]._level = level;
-        return true;
+        LoggerInfo & logger = _loggers[i];
+        const LoggerConfig * config = logger._config.load(std::memory_order_acquire);
+        const LoggerConfig * applied = logger._applied;
+        if (config == applied)
+        {
+            continue;
+        }
+        if (applied != NULL && logger._handle.isOpen()
+            && (!config->_enable || !config->_outfile || config->_name != applied->_name || config->_path != applied->_path
+            || config->_monthdir != applied->_monthdir || config->_mmap != applied->_mmap))
+        {
+            logger._handle.close();
+        }
+        logger._fileError = false;
+        logger._applied = config;
+    }
+    for (std::vector<const LoggerConfig *>::iterator iter = retired.begin(); iter != retired.end(); ++iter)
+    {
+        delete *iter;
     }
-    return hotChange(id, LDT_SET_LOGGER_LEVEL, level, ""); 
 }
+
+bool LogerManager::enableLogger(LoggerId id, bool enable) { return hotChange(id, LDT_ENABLE_LOGGER, enable, ""); }
+bool LogerManager::setLoggerLevel(LoggerId id, int level) { return hotChange(id, LDT_SET_LOGGER_LEVEL, level, ""); }
 bool LogerManager::setLoggerDisplay(LoggerId id, bool enable) { return hotChange(id, LDT_SET_LOGGER_DISPLAY, enable, ""); }
 bool LogerManager::setLoggerOutFile(LoggerId id, bool enable) { return hotChange(id, LDT_SET_LOGGER_OUTFILE, enable, ""); }
 bool LogerManager::setLoggerMonthdir(LoggerId id, bool enable) { return hotChange(id, LDT_SET_LOGGER_MONTHDIR, enable, ""); }
 bool LogerManager::setLoggerFileLine(LoggerId id, bool enable) { return hotChange(id, LDT_SET_LOGGER_FILELINE, enable, ""); }
 bool LogerManager::setLoggerReserveTime(LoggerId id, time_t sec) { return hotChange(id, LDT_SET_LOGGER_RESERVETIME, (int)sec, ""); }
-bool LogerManager::setLoggerLimitsize(LoggerId id, unsigned int limitsize)
-{
-    if (limitsize == 0 ) {limitsize = (unsigned int)-1;}
-    return hotChange(id, LDT_SET_LOGGER_LIMITSIZE, limitsize, "");
-}
+bool LogerManager::setLoggerMmap(LoggerId id, bool enable) { return hotChange(id, LDT_SET_LOGGER_MMAP, enable, ""); }
+bool LogerManager::setLoggerCompress(LoggerId id, bool enable) { return hotChange(id, LDT_SET_LOGGER_COMPRESS, enable, ""); }
+bool LogerManager::setLoggerReserveSize(LoggerId id, unsigned int reserveSize) { return hotChange(id, LDT_SET_LOGGER_RESERVESIZE, (int)reserveSize, ""); }
+bool LogerManager::setLoggerLimitsize(LoggerId id, unsigned int limitsize) { return hotChange(id, LDT_SET_LOGGER_LIMITSIZE, limitsize, ""); }
 
 bool LogerManager::setLoggerName(LoggerId id, const char * name)
 {
@@ -1598,21 +2848,22 @@ bool LogerManager::setLoggerPath(LoggerId id, const char * path)
 {
     if (id <0 || id > _lastId) return false;
     if (path == NULL || strlen(path) == 0)  return false;
-    std::string copyPath = path;
-    {
-        char ch = copyPath.at(copyPath.length() - 1);
-        if (ch != '\\' && ch != '/')
-        {
-            copyPath.append("/");
-        }
-    }
-    return hotChange(id, LDT_SET_LOGGER_PATH, 0, copyPath);
+    return hotChange(id, LDT_SET_LOGGER_PATH, 0, path);
 }
 bool LogerManager::setAutoUpdate(int interval)
 {
     _hotUpdateInterval = interval;
     return true;
 }
+bool LogerManager::setCoarseClock(bool enable)
+{
+    if (enable)
+    {
+        adjustCoarseClock();
+    }
+    g_coarseClock.store(enable, std::memory_order_relaxed);
+    return true;
+}
 bool LogerManager::updateConfig()
 {
     if (_configFile.empty())
@@ -1634,8 +2885,8 @@ bool LogerManager::updateConfig()
 
 bool LogerManager::isLoggerEnable(LoggerId id)
 {
-    if (id <0 || id > _lastId) return false;
-    return _loggers[id]._enable;
+    if (id <0 || id >= LOGGER_LOGGER_MAX) return false;
+    return _filters[id]._level.load(std::memory_order_relaxed) != LOGGER_FILTER_DISABLED;
 }
 
 unsigned int LogerManager::getStatusActiveLoggers()
@@ -1643,7 +2894,7 @@ unsigned int LogerManager::getStatusActiveLoggers()
     unsigned int actives = 0;
     for (int i=0; i<= _lastId; i++)
     {
-        if (_loggers[i]._enable)
+        if (_filters[i]._level.load(std::memory_order_relaxed) != LOGGER_FILTER_DISABLED)
         {
             actives ++;
         }
@@ -1662,13 +2913,14 @@ bool LogerManager::openLogger(LogData * pLog)
     }
 
     LoggerInfo * pLogger = &_loggers[id];
-    if (!pLogger->_enable || !pLogger->_outfile || pLog->_level < pLogger->_level)
+    const LoggerConfig * config = pLogger->_applied;
+    if (!config->_enable || !config->_outfile || pLogger->_fileError || pLog->_level < config->_level)
     {
         return false;
     }
 
-    bool sameday = isSameDay(pLog->_time, pLogger->_curFileCreateTime);
-    bool needChageFile = pLogger->_curWriteLen > pLogger->_limitsize * 1024 * 1024;
+    bool sameday = pLog->_time >= pLogger->_curFileDayBegin && pLog->_time < pLogger->_curFileDayEnd;
+    bool needChageFile = pLogger->_curWriteLen > config->_limitsize * 1024 * 1024;
     if (!sameday || needChageFile)
     {
         if (!sameday)
@@ -1686,27 +2938,42 @@ bool LogerManager::openLogger(LogData * pLog)
     }
     if (!pLogger->_handle.isOpen())
     {
+        time_t lastFileCreateTime = pLogger->_curFileCreateTime;
         pLogger->_curFileCreateTime = pLog->_time;
         pLogger->_curWriteLen = 0;
 
         tm t = timeToTm(pLogger->_curFileCreateTime);
+        //the local day of the file, checked for every log
+        tm day = t;
+        day.tm_hour = 0;
+        day.tm_min = 0;
+        day.tm_sec = 0;
+        day.tm_isdst = -1;
+        pLogger->_curFileDayBegin = mktime(&day);
+        day.tm_mday++;
+        day.tm_isdst = -1;
+        pLogger->_curFileDayEnd = mktime(&day);
         std::string name;
         std::string path;
 
-        name = pLogger->_name;
-        path = pLogger->_path;
+        name = config->_name;
+        path = config->_path;
 
         
         char buf[500] = { 0 };
-        if (pLogger->_monthdir)
+        if (config->_monthdir)
         {
             sprintf(buf, "%04d_%02d/", t.tm_year + 1900, t.tm_mon + 1);
             path += buf;
         }
 
-        if (!isDirectory(path))
+        if (path != pLogger->_curDirectory)
         {
-            createRecursionDir(path);
+            if (!isDirectory(path))
+            {
+                createRecursionDir(path);
+            }
+            pLogger->_curDirectory = path;
         }
 
 		if (name == "Main") 
@@ -1722,28 +2989,40 @@ bool LogerManager::openLogger(LogData * pLog)
 				t.tm_hour, t.tm_min, _pid.c_str(), pLogger->_curFileIndex);
 		}
 		path += buf;
-        pLogger->_handle.open(path.c_str(), "ab");
+        if (config->_mmap)
+        {
+            pLogger->_handle.openMapped(path.c_str(), LOGGER_MMAP_SEGMENT_SIZE);
+        }
+        else
+        {
+            pLogger->_handle.open(path.c_str(), "ab");
+        }
         if (!pLogger->_handle.isOpen())
         {
+            pLogger->_curDirectory.clear();
 			sprintf(buf, "Logger: can not open log file %s. \r\n", path.c_str());
             showColorText("!!!!!!!!!!!!!!!!!!!!!!!!!! \r\n", LOG_LEVEL_FATAL);
             showColorText(buf, LOG_LEVEL_FATAL);
             showColorText("!!!!!!!!!!!!!!!!!!!!!!!!!! \r\n", LOG_LEVEL_FATAL);
-            pLogger->_outfile = false;
+            pLogger->_fileError = true;
             return false;
         }
-		if (pLogger->_logReserveTime > 0 )
-		{
-			if (pLogger->_historyLogs.size() > LOGGER_FORCE_RESERVE_FILE_COUNT)
-			{
-				while (!pLogger->_historyLogs.empty() && pLogger->_historyLogs.front().first < time(NULL) - pLogger->_logReserveTime)
-				{
-					pLogger->_handle.removeFile(pLogger->_historyLogs.front().second.c_str());
-					pLogger->_historyLogs.pop_front();
-				}
-			}
-			pLogger->_historyLogs.push_back(std::make_pair(time(NULL), path));
-		}
+        //! hand the previous file to the archiver, it is not written any more
+        if (!pLogger->_curFilePath.empty() && pLogger->_curFilePath != path
+            && (config->_compress || config->_logReserveTime > 0 || config->_reserveSize > 0))
+        {
+            LoggerArchiveJob job;
+            job._id = id;
+            job._path = pLogger->_curFilePath;
+            job._index = config->_path + _proName + (name == "Main" ? "" : "_" + name) + "_" + _pid + LOGGER_INDEX_EXTENSION;
+            job._begin = lastFileCreateTime;
+            job._end = pLog->_time;
+            job._compress = config->_compress;
+            job._reserveTime = config->_logReserveTime;
+            job._reserveSize = config->_reserveSize;
+            _archiver.push(job);
+        }
+        pLogger->_curFilePath = path;
         return true;
     }
     return true;
@@ -1763,129 +3042,94 @@ bool LogerManager::closeLogger(LoggerId id)
     }
     return false;
 }
-bool LogerManager::popLog(LogData *& log)
+void LogerManager::outputLog(LogData * pLog, int * needFlush)
 {
-    AutoLock l(_logLock);
-    if (_logs.empty())
+    LoggerInfo & curLogger = _loggers[pLog->_id];
+    if (curLogger._applied->_display && !LOGGER_ALL_SYNCHRONOUS_OUTPUT)
     {
-        return false;
+        showColorText(pLog->_content, pLog->_level);
     }
-    log = _logs.front();
-    _logs.pop();
-    return true;
+    if (LOGGER_ALL_DEBUGOUTPUT_DISPLAY && !LOGGER_ALL_SYNCHRONOUS_OUTPUT)
+    {
+#ifdef WIN32
+        OutputDebugStringA(pLog->_content);
+#endif
+    }
+
+    if (curLogger._applied->_outfile && !LOGGER_ALL_SYNCHRONOUS_OUTPUT)
+    {
+        if (!openLogger(pLog))
+        {
+            freeLogData(pLog);
+            return;
+        }
+
+        curLogger._handle.write(pLog->_content, pLog->_contentLen);
+        curLogger._curWriteLen += (unsigned int)pLog->_contentLen;
+        needFlush[pLog->_id] ++;
+        _ullStatusTotalWriteFileCount++;
+        _ullStatusTotalWriteFileBytes += pLog->_contentLen;
+    }
+    else if (!LOGGER_ALL_SYNCHRONOUS_OUTPUT)
+    {
+        _ullStatusTotalWriteFileCount++;
+        _ullStatusTotalWriteFileBytes += pLog->_contentLen;
+    }
+
+    freeLogData(pLog);
 }
 
 void LogerManager::run()
 {
     _runing = true;
+    refreshConfigs();
     LOGI("-----------------  Logger thread started!   ----------------------------");
     for (int i = 0; i <= _lastId; i++)
     {
-        if (_loggers[i]._enable)
+        const LoggerConfig * config = _loggers[i]._applied;
+        if (config->_enable)
         {
             LOGI("logger id=" << i
-                << " key=" << _loggers[i]._key
-                << " name=" << _loggers[i]._name
-                << " path=" << _loggers[i]._path
-                << " level=" << _loggers[i]._level
-                << " display=" << _loggers[i]._display);
+                << " key=" << config->_key
+                << " name=" << config->_name
+                << " path=" << config->_path
+                << " level=" << config->_level
+                << " display=" << config->_display);
         }
     }
 
     _semaphore.post();
 
 
-    LogData * pLog = NULL;
     int needFlush[LOGGER_LOGGER_MAX] = {0};
     time_t lastCheckUpdate = time(NULL);
+    time_t lastClockAdjust = time(NULL);
     while (true)
     {
-        while(popLog(pLog))
+        //! the synchronous output takes the configs on the logging threads under the same lock
         {
-            if (pLog->_id <0 || pLog->_id > _lastId)
-            {
-                freeLogData(pLog);
-                continue;
-            }
-            LoggerInfo & curLogger = _loggers[pLog->_id];
-
-            if (pLog->_type != LDT_GENERAL)
-            {
-                onHotChange(pLog->_id, (LogDataType)pLog->_type, pLog->_typeval, std::string(pLog->_content, pLog->_contentLen));
-                curLogger._handle.close();
-                freeLogData(pLog);
-                continue;
-            }
-            
-            //
-            _ullStatusTotalPopLog ++;
-            //discard
-            
-            if (!curLogger._enable || pLog->_level <curLogger._level  )
-            {
-                freeLogData(pLog);
-                continue;
-            }
-
-
-            if (curLogger._display && !LOGGER_ALL_SYNCHRONOUS_OUTPUT)
-            {
-                showColorText(pLog->_content, pLog->_level);
-            }
-            if (LOGGER_ALL_DEBUGOUTPUT_DISPLAY && !LOGGER_ALL_SYNCHRONOUS_OUTPUT)
-            {
-#ifdef WIN32
-                OutputDebugStringA(pLog->_content);
-#endif
-            }
-
-
-            if (curLogger._outfile && !LOGGER_ALL_SYNCHRONOUS_OUTPUT)
-            {
-                if (!openLogger(pLog))
-                {
-                    freeLogData(pLog);
-                    continue;
-                }
-
-                curLogger._handle.write(pLog->_content, pLog->_contentLen);
-                curLogger._curWriteLen += (unsigned int)pLog->_contentLen;
-                needFlush[pLog->_id] ++;
-                _ullStatusTotalWriteFileCount++;
-                _ullStatusTotalWriteFileBytes += pLog->_contentLen;
-            }
-            else if (!LOGGER_ALL_SYNCHRONOUS_OUTPUT)
-            {
-                _ullStatusTotalWriteFileCount++;
-                _ullStatusTotalWriteFileBytes += pLog->_contentLen;
-            }
-
-            freeLogData(pLog);
+            AutoLock l(_logLock);
+            refreshConfigs();
         }
 
+        popLogs(needFlush);
+
         for (int i=0; i<=_lastId; i++)
         {
-            if (_loggers[i]._enable && needFlush[i] > 0)
+            if (needFlush[i] > 0)
             {
                 _loggers[i]._handle.flush();
                 needFlush[i] = 0;
             }
-            if(!_loggers[i]._enable && _loggers[i]._handle.isOpen())
-            {
-                _loggers[i]._handle.close();
-            }
         }
 
-        //! delay. 
-#ifdef WIN32
-    	Sleep(100);
-#else
-    	usleep(1000*100);
-#endif 
+        //! delay, or until a binary log ring is half full.
+        _wakeup.wait(100);
 
         //! quit
-        if (!_runing && _logs.empty())
+        if (!_runing && _logsSize.load(std::memory_order_relaxed) == 0)
         {
+            popLogs(needFlush);
             break;
         }
         
@@ -1894,6 +3138,13 @@ void LogerManager::run()
             updateConfig();
             lastCheckUpdate = time(NULL);
         }
+
+        //! follow adjustments of the wall clock
+        if (g_coarseClock.load(std::memory_order_relaxed) && time(NULL) - lastClockAdjust >= LOGGER_COARSE_CLOCK_ADJUST_INTERVAL)
+        {
+            adjustCoarseClock();
+            lastClockAdjust = time(NULL);
+        }
         
 
 
@@ -1901,11 +3152,7 @@ void LogerManager::run()
 
     for (int i=0; i <= _lastId; i++)
     {
-        if (_loggers[i]._enable)
-        {
-            _loggers[i]._enable = false;
-            closeLogger(i);
-        }
+        closeLogger(i);
     }
 
 }
@@ -1919,3 +3166,92 @@ LogManager * LogManager::getInstance()
     return &m;
 }
 
+
+//////////////////////////////////////////////////////////////////////////
+//LoggerArchiveReader
+//////////////////////////////////////////////////////////////////////////
+LoggerArchiveReader::LoggerArchiveReader()
+{
+    _file = NULL;
+    _compressed = false;
+}
+
+LoggerArchiveReader::~LoggerArchiveReader()
+{
+    close();
+}
+
+bool LoggerArchiveReader::open(const char * path)
+{
+    close();
+    _file = fopen(path, "rb");
+    if (_file == NULL)
+    {
+        return false;
+    }
+    char magic[sizeof(LOGGER_ARCHIVE_MAGIC)];
+    _compressed = fread(magic, 1, sizeof(magic), _file) == sizeof(magic) && memcmp(magic, LOGGER_ARCHIVE_MAGIC, sizeof(magic)) == 0;
+    if (!_compressed)
+    {
+        fseek(_file, 0, SEEK_SET);
+    }
+    return true;
+}
+
+bool LoggerArchiveReader::read(std::string & text)
+{
+    text.clear();
+    if (_file == NULL)
+    {
+        return false;
+    }
+    if (!_compressed)
+    {
+        text.swap(_carry);
+        size_t fill = text.size();
+        text.resize(LOGGER_ARCHIVE_BLOCK_SIZE);
+        fill += fread(&text[fill], 1, text.size() - fill, _file);
+        size_t len = fill < text.size() ? fill : completeLines(text.data(), fill);
+        _carry.assign(text, len, fill - len);
+        text.resize(len);
+        return len > 0;
+    }
+
+    unsigned int header[2];
+    if (fread(header, 1, sizeof(header), _file) != sizeof(header) || header[0] == 0)
+    {
+        return false;
+    }
+    if (header[0] > (unsigned int)LOGGER_ARCHIVE_BLOCK_SIZE || header[1] > header[0])
+    {
+        return false;
+    }
+    if (header[1] == header[0])
+    {
+        text.resize(header[0]);
+        return fread(&text[0], 1, header[0], _file) == header[0];
+    }
+    _packed.resize(header[1]);
+    if (header[1] > 0 && fread(&_packed[0], 1, header[1], _file) != header[1])
+    {
+        return false;
+    }
+    text.resize(header[0]);
+    if (lzDecompressBlock(_packed.data(), (int)header[1], &text[0], (int)header[0]) != (int)header[0])
+    {
+        text.clear();
+        return false;
+    }
+    return true;
+}
+
+void LoggerArchiveReader::close()
+{
+    if (_file != NULL)
+    {
+        fclose(_file);
+        _file = NULL;
+    }
+    _compressed = false;
+    _carry.clear();
+}
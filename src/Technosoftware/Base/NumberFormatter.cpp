@@ -44,6 +44,85 @@
 #endif
 
 
+namespace
+{
+    const char DIGIT_PAIRS[] =
+        "00010203040506070809"
+        "10111213141516171819"
+        "20212223242526272829"
+        "30313233343536373839"
+        "40414243444546474849"
+        "50515253545556575859"
+        "60616263646566676869"
+        "70717273747576777879"
+        "80818283848586878889"
+        "90919293949596979899";
+
+    template <typename U>
+    inline unsigned CountDigits(U value)
+    {
+        unsigned digits = 1;
+        for (;;)
+        {
+            if (value < 10) return digits;
+            if (value < 100) return digits + 1;
+            if (value < 1000) return digits + 2;
+            if (value < 10000) return digits + 3;
+            value /= 10000;
+            digits += 4;
+        }
+    }
+
+    /**
+     * @fn  template <typename U> std::size_t WriteDecimal(char* buffer, std::size_t size, U value, bool negative)
+     *
+     * @brief   Writes the decimal digits of value from the end, two digits per division. Used only
+     *          internally.
+     *
+     * @param [out]     buffer      The buffer.
+     * @param           size        The size of the buffer.
+     * @param           value       The magnitude of the value.
+     * @param           negative    true to prepend a minus sign.
+     *
+     * @return  The number of characters written or 0 if the buffer is too small.
+     */
+
+    template <typename U>
+    std::size_t WriteDecimal(char* buffer, std::size_t size, U value, bool negative)
+    {
+        unsigned digits = CountDigits(value);
+        std::size_t length = digits + (negative ? 1 : 0);
+        if (length > size) return 0;
+
+        if (negative) *buffer++ = '-';
+        char* p = buffer + digits;
+        while (value >= 100)
+        {
+            unsigned i = static_cast<unsigned>(value % 100) * 2;
+            value /= 100;
+            *--p = DIGIT_PAIRS[i + 1];
+            *--p = DIGIT_PAIRS[i];
+        }
+        if (value >= 10)
+        {
+            unsigned i = static_cast<unsigned>(value) * 2;
+            *--p = DIGIT_PAIRS[i + 1];
+            *--p = DIGIT_PAIRS[i];
+        }
+        else *--p = static_cast<char>('0' + value);
+        return length;
+    }
+
+    template <typename S, typename U>
+    inline std::size_t WriteSignedDecimal(char* buffer, std::size_t size, S value)
+    {
+        // Negate in the unsigned type so that the minimum value does not overflow
+        return value < 0 ? WriteDecimal(buffer, size, static_cast<U>(0 - static_cast<U>(value)), true)
+                         : WriteDecimal(buffer, size, static_cast<U>(value), false);
+    }
+}
+
+
 namespace Technosoftware
 {
     namespace Base
@@ -74,9 +153,7 @@ namespace Technosoftware
         void NumberFormatter::Append(std::string& str, int value)
         {
             char result[NF_MAX_INT_STRING_LEN];
-            std::size_t sz = NF_MAX_INT_STRING_LEN;
-            IntToStr(value, 10, result, sz);
-            str.append(result, sz);
+            str.append(result, ToChars(result, NF_MAX_INT_STRING_LEN, value));
         }
 
 
@@ -119,9 +196,7 @@ namespace Technosoftware
         void NumberFormatter::Append(std::string& str, unsigned value)
         {
             char result[NF_MAX_INT_STRING_LEN];
-            std::size_t sz = NF_MAX_INT_STRING_LEN;
-            UIntToStr(value, 10, result, sz);
-            str.append(result, sz);
+            str.append(result, ToChars(result, NF_MAX_INT_STRING_LEN, value));
         }
 
 
@@ -164,9 +239,7 @@ namespace Technosoftware
         void NumberFormatter::Append(std::string& str, long value)
         {
             char result[NF_MAX_INT_STRING_LEN];
-            std::size_t sz = NF_MAX_INT_STRING_LEN;
-            IntToStr(value, 10, result, sz);
-            str.append(result, sz);
+            str.append(result, ToChars(result, NF_MAX_INT_STRING_LEN, value));
         }
 
 
@@ -209,9 +282,7 @@ namespace Technosoftware
         void NumberFormatter::Append(std::string& str, unsigned long value)
         {
             char result[NF_MAX_INT_STRING_LEN];
-            std::size_t sz = NF_MAX_INT_STRING_LEN;
-            UIntToStr(value, 10, result, sz);
-            str.append(result, sz);
+            str.append(result, ToChars(result, NF_MAX_INT_STRING_LEN, value));
         }
 
 
@@ -257,9 +328,7 @@ namespace Technosoftware
         void NumberFormatter::Append(std::string& str, Int64 value)
         {
             char result[NF_MAX_INT_STRING_LEN];
-            std::size_t sz = NF_MAX_INT_STRING_LEN;
-            IntToStr(value, 10, result, sz);
-            str.append(result, sz);
+            str.append(result, ToChars(result, NF_MAX_INT_STRING_LEN, value));
         }
 
 
@@ -302,9 +371,7 @@ namespace Technosoftware
         void NumberFormatter::Append(std::string& str, UInt64 value)
         {
             char result[NF_MAX_INT_STRING_LEN];
-            std::size_t sz = NF_MAX_INT_STRING_LEN;
-            UIntToStr(value, 10, result, sz);
-            str.append(result, sz);
+            str.append(result, ToChars(result, NF_MAX_INT_STRING_LEN, value));
         }
 
 
@@ -372,9 +439,8 @@ namespace Technosoftware
 
         void NumberFormatter::Append(std::string& str, double value)
         {
-            char buffer[NF_MAX_FLT_STRING_LEN];
-            DoubleToStr(buffer, TECHNOSOFTWARE_MAX_FLT_STRING_LEN, value);
-            str.append(buffer);
+            char buffer[NF_MAX_DBL_CHARS_LEN];
+            str.append(buffer, ToChars(buffer, NF_MAX_DBL_CHARS_LEN, value));
         }
 
 
@@ -393,6 +459,75 @@ namespace Technosoftware
         }
 
 
+        std::size_t NumberFormatter::ToChars(char* buffer, std::size_t size, int value) noexcept
+        {
+            return WriteSignedDecimal<int, unsigned>(buffer, size, value);
+        }
+
+
+        std::size_t NumberFormatter::ToChars(char* buffer, std::size_t size, unsigned value) noexcept
+        {
+            return WriteDecimal(buffer, size, value, false);
+        }
+
+
+        std::size_t NumberFormatter::ToChars(char* buffer, std::size_t size, long value) noexcept
+        {
+            return WriteSignedDecimal<long, unsigned long>(buffer, size, value);
+        }
+
+
+        std::size_t NumberFormatter::ToChars(char* buffer, std::size_t size, unsigned long value) noexcept
+        {
+            return WriteDecimal(buffer, size, value, false);
+        }
+
+
+#if defined(TECHNOSOFTWARE_HAVE_INT64) && !defined(TECHNOSOFTWARE_LONG_IS_64_BIT)
+
+
+        std::size_t NumberFormatter::ToChars(char* buffer, std::size_t size, Int64 value) noexcept
+        {
+            return WriteSignedDecimal<Int64, UInt64>(buffer, size, value);
+        }
+
+
+        std::size_t NumberFormatter::ToChars(char* buffer, std::size_t size, UInt64 value) noexcept
+        {
+            return WriteDecimal(buffer, size, value, false);
+        }
+
+
+#endif // defined(TECHNOSOFTWARE_HAVE_INT64) && !defined(TECHNOSOFTWARE_LONG_IS_64_BIT)
+
+
+        std::size_t NumberFormatter::ToChars(char* buffer, std::size_t size, float value) noexcept
+        {
+            return FloatToChars(buffer, size, value);
+        }
+
+
+        std::size_t NumberFormatter::ToChars(char* buffer, std::size_t size, double value) noexcept
+        {
+            return DoubleToChars(buffer, size, value);
+        }
+
+
+        std::size_t NumberFormatter::FormatColumn(const double* values, std::size_t count, char separator, char* buffer, std::size_t size) noexcept
+        {
+            char* p = buffer;
+            char* end = buffer + size;
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                std::size_t length = DoubleToChars(p, static_cast<std::size_t>(end - p), values[i]);
+                if (length == 0 || p + length == end) return 0;
+                p += length;
+                *p++ = separator;
+            }
+            return static_cast<std::size_t>(p - buffer);
+        }
+
+
         void NumberFormatter::Append(std::string& str, const void* ptr)
         {
             char buffer[24];
@@ -44,6 +44,12 @@
 #include "Base/String.h"
 #include <memory>
 #include <cctype>
+#include <cstring>
+#if defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
+#endif
+
+#include "NumericString_PowersOfFive.cpp"
 
 namespace {
 
@@ -149,6 +155,491 @@ namespace {
     }
 
 
+    // Large enough for the longest shortest representation with the default lowDec and highDec
+    // (e.g. "-0.0000000000000012345678901234568", 34 characters) plus the terminating zero of StringBuilder.
+    const int SHORTEST_STRING_LEN = 48;
+
+    const double_conversion::DoubleToStringConverter& ShortestConverter(bool single)
+    {
+        using namespace double_conversion;
+
+        static const int flags = DoubleToStringConverter::UNIQUE_ZERO | DoubleToStringConverter::EMIT_POSITIVE_EXPONENT_SIGN;
+        static const DoubleToStringConverter floatConverter(flags, TECHNOSOFTWARE_FLT_INF, TECHNOSOFTWARE_FLT_NAN, TECHNOSOFTWARE_FLT_EXP,
+            -std::numeric_limits<float>::digits10, std::numeric_limits<float>::digits10, 0, 0);
+        static const DoubleToStringConverter doubleConverter(flags, TECHNOSOFTWARE_FLT_INF, TECHNOSOFTWARE_FLT_NAN, TECHNOSOFTWARE_FLT_EXP,
+            -std::numeric_limits<double>::digits10, std::numeric_limits<double>::digits10, 0, 0);
+        return single ? floatConverter : doubleConverter;
+    }
+
+    /**
+     * @fn  std::size_t ShortestToChars(char* buffer, std::size_t bufferSize, double value, bool single)
+     *
+     * @brief   Writes the shortest representation of value without terminating zero. Small buffers are
+     *          served from a local buffer because StringBuilder does not check its bounds in release
+     *          builds. Used only internally.
+     *
+     * @param [out]     buffer      The buffer.
+     * @param           bufferSize  Size of the buffer.
+     * @param           value       The value.
+     * @param           single      true to convert with single precision.
+     *
+     * @return  The number of characters written or 0 if the buffer is too small.
+     */
+
+    std::size_t ShortestToChars(char* buffer, std::size_t bufferSize, double value, bool single)
+    {
+        char local[SHORTEST_STRING_LEN];
+        bool direct = bufferSize >= static_cast<std::size_t>(SHORTEST_STRING_LEN);
+
+        double_conversion::StringBuilder builder(direct ? buffer : local, SHORTEST_STRING_LEN);
+        if (single)
+            ShortestConverter(true).ToShortestSingle(static_cast<float>(value), &builder);
+        else
+            ShortestConverter(false).ToShortest(value, &builder);
+
+        std::size_t length = static_cast<std::size_t>(builder.position());
+        if (!direct)
+        {
+            if (length > bufferSize) return 0;
+            std::memcpy(buffer, local, length);
+        }
+        return length;
+    }
+
+    typedef Technosoftware::Base::UInt64 UInt64;
+    typedef Technosoftware::Base::UInt32 UInt32;
+
+    // Number of decimal digits which always fit into an UInt64
+    const int MAX_MANTISSA_DIGITS = 19;
+
+    // Same limit as StringToDoubleConverter; more digits cannot change the rounding
+    const int MAX_FALLBACK_DIGITS = 772;
+
+    template <typename T> struct BinaryFormat;
+
+    template <> struct BinaryFormat<double>
+    {
+        typedef UInt64 Bits;
+        static const int MANTISSA_BITS = 52;
+        static const int MINIMUM_EXPONENT = -1023;
+        static const int INFINITE_POWER = 0x7FF;
+        static const int MIN_EXPONENT_ROUND_TO_EVEN = -4;
+        static const int MAX_EXPONENT_ROUND_TO_EVEN = 23;
+        static const int SMALLEST_POWER_OF_TEN = -342;
+        static const int LARGEST_POWER_OF_TEN = 308;
+        static const int MAX_EXPONENT_FAST_PATH = 22;
+    };
+
+    template <> struct BinaryFormat<float>
+    {
+        typedef UInt32 Bits;
+        static const int MANTISSA_BITS = 23;
+        static const int MINIMUM_EXPONENT = -127;
+        static const int INFINITE_POWER = 0xFF;
+        static const int MIN_EXPONENT_ROUND_TO_EVEN = -17;
+        static const int MAX_EXPONENT_ROUND_TO_EVEN = 10;
+        static const int SMALLEST_POWER_OF_TEN = -64;
+        static const int LARGEST_POWER_OF_TEN = 38;
+        static const int MAX_EXPONENT_FAST_PATH = 10;
+    };
+
+    const double EXACT_POWERS_OF_TEN[] =
+    {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+
+    inline bool IsDecimalDigit(char c)
+    {
+        return static_cast<unsigned char>(c - '0') < 10;
+    }
+
+    inline int LeadingZeros(UInt64 value)
+    {
+#if defined(_MSC_VER) && defined(_M_X64)
+        unsigned long index;
+        _BitScanReverse64(&index, value);
+        return 63 - static_cast<int>(index);
+#elif defined(__GNUC__)
+        return __builtin_clzll(value);
+#else
+        int zeros = 0;
+        while (!(value & 0x8000000000000000ULL))
+        {
+            value <<= 1;
+            ++zeros;
+        }
+        return zeros;
+#endif
+    }
+
+    inline UInt64 Multiply(UInt64 a, UInt64 b, UInt64& low)
+    {
+#if defined(_MSC_VER) && defined(_M_X64)
+        UInt64 high;
+        low = _umul128(a, b, &high);
+        return high;
+#elif defined(__SIZEOF_INT128__)
+        unsigned __int128 product = static_cast<unsigned __int128>(a) * b;
+        low = static_cast<UInt64>(product);
+        return static_cast<UInt64>(product >> 64);
+#else
+        UInt64 aLow = a & 0xFFFFFFFF, aHigh = a >> 32;
+        UInt64 bLow = b & 0xFFFFFFFF, bHigh = b >> 32;
+        UInt64 ll = aLow * bLow, lh = aLow * bHigh, hl = aHigh * bLow, hh = aHigh * bHigh;
+        UInt64 middle = (ll >> 32) + (lh & 0xFFFFFFFF) + (hl & 0xFFFFFFFF);
+        low = (middle << 32) | (ll & 0xFFFFFFFF);
+        return hh + (lh >> 32) + (hl >> 32) + (middle >> 32);
+#endif
+    }
+
+    /**
+     * @fn  template <typename T> bool EiselLemire(UInt64 w, int q, UInt64& mantissa, int& power2)
+     *
+     * @brief   Computes the binary significand and biased exponent of w * 10^q rounded to nearest.
+     *          Used only internally.
+     *
+     * @param           w           The decimal significand.
+     * @param           q           The decimal exponent.
+     * @param [out]     mantissa    The significand without the implicit bit.
+     * @param [out]     power2      The biased binary exponent.
+     *
+     * @return  false if the 128-bit approximation of 5^q is not precise enough to decide the
+     *          rounding; the caller has to use the bignum conversion.
+     */
+
+    template <typename T>
+    bool EiselLemire(UInt64 w, int q, UInt64& mantissa, int& power2)
+    {
+        typedef BinaryFormat<T> Format;
+
+        if (w == 0 || q < Format::SMALLEST_POWER_OF_TEN)
+        {
+            mantissa = 0;
+            power2 = 0;
+            return true;
+        }
+        if (q > Format::LARGEST_POWER_OF_TEN)
+        {
+            mantissa = 0;
+            power2 = Format::INFINITE_POWER;
+            return true;
+        }
+
+        int lz = LeadingZeros(w);
+        w <<= lz;
+
+        std::size_t index = 2 * static_cast<std::size_t>(q - SMALLEST_POWER_OF_FIVE);
+        UInt64 low;
+        UInt64 high = Multiply(w, POWERS_OF_FIVE_128[index], low);
+        const UInt64 precisionMask = 0xFFFFFFFFFFFFFFFFULL >> (Format::MANTISSA_BITS + 3);
+        if ((high & precisionMask) == precisionMask)
+        {
+            // The truncated product may be too small; add the next 64 bits of 5^q
+            UInt64 secondLow;
+            UInt64 secondHigh = Multiply(w, POWERS_OF_FIVE_128[index + 1], secondLow);
+            low += secondHigh;
+            if (secondHigh > low) ++high;
+        }
+        if (low == 0xFFFFFFFFFFFFFFFFULL && (q < -27 || q > 55)) return false;
+
+        int upperBit = static_cast<int>(high >> 63);
+        int shift = upperBit + 64 - Format::MANTISSA_BITS - 3;
+        mantissa = high >> shift;
+        power2 = ((((152170 + 65536) * q) >> 16) + 63) + upperBit - lz - Format::MINIMUM_EXPONENT;
+
+        if (power2 <= 0)
+        {
+            // Subnormal or zero
+            if (-power2 + 1 >= 64)
+            {
+                mantissa = 0;
+                power2 = 0;
+                return true;
+            }
+            mantissa >>= -power2 + 1;
+            mantissa += mantissa & 1;
+            mantissa >>= 1;
+            power2 = mantissa < (UInt64(1) << Format::MANTISSA_BITS) ? 0 : 1;
+            return true;
+        }
+
+        // Exactly halfway between two floating point numbers: round to even
+        if (low <= 1 && q >= Format::MIN_EXPONENT_ROUND_TO_EVEN && q <= Format::MAX_EXPONENT_ROUND_TO_EVEN &&
+            (mantissa & 3) == 1 && (mantissa << shift) == high)
+        {
+            mantissa &= ~UInt64(1);
+        }
+
+        mantissa += mantissa & 1;
+        mantissa >>= 1;
+        if (mantissa >= (UInt64(2) << Format::MANTISSA_BITS))
+        {
+            mantissa = UInt64(1) << Format::MANTISSA_BITS;
+            ++power2;
+        }
+        mantissa &= ~(UInt64(1) << Format::MANTISSA_BITS);
+        if (power2 >= Format::INFINITE_POWER)
+        {
+            mantissa = 0;
+            power2 = Format::INFINITE_POWER;
+        }
+        return true;
+    }
+
+    template <typename T>
+    T MakeFloatingPoint(bool negative, UInt64 mantissa, int power2)
+    {
+        typedef BinaryFormat<T> Format;
+        typedef typename Format::Bits Bits;
+
+        Bits bits = static_cast<Bits>(mantissa) |
+            (static_cast<Bits>(power2) << Format::MANTISSA_BITS) |
+            (static_cast<Bits>(negative ? 1 : 0) << (sizeof(Bits) * 8 - 1));
+        T value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+    struct DecimalNumber
+    {
+        UInt64      mantissa;       // First MAX_MANTISSA_DIGITS significant digits
+        int         exponent;       // Decimal exponent of mantissa
+        bool        negative;
+        bool        truncated;      // Non-zero digits after the first MAX_MANTISSA_DIGITS
+        const char* integer;        // Digits before the decimal point
+        const char* integerEnd;
+        const char* fraction;       // Digits after the decimal point
+        const char* fractionEnd;
+        int         explicitExponent;
+    };
+
+    /**
+     * @fn  std::size_t ParseDecimal(const char* str, std::size_t length, DecimalNumber& number)
+     *
+     * @brief   Splits a decimal number into its significand and exponent. Used only internally.
+     *
+     * @param           str     The characters.
+     * @param           length  The number of characters.
+     * @param [out]     number  The decimal number.
+     *
+     * @return  The number of characters consumed or 0 if there is no number.
+     */
+
+    std::size_t ParseDecimal(const char* str, std::size_t length, DecimalNumber& number)
+    {
+        const char* p = str;
+        const char* end = str + length;
+
+        number.negative = p != end && *p == '-';
+        if (number.negative) ++p;
+
+        UInt64 mantissa = 0;
+        int digits = 0;
+        int exponent = 0;
+        bool truncated = false;
+
+        number.integer = p;
+        while (p != end && IsDecimalDigit(*p))
+        {
+            unsigned digit = static_cast<unsigned>(*p++ - '0');
+            if (digits == 0 && digit == 0) continue;            // Leading zero
+            if (digits < MAX_MANTISSA_DIGITS)
+            {
+                mantissa = mantissa * 10 + digit;
+                ++digits;
+            }
+            else
+            {
+                ++exponent;
+                truncated = truncated || digit != 0;
+            }
+        }
+        number.integerEnd = p;
+
+        number.fraction = number.fractionEnd = p;
+        if (p != end && *p == '.')
+        {
+            number.fraction = ++p;
+            while (p != end && IsDecimalDigit(*p))
+            {
+                unsigned digit = static_cast<unsigned>(*p++ - '0');
+                if (digits == 0 && digit == 0)
+                {
+                    --exponent;
+                }
+                else if (digits < MAX_MANTISSA_DIGITS)
+                {
+                    mantissa = mantissa * 10 + digit;
+                    ++digits;
+                    --exponent;
+                }
+                else truncated = truncated || digit != 0;
+            }
+            number.fractionEnd = p;
+        }
+        if (number.integer == number.integerEnd && number.fraction == number.fractionEnd) return 0;
+
+        number.explicitExponent = 0;
+        if (p != end && (*p == 'e' || *p == 'E'))
+        {
+            const char* e = p + 1;
+            bool negativeExponent = false;
+            if (e != end && (*e == '+' || *e == '-')) negativeExponent = *e++ == '-';
+            if (e != end && IsDecimalDigit(*e))
+            {
+                int value = 0;
+                while (e != end && IsDecimalDigit(*e))
+                {
+                    if (value < 100000) value = value * 10 + (*e - '0');     // Far beyond any finite result
+                    ++e;
+                }
+                number.explicitExponent = negativeExponent ? -value : value;
+                p = e;
+            }
+        }
+
+        number.mantissa = mantissa;
+        number.exponent = exponent + number.explicitExponent;
+        number.truncated = truncated;
+        return static_cast<std::size_t>(p - str);
+    }
+
+    /**
+     * @fn  template <typename T> T ConvertWithBignum(const DecimalNumber& number)
+     *
+     * @brief   Converts all digits of the number with Strtod()/Strtof() of double-conversion. Used only
+     *          internally for the cases Eisel-Lemire cannot decide.
+     *
+     * @param   number  The decimal number.
+     *
+     * @return  The value without sign.
+     */
+
+    template <typename T>
+    T ConvertWithBignum(const DecimalNumber& number)
+    {
+        char buffer[MAX_FALLBACK_DIGITS + 1];
+        int digits = 0;
+        int exponent = number.explicitExponent;
+        bool nonZeroDropped = false;
+
+        for (const char* p = number.integer; p != number.integerEnd; ++p)
+        {
+            if (digits == 0 && *p == '0') continue;
+            if (digits < MAX_FALLBACK_DIGITS) buffer[digits++] = *p;
+            else
+            {
+                ++exponent;
+                nonZeroDropped = nonZeroDropped || *p != '0';
+            }
+        }
+        for (const char* p = number.fraction; p != number.fractionEnd; ++p)
+        {
+            if (digits == 0 && *p == '0')
+            {
+                --exponent;
+            }
+            else if (digits < MAX_FALLBACK_DIGITS)
+            {
+                buffer[digits++] = *p;
+                --exponent;
+            }
+            else nonZeroDropped = nonZeroDropped || *p != '0';
+        }
+        if (nonZeroDropped)
+        {
+            // Sufficient to round correctly, see StringToDoubleConverter
+            buffer[digits++] = '1';
+            --exponent;
+        }
+
+        double_conversion::Vector<const char> vector(buffer, digits);
+        return sizeof(T) == sizeof(float) ? static_cast<T>(double_conversion::Strtof(vector, exponent))
+                                          : static_cast<T>(double_conversion::Strtod(vector, exponent));
+    }
+
+    bool MatchesIgnoreCase(const char* p, const char* end, const char* word)
+    {
+        for (; *word; ++p, ++word)
+        {
+            if (p == end || (*p | 0x20) != *word) return false;
+        }
+        return true;
+    }
+
+    template <typename T>
+    std::size_t ParseSpecial(const char* str, std::size_t length, T& result)
+    {
+        const char* p = str;
+        const char* end = str + length;
+        bool negative = p != end && *p == '-';
+        if (negative) ++p;
+
+        if (MatchesIgnoreCase(p, end, "nan"))
+        {
+            result = std::numeric_limits<T>::quiet_NaN();
+            return static_cast<std::size_t>(p + 3 - str);
+        }
+        if (MatchesIgnoreCase(p, end, "inf"))
+        {
+            result = negative ? -std::numeric_limits<T>::infinity() : std::numeric_limits<T>::infinity();
+            return static_cast<std::size_t>((MatchesIgnoreCase(p, end, "infinity") ? p + 8 : p + 3) - str);
+        }
+        return 0;
+    }
+
+    template <typename T>
+    std::size_t CharsToFloatingPoint(const char* str, std::size_t length, T& result)
+    {
+        typedef BinaryFormat<T> Format;
+
+        DecimalNumber number;
+        std::size_t consumed = ParseDecimal(str, length, number);
+        if (consumed == 0) return ParseSpecial(str, length, result);
+
+        // Exact for small significands and powers of ten (Clinger)
+        if (!number.truncated && number.exponent >= -Format::MAX_EXPONENT_FAST_PATH &&
+            number.exponent <= Format::MAX_EXPONENT_FAST_PATH && number.mantissa <= (UInt64(2) << Format::MANTISSA_BITS))
+        {
+            T value = static_cast<T>(number.mantissa);
+            if (number.exponent < 0)
+                value = value / static_cast<T>(EXACT_POWERS_OF_TEN[-number.exponent]);
+            else
+                value = value * static_cast<T>(EXACT_POWERS_OF_TEN[number.exponent]);
+            result = number.negative ? -value : value;
+            return consumed;
+        }
+
+        UInt64 mantissa;
+        int power2;
+        bool decided = EiselLemire<T>(number.mantissa, number.exponent, mantissa, power2);
+        if (decided && number.truncated)
+        {
+            // The dropped digits lie between mantissa and mantissa + 1
+            UInt64 upperMantissa;
+            int upperPower2;
+            decided = EiselLemire<T>(number.mantissa + 1, number.exponent, upperMantissa, upperPower2) &&
+                upperMantissa == mantissa && upperPower2 == power2;
+        }
+
+        if (decided)
+        {
+            result = MakeFloatingPoint<T>(number.negative, mantissa, power2);
+        }
+        else
+        {
+            T value = ConvertWithBignum<T>(number);
+            result = number.negative ? -value : value;
+        }
+        return consumed;
+    }
+
+    inline bool IsBlank(char c)
+    {
+        return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+    }
+
 } // namespace
 
 
@@ -184,6 +675,12 @@ namespace Technosoftware
         }
 
 
+        std::size_t FloatToChars(char* buffer, std::size_t bufferSize, float value) noexcept
+        {
+            return ShortestToChars(buffer, bufferSize, value, true);
+        }
+
+
         std::string& FloatToStr(std::string& str, float value, int precision, int width, char thSep, char decSep)
         {
             if (!decSep) decSep = '.';
@@ -246,6 +743,12 @@ namespace Technosoftware
         }
 
 
+        std::size_t DoubleToChars(char* buffer, std::size_t bufferSize, double value) noexcept
+        {
+            return ShortestToChars(buffer, bufferSize, value, false);
+        }
+
+
         std::string& DoubleToStr(std::string& str, double value, int precision, int width, char thSep, char decSep)
         {
             if (!decSep) decSep = '.';
@@ -289,9 +792,9 @@ namespace Technosoftware
             using namespace double_conversion;
 
             int processed;
-            int flags = StringToDoubleConverter::ALLOW_LEADING_SPACES |
+            static const int flags = StringToDoubleConverter::ALLOW_LEADING_SPACES |
                 StringToDoubleConverter::ALLOW_TRAILING_SPACES;
-            StringToDoubleConverter converter(flags, 0.0, Single::NaN(), TECHNOSOFTWARE_FLT_INF, TECHNOSOFTWARE_FLT_NAN);
+            static const StringToDoubleConverter converter(flags, 0.0, Single::NaN(), TECHNOSOFTWARE_FLT_INF, TECHNOSOFTWARE_FLT_NAN);
             float result = converter.StringToFloat(str, static_cast<int>(strlen(str)), &processed);
             return result;
         }
@@ -301,9 +804,9 @@ namespace Technosoftware
         {
             using namespace double_conversion;
             int processed;
-            int flags = StringToDoubleConverter::ALLOW_LEADING_SPACES |
+            static const int flags = StringToDoubleConverter::ALLOW_LEADING_SPACES |
                 StringToDoubleConverter::ALLOW_TRAILING_SPACES;
-            StringToDoubleConverter converter(flags, 0.0, Double::NaN(), TECHNOSOFTWARE_FLT_INF, TECHNOSOFTWARE_FLT_NAN);
+            static const StringToDoubleConverter converter(flags, 0.0, Double::NaN(), TECHNOSOFTWARE_FLT_INF, TECHNOSOFTWARE_FLT_NAN);
             double result = converter.StringToDouble(str, static_cast<int>(strlen(str)), &processed);
             return result;
         }
@@ -340,5 +843,43 @@ namespace Technosoftware
                 !FPEnvironment::IsNaN(result);
         }
 
+
+        std::size_t CharsToDouble(const char* str, std::size_t length, double& result) noexcept
+        {
+            return CharsToFloatingPoint(str, length, result);
+        }
+
+
+        std::size_t CharsToFloat(const char* str, std::size_t length, float& result) noexcept
+        {
+            return CharsToFloatingPoint(str, length, result);
+        }
+
+
+        std::size_t CharsToDoubles(const char* str, std::size_t length, char separator, double* values, std::size_t count, std::size_t* consumed) noexcept
+        {
+            const char* p = str;
+            const char* end = str + length;
+            const char* parsedEnd = str;
+            std::size_t parsed = 0;
+
+            while (parsed < count)
+            {
+                while (p != end && *p != separator && IsBlank(*p)) ++p;
+                std::size_t n = CharsToDouble(p, static_cast<std::size_t>(end - p), values[parsed]);
+                if (n == 0) break;
+                p += n;
+                ++parsed;
+                parsedEnd = p;
+
+                while (p != end && *p != separator && IsBlank(*p)) ++p;
+                if (p == end || *p != separator) break;
+                ++p;
+            }
+
+            if (consumed) *consumed = static_cast<std::size_t>(parsedEnd - str);
+            return parsed;
+        }
+
     }
 }
@@ -0,0 +1,260 @@
+/*
+ * Copyright (c) 2011-2021 Technosoftware GmbH. All rights reserved
+ * Web: https://technosoftware.com
+ *
+ * The source code in this file is covered under a dual-license scenario:
+ *   - Owner of a purchased license: SCLA 1.0
+ *   - GPL V3: everybody else
+ *
+ * SCLA license terms accompanied with this source code.
+ * See SCLA 1.0: https://technosoftware.com/license/Source_Code_License_Agreement.pdf
+ *
+ * GNU General Public License as published by the Free Software Foundation;
+ * version 3 of the License are accompanied with this source code.
+ * See https://technosoftware.com/license/GPLv3License.txt
+ *
+ * This source code is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#include "Base/RcuPtr.h"
+
+#include <new>
+#include <thread>
+
+namespace Technosoftware
+{
+    namespace Base
+    {
+        namespace
+        {
+            typedef unsigned long long Epoch;
+
+            enum
+            {
+                CACHE_LINE_SIZE = 64
+            };
+
+            // The epoch announced by one thread, 0 outside of read sections. Records are never freed,
+            // the record of a thread which has exited is reused by the next new thread.
+            struct Record
+            {
+                std::atomic<Epoch>  epoch;
+                std::atomic<bool>   inUse;
+                Record*             next;
+                char                padding[CACHE_LINE_SIZE - sizeof(std::atomic<Epoch>) - sizeof(std::atomic<bool>) - sizeof(Record*)];
+            };
+
+            struct Retired
+            {
+                void*       object;
+                Rcu::Deleter deleter;
+                Epoch       epoch;
+                Retired*    next;
+            };
+
+            // All state is constant initialized, RcuPtr objects with static storage duration may be
+            // destroyed in any order.
+            std::atomic<Epoch>      globalEpoch(1);
+            std::atomic<Record*>    records(0);
+            std::atomic_flag        retiredLock = ATOMIC_FLAG_INIT;
+            Retired*                retiredHead = 0;    // Oldest retired object, the list is ordered by epoch
+            Retired*                retiredTail = 0;
+            std::size_t             retiredCount = 0;
+
+            Record* AcquireRecord()
+            {
+                for (Record* record = records.load(std::memory_order_acquire); record; record = record->next)
+                {
+                    bool inUse = false;
+                    if (!record->inUse.load(std::memory_order_relaxed) &&
+                        record->inUse.compare_exchange_strong(inUse, true, std::memory_order_acquire))
+                    {
+                        return record;
+                    }
+                }
+
+                char* memory = new char[sizeof(Record) + CACHE_LINE_SIZE - 1];
+                std::size_t misalignment = reinterpret_cast<std::size_t>(memory) & (CACHE_LINE_SIZE - 1);
+                Record* record = new (memory + (misalignment == 0 ? 0 : CACHE_LINE_SIZE - misalignment)) Record();
+                record->epoch.store(0, std::memory_order_relaxed);
+                record->inUse.store(true, std::memory_order_relaxed);
+                record->next = records.load(std::memory_order_relaxed);
+                while (!records.compare_exchange_weak(record->next, record, std::memory_order_release, std::memory_order_relaxed))
+                {
+                }
+                return record;
+            }
+
+            // Owns the record of the current thread and releases it when the thread exits. Used only internally.
+            struct ThreadState
+            {
+                Record*         record;
+                unsigned int    nesting;
+
+                ThreadState() :
+                    record(0),
+                    nesting(0)
+                {
+                }
+
+                ~ThreadState()
+                {
+                    if (record)
+                    {
+                        record->epoch.store(0, std::memory_order_release);
+                        record->inUse.store(false, std::memory_order_release);
+                    }
+                }
+            };
+
+            thread_local ThreadState threadState;
+
+            void LockRetired()
+            {
+                while (retiredLock.test_and_set(std::memory_order_acquire))
+                {
+                    std::this_thread::yield();
+                }
+            }
+
+            void UnlockRetired()
+            {
+                retiredLock.clear(std::memory_order_release);
+            }
+
+            // Returns the oldest epoch announced by a reader, or the current epoch if there is no reader.
+            Epoch OldestEpoch()
+            {
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                Epoch oldest = globalEpoch.load(std::memory_order_relaxed);
+                for (Record* record = records.load(std::memory_order_acquire); record; record = record->next)
+                {
+                    Epoch epoch = record->epoch.load(std::memory_order_acquire);
+                    if (epoch != 0 && epoch < oldest)
+                    {
+                        oldest = epoch;
+                    }
+                }
+                return oldest;
+            }
+
+            // Deletes all retired objects no reader can still use.
+            void Reclaim()
+            {
+                Epoch oldest = OldestEpoch();
+                Retired* reclaimed = 0;
+
+                LockRetired();
+                while (retiredHead && retiredHead->epoch <= oldest)
+                {
+                    Retired* retired = retiredHead;
+                    retiredHead = retired->next;
+                    retired->next = reclaimed;
+                    reclaimed = retired;
+                    --retiredCount;
+                }
+                if (!retiredHead)
+                {
+                    retiredTail = 0;
+                }
+                UnlockRetired();
+
+                // The deleters run unlocked, they may retire further objects.
+                while (reclaimed)
+                {
+                    Retired* retired = reclaimed;
+                    reclaimed = retired->next;
+                    retired->deleter(retired->object);
+                    delete retired;
+                }
+            }
+        }
+
+
+        void Rcu::ReadLock()
+        {
+            ThreadState& state = threadState;
+            if (state.nesting++ == 0)
+            {
+                if (!state.record)
+                {
+                    state.record = AcquireRecord();
+                }
+                state.record->epoch.store(globalEpoch.load(std::memory_order_acquire), std::memory_order_relaxed);
+                // Orders the announcement before the loads of the read section, pairs with the fence in
+                // OldestEpoch() and Synchronize().
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+            }
+        }
+
+
+        void Rcu::ReadUnlock()
+        {
+            ThreadState& state = threadState;
+            technosoftware_assert_dbg(state.nesting > 0);
+            if (--state.nesting == 0)
+            {
+                state.record->epoch.store(0, std::memory_order_release);
+            }
+        }
+
+
+        void Rcu::Retire(void* object, Rcu::Deleter deleter)
+        {
+            if (object)
+            {
+                Retired* retired = new Retired;
+                retired->object = object;
+                retired->deleter = deleter;
+                retired->next = 0;
+
+                // Readers announcing this epoch or a newer one started after the object was unlinked.
+                // The epoch is taken under the lock to keep the list ordered.
+                LockRetired();
+                retired->epoch = globalEpoch.fetch_add(1, std::memory_order_seq_cst) + 1;
+                if (retiredTail)
+                {
+                    retiredTail->next = retired;
+                }
+                else
+                {
+                    retiredHead = retired;
+                }
+                retiredTail = retired;
+                ++retiredCount;
+                UnlockRetired();
+            }
+            Reclaim();
+        }
+
+
+        void Rcu::Synchronize()
+        {
+            technosoftware_assert_dbg(threadState.nesting == 0);
+
+            Epoch target = globalEpoch.fetch_add(1, std::memory_order_seq_cst) + 1;
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            for (Record* record = records.load(std::memory_order_acquire); record; record = record->next)
+            {
+                Epoch epoch = record->epoch.load(std::memory_order_acquire);
+                while (epoch != 0 && epoch < target)
+                {
+                    std::this_thread::yield();
+                    epoch = record->epoch.load(std::memory_order_acquire);
+                }
+            }
+            Reclaim();
+        }
+
+
+        std::size_t Rcu::GetRetiredCount()
+        {
+            LockRetired();
+            std::size_t count = retiredCount;
+            UnlockRetired();
+            return count;
+        }
+    }
+}
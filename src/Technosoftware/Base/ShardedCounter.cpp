@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) 2011-2021 Technosoftware GmbH. All rights reserved
+ * Web: https://technosoftware.com
+ *
+ * The source code in this file is covered under a dual-license scenario:
+ *   - Owner of a purchased license: SCLA 1.0
+ *   - GPL V3: everybody else
+ *
+ * SCLA license terms accompanied with this source code.
+ * See SCLA 1.0: https://technosoftware.com/license/Source_Code_License_Agreement.pdf
+ *
+ * GNU General Public License as published by the Free Software Foundation;
+ * version 3 of the License are accompanied with this source code.
+ * See https://technosoftware.com/license/GPLv3License.txt
+ *
+ * This source code is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#include "Base/ShardedCounter.h"
+
+#include <new>
+#include <thread>
+
+namespace Technosoftware
+{
+    namespace Base
+    {
+        namespace
+        {
+            std::atomic<unsigned int> nextThreadIndex(0);
+
+            // Assigned when a thread first uses a ShardedCounter. Used only internally.
+            thread_local unsigned int threadIndex = nextThreadIndex.fetch_add(1, std::memory_order_relaxed);
+        }
+
+
+        ShardedCounter::ShardedCounter()
+        {
+            Init(0);
+        }
+
+
+        ShardedCounter::ShardedCounter(ShardedCounter::ValueType initialValue)
+        {
+            Init(initialValue);
+        }
+
+
+        ShardedCounter::~ShardedCounter()
+        {
+            for (std::size_t i = 0; i <= mask_; ++i)
+            {
+                shards_[i].~Shard();
+            }
+            delete[] memory_;
+        }
+
+
+        void ShardedCounter::Init(ShardedCounter::ValueType initialValue)
+        {
+            std::size_t processors = std::thread::hardware_concurrency();
+            std::size_t count = 1;
+            while (count < processors && count < MAX_SHARDS)
+            {
+                count *= 2;
+            }
+            mask_ = count - 1;
+
+            memory_ = new char[count * sizeof(Shard) + CACHE_LINE_SIZE - 1];
+            std::size_t misalignment = reinterpret_cast<std::size_t>(memory_) & (CACHE_LINE_SIZE - 1);
+            shards_ = reinterpret_cast<Shard*>(memory_ + (misalignment == 0 ? 0 : CACHE_LINE_SIZE - misalignment));
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                new (&shards_[i]) Shard();
+                shards_[i].value.store(0, std::memory_order_relaxed);
+            }
+            shards_[0].value.store(initialValue, std::memory_order_relaxed);
+        }
+
+
+        ShardedCounter& ShardedCounter::operator = (ShardedCounter::ValueType value)
+        {
+            for (std::size_t i = 1; i <= mask_; ++i)
+            {
+                shards_[i].value.store(0, std::memory_order_relaxed);
+            }
+            shards_[0].value.store(value, std::memory_order_relaxed);
+            return *this;
+        }
+
+
+        ShardedCounter::ValueType ShardedCounter::Value() const
+        {
+            ValueType result = 0;
+            for (std::size_t i = 0; i <= mask_; ++i)
+            {
+                result += shards_[i].value.load(std::memory_order_relaxed);
+            }
+            return result;
+        }
+
+
+        unsigned int ShardedCounter::ThreadIndex()
+        {
+            return threadIndex;
+        }
+    }
+}
@@ -28,13 +28,113 @@
 #include "Base/TextConverter.h"
 #include "Base/TextIterator.h"
 #include "Base/TextEncoding.h"
+#include <algorithm>
+#include <cstring>
+
+#if defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+#include <emmintrin.h>
+#define TECHNOSOFTWARE_HAVE_SSE2
+#endif
 
 
 namespace {
+    using Technosoftware::Base::TextEncoding;
+
     int nullTransform(int ch)
     {
         return ch;
     }
+
+    /**
+     * @fn  const unsigned char* FindNonAscii(const unsigned char* p, const unsigned char* end)
+     *
+     * @brief   Returns the first byte which is not ASCII or end. Used only internally.
+     */
+
+    const unsigned char* FindNonAscii(const unsigned char* p, const unsigned char* end)
+    {
+#if defined(TECHNOSOFTWARE_HAVE_SSE2)
+        while (end - p >= 16)
+        {
+            int mask = _mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)));
+            if (mask)
+            {
+                while (!(mask & 1)) { mask >>= 1; ++p; }
+                return p;
+            }
+            p += 16;
+        }
+#endif
+        while (p != end && *p < 0x80) ++p;
+        return p;
+    }
+
+    /**
+     * @fn  void Reserve(std::string& destination, std::size_t length)
+     *
+     * @brief   Makes room for length more characters without giving up the exponential growth of
+     *          the string when it is appended to repeatedly. Used only internally.
+     */
+
+    void Reserve(std::string& destination, std::size_t length)
+    {
+        if (destination.capacity() - destination.size() < length)
+        {
+            destination.reserve(std::max(destination.size() + length, 2 * destination.capacity()));
+        }
+    }
+
+    /**
+     * @fn  int NextCharacter(const TextEncoding& encoding, const unsigned char*& it, const unsigned char* end)
+     *
+     * @brief   Decodes the character at it and moves it to the next character with the same rules
+     *          as TextIterator::operator * () and TextIterator::operator ++ (). Sequences longer than
+     *          MAX_SEQUENCE_LENGTH (5 and 6 byte UTF-8) are malformed. Used only internally.
+     *
+     * @return  The Unicode scalar value or -1 if the sequence is malformed.
+     */
+
+    int NextCharacter(const TextEncoding& encoding, const unsigned char*& it, const unsigned char* end)
+    {
+        unsigned char buffer[TextEncoding::MAX_SEQUENCE_LENGTH];
+
+        const unsigned char* p = it;
+        unsigned char* b = buffer;
+        *b++ = *p++;
+        int read = 1;
+        int n = encoding.QueryConvert(buffer, 1);
+        while (-1 > n && (end - p) >= -n - read)
+        {
+            if (-n > TextEncoding::MAX_SEQUENCE_LENGTH) { n = -1; break; }
+            while (read < -n && p != end)
+            {
+                *b++ = *p++;
+                read++;
+            }
+            n = encoding.QueryConvert(buffer, read);
+        }
+        int ch = -1 > n ? -1 : n;
+
+        b = buffer;
+        *b++ = *it++;
+        read = 1;
+        n = encoding.GetSequenceLength(buffer, 1);
+        while (-1 > n && (end - it) >= -n - read)
+        {
+            while (read < -n && it != end)
+            {
+                *b++ = *it++;
+                read++;
+            }
+            n = encoding.GetSequenceLength(buffer, read);
+        }
+        while (read < n && it != end)
+        {
+            it++;
+            read++;
+        }
+        return ch;
+    }
 }
 
 
@@ -47,35 +147,67 @@ namespace Technosoftware
 TextConverter::TextConverter(const TextEncoding& inEncoding, const TextEncoding& outEncoding, int defaultChar):
     inEncoding_(inEncoding),
     outEncoding_(outEncoding),
-    defaultChar_(defaultChar)
+    defaultChar_(defaultChar),
+    singleByteInput_(true),
+    asciiCompatible_(true),
+    byteTable_(0)
 {
+    // Only the character maps are inspected here; converters are often created for a single conversion.
+    const TextEncoding::CharacterMap& inMap = inEncoding_.GetCharacterMap();
+    const TextEncoding::CharacterMap& outMap = outEncoding_.GetCharacterMap();
+    for (int i = 0; i < 256; ++i)
+    {
+        if (inMap[i] < -1) singleByteInput_ = false;
+        if (i < 128 && (inMap[i] != i || outMap[i] != i)) asciiCompatible_ = false;
+    }
 }
 
 
 TextConverter::~TextConverter()
 {
+    delete byteTable_.load();
 }
 
 
-int TextConverter::Convert(const std::string& source, std::string& destination, Transform trans)
+const TextConverter::ByteTable* TextConverter::GetByteTable()
 {
-    int errors = 0;
-    TextIterator it(source, inEncoding_);
-    TextIterator end(source);
-    unsigned char buffer[TextEncoding::MAX_SEQUENCE_LENGTH];
+    const ByteTable* table = byteTable_.load(std::memory_order_acquire);
+    if (table) return table;
 
-    while (it != end)
+    const TextEncoding::CharacterMap& map = inEncoding_.GetCharacterMap();
+    ByteTable* created = new ByteTable;
+    created->maxSequenceLength = 0;
+    for (int i = 0; i < 256; ++i)
     {
-        int c = *it;
-        if (c == -1) { ++errors; c = defaultChar_; }
-        c = trans(c);
-        int n = outEncoding_.Convert(c, buffer, sizeof(buffer));
-        if (n == 0) n = outEncoding_.Convert(defaultChar_, buffer, sizeof(buffer));
-        technosoftware_assert (n <= sizeof(buffer));
-        destination.append((const char*) buffer, n);
-        ++it;
+        ByteSequence& sequence = created->sequences[i];
+        int c = map[i];
+        sequence.error = c == -1 ? 1 : 0;
+        if (sequence.error) c = defaultChar_;
+        int n = outEncoding_.Convert(c, sequence.bytes, sizeof(sequence.bytes));
+        if (n == 0) n = outEncoding_.Convert(defaultChar_, sequence.bytes, sizeof(sequence.bytes));
+        technosoftware_assert (static_cast<std::size_t>(n) <= sizeof(sequence.bytes));
+        sequence.length = static_cast<unsigned char>(n);
+        created->maxSequenceLength = std::max(created->maxSequenceLength, static_cast<std::size_t>(n));
     }
-    return errors;
+
+    // A converter may be used by several threads; the table of a thread which loses the race is discarded.
+    if (!byteTable_.compare_exchange_strong(table, created, std::memory_order_acq_rel, std::memory_order_acquire))
+    {
+        delete created;
+        return table;
+    }
+    return created;
+}
+
+
+int TextConverter::Convert(const std::string& source, std::string& destination, Transform trans)
+{
+    const unsigned char* it  = reinterpret_cast<const unsigned char*>(source.data());
+    const unsigned char* end = it + source.size();
+    if (singleByteInput_)
+        return ConvertSingleByte(it, end, destination, trans);
+    else
+        return ConvertMultiByte(it, end, destination, trans, true);
 }
 
 
@@ -83,62 +215,146 @@ int TextConverter::Convert(const void* source, int length, std::string& destinat
 {
     technosoftware_check_ptr (source);
 
-    int errors = 0;
     const unsigned char* it  = (const unsigned char*) source;
     const unsigned char* end = (const unsigned char*) source + length;
-    unsigned char buffer[TextEncoding::MAX_SEQUENCE_LENGTH];
-    
-    while (it < end)
-    {
-        int n = inEncoding_.QueryConvert(it, 1);
-        int uc;
-        int read = 1;
+    if (singleByteInput_)
+        return ConvertSingleByte(it, end, destination, trans);
+    else
+        return ConvertMultiByte(it, end, destination, trans, false);
+}
 
-        while (-1 > n && (end - it) >= -n)
+
+int TextConverter::Convert(const std::string& source, std::string& destination)
+{
+    return Convert(source, destination, nullTransform);
+}
+
+
+int TextConverter::Convert(const void* source, int length, std::string& destination)
+{
+    return Convert(source, length, destination, nullTransform);
+}
+
+
+int TextConverter::ConvertSingleByte(const unsigned char* it, const unsigned char* end, std::string& destination, Transform trans)
+{
+    int errors = 0;
+    if (it == end) return errors;
+
+    if (trans != nullTransform)
+    {
+        const TextEncoding::CharacterMap& map = inEncoding_.GetCharacterMap();
+        unsigned char buffer[TextEncoding::MAX_SEQUENCE_LENGTH];
+        Reserve(destination, static_cast<std::size_t>(end - it));
+        while (it < end)
         {
-            read = -n;
-            n = inEncoding_.QueryConvert(it, read);
+            int c = map[*it++];
+            if (c == -1) { ++errors; c = defaultChar_; }
+            c = trans(c);
+            int n = outEncoding_.Convert(c, buffer, sizeof(buffer));
+            if (n == 0) n = outEncoding_.Convert(defaultChar_, buffer, sizeof(buffer));
+            technosoftware_assert (static_cast<std::size_t>(n) <= sizeof(buffer));
+            destination.append((const char*) buffer, n);
         }
+        return errors;
+    }
+
+    // Room for the longest output of every byte; the string is cut to the real length at the end
+    const ByteTable* table = GetByteTable();
+    std::size_t offset = destination.size();
+    std::size_t maxLength = static_cast<std::size_t>(end - it) * table->maxSequenceLength;
+    Reserve(destination, maxLength);
+    destination.resize(offset + maxLength);
+    char* begin = &destination[0];
+    char* out = begin + offset;
 
-        if (-1 > n)
+    while (it < end)
+    {
+        if (asciiCompatible_)
         {
-            it = end;
+            const unsigned char* run = FindNonAscii(it, end);
+            std::memcpy(out, it, run - it);
+            out += run - it;
+            it = run;
+            if (it == end) break;
         }
-        else
+        const ByteSequence& sequence = table->sequences[*it++];
+        errors += sequence.error;
+        for (unsigned char i = 0; i < sequence.length; ++i) *out++ = static_cast<char>(sequence.bytes[i]);
+    }
+    destination.resize(static_cast<std::size_t>(out - begin));
+    return errors;
+}
+
+
+int TextConverter::ConvertMultiByte(const unsigned char* it, const unsigned char* end, std::string& destination, Transform trans, bool iteratorRules)
+{
+    int errors = 0;
+    bool copyAscii = asciiCompatible_ && trans == nullTransform;
+    unsigned char buffer[TextEncoding::MAX_SEQUENCE_LENGTH];
+
+    // At least one byte per character for ASCII compatible output
+    Reserve(destination, static_cast<std::size_t>(end - it));
+
+    while (it < end)
+    {
+        if (copyAscii)
         {
-            it += read;
+            const unsigned char* run = FindNonAscii(it, end);
+            if (run != it)
+            {
+                destination.append((const char*) it, run - it);
+                it = run;
+                if (it == end) break;
+            }
         }
 
-        if (-1 >= n)
+        int uc;
+        if (iteratorRules)
         {
-            uc = defaultChar_;
-            ++errors;
+            uc = NextCharacter(inEncoding_, it, end);
+            if (uc == -1) { ++errors; uc = defaultChar_; }
         }
         else
         {
-            uc = n;
+            int n = inEncoding_.QueryConvert(it, 1);
+            int read = 1;
+
+            while (-1 > n && (end - it) >= -n)
+            {
+                if (-n > TextEncoding::MAX_SEQUENCE_LENGTH) { n = -1; break; }
+                read = -n;
+                n = inEncoding_.QueryConvert(it, read);
+            }
+
+            if (-1 > n)
+            {
+                it = end;
+            }
+            else
+            {
+                it += read;
+            }
+
+            if (-1 >= n)
+            {
+                uc = defaultChar_;
+                ++errors;
+            }
+            else
+            {
+                uc = n;
+            }
         }
 
         uc = trans(uc);
-        n = outEncoding_.Convert(uc, buffer, sizeof(buffer));
+        int n = outEncoding_.Convert(uc, buffer, sizeof(buffer));
         if (n == 0) n = outEncoding_.Convert(defaultChar_, buffer, sizeof(buffer));
-        technosoftware_assert (n <= sizeof(buffer));
+        technosoftware_assert (static_cast<std::size_t>(n) <= sizeof(buffer));
         destination.append((const char*) buffer, n);
     }
     return errors;
 }
 
-
-int TextConverter::Convert(const std::string& source, std::string& destination)
-{
-    return Convert(source, destination, nullTransform);
-}
-
-
-int TextConverter::Convert(const void* source, int length, std::string& destination)
-{
-    return Convert(source, length, destination, nullTransform);
-}
-
     }
 } 
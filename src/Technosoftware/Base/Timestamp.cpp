@@ -46,6 +46,12 @@
 #if defined(_WIN32_WCE)
 #include <cmath>
 #endif
+// On x86 a 64 bit division is a call into the runtime library, so the bulk FILETIME conversion uses SSE2.
+// On x64 the compiler replaces the division by a multiplication, which is faster than the SSE2 code.
+#if defined(_M_IX86_FP) && _M_IX86_FP >= 2
+#include <emmintrin.h>
+#define TECHNOSOFTWARE_HAVE_SSE2
+#endif
 #endif
 
 
@@ -323,6 +329,99 @@ namespace Technosoftware
         }
 
 
+        void Timestamp::FromFileTimes(const FILETIME* fileTimes, std::size_t count, Timestamp* timestamps)
+        {
+            const UInt64 epoch = 0x019DB1DED53E8000; // UNIX epoch (1970-01-01 00:00:00) expressed in Windows NT FILETIME
+
+            std::size_t i = 0;
+#if defined(TECHNOSOFTWARE_HAVE_SSE2)
+            // Blocks of four values with the same high part H:
+            //   (H * 2^32 + L - epoch) / 10 = q0 + L / 10 + ((L % 10 + r0) >= 10)
+            // with q0 and r0 the quotient and remainder of (H * 2^32 - epoch) / 10. L / 10 is computed
+            // as (L * 0xCCCCCCCD) >> 35, which is exact for all 32 bit values.
+            DWORD high = 0;                              // No valid high part yet, see check above
+            UInt64 q0 = 0;
+            __m128i r0 = _mm_setzero_si128();
+            const __m128i magic = _mm_set1_epi32((int)0xCCCCCCCD);
+            const __m128i nine = _mm_set1_epi32(9);
+
+            for (; i + 4 <= count; i += 4)
+            {
+                __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(fileTimes + i));       // L0 H0 L1 H1
+                __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(fileTimes + i + 2));   // L2 H2 L3 H3
+                __m128i lows = _mm_castps_si128(_mm_shuffle_ps(_mm_castsi128_ps(a), _mm_castsi128_ps(b), _MM_SHUFFLE(2, 0, 2, 0)));
+                __m128i highs = _mm_castps_si128(_mm_shuffle_ps(_mm_castsi128_ps(a), _mm_castsi128_ps(b), _MM_SHUFFLE(3, 1, 3, 1)));
+
+                DWORD h = fileTimes[i].dwHighDateTime;
+                if (_mm_movemask_epi8(_mm_cmpeq_epi32(highs, _mm_set1_epi32((int)h))) != 0xFFFF ||
+                    h <= (DWORD)(epoch >> 32))           // H * 2^32 - epoch must not wrap
+                {
+                    for (std::size_t j = i; j < i + 4; j++)
+                    {
+                        timestamps[j] = FromFileTime(fileTimes[j].dwLowDateTime, fileTimes[j].dwHighDateTime);
+                    }
+                    continue;
+                }
+                if (h != high)
+                {
+                    UInt64 base = ((UInt64)h << 32) - epoch;
+                    high = h;
+                    q0 = base / 10;
+                    r0 = _mm_set1_epi32((int)(base % 10));
+                }
+
+                // L / 10 for the even and odd lanes
+                __m128i even = _mm_srli_epi64(_mm_mul_epu32(lows, magic), 35);
+                __m128i odd = _mm_srli_epi64(_mm_mul_epu32(_mm_srli_epi64(lows, 32), magic), 35);
+                __m128i q = _mm_or_si128(even, _mm_slli_epi64(odd, 32));
+
+                // Carry if L % 10 + r0 >= 10; the values are small, so a signed compare is sufficient
+                __m128i rem = _mm_sub_epi32(lows, _mm_add_epi32(_mm_slli_epi32(q, 3), _mm_add_epi32(q, q)));
+                __m128i carry = _mm_srli_epi32(_mm_cmpgt_epi32(_mm_add_epi32(rem, r0), nine), 31);
+                q = _mm_add_epi32(q, carry);
+
+                // Timestamp is not trivially copyable, so the lanes are staged instead of stored into the array
+                __m128i base = _mm_set1_epi64x((long long)q0);
+                __m128i zero = _mm_setzero_si128();
+                Int64 lanes[4];
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), _mm_add_epi64(base, _mm_unpacklo_epi32(q, zero)));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes + 2), _mm_add_epi64(base, _mm_unpackhi_epi32(q, zero)));
+                for (std::size_t j = 0; j < 4; j++)
+                {
+                    timestamps[i + j] = lanes[j];
+                }
+            }
+#endif
+            for (; i < count; i++)
+            {
+                timestamps[i] = FromFileTime(fileTimes[i].dwLowDateTime, fileTimes[i].dwHighDateTime);
+            }
+        }
+
+
+        void Timestamp::ToFileTimes(const Timestamp* timestamps, std::size_t count, FILETIME* fileTimes)
+        {
+            const UInt64 epoch = 0x019DB1DED53E8000; // UNIX epoch (1970-01-01 00:00:00) expressed in Windows NT FILETIME
+
+            std::size_t i = 0;
+#if defined(TECHNOSOFTWARE_HAVE_SSE2)
+            // ts * 10 + epoch as (ts << 3) + (ts << 1) + epoch, two values at a time. The values are read through
+            // GetEpochMicroseconds() rather than from the array because Timestamp is not trivially copyable.
+            const __m128i offset = _mm_set1_epi64x((long long)epoch);
+            for (; i + 2 <= count; i += 2)
+            {
+                __m128i ts = _mm_set_epi64x(timestamps[i + 1].GetEpochMicroseconds(), timestamps[i].GetEpochMicroseconds());
+                __m128i ft = _mm_add_epi64(_mm_add_epi64(_mm_slli_epi64(ts, 3), _mm_slli_epi64(ts, 1)), offset);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(fileTimes + i), ft);
+            }
+#endif
+            for (; i < count; i++)
+            {
+                timestamps[i].ToFileTime(fileTimes[i].dwLowDateTime, fileTimes[i].dwHighDateTime);
+            }
+        }
+
+
 #endif
     }
 
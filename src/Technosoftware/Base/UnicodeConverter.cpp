@@ -33,6 +33,109 @@
 #include "Base/UTF32Encoding.h"
 #include <cstring>
 
+#if defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+#include <emmintrin.h>
+#define TECHNOSOFTWARE_HAVE_SSE2
+#endif
+
+
+namespace
+{
+    using Technosoftware::Base::UInt16;
+    using Technosoftware::Base::UInt32;
+
+    inline bool IsContinuation(unsigned char c)
+    {
+        return (c & 0xC0) == 0x80;
+    }
+
+    /**
+     * @fn  std::size_t AsciiPrefix(const unsigned char* p, const unsigned char* end)
+     *
+     * @brief   Returns the number of bytes before the first non-ASCII byte. Used only internally.
+     */
+
+    std::size_t AsciiPrefix(const unsigned char* p, const unsigned char* end)
+    {
+        const unsigned char* begin = p;
+#if defined(TECHNOSOFTWARE_HAVE_SSE2)
+        while (end - p >= 32)
+        {
+            __m128i first = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+            __m128i second = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 16));
+            if (_mm_movemask_epi8(_mm_or_si128(first, second))) break;
+            p += 32;
+        }
+        while (end - p >= 16)
+        {
+            if (_mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)))) break;
+            p += 16;
+        }
+#endif
+        while (p != end && *p < 0x80) ++p;
+        return static_cast<std::size_t>(p - begin);
+    }
+
+    /**
+     * @fn  int SequenceLength(const unsigned char* p, const unsigned char* end)
+     *
+     * @brief   Validates the multi-byte sequence at p according to RFC 3629. Used only internally.
+     *
+     * @return  The length of the sequence or 0 if it is not valid.
+     */
+
+    int SequenceLength(const unsigned char* p, const unsigned char* end)
+    {
+        unsigned char c = *p;
+        std::size_t available = static_cast<std::size_t>(end - p);
+        if (c < 0xC2) return 0;                                         // Continuation byte or overlong
+        if (c < 0xE0)
+        {
+            return available >= 2 && IsContinuation(p[1]) ? 2 : 0;
+        }
+        if (c < 0xF0)
+        {
+            if (available < 3 || !IsContinuation(p[1]) || !IsContinuation(p[2])) return 0;
+            if (c == 0xE0 && p[1] < 0xA0) return 0;                     // Overlong
+            if (c == 0xED && p[1] >= 0xA0) return 0;                    // Surrogate
+            return 3;
+        }
+        if (c < 0xF5)
+        {
+            if (available < 4 || !IsContinuation(p[1]) || !IsContinuation(p[2]) || !IsContinuation(p[3])) return 0;
+            if (c == 0xF0 && p[1] < 0x90) return 0;                     // Overlong
+            if (c == 0xF4 && p[1] >= 0x90) return 0;                    // Above U+10FFFF
+            return 4;
+        }
+        return 0;
+    }
+
+    /**
+     * @fn  template <typename C> std::size_t AsciiUnits(const C* p, const C* end)
+     *
+     * @brief   Returns the number of UTF-16 code units before the first one above 0x7F. Used only
+     *          internally.
+     */
+
+    template <typename C>
+    std::size_t AsciiUnits(const C* p, const C* end)
+    {
+        const C* begin = p;
+#if defined(TECHNOSOFTWARE_HAVE_SSE2)
+        const __m128i nonAscii = _mm_set1_epi16(static_cast<short>(0xFF80));
+        const __m128i zero = _mm_setzero_si128();
+        while (end - p >= 8)
+        {
+            __m128i units = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+            if (_mm_movemask_epi8(_mm_cmpeq_epi16(_mm_and_si128(units, nonAscii), zero)) != 0xFFFF) break;
+            p += 8;
+        }
+#endif
+        while (p != end && static_cast<UInt16>(*p) < 0x80) ++p;
+        return static_cast<std::size_t>(p - begin);
+    }
+}
+
 
 namespace Technosoftware
 {
@@ -81,7 +184,9 @@ namespace Technosoftware
 
         void UnicodeConverter::Convert(const std::string& utf8String, UTF16String& utf16String)
         {
-            utf16String.clear();
+            if (TryConvert(utf8String.data(), utf8String.size(), utf16String)) return;
+
+            // Invalid sequences are decoded the same way as by TextIterator
             UTF8Encoding utf8Encoding;
             TextIterator it(utf8String, utf8Encoding);
             TextIterator end(utf8String);
@@ -110,6 +215,7 @@ namespace Technosoftware
                 return;
             }
 
+            if (TryConvert(utf8String, length, utf16String)) return;
             Convert(std::string(utf8String, utf8String + length), utf16String);
         }
 
@@ -122,13 +228,14 @@ namespace Technosoftware
                 return;
             }
 
-            Convert(std::string(utf8String), utf16String);
+            Convert(utf8String, std::strlen(utf8String), utf16String);
         }
 
 
         void UnicodeConverter::Convert(const UTF16String& utf16String, std::string& utf8String)
         {
-            utf8String.clear();
+            if (TryConvert(utf16String.data(), utf16String.length(), utf8String)) return;
+
             UTF8Encoding utf8Encoding;
             UTF16Encoding utf16Encoding;
             TextConverter converter(utf16Encoding, utf8Encoding);
@@ -148,7 +255,8 @@ namespace Technosoftware
 
         void UnicodeConverter::Convert(const UTF16Char* utf16String, std::size_t length, std::string& utf8String)
         {
-            utf8String.clear();
+            if (TryConvert(utf16String, length, utf8String)) return;
+
             UTF8Encoding utf8Encoding;
             UTF16Encoding utf16Encoding;
             TextConverter converter(utf16Encoding, utf8Encoding);
@@ -172,5 +280,185 @@ namespace Technosoftware
         {
             toUTF8(utf32String, UTFStrlen(utf32String), utf8String);
         }
+
+
+        std::size_t UnicodeConverter::UTF16Length(const char* utf8String, std::size_t length) noexcept
+        {
+            const unsigned char* p = reinterpret_cast<const unsigned char*>(utf8String);
+            const unsigned char* end = p + length;
+            std::size_t units = 0;
+            for (;;)
+            {
+                std::size_t ascii = AsciiPrefix(p, end);
+                p += ascii;
+                units += ascii;
+                if (p == end) return units;
+
+                int n = SequenceLength(p, end);
+                if (n == 0) return INVALID_LENGTH;
+                p += n;
+                units += n == 4 ? 2 : 1;
+            }
+        }
+
+
+        std::size_t UnicodeConverter::UTF8Length(const UTF16Char* utf16String, std::size_t length) noexcept
+        {
+            const UTF16Char* p = utf16String;
+            const UTF16Char* end = p + length;
+            std::size_t bytes = 0;
+            for (;;)
+            {
+                std::size_t ascii = AsciiUnits(p, end);
+                p += ascii;
+                bytes += ascii;
+                if (p == end) return bytes;
+
+                UInt16 c = static_cast<UInt16>(*p++);
+                if (c < 0x800)
+                {
+                    bytes += 2;
+                }
+                else if (c >= 0xD800 && c <= 0xDBFF)
+                {
+                    if (p == end || static_cast<UInt16>(*p) < 0xDC00 || static_cast<UInt16>(*p) > 0xDFFF) return INVALID_LENGTH;
+                    ++p;
+                    bytes += 4;
+                }
+                else if (c >= 0xDC00 && c <= 0xDFFF)
+                {
+                    return INVALID_LENGTH;
+                }
+                else bytes += 3;
+            }
+        }
+
+
+        std::size_t UnicodeConverter::Transcode(const char* utf8String, std::size_t length, UTF16Char* utf16String) noexcept
+        {
+            const unsigned char* p = reinterpret_cast<const unsigned char*>(utf8String);
+            const unsigned char* end = p + length;
+            UTF16Char* out = utf16String;
+            while (p != end)
+            {
+#if defined(TECHNOSOFTWARE_HAVE_SSE2)
+                const __m128i zero = _mm_setzero_si128();
+                while (end - p >= 16)
+                {
+                    __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+                    if (_mm_movemask_epi8(bytes)) break;
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_unpacklo_epi8(bytes, zero));
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 8), _mm_unpackhi_epi8(bytes, zero));
+                    p += 16;
+                    out += 16;
+                }
+                if (p == end) break;
+#endif
+                unsigned c = *p;
+                if (c < 0x80)
+                {
+                    *out++ = static_cast<UTF16Char>(c);
+                    ++p;
+                }
+                else if (c < 0xE0)
+                {
+                    *out++ = static_cast<UTF16Char>(((c & 0x1F) << 6) | (p[1] & 0x3F));
+                    p += 2;
+                }
+                else if (c < 0xF0)
+                {
+                    *out++ = static_cast<UTF16Char>(((c & 0x0F) << 12) | ((p[1] & 0x3F) << 6) | (p[2] & 0x3F));
+                    p += 3;
+                }
+                else
+                {
+                    UInt32 cc = ((c & 0x07) << 18) | ((p[1] & 0x3F) << 12) | ((p[2] & 0x3F) << 6) | (p[3] & 0x3F);
+                    cc -= 0x10000;
+                    *out++ = static_cast<UTF16Char>(0xD800 | (cc >> 10));
+                    *out++ = static_cast<UTF16Char>(0xDC00 | (cc & 0x3FF));
+                    p += 4;
+                }
+            }
+            return static_cast<std::size_t>(out - utf16String);
+        }
+
+
+        std::size_t UnicodeConverter::Transcode(const UTF16Char* utf16String, std::size_t length, char* utf8String) noexcept
+        {
+            const UTF16Char* p = utf16String;
+            const UTF16Char* end = p + length;
+            char* out = utf8String;
+            while (p != end)
+            {
+#if defined(TECHNOSOFTWARE_HAVE_SSE2)
+                const __m128i nonAscii = _mm_set1_epi16(static_cast<short>(0xFF80));
+                const __m128i zero = _mm_setzero_si128();
+                while (end - p >= 16)
+                {
+                    __m128i first = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+                    __m128i second = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 8));
+                    __m128i high = _mm_and_si128(_mm_or_si128(first, second), nonAscii);
+                    if (_mm_movemask_epi8(_mm_cmpeq_epi16(high, zero)) != 0xFFFF) break;
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_packus_epi16(first, second));
+                    p += 16;
+                    out += 16;
+                }
+                if (p == end) break;
+#endif
+                UInt32 c = static_cast<UInt16>(*p++);
+                if (c < 0x80)
+                {
+                    *out++ = static_cast<char>(c);
+                }
+                else if (c < 0x800)
+                {
+                    *out++ = static_cast<char>(0xC0 | (c >> 6));
+                    *out++ = static_cast<char>(0x80 | (c & 0x3F));
+                }
+                else if (c >= 0xD800 && c <= 0xDBFF)
+                {
+                    c = 0x10000 + ((c - 0xD800) << 10) + (static_cast<UInt16>(*p++) - 0xDC00);
+                    *out++ = static_cast<char>(0xF0 | (c >> 18));
+                    *out++ = static_cast<char>(0x80 | ((c >> 12) & 0x3F));
+                    *out++ = static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+                    *out++ = static_cast<char>(0x80 | (c & 0x3F));
+                }
+                else
+                {
+                    *out++ = static_cast<char>(0xE0 | (c >> 12));
+                    *out++ = static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+                    *out++ = static_cast<char>(0x80 | (c & 0x3F));
+                }
+            }
+            return static_cast<std::size_t>(out - utf8String);
+        }
+
+
+        bool UnicodeConverter::TryConvert(const char* utf8String, std::size_t length, UTF16String& utf16String)
+        {
+            std::size_t units = UTF16Length(utf8String, length);
+            if (units == INVALID_LENGTH)
+            {
+                utf16String.clear();
+                return false;
+            }
+            utf16String.resize(units);
+            if (units) Transcode(utf8String, length, &utf16String[0]);
+            return true;
+        }
+
+
+        bool UnicodeConverter::TryConvert(const UTF16Char* utf16String, std::size_t length, std::string& utf8String)
+        {
+            std::size_t bytes = UTF8Length(utf16String, length);
+            if (bytes == INVALID_LENGTH)
+            {
+                utf8String.clear();
+                return false;
+            }
+            utf8String.resize(bytes);
+            if (bytes) Transcode(utf16String, length, &utf8String[0]);
+            return true;
+        }
     }
 }
@@ -33,17 +33,16 @@ namespace Technosoftware
             ONEVENTSTRUCT* _pOnEvent = static_cast<ONEVENTSTRUCT*>(pOnEvent);
             _ASSERTE(_pOnEvent);
 
-            USES_CONVERSION;
             changeMask_ = _pOnEvent->wChangeMask;
             newState_ = _pOnEvent->wNewState;
-            source_ = OLE2A(_pOnEvent->szSource);
+            OpcStringConversion::ToString(_pOnEvent->szSource, source_);
             timestamp_ = Base::Timestamp::FromFileTime(_pOnEvent->ftTime.dwLowDateTime, _pOnEvent->ftTime.dwHighDateTime);
-            message_ = OLE2A(_pOnEvent->szMessage);
+            OpcStringConversion::ToString(_pOnEvent->szMessage, message_);
             eventType_ = _pOnEvent->dwEventType;
             eventCategory_ = _pOnEvent->dwEventCategory;
             severity_ = _pOnEvent->dwSeverity;
-            conditionName_ = OLE2A(_pOnEvent->szConditionName);
-            subconditionName_ = OLE2A(_pOnEvent->szSubconditionName);
+            OpcStringConversion::ToString(_pOnEvent->szConditionName, conditionName_);
+            OpcStringConversion::ToString(_pOnEvent->szSubconditionName, subconditionName_);
             quality_ = _pOnEvent->wQuality;
             reserved_ = _pOnEvent->wReserved;
             ackRequired_ = _pOnEvent->bAckRequired ? true : false;
@@ -78,7 +77,7 @@ namespace Technosoftware
             // According to the specification a server should return a NUL string
             // and not a NULL pointer. To avoid conflicts with incompatible servers
             // we test for a NULL pointer.
-            actorId_ = _pOnEvent->szActorID ? OLE2A(_pOnEvent->szActorID) : "";
+            OpcStringConversion::ToString(_pOnEvent->szActorID, actorId_);
         }
 
         AeEvent::~AeEvent() throw ()
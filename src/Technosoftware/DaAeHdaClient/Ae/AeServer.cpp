@@ -302,21 +302,21 @@ namespace Technosoftware
             }
             string sRegisterName;
             try {
-                USES_CONVERSION;
                 if (fMachineNameAsPrefix) {
-                    TCHAR szComputerName[MAX_COMPUTERNAME_LENGTH + 1];
+                    WCHAR szComputerName[MAX_COMPUTERNAME_LENGTH + 1];
                     DWORD dwNameLen = _countof(szComputerName);
 
-                    if (!GetComputerName(szComputerName, &dwNameLen)) {
+                    if (!GetComputerNameW(szComputerName, &dwNameLen)) {
                         return Technosoftware::DaAeHdaClient::GetStatusFromHResult(HRESULT_FROM_WIN32(GetLastError()));
                     }
                     sRegisterName = "\\\\";
-                    sRegisterName += T2A(szComputerName);
+                    sRegisterName += OpcStringConversion::ToString(szComputerName);
                     sRegisterName += "\\";
                 }
                 sRegisterName += sClientName;
 
-                return Technosoftware::DaAeHdaClient::GetStatusFromHResult(iOPCCommon_->SetClientName(A2CW(sRegisterName.c_str())),Base::StatusCode::AeFuncCall);
+                OpcStringConversion conversion;
+                return Technosoftware::DaAeHdaClient::GetStatusFromHResult(iOPCCommon_->SetClientName(conversion.ToWide(sRegisterName)),Base::StatusCode::AeFuncCall);
             }
             catch (...) {
                 return Technosoftware::DaAeHdaClient::GetStatusFromHResult(E_OUTOFMEMORY);
@@ -408,7 +408,6 @@ namespace Technosoftware
             OPCEVENTSERVERSTATUS* pStatusResult;
             HRESULT hr = iOPCEventServer_->GetStatus(&pStatusResult);
             if (SUCCEEDED(hr)) {
-                USES_CONVERSION;
                 pStatus->startTime_ = Base::Timestamp::FromFileTime(pStatusResult->ftStartTime.dwLowDateTime, pStatusResult->ftStartTime.dwHighDateTime);
                 pStatus->currentTime_ = Base::Timestamp::FromFileTime(pStatusResult->ftCurrentTime.dwLowDateTime, pStatusResult->ftCurrentTime.dwHighDateTime);
                 pStatus->lastUpdateTime_ = Base::Timestamp::FromFileTime(pStatusResult->ftLastUpdateTime.dwLowDateTime, pStatusResult->ftLastUpdateTime.dwHighDateTime);
@@ -437,7 +436,7 @@ namespace Technosoftware
                 pStatus->majorVersion_ = pStatusResult->wMajorVersion;
                 pStatus->minorVersion_ = pStatusResult->wMinorVersion;
                 pStatus->buildNumber_ = pStatusResult->wBuildNumber;
-                pStatus->vendorInfo_ = OLE2A(pStatusResult->szVendorInfo);
+                OpcStringConversion::ToString(pStatusResult->szVendorInfo, pStatus->vendorInfo_);
 
                 opcAESrv_.m_pIMalloc->Free(pStatusResult->szVendorInfo);
                 opcAESrv_.m_pIMalloc->Free(pStatusResult);
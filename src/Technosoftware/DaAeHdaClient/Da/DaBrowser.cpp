@@ -124,9 +124,8 @@ namespace Technosoftware
             OPCBROWSEELEMENT* pEl = static_cast<OPCBROWSEELEMENT*>(pOPCBROWSEELEMENT);
             if (!pEl) throw Technosoftware::Base::InvalidArgumentException();
             try {
-                USES_CONVERSION;
-                name_ = W2A(pEl->szName);
-                itemId_ = W2A(pEl->szItemID);
+                OpcStringConversion::ToString(pEl->szName, name_);
+                OpcStringConversion::ToString(pEl->szItemID, itemId_);
                 m_dwFlagValue = pEl->dwFlagValue;
 
                 // Add the available Properties
@@ -364,7 +363,7 @@ namespace Technosoftware
         //----------------------------------------------------------------------------------------------------------------------
         Technosoftware::Base::Status DaBrowserImpl::Browse(const string& sPosition) noexcept
         {
-            USES_CONVERSION;
+            OpcStringConversion conversion;
             Technosoftware::Base::Status res;
 
             // Remove all existing elements
@@ -387,12 +386,12 @@ namespace Technosoftware
                 else                                                  dwGetBrowseElementFilter = OPC_BROWSE_FILTER_ITEMS;
 
                 HRESULT hr = m_pIOPCBrowse->Browse(
-                    A2W(sPosition.c_str()),
+                    conversion.ToWide(sPosition),
                     &m_pszContinuationPoint,
                     m_Filters.GetMaxElementsReturned(),
                     dwGetBrowseElementFilter,
-                    A2W(m_Filters.GetElementNameFilter().c_str()),
-                    A2W(m_Filters.GetVendorFilter().c_str()),
+                    conversion.ToWide(m_Filters.GetElementNameFilter()),
+                    conversion.ToWide(m_Filters.GetVendorFilter()),
                     m_Filters.IsReturnAllProperties() ? TRUE : FALSE,
                     m_Filters.GetReturnPropertyValues() ? TRUE : FALSE,
                     dwPropertyCount,
@@ -459,7 +458,7 @@ namespace Technosoftware
                     LPENUMSTRING pIEnumString = NULL;
                     HRESULT hr = m_pIOPCBrowseSAS->BrowseOPCItemIDs(
                         OPC_FLAT,
-                        A2W(m_Filters.GetElementNameFilter().c_str()),
+                        conversion.ToWide(m_Filters.GetElementNameFilter()),
                         m_Filters.GetDataTypeFilter(),
                         m_Filters.GetAccessRightsFilter(),
                         &pIEnumString);
@@ -509,7 +508,7 @@ namespace Technosoftware
 
         string DaBrowserImpl::GetPropertyValueAsText(const string& sItemID, DWORD dwPropertyId) throw()
         {
-            USES_CONVERSION;
+            OpcStringConversion conversion;
             Technosoftware::Base::Status res;
 
             DWORD             dwPropertyCount = 0;                            // Dummy
@@ -519,7 +518,7 @@ namespace Technosoftware
             OPCBROWSEELEMENT* pBrowseElements = NULL;
             OPCBROWSEFILTER   dwGetBrowseElementFilter;
             OPCITEMPROPERTIES* pProperties;
-            LPWSTR sItemName = A2W(sItemID.c_str());
+            LPWSTR sItemName = conversion.ToWide(sItemID);
 
             // Map the Element Filter
             if (m_Filters.GetBrowseElementFilter() == DaBrowseElementFilter::All)           dwGetBrowseElementFilter = OPC_BROWSE_FILTER_ALL;
@@ -569,7 +568,7 @@ namespace Technosoftware
 
         DaItemProperties& DaBrowserImpl::GetProperties(const string& sItemID)
         {
-            USES_CONVERSION;
+            OpcStringConversion conversion;
             Technosoftware::Base::Status res;
 
             m_ItemProperties.clear();
@@ -581,7 +580,7 @@ namespace Technosoftware
             OPCBROWSEELEMENT* pBrowseElements = NULL;
             OPCBROWSEFILTER   dwGetBrowseElementFilter;
             OPCITEMPROPERTIES* pProperties;
-            LPWSTR sItemName = A2W(sItemID.c_str());
+            LPWSTR sItemName = conversion.ToWide(sItemID);
 
             // Map the Element Filter
             if (m_Filters.GetBrowseElementFilter() == DaBrowseElementFilter::All)           dwGetBrowseElementFilter = OPC_BROWSE_FILTER_ALL;
@@ -654,14 +653,14 @@ namespace Technosoftware
                 }
             }
             else {
-                USES_CONVERSION;
+                OpcStringConversion conversion;
                 HRESULT        hr;
                 LPENUMSTRING   pIEnumString;
 
                 // Change position to the branch to be browsing
                 hr = m_pIOPCBrowseSAS->ChangeBrowsePosition(
                     OPC_BROWSE_TO,
-                    A2W(sPosition.c_str()));
+                    conversion.ToWide(sPosition));
                 if (hr == E_FAIL) {
                     hr = OPC_E_UNKNOWNITEMID;              // Use the same error code like OPC 3.0 Servers
                 }
@@ -672,7 +671,7 @@ namespace Technosoftware
                 if (eGetBrowseElementFilter == DaBrowseElementFilter::Items) {
                     hr = m_pIOPCBrowseSAS->BrowseOPCItemIDs(
                         OPC_LEAF,
-                        A2W(m_Filters.GetElementNameFilter().c_str()),
+                        conversion.ToWide(m_Filters.GetElementNameFilter()),
                         m_Filters.GetDataTypeFilter(),
                         m_Filters.GetAccessRightsFilter(),
                         &pIEnumString);
@@ -892,6 +891,9 @@ namespace Technosoftware
             LPWSTR      pItemID = NULL;
             DWORD       dwAddedElements = 0;
 
+            OpcStringConversion filterConversion;
+            LPCWSTR     pszElementNameFilter = filterConversion.ToWide(m_Filters.GetElementNameFilter());
+
             try {
                 HRESULT hr = pIEnumString->Reset();       // Resets the enumeration sequence to the beginning 
                 while (hr == S_OK) {
@@ -899,7 +901,7 @@ namespace Technosoftware
                     hr = pIEnumString->Next(RECSIZE_NEXT, apOleStrings, &ulNum);
 
                     for (ul = 0; ul < ulNum; ul++) {
-                        USES_CONVERSION;
+                        OpcStringConversion conversion;
 
                         bool fAddThisElementElement = true;
 
@@ -911,7 +913,7 @@ namespace Technosoftware
                         if (fAddThisElementElement && m_Filters.GetElementNameFilter().length() > 0) {
                             fAddThisElementElement = MatchPattern(
                                 apOleStrings[ul],
-                                A2CW(m_Filters.GetElementNameFilter().c_str())
+                                pszElementNameFilter
                             ) ? true : false;
                         }
 
@@ -925,7 +927,7 @@ namespace Technosoftware
                                 if (res.IsNotGood()) throw res;
 
                                 try {
-                                    DaBrowseElement el(OLE2A(apOleStrings[ul]), OLE2A(pItemID), fIsItem, &Properties);
+                                    DaBrowseElement el(conversion.ToUtf8(apOleStrings[ul]), conversion.ToUtf8(pItemID), fIsItem, &Properties);
                                     ReleaseOPCITEMPROPERTIES(&Properties);
                                     m_Elements.push_back(el);
                                 }
@@ -944,7 +946,7 @@ namespace Technosoftware
                                 if (res.IsNotGood()) throw res;
 
                                 try {
-                                    DaBrowseElement el(OLE2A(apOleStrings[ul]), &Properties);
+                                    DaBrowseElement el(conversion.ToUtf8(apOleStrings[ul]), &Properties);
                                     ReleaseOPCITEMPROPERTIES(&Properties);
                                     m_Elements.push_back(el);
                                 }
@@ -57,8 +57,6 @@ namespace Technosoftware
 
             HRESULT hr = S_OK;
             try {
-                USES_CONVERSION;
-
                 ItemDef.vtRequestedDataType = requestedDataType;
                 ItemDef.hClient = clientHandle;
                 ItemDef.bActive = isActive;
@@ -66,11 +64,11 @@ namespace Technosoftware
                 ItemDef.wReserved = 0;
 
                 // SzItemID, szAccessPath and blob_
-                ItemDef.szItemID = _wcsdup(A2W(itemIdentifier));
+                ItemDef.szItemID = OpcStringConversion::DuplicateWide(itemIdentifier);
                 if (!ItemDef.szItemID) throw Technosoftware::Base::OutOfMemoryException();
 
                 if (accessPath) {
-                    ItemDef.szAccessPath = _wcsdup(A2W(accessPath));
+                    ItemDef.szAccessPath = OpcStringConversion::DuplicateWide(accessPath);
                     if (!ItemDef.szAccessPath) Technosoftware::Base::OutOfMemoryException();
                 }
 
@@ -0,0 +1,420 @@
+/*
+ * Copyright (c) 2011-2021 Technosoftware GmbH. All rights reserved
+ * Web: https://www.technosoftware.com
+ *
+ * The source code in this file is covered under a dual-license scenario:
+ *   - Owner of a purchased license: SCLA 1.0
+ *   - GPL V3: everybody else
+ *
+ * SCLA license terms accompanied with this source code.
+ * See SCLA 1.0: https://technosoftware.com/license/Source_Code_License_Agreement.pdf
+ *
+ * GNU General Public License as published by the Free Software Foundation;
+ * version 3 of the License are accompanied with this source code.
+ * See https://technosoftware.com/license/GPLv3License.txt
+ *
+ * This source code is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#include "OpcInternal.h"
+#include "DaAeHdaClient/Da/DaDataCapture.h"
+#include "DaAeHdaClient/Da/DaGroup.h"
+#include "DaGroupImpl.h"
+#include "DaAeHdaClient/Da/DaItem.h"
+
+#include "Base/Exception.h"
+#include "Base/FlatHashMap.h"
+#include "Base/Timestamp.h"
+
+
+namespace Technosoftware
+{
+    namespace DaAeHdaClient
+    {
+        //----------------------------------------------------------------------------------------------------------------------
+        // File layout
+        //    All fields are stored in the byte order of the recording machine. A record is built completely before
+        //    it is written so that a capture which was interrupted ends with a complete or a truncated last record.
+        //----------------------------------------------------------------------------------------------------------------------
+        static const uint32_t CaptureMagic = 0x50434144;     // "DACP"
+        static const uint32_t CaptureVersion = 2;            // 2: one-dimensional arrays of scalar values
+
+        struct DaCaptureFileHeader
+        {
+            uint32_t            magic;
+            uint32_t            version;
+            uint64_t            reserved;
+        };
+
+        struct DaCaptureRecordHeader
+        {
+            uint32_t            size;                       // Record size including this header
+            uint32_t            count;                      // Number of item entries
+            int64_t             captureTime;                // Epoch microseconds when the notification was received
+            uint32_t            transactionId;
+            uint32_t            groupClientHandle;
+            int32_t             masterQuality;
+            int32_t             masterError;
+        };
+
+        struct DaCaptureItemEntry
+        {
+            uint32_t            clientHandle;
+            uint16_t            quality;
+            uint16_t            dataType;
+            int32_t             error;
+            uint32_t            dataLength;                 // Number of bytes following the entry (strings, array elements)
+            uint64_t            timeStamp;                  // FILETIME
+            int64_t             value;                      // Payload of scalar values, lower bound of arrays
+        };
+
+        //----------------------------------------------------------------------------------------------------------------------
+        // GetScalarSize
+        //    The size of types whose value fits into the 8 byte payload of a VARIANT, 0 for all other types.
+        //----------------------------------------------------------------------------------------------------------------------
+        static inline uint32_t GetScalarSize(VARTYPE vt)
+        {
+            switch (vt) {
+            case VT_I1: case VT_UI1:
+                return 1;
+            case VT_I2: case VT_UI2: case VT_BOOL:
+                return 2;
+            case VT_I4: case VT_UI4: case VT_INT: case VT_UINT: case VT_R4: case VT_ERROR:
+                return 4;
+            case VT_I8: case VT_UI8: case VT_R8: case VT_CY: case VT_DATE:
+                return 8;
+            default:
+                return 0;
+            }
+        }
+
+
+        static inline bool IsScalarType(VARTYPE vt)
+        {
+            return GetScalarSize(vt) != 0;
+        }
+
+
+        //======================================================================================================================
+        // DaDataCaptureWriter
+        //======================================================================================================================
+
+        //----------------------------------------------------------------------------------------------------------------------
+        // Constructor
+        //----------------------------------------------------------------------------------------------------------------------
+        DaDataCaptureWriter::DaDataCaptureWriter(const char* fileName) noexcept(false)
+        {
+            if (!fileName) throw Technosoftware::Base::InvalidArgumentException();
+
+            file_ = NULL;
+            records_ = 0;
+            droppedValues_ = 0;
+            if (fopen_s(&file_, fileName, "wb") != 0 || !file_) {
+                throw Technosoftware::Base::CreateFileException(fileName);
+            }
+
+            DaCaptureFileHeader header;
+            header.magic = CaptureMagic;
+            header.version = CaptureVersion;
+            header.reserved = 0;
+            if (fwrite(&header, sizeof(header), 1, file_) != 1) {
+                fclose(file_);
+                throw Technosoftware::Base::WriteFileException(fileName);
+            }
+        }
+
+
+        //----------------------------------------------------------------------------------------------------------------------
+        // Destructor
+        //----------------------------------------------------------------------------------------------------------------------
+        DaDataCaptureWriter::~DaDataCaptureWriter() noexcept
+        {
+            if (file_) fclose(file_);
+        }
+
+
+        //----------------------------------------------------------------------------------------------------------------------
+        // Flush
+        //----------------------------------------------------------------------------------------------------------------------
+        void DaDataCaptureWriter::Flush() noexcept
+        {
+            Base::FastMutex::ScopedLock lock(mutex_);
+            fflush(file_);
+        }
+
+
+        //----------------------------------------------------------------------------------------------------------------------
+        // Write
+        //    Called by the data callback before the notification is dispatched. Items are recorded with the client
+        //    handles of the user; items which have already been removed are skipped. The item table is only locked
+        //    while the record is built, not while it is written to the file. Values passed by reference are recorded
+        //    as the referenced value; values which cannot be recorded are stored as VT_EMPTY and counted.
+        //----------------------------------------------------------------------------------------------------------------------
+        void DaDataCaptureWriter::Write(DWORD transactionId, Base::ClientHandle groupClientHandle, HRESULT masterQuality, HRESULT masterError,
+            DWORD count, OPCHANDLE* clientItems, VARIANT* values, WORD* qualities, FILETIME* timeStamps, HRESULT* errors) noexcept
+        {
+            Base::FastMutex::ScopedLock lock(mutex_);
+
+            try {
+                // The header is filled in once the size is known; segments of the buffer never move.
+                record_.Clear();
+                char* recordHeader = record_.Reserve(sizeof(DaCaptureRecordHeader));
+                record_.Commit(sizeof(DaCaptureRecordHeader));
+                uint32_t recorded = 0;
+
+                {
+                    Base::RWLock::ScopedReadLock tableLock(g_HandleTableLock);
+                    for (DWORD i = 0; i < count; i++) {
+                        auto result = m_cItems.find(clientItems[i]);
+                        if (result == m_cItems.end()) continue;
+
+                        DaCaptureItemEntry entry;
+                        entry.clientHandle = result->second->GetClientHandle();
+                        entry.quality = qualities[i];
+                        entry.error = errors[i];
+                        entry.timeStamp = ((uint64_t)timeStamps[i].dwHighDateTime << 32) | timeStamps[i].dwLowDateTime;
+                        entry.dataLength = 0;
+                        entry.value = 0;
+
+                        CComVariant indirect;
+                        const VARIANT* pValue = &values[i];
+                        if ((pValue->vt & VT_BYREF) && SUCCEEDED(VariantCopyInd(&indirect, pValue))) {
+                            pValue = &indirect;
+                        }
+
+                        const VARIANT& value = *pValue;
+                        void* data = NULL;
+                        SAFEARRAY* accessedArray = NULL;
+                        if (IsScalarType(value.vt)) {
+                            entry.dataType = value.vt;
+                            memcpy(&entry.value, &value.llVal, GetScalarSize(value.vt));     // Keep the unused bytes 0
+                        }
+                        else if (value.vt == VT_BSTR) {
+                            entry.dataType = VT_BSTR;
+                            entry.dataLength = value.bstrVal ? SysStringByteLen(value.bstrVal) : 0;
+                            data = value.bstrVal;
+                        }
+                        else if ((value.vt & ~VT_TYPEMASK) == VT_ARRAY && IsScalarType(value.vt & VT_TYPEMASK) &&
+                                 value.parray && SafeArrayGetDim(value.parray) == 1 &&
+                                 SUCCEEDED(SafeArrayAccessData(value.parray, &data))) {
+                            accessedArray = value.parray;
+                            LONG lowerBound = 0;
+                            LONG upperBound = -1;
+                            SafeArrayGetLBound(value.parray, 1, &lowerBound);
+                            SafeArrayGetUBound(value.parray, 1, &upperBound);
+                            entry.dataType = value.vt;
+                            entry.value = lowerBound;
+                            entry.dataLength = (uint32_t)(upperBound - lowerBound + 1) * GetScalarSize(value.vt & VT_TYPEMASK);
+                        }
+                        else {
+                            entry.dataType = VT_EMPTY;
+                            if (value.vt != VT_EMPTY) droppedValues_++;
+                        }
+
+                        try {
+                            record_.Append(&entry, sizeof(entry));
+                            if (entry.dataLength) {
+                                record_.Append(data, entry.dataLength);
+                            }
+                        }
+                        catch (...) {
+                            if (accessedArray) SafeArrayUnaccessData(accessedArray);
+                            throw;
+                        }
+                        if (accessedArray) SafeArrayUnaccessData(accessedArray);
+                        recorded++;
+                    }
+                }
+
+                DaCaptureRecordHeader header;
+                header.size = (uint32_t)record_.Size();
+                header.count = recorded;
+                header.captureTime = Base::Timestamp().GetEpochMicroseconds();
+                header.transactionId = transactionId;
+                header.groupClientHandle = groupClientHandle;
+                header.masterQuality = masterQuality;
+                header.masterError = masterError;
+                memcpy(recordHeader, &header, sizeof(header));
+
+                FILE* file = file_;
+                if (record_.ForEachSegment([file](const char* data, size_t length) { return fwrite(data, length, 1, file) == 1; })) {
+                    records_++;
+                }
+            }
+            catch (...) {}                                   // Never disturb the dispatch of the notification
+        }
+
+
+        //======================================================================================================================
+        // DaDataCaptureReplayer
+        //======================================================================================================================
+
+        //----------------------------------------------------------------------------------------------------------------------
+        // Constructor
+        //----------------------------------------------------------------------------------------------------------------------
+        DaDataCaptureReplayer::DaDataCaptureReplayer(const char* fileName) noexcept(false)
+        {
+            if (!fileName) throw Technosoftware::Base::InvalidArgumentException();
+
+            file_ = NULL;
+            if (fopen_s(&file_, fileName, "rb") != 0 || !file_) {
+                throw Technosoftware::Base::OpenFileException(fileName);
+            }
+
+            DaCaptureFileHeader header;
+            if (fread(&header, sizeof(header), 1, file_) != 1 || header.magic != CaptureMagic ||
+                header.version == 0 || header.version > CaptureVersion) {
+                fclose(file_);
+                throw Technosoftware::Base::DataFormatException(fileName);
+            }
+        }
+
+
+        //----------------------------------------------------------------------------------------------------------------------
+        // Destructor
+        //----------------------------------------------------------------------------------------------------------------------
+        DaDataCaptureReplayer::~DaDataCaptureReplayer() noexcept
+        {
+            if (file_) fclose(file_);
+        }
+
+
+        //----------------------------------------------------------------------------------------------------------------------
+        // Replay
+        //    The records are converted back to the arrays of IOPCDataCallback::OnDataChange() and passed to the data
+        //    callback object of the group, with the internal item handles of the group instead of the recorded
+        //    client handles.
+        //----------------------------------------------------------------------------------------------------------------------
+        Base::Status DaDataCaptureReplayer::Replay(DaGroup* group, bool realTime, uint64_t* replayedRecords)
+        {
+            if (replayedRecords) *replayedRecords = 0;
+            if (!group) return Technosoftware::DaAeHdaClient::GetStatusFromHResult(E_INVALIDARG);
+
+            DaGroupImpl* pImpl = group->impl_;
+            if (!pImpl->m_pDataCallbackRef) return Technosoftware::DaAeHdaClient::GetStatusFromHResult(CONNECT_E_NOCONNECTION);
+
+            // Client handle -> internal handle of the items of the group
+            Base::FlatHashMap<Base::ClientHandle, OPCHANDLE> cHandles;
+            {
+                Base::RWLock::ScopedReadLock lock(g_HandleTableLock);
+                for (auto& entry : m_cItems) {
+                    DaItem* pItem = entry.second;
+                    if (pItem->parent_ != pImpl) continue;
+                    cHandles[pItem->GetClientHandle()] = (OPCHANDLE)pItem->internalClientHandle_;
+                }
+            }
+
+            if (fseek(file_, sizeof(DaCaptureFileHeader), SEEK_SET) != 0) {
+                return Technosoftware::DaAeHdaClient::GetStatusFromHResult(E_FAIL);
+            }
+
+            vector<unsigned char>   record;
+            vector<OPCHANDLE>       clientItems;
+            vector<VARIANT>         values;
+            vector<WORD>            qualities;
+            vector<FILETIME>        timeStamps;
+            vector<HRESULT>         errors;
+
+            Base::Timestamp         start;
+            int64_t                 firstCaptureTime = 0;
+            uint64_t                replayed = 0;
+            HRESULT                 hr = S_OK;
+
+            for (;;) {
+                DaCaptureRecordHeader header;
+                if (fread(&header, sizeof(header), 1, file_) != 1) break;          // End of capture
+                if (header.size < sizeof(header)) { hr = E_FAIL; break; }
+
+                record.resize(header.size - sizeof(header));
+                if (!record.empty() && fread(&record[0], record.size(), 1, file_) != 1) break;  // Truncated last record
+
+                clientItems.clear();
+                values.clear();
+                qualities.clear();
+                timeStamps.clear();
+                errors.clear();
+
+                size_t offset = 0;
+                for (uint32_t i = 0; i < header.count; i++) {
+                    DaCaptureItemEntry entry;
+                    if (offset + sizeof(entry) > record.size()) { hr = E_FAIL; break; }
+                    memcpy(&entry, &record[offset], sizeof(entry));
+                    offset += sizeof(entry);
+                    if (offset + entry.dataLength > record.size()) { hr = E_FAIL; break; }
+
+                    auto result = cHandles.find(entry.clientHandle);
+                    if (result != cHandles.end()) {
+                        VARIANT value;
+                        VariantInit(&value);
+                        if (entry.dataType == VT_BSTR) {
+                            value.vt = VT_BSTR;
+                            value.bstrVal = SysAllocStringLen(reinterpret_cast<const OLECHAR*>(entry.dataLength ? &record[offset] : NULL),
+                                entry.dataLength / sizeof(OLECHAR));
+                        }
+                        else if (entry.dataType & VT_ARRAY) {
+                            uint32_t elementSize = GetScalarSize(entry.dataType & VT_TYPEMASK);
+                            ULONG elements = elementSize ? entry.dataLength / elementSize : 0;
+                            SAFEARRAY* array = elementSize ? SafeArrayCreateVector(entry.dataType & VT_TYPEMASK, (LONG)entry.value, elements) : NULL;
+                            if (array) {
+                                if (elements) memcpy(array->pvData, &record[offset], elements * elementSize);
+                                value.vt = entry.dataType;
+                                value.parray = array;
+                            }
+                        }
+                        else if (entry.dataType != VT_EMPTY) {
+                            value.vt = entry.dataType;
+                            value.llVal = entry.value;
+                        }
+
+                        FILETIME ft;
+                        ft.dwLowDateTime = (DWORD)entry.timeStamp;
+                        ft.dwHighDateTime = (DWORD)(entry.timeStamp >> 32);
+
+                        clientItems.push_back(result->second);
+                        values.push_back(value);
+                        qualities.push_back(entry.quality);
+                        timeStamps.push_back(ft);
+                        errors.push_back(entry.error);
+                    }
+                    offset += entry.dataLength;
+                }
+
+                if (SUCCEEDED(hr) && !clientItems.empty()) {
+                    if (realTime) {
+                        if (replayed == 0) {
+                            firstCaptureTime = header.captureTime;
+                            start.Update();
+                        }
+                        Base::Timestamp::TimeDiff wait = (header.captureTime - firstCaptureTime) - (Base::Timestamp() - start);
+                        if (wait > 0) {
+                            ::Sleep((DWORD)(wait / 1000));
+                        }
+                    }
+
+                    pImpl->m_pDataCallbackRef->OnDataChange(
+                        header.transactionId,
+                        pImpl->m_hGroup,
+                        header.masterQuality,
+                        header.masterError,
+                        (DWORD)clientItems.size(),
+                        clientItems.data(),
+                        values.data(),
+                        qualities.data(),
+                        timeStamps.data(),
+                        errors.data());
+                    replayed++;
+                }
+
+                for (auto& value : values) {
+                    VariantClear(&value);
+                }
+                if (FAILED(hr)) break;
+            }
+
+            if (replayedRecords) *replayedRecords = replayed;
+            return Technosoftware::DaAeHdaClient::GetStatusFromHResult(hr);
+        }
+    }
+}
@@ -27,7 +27,10 @@
 #include "DaAeHdaClient/Da/DaServer.h"
 #include "DaServerImpl.h"
 #include "DaAeHdaClient/Da/DaItem.h"
+#include "DaAeHdaClient/Da/DaValueHistory.h"
+#include "DaAeHdaClient/Da/DaDataCapture.h"
 
+#include "Base/Buffer.h"
 #include "Base/Exception.h"
 
 
@@ -35,6 +38,41 @@ namespace Technosoftware
 {
     namespace DaAeHdaClient
     {
+        Base::FlatHashMap<Base::ServerHandle, DaItem*> m_cItems;
+        unsigned long g_uItemCount = 0;
+
+        Base::FlatHashMap<Base::ServerHandle, DaGroup*> m_cGroups;
+        unsigned long g_uGroupCount = 0;
+
+        Base::RWLock g_HandleTableLock;
+        std::atomic<unsigned long> g_uCallbacksInProgress(0);
+
+        // Counts a data callback in g_uCallbacksInProgress for the lifetime of the object.
+        class CallbackInProgress
+        {
+        public:
+            CallbackInProgress() { g_uCallbacksInProgress.fetch_add(1); }
+            ~CallbackInProgress() { g_uCallbacksInProgress.fetch_sub(1); }
+        };
+
+        //----------------------------------------------------------------------------------------------------------------------
+        // FindItem
+        //    Lookup outside of the callbacks; the lock is released before the caller may delete the item.
+        //----------------------------------------------------------------------------------------------------------------------
+        static DaItem* FindItem(OPCHANDLE hItem)
+        {
+            Base::RWLock::ScopedReadLock lock(g_HandleTableLock);
+            auto result = m_cItems.find(hItem);
+            return result != m_cItems.end() ? result->second : NULL;
+        }
+
+        // Scratch arrays of the batch calls. Batches of up to BatchInlineItems items use storage on the stack,
+        // the arrays start at a cache line.
+        static const size_t BatchInlineItems = 128;
+        static const size_t BatchAlignment = 64;
+        typedef Base::Buffer<OPCHANDLE, BatchAlignment, BatchInlineItems>   ServerHandleBuffer;
+        typedef Base::Buffer<VARIANT, BatchAlignment, BatchInlineItems>     ValueBuffer;
+
         DaGroup::DaGroup(DaServer*  parent,
             const char*             name,
             bool                    active,
@@ -94,6 +132,8 @@ namespace Technosoftware
             return impl_->AddItems(itemDefinitions, items, errorHandler);
         }
 
+        Base::Status DaGroup::RemoveItems(vector<DaItem*>& items) { return impl_->RemoveItems(items); }
+
         Base::Status DaGroup::Read(vector<DaItem*>& items, bool fromCache) { return impl_->Read(items, fromCache); }
 
         Base::Status DaGroup::Write(vector<DaItem*>& items) { return impl_->Write(items); }
@@ -110,6 +150,12 @@ namespace Technosoftware
 
         Base::Status DaGroup::Refresh(uint32_t transactionId, uint32_t* cancelId, bool fromCache) { return Technosoftware::DaAeHdaClient::GetStatusFromHResult(impl_->Refresh(transactionId, cancelId, fromCache)); }
 
+        Base::Status DaGroup::SetValueHistory(uint32_t depth, uint32_t maxItems) { return impl_->SetValueHistory(depth, maxItems); }
+
+        DaValueHistory* DaGroup::GetValueHistory() const noexcept { return impl_->m_pValueHistory; }
+
+        Base::Status DaGroup::SetDataCapture(DaDataCaptureWriter* dataCapture) { return impl_->SetDataCapture(dataCapture); }
+
 
         //----------------------------------------------------------------------------------------------------------------------
         // IMPLEMENTATION CLASS DaGroupImpl
@@ -165,16 +211,22 @@ namespace Technosoftware
             if (!m_pIOPCServer) throw Technosoftware::Base::StatusException(Technosoftware::DaAeHdaClient::GetStatusFromHResult(E_NOINTERFACE,Base::StatusCode::DaFuncCall));
 
             // Group Name
-            USES_CONVERSION;
+            OpcStringConversion conversion;
             LPWSTR pwszName = L"";
-            if (pszName) pwszName = A2W(pszName);
+            if (pszName) pwszName = conversion.ToWide(pszName);
+
+            // Reserve the client group handle
+            {
+                Base::RWLock::ScopedWriteLock lock(g_HandleTableLock);
+                m_hGroup = g_uGroupCount++;
+            }
 
             // Add the Group
             HRESULT hr = m_pIOPCServer->AddGroup(
                 pwszName,                     // Group Name
                 fActive,                      // Active State
                 dwRequestedUpdateRate,        // Requested Update Rate
-                g_uGroupCount,                  // Client Group Handle
+                m_hGroup,                     // Client Group Handle
                 pTimeBias,                    // TimeBias
                 pPercentDeadband,             // Percent Deadband
                 dwLCID,                       // The Locale ID (language)
@@ -186,8 +238,10 @@ namespace Technosoftware
 
             if (FAILED(hr)) throw Technosoftware::Base::StatusException(Technosoftware::DaAeHdaClient::GetStatusFromHResult(hr,Base::StatusCode::DaFuncCall));
 
-            m_hGroup = g_uGroupCount;
-            m_cGroups[g_uGroupCount++] = pImplOwner;
+            {
+                Base::RWLock::ScopedWriteLock lock(g_HandleTableLock);
+                m_cGroups[m_hGroup] = pImplOwner;
+            }
 
             m_pIOPCItemMgt = m_pIOPCGroupStateMgt;
             if (!m_pIOPCItemMgt) throw Technosoftware::Base::StatusException(Technosoftware::DaAeHdaClient::GetStatusFromHResult(E_NOINTERFACE,Base::StatusCode::DaFuncCall));
@@ -203,6 +257,8 @@ namespace Technosoftware
             m_pDataCallbackRef = NULL;
             m_fEnabled = false;                          // Subscription State
             m_fActive = fActive;                         // Group State
+            m_pValueHistory = NULL;
+            m_pDataCapture = NULL;
         }
 
 
@@ -220,7 +276,13 @@ namespace Technosoftware
         {
             try {
                 SetDataSubscription(NULL);
+                if (m_pValueHistory) {
+                    DeleteAllChildren();                     // Items release their history slots
+                    delete m_pValueHistory;
+                    m_pValueHistory = NULL;
+                }
                 m_pIOPCServer->RemoveGroup(m_hServerGroup, FALSE);
+                Base::RWLock::ScopedWriteLock lock(g_HandleTableLock);
                 m_cGroups.erase(m_hGroup);
             }
             catch (...) {}
@@ -281,6 +343,7 @@ namespace Technosoftware
                     pItem = new DaItem(this, *pHandle);
                     if (!pItem) throw Technosoftware::Base::OutOfMemoryException();
                     arItems.push_back(pItem);
+                    Base::RWLock::ScopedWriteLock lock(g_HandleTableLock);
                     *pHandle = (OPCHANDLE)g_uItemCount;
                     pItem->internalClientHandle_ = g_uItemCount;
                     m_cItems[g_uItemCount++] = pItem;
@@ -297,27 +360,25 @@ namespace Technosoftware
 
                 for (i = 0; i < dwCount; i++) {
                     // Restore the client item handles
-                    auto result = m_cItems.find(ItemDefs.parItemDefs_->m_aT[i].hClient);
-                    if (result == m_cItems.end()) {
+                    pItem = FindItem(ItemDefs.parItemDefs_->m_aT[i].hClient);
+                    if (!pItem) {
                         cout << "Element not found." << endl;
                         continue;
                     }
 
-                    pItem = result->second;
-
                     //pItem = (DaItem*)ItemDefs.parItemDefs_->m_aT[i].clientHandle_;
                     ItemDefs.parItemDefs_->m_aT[i].hClient = pItem->clientHandle_;
 
                     if (FAILED(pErrors[i])) {
                         if (pfnErrHandler) {
-                            USES_CONVERSION;
+                            OpcStringConversion conversion;
                             OPCITEMDEF*    pItemDef = &(*ItemDefs.parItemDefs_)[i];
                             DaItemDefinition   def;
-                            def.ItemIdentifier = W2A(pItemDef->szItemID);
+                            def.ItemIdentifier = conversion.ToUtf8(pItemDef->szItemID);
                             def.ClientHandle = pItem->clientHandle_;
                             def.RequestedDataType = pItemDef->vtRequestedDataType;
                             def.IsActive = pItemDef->bActive == TRUE ? true : false;
-                            def.AccessPath = W2A(pItemDef->szAccessPath);
+                            def.AccessPath = conversion.ToUtf8(pItemDef->szAccessPath);
                             def.BlobSize = pItemDef->dwBlobSize;
                             def.Blob = pItemDef->pBlob;
                             pfnErrHandler(def, Technosoftware::DaAeHdaClient::GetStatusFromHResult(pErrors[i]));
@@ -330,6 +391,9 @@ namespace Technosoftware
                     }
                     else {
                         pItem->FinalConstruct(&pItemResults[i]);
+                        if (m_pValueHistory) {
+                            pItem->valueHistorySlot_ = m_pValueHistory->AllocateSlot();
+                        }
 
                         // Blob is not yet supported by this version so the memory can be alraedy released here.
                         // Move this section of code if Blob is supported in future versions.
@@ -353,13 +417,11 @@ namespace Technosoftware
             // elements which could not be added successfully to the server.
             if (res.IsNotGood()) {
                 for (i = 0; i < dwCreatedItemInstancesCount; i++) {
-                    auto result = m_cItems.find(ItemDefs.parItemDefs_->m_aT[i].hClient);
-                    if (result == m_cItems.end()) {
+                    pItem = FindItem(ItemDefs.parItemDefs_->m_aT[i].hClient);
+                    if (!pItem) {
                         cout << "Element not found." << endl;
                         continue;
                     }
-
-                    pItem = result->second;
                     ItemDefs.parItemDefs_->m_aT[i].hClient = pItem->clientHandle_;
                     delete pItem;
                 }
@@ -369,6 +431,61 @@ namespace Technosoftware
         }
 
 
+        //----------------------------------------------------------------------------------------------------------------------
+        // RemoveItems
+        //----------------------------------------------------------------------------------------------------------------------
+        Technosoftware::Base::Status DaGroupImpl::RemoveItems(vector<DaItem*>& arItems)
+        {
+            Technosoftware::Base::Status res;
+
+            try {
+                DWORD          i;
+                DWORD          dwCount = arItems.size();
+                HRESULT*       pErrors = NULL;
+
+                if (dwCount == 0)  throw Technosoftware::DaAeHdaClient::GetStatusFromHResult(S_FALSE);
+
+                ServerHandleBuffer serverHandles(dwCount);
+                OPCHANDLE* phServer = serverHandles.Begin();
+
+                for (i = 0; i < dwCount; i++) {
+                    phServer[i] = arItems[i]->GetServerHandle();
+                }
+
+                HRESULT hr = m_pIOPCItemMgt->RemoveItems(dwCount, phServer, &pErrors);
+
+                res = Technosoftware::DaAeHdaClient::GetStatusFromHResult(hr,Base::StatusCode::DaFuncCall);
+                if (FAILED(hr)) throw res;
+
+                // Delete the local instances of all removed items and keep the others in the list.
+                // The item destructor also removes the internal client handle from the lookup table
+                // so that late notifications for these items are ignored by the data callback.
+                vector<DaItem*> arNotRemoved;
+                for (i = 0; i < dwCount; i++) {
+                    if (FAILED(pErrors[i])) {
+                        arNotRemoved.push_back(arItems[i]);
+                    }
+                    else {
+                        delete arItems[i];
+                    }
+                }
+                arItems.swap(arNotRemoved);
+                m_pIMalloc->Free(pErrors);
+            }
+            catch (HRESULT hr) {
+                res = Technosoftware::DaAeHdaClient::GetStatusFromHResult(hr);
+            }
+            catch (Technosoftware::Base::Status& resEx) {
+                res = resEx;
+            }
+            catch (...) {
+                res = Technosoftware::DaAeHdaClient::GetStatusFromHResult(E_FAIL);
+            }
+
+            return res;
+        }
+
+
         //----------------------------------------------------------------------------------------------------------------------
         // CODE CComOPCDataCallbackImpl
         //----------------------------------------------------------------------------------------------------------------------
@@ -376,6 +493,7 @@ namespace Technosoftware
         CComOPCDataCallbackImpl::CComOPCDataCallbackImpl()
         {
             m_pIUserDataCallback = NULL;
+            m_pDataCapture = NULL;
         }
 
 
@@ -386,6 +504,18 @@ namespace Technosoftware
         }
 
 
+        //----------------------------------------------------------------------------------------------------------------------
+        // SetDataCapture
+        //    The lock is taken by OnDataChange() across the write, so the previous writer is no longer used once this
+        //    function returns and may be destroyed by the caller.
+        //----------------------------------------------------------------------------------------------------------------------
+        void CComOPCDataCallbackImpl::SetDataCapture(DaDataCaptureWriter* pDataCapture)
+        {
+            Base::FastMutex::ScopedLock lock(m_DataCaptureLock);
+            m_pDataCapture.store(pDataCapture);
+        }
+
+
         CComOPCDataCallbackImpl::~CComOPCDataCallbackImpl()
         {
         }
@@ -408,37 +538,51 @@ namespace Technosoftware
             /* [size_is][in] */  FILETIME*   pftTimeStamps,
             /* [size_is][in] */  HRESULT*    pErrors)
         {
+            CallbackInProgress inProgress;
             DaItem*  pItem;
             DWORD       i;
 
-            std::vector<DaItem*> items = std::vector<DaItem*>(dwCount);
-
-            //OpcArray<DaItem*> items = OpcArray<DaItem*>(dwCount);
+            std::vector<DaItem*> items;
+            items.reserve(dwCount);
 
-            for (i = 0; i < dwCount; i++) {
-                auto result = m_cItems.find(phClientItems[i]);
-                if (result != m_cItems.end()) {
+            DaGroup* pGroup = NULL;
+            {
+                Base::RWLock::ScopedReadLock lock(g_HandleTableLock);
+                for (i = 0; i < dwCount; i++) {
+                    auto result = m_cItems.find(phClientItems[i]);
+                    if (result == m_cItems.end()) {
+                        continue;                        // Item already removed; late notification
+                    }
                     pItem = result->second;
+                    items.push_back(pItem);
+                    if (!pItem->GetReadAsyncResult().Set(
+                        &pvValues[i],
+                        &pftTimeStamps[i], pwQualities[i], Technosoftware::DaAeHdaClient::GetStatusFromHResult(pErrors[i],Base::StatusCode::DaFuncCall)))
+                    {
+                        hrMastererror = S_FALSE;
+                    }
+                    if (pItem->valueHistorySlot_ != DaValueHistory::NoSlot && SUCCEEDED(pErrors[i])) {
+                        pItem->parent_->m_pValueHistory->Record(pItem->valueHistorySlot_, &pvValues[i], &pftTimeStamps[i], pwQualities[i]);
+                    }
+                }
+
+                auto result = m_cGroups.find(hGroup);
+                if (result != m_cGroups.end()) {
+                    pGroup = result->second;
                 }
                 else {
                     cout << "Element not found." << endl;
                 }
-                items[i] = pItem;
-                if (!pItem->GetReadAsyncResult().Set(
-                    &pvValues[i],
-                    &pftTimeStamps[i], pwQualities[i], Technosoftware::DaAeHdaClient::GetStatusFromHResult(pErrors[i],Base::StatusCode::DaFuncCall)))
-                {
-                    hrMastererror = S_FALSE;
-                }
             }
 
-            DaGroup* pGroup;
-            auto result = m_cGroups.find(hGroup);
-            if (result != m_cGroups.end()) {
-                pGroup = result->second;
-            }
-            else {
-                cout << "Element not found." << endl;
+            // The writer locks the item table itself while it builds the record, but not while it writes the file
+            if (m_pDataCapture.load() && pGroup) {
+                Base::FastMutex::ScopedLock captureLock(m_DataCaptureLock);
+                DaDataCaptureWriter* pDataCapture = m_pDataCapture.load();
+                if (pDataCapture) {
+                    pDataCapture->Write(dwTransid, pGroup->GetClientHandle(), hrMasterquality, hrMastererror,
+                        dwCount, phClientItems, pvValues, pwQualities, pftTimeStamps, pErrors);
+                }
             }
 
             m_pIUserDataCallback->DataChange(
@@ -446,7 +590,7 @@ namespace Technosoftware
                 pGroup,
                 (hrMasterquality == S_OK) ? true : false,
                 (hrMastererror == S_OK) ? true : false,
-                dwCount,
+                (uint32_t)items.size(),
                 (DaItem**)items.data()
             );
             items.clear();
@@ -471,35 +615,37 @@ namespace Technosoftware
             /* [size_is][in] */  FILETIME*   pftTimeStamps,
             /* [size_is][in] */  HRESULT*    pErrors)
         {
+            CallbackInProgress inProgress;
             DaItem*  pItem;
             DWORD       i;
 
-            std::vector<DaItem*> items = std::vector<DaItem*>(dwCount);
-            //OpcArray<DaItem*> items = OpcArray<DaItem*>(dwCount);
+            std::vector<DaItem*> items;
+            items.reserve(dwCount);
 
-            for (i = 0; i < dwCount; i++) {
-                auto result = m_cItems.find(phClientItems[i]);
-                if (result != m_cItems.end()) {
+            DaGroup* pGroup = NULL;
+            {
+                Base::RWLock::ScopedReadLock lock(g_HandleTableLock);
+                for (i = 0; i < dwCount; i++) {
+                    auto result = m_cItems.find(phClientItems[i]);
+                    if (result == m_cItems.end()) {
+                        continue;                        // Item already removed; late notification
+                    }
                     pItem = result->second;
+                    items.push_back(pItem);
+                    if (!pItem->GetReadAsyncResult().Set(
+                        &pvValues[i],
+                        &pftTimeStamps[i], pwQualities[i], Technosoftware::DaAeHdaClient::GetStatusFromHResult(pErrors[i],Base::StatusCode::DaFuncCall))) {
+                        hrMastererror = S_FALSE;
+                    }
+                }
+
+                auto result = m_cGroups.find(hGroup);
+                if (result != m_cGroups.end()) {
+                    pGroup = result->second;
                 }
                 else {
                     cout << "Element not found." << endl;
                 }
-                items[i] = pItem;
-                if (!pItem->GetReadAsyncResult().Set(
-                    &pvValues[i],
-                    &pftTimeStamps[i], pwQualities[i], Technosoftware::DaAeHdaClient::GetStatusFromHResult(pErrors[i],Base::StatusCode::DaFuncCall))) {
-                    hrMastererror = S_FALSE;
-                }
-            }
-
-            DaGroup* pGroup;
-            auto result = m_cGroups.find(hGroup);
-            if (result != m_cGroups.end()) {
-                pGroup = result->second;
-            }
-            else {
-                cout << "Element not found." << endl;
             }
 
             m_pIUserDataCallback->ReadComplete(
@@ -507,7 +653,7 @@ namespace Technosoftware
                 pGroup,
                 (hrMasterquality == S_OK) ? true : false,
                 (hrMastererror == S_OK) ? true : false,
-                dwCount,
+                (uint32_t)items.size(),
                 (DaItem**)items.data()
             );
             items.clear();
@@ -528,39 +674,41 @@ namespace Technosoftware
             /* [size_is][in] */  OPCHANDLE*  phClientItems,
             /* [size_is][in] */  HRESULT*    pErrors)
         {
+            CallbackInProgress inProgress;
             DaItem*  pItem;
             DWORD       i;
 
-            std::vector<DaItem*> items = std::vector<DaItem*>(dwCount);
-            //OpcArray<DaItem*> items = OpcArray<DaItem*>(dwCount);
+            std::vector<DaItem*> items;
+            items.reserve(dwCount);
 
-            for (i = 0; i < dwCount; i++) {
-                auto result = m_cItems.find(phClientItems[i]);
-                if (result != m_cItems.end()) {
+            DaGroup* pGroup = NULL;
+            {
+                Base::RWLock::ScopedReadLock lock(g_HandleTableLock);
+                for (i = 0; i < dwCount; i++) {
+                    auto result = m_cItems.find(phClientItems[i]);
+                    if (result == m_cItems.end()) {
+                        continue;                        // Item already removed; late notification
+                    }
                     pItem = result->second;
+                    items.push_back(pItem);
+                    //pItem = (DaItem*)(phClientItems[i]);
+                    pItem->GetWriteAsyncResult().Set(Technosoftware::DaAeHdaClient::GetStatusFromHResult(pErrors[i],Base::StatusCode::DaFuncCall));
+                }
+
+                auto result = m_cGroups.find(hGroup);
+                if (result != m_cGroups.end()) {
+                    pGroup = result->second;
                 }
                 else {
                     cout << "Element not found." << endl;
                 }
-                items[i] = pItem;
-                //pItem = (DaItem*)(phClientItems[i]);
-                pItem->GetWriteAsyncResult().Set(Technosoftware::DaAeHdaClient::GetStatusFromHResult(pErrors[i],Base::StatusCode::DaFuncCall));
-        }
-
-            DaGroup* pGroup;
-            auto result = m_cGroups.find(hGroup);
-            if (result != m_cGroups.end()) {
-                pGroup = result->second;
-            }
-            else {
-                cout << "Element not found." << endl;
             }
 
             m_pIUserDataCallback->WriteComplete(
                 dwTransid,
                 pGroup,
                 (hrMastererr == S_OK) ? true : false,
-                dwCount,
+                (uint32_t)items.size(),
                 (DaItem**)items.data()
             );
             items.clear();
@@ -577,13 +725,17 @@ namespace Technosoftware
             /* [in] */           DWORD       dwTransid,
             /* [in] */           OPCHANDLE   hGroup)
         {
-            DaGroup* pGroup;
-            auto result = m_cGroups.find(hGroup);
-            if (result != m_cGroups.end()) {
-                pGroup = result->second;
-            }
-            else {
-                cout << "Element not found." << endl;
+            CallbackInProgress inProgress;
+            DaGroup* pGroup = NULL;
+            {
+                Base::RWLock::ScopedReadLock lock(g_HandleTableLock);
+                auto result = m_cGroups.find(hGroup);
+                if (result != m_cGroups.end()) {
+                    pGroup = result->second;
+                }
+                else {
+                    cout << "Element not found." << endl;
+                }
             }
 
             m_pIUserDataCallback->CancelComplete(dwTransid, pGroup);
@@ -596,7 +748,6 @@ namespace Technosoftware
         //----------------------------------------------------------------------------------------------------------------------
         Technosoftware::Base::Status DaGroupImpl::Read(vector<DaItem*>& arItems, bool fFromCache)
         {
-            OPCHANDLE*  phServer = NULL;
             Technosoftware::Base::Status res;
 
             try {
@@ -605,8 +756,8 @@ namespace Technosoftware
                 HRESULT*       pErrors = NULL;
                 OPCITEMSTATE*  pItemState = NULL;
 
-                phServer = new OPCHANDLE[dwCount];
-                if (!phServer) throw Technosoftware::Base::OutOfMemoryException();
+                ServerHandleBuffer serverHandles(dwCount);
+                OPCHANDLE* phServer = serverHandles.Begin();
 
                 for (i = 0; i < dwCount; i++) {
                     phServer[i] = arItems[i]->GetServerHandle();
@@ -638,8 +789,6 @@ namespace Technosoftware
                 res = Technosoftware::DaAeHdaClient::GetStatusFromHResult(E_FAIL);
             }
 
-            if (phServer) delete[] phServer;
-
             return res;
         }
 
@@ -649,8 +798,6 @@ namespace Technosoftware
         //----------------------------------------------------------------------------------------------------------------------
         Technosoftware::Base::Status DaGroupImpl::Write(vector<DaItem*>& arItems)
         {
-            LPVARIANT   pValues = NULL;
-            OPCHANDLE*  phServer = NULL;
             Technosoftware::Base::Status res;
 
             try {
@@ -659,11 +806,11 @@ namespace Technosoftware
                 HRESULT* pErrors = NULL;
 
                 // Create an array with shallow copies of the values to be written.
-                pValues = new VARIANT[dwCount];
-                if (!pValues) throw Technosoftware::Base::OutOfMemoryException();
+                ValueBuffer values(dwCount);
+                LPVARIANT pValues = values.Begin();
 
-                phServer = new OPCHANDLE[dwCount];
-                if (!phServer) throw Technosoftware::Base::OutOfMemoryException();
+                ServerHandleBuffer serverHandles(dwCount);
+                OPCHANDLE* phServer = serverHandles.Begin();
 
                 for (i = 0; i < dwCount; i++) {
                     memcpy(&pValues[i], &arItems[i]->writeValue_, sizeof(VARIANT));    // Shallow Copy
@@ -694,9 +841,6 @@ namespace Technosoftware
                 res = Technosoftware::DaAeHdaClient::GetStatusFromHResult(E_FAIL);
             }
 
-            if (pValues) delete[] pValues;
-            if (phServer) delete[] phServer;
-
             return res;
         }
 
@@ -714,6 +858,7 @@ namespace Technosoftware
             if (pIUserDataCallback == NULL) {
                 if (m_ICP) {
                     if (m_dwDataCallbackCookie) {
+                        m_pDataCallbackRef->SetDataCapture(NULL);   // The server may still hold the callback object
                         hr = m_ICP->Unadvise(m_dwDataCallbackCookie);
                         m_dwDataCallbackCookie = 0;
                         m_pDataCallbackRef = NULL;
@@ -738,6 +883,7 @@ namespace Technosoftware
                 m_pDataCallbackRef = new (std::nothrow) CComObjectOPCDataCallback;
                 if (!m_pDataCallbackRef) throw Technosoftware::Base::OutOfMemoryException();
                 m_pDataCallbackRef->Create(pIUserDataCallback);
+                m_pDataCallbackRef->SetDataCapture(m_pDataCapture);
                 m_pDataCallbackRef->AddRef();                // Add temporary reference during creation
 
                 // Create a connection between the connection point
@@ -779,7 +925,6 @@ namespace Technosoftware
         //----------------------------------------------------------------------------------------------------------------------
         Technosoftware::Base::Status DaGroupImpl::ReadAsync(vector<DaItem*>& arItems, DWORD dwTransactionID, DWORD* pdwCancelID)
         {
-            OPCHANDLE*  phServer = NULL;
             Technosoftware::Base::Status res;
 
             try {
@@ -787,8 +932,8 @@ namespace Technosoftware
                 DWORD    dwCount = arItems.size();
                 HRESULT* pErrors = NULL;
 
-                phServer = new OPCHANDLE[dwCount];
-                if (!phServer) throw Technosoftware::Base::OutOfMemoryException();
+                ServerHandleBuffer serverHandles(dwCount);
+                OPCHANDLE* phServer = serverHandles.Begin();
 
                 for (i = 0; i < dwCount; i++) {
                     phServer[i] = arItems[i]->GetServerHandle();
@@ -819,8 +964,6 @@ namespace Technosoftware
                 res = Technosoftware::DaAeHdaClient::GetStatusFromHResult(E_FAIL);
             }
 
-            if (phServer) delete[] phServer;
-
             return res;
         }
 
@@ -830,8 +973,6 @@ namespace Technosoftware
         //----------------------------------------------------------------------------------------------------------------------
         Technosoftware::Base::Status DaGroupImpl::WriteAsync(vector<DaItem*>& arItems, DWORD dwTransactionID, DWORD* pdwCancelID)
         {
-            LPVARIANT   pValues = NULL;
-            OPCHANDLE*  phServer = NULL;
             Technosoftware::Base::Status res;
 
             try {
@@ -840,11 +981,11 @@ namespace Technosoftware
                 HRESULT* pErrors = NULL;
 
                 // Create an array with shallow copies of the values to be written.
-                pValues = new VARIANT[dwCount];
-                if (!pValues) throw Technosoftware::Base::OutOfMemoryException();
+                ValueBuffer values(dwCount);
+                LPVARIANT pValues = values.Begin();
 
-                phServer = new OPCHANDLE[dwCount];
-                if (!phServer) throw Technosoftware::Base::OutOfMemoryException();
+                ServerHandleBuffer serverHandles(dwCount);
+                OPCHANDLE* phServer = serverHandles.Begin();
 
                 for (i = 0; i < dwCount; i++) {
                     memcpy(&pValues[i], &arItems[i]->writeValue_, sizeof(VARIANT));    // Shallow Copy
@@ -877,13 +1018,59 @@ namespace Technosoftware
                 res = Technosoftware::DaAeHdaClient::GetStatusFromHResult(E_FAIL);
             }
 
-            if (pValues) delete[] pValues;
-            if (phServer) delete[] phServer;
+            return res;
+        }
+
 
+        //----------------------------------------------------------------------------------------------------------------------
+        // SetValueHistory
+        //----------------------------------------------------------------------------------------------------------------------
+        Technosoftware::Base::Status DaGroupImpl::SetValueHistory(uint32_t dwDepth, uint32_t dwMaxItems)
+        {
+            // The data callback is the writer of the history and must not run while it is replaced
+            if (m_pDataCallbackRef) return Technosoftware::DaAeHdaClient::GetStatusFromHResult(E_FAIL);
+
+            Technosoftware::Base::Status res = Technosoftware::DaAeHdaClient::GetStatusFromHResult(S_OK);
+            try {
+                DaValueHistory* pValueHistory = NULL;
+                if (dwDepth > 0 && dwMaxItems > 0) {
+                    pValueHistory = new DaValueHistory(dwMaxItems, dwDepth);
+                }
+
+                // Assign a ring of the new history to all existing items of this group
+                Base::RWLock::ScopedReadLock lock(g_HandleTableLock);
+                for (auto& entry : m_cItems) {
+                    DaItem* pItem = entry.second;
+                    if (pItem->parent_ != this) continue;
+                    pItem->valueHistorySlot_ = pValueHistory ? pValueHistory->AllocateSlot() : DaValueHistory::NoSlot;
+                }
+
+                if (m_pValueHistory) delete m_pValueHistory;
+                m_pValueHistory = pValueHistory;
+            }
+            catch (Technosoftware::Base::Status& resEx) {
+                res = resEx;
+            }
+            catch (...) {
+                res = Technosoftware::DaAeHdaClient::GetStatusFromHResult(E_OUTOFMEMORY);
+            }
             return res;
         }
 
 
+        //----------------------------------------------------------------------------------------------------------------------
+        // SetDataCapture
+        //----------------------------------------------------------------------------------------------------------------------
+        Technosoftware::Base::Status DaGroupImpl::SetDataCapture(DaDataCaptureWriter* pDataCapture)
+        {
+            m_pDataCapture = pDataCapture;
+            if (m_pDataCallbackRef) {
+                m_pDataCallbackRef->SetDataCapture(pDataCapture);
+            }
+            return Technosoftware::DaAeHdaClient::GetStatusFromHResult(S_OK);
+        }
+
+
         //----------------------------------------------------------------------------------------------------------------------
         // SetEnable
         //----------------------------------------------------------------------------------------------------------------------
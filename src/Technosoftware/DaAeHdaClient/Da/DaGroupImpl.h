@@ -14,14 +14,20 @@
 #define __DaGROUPIMPL_H
 
 #include "Base/Status.h"
-#include "Base/HashMap.h"
+#include "Base/FlatHashMap.h"
+#include "Base/Mutex.h"
+#include "Base/RWLock.h"
 #include "DaAeHdaClient/OpcBase.h"
 
+#include <atomic>
+
 namespace Technosoftware
 {
     namespace DaAeHdaClient
     {
         class DaServer;
+        class DaValueHistory;
+        class DaDataCaptureWriter;
 
         //======================================================================================================================
         // OPCDataCallback Object
@@ -77,8 +83,12 @@ namespace Technosoftware
                 /* [in] */           DWORD       dwTransid,
                 /* [in] */           OPCHANDLE   hGroup);
 
+            void SetDataCapture(DaDataCaptureWriter* pDataCapture);
+
         protected:
             DaIDataCallback*  m_pIUserDataCallback;
+            std::atomic<DaDataCaptureWriter*> m_pDataCapture;  // Optional, records notifications before dispatch
+            Base::FastMutex   m_DataCaptureLock;               // Held across Write() so a detached writer is no longer used
 
         };
 
@@ -129,6 +139,7 @@ namespace Technosoftware
             inline Technosoftware::Base::Status AddItems(DaItemDefinitions& ItemDefs,
                 vector<DaItem*>& arItems,
                 const std::function<void(const DaItemDefinition&, Base::Status)>& pfnErrHandler);
+            inline Technosoftware::Base::Status RemoveItems(vector<DaItem*>& arItems);
             inline Technosoftware::Base::Status Read(vector<DaItem*>& arItems, bool fFromCache);
             inline Technosoftware::Base::Status Write(vector<DaItem*>& arItems);
             inline Technosoftware::Base::Status SetDataSubscription(DaIDataCallback* pIUserDataCallback);
@@ -138,12 +149,16 @@ namespace Technosoftware
             inline HRESULT GetEnable(bool* pfEnable);
             inline HRESULT Cancel(uint32_t dwCancelID);
             inline HRESULT Refresh(uint32_t dwTransactionID, uint32_t* pdwCancelID, bool fFromCache);
+            inline Technosoftware::Base::Status SetValueHistory(uint32_t dwDepth, uint32_t dwMaxItems);
+            inline Technosoftware::Base::Status SetDataCapture(DaDataCaptureWriter* pDataCapture);
 
 
             // Implementation
         protected:
             friend class DaGroup;
             friend class DaItem;
+            friend class CComOPCDataCallbackImpl;
+            friend class DaDataCaptureReplayer;
             CComPtr<IMalloc>           m_pIMalloc;
             CComPtr<IOPCServer>        m_pIOPCServer;
             CComPtr<IOPCGroupStateMgt> m_pIOPCGroupStateMgt;
@@ -159,13 +174,26 @@ namespace Technosoftware
             CComObjectOPCDataCallback* m_pDataCallbackRef;
             bool                       m_fEnabled;       // Subscription State
             bool                       m_fActive;        // Group State
+            DaValueHistory*            m_pValueHistory;  // Optional, written by the data callback
+            DaDataCaptureWriter*       m_pDataCapture;   // Optional, passed to the data callback
         };
 
-        static Base::HashMap<Base::ServerHandle, DaItem*> m_cItems;
-        static unsigned long g_uItemCount = 0;
+        // Defined once in DaGroup.cpp; the callbacks and the item destructor must see the same tables.
+        extern Base::FlatHashMap<Base::ServerHandle, DaItem*> m_cItems;
+        extern unsigned long g_uItemCount;
+
+        extern Base::FlatHashMap<Base::ServerHandle, DaGroup*> m_cGroups;
+        extern unsigned long g_uGroupCount;
+
+        // Guards the tables and handle counters above. The callbacks take the read side, adding and removing groups
+        // and items the write side. The lock is not held while the user callback is dispatched because the user may
+        // remove items from there.
+        extern Base::RWLock g_HandleTableLock;
 
-        static Base::HashMap<Base::ServerHandle, DaGroup*> m_cGroups;
-        static unsigned long g_uGroupCount = 0;
+        // Number of data callbacks of all groups which are in progress, counted from before the tables are searched
+        // until the user callback has returned. Objects which the user may see in a callback are deleted only when
+        // it is 0.
+        extern std::atomic<unsigned long> g_uCallbacksInProgress;
 
     }
 }
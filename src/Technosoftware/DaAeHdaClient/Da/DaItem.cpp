@@ -22,6 +22,7 @@
 #include "DaAeHdaClient/Da/DaGroup.h"
 #include "DaAeHdaClient/Da/DaGroupImpl.h"
 #include "DaAeHdaClient/Da/DaItem.h"
+#include "DaAeHdaClient/Da/DaValueHistory.h"
 
 namespace Technosoftware
 {
@@ -33,6 +34,7 @@ namespace Technosoftware
             parent_ = parent;
             clientHandle_ = clientHandle;
             internalClientHandle_ = 0;
+            valueHistorySlot_ = DaValueHistory::NoSlot;
 
             asyncCommandResult_ = Technosoftware::DaAeHdaClient::GetStatusFromHResult(E_NOTIMPL);
             // Write Value
@@ -61,7 +63,13 @@ namespace Technosoftware
         {
             try {
                 VariantClear(&writeValue_);
-                m_cItems.erase(internalClientHandle_);
+                {
+                    Base::RWLock::ScopedWriteLock lock(g_HandleTableLock);
+                    m_cItems.erase(internalClientHandle_);
+                }
+                if (valueHistorySlot_ != DaValueHistory::NoSlot) {
+                    parent_->m_pValueHistory->ReleaseSlot(valueHistorySlot_);
+                }
             }
             catch (...) {}
         }
@@ -59,20 +59,11 @@ namespace Technosoftware
 
                 result_ = Technosoftware::DaAeHdaClient::GetStatusFromHResult(_pItemProperty->hrErrorID,Base::StatusCode::DaFuncCall);
                 if (result_.IsGood()) {
-                    USES_CONVERSION;
-
-                    if (_pItemProperty->szDescription != NULL)
-                    {
-                        description_ = OLE2A(_pItemProperty->szDescription);
-                    }
-                    else
-                    {
-                        description_ = "";
-                    }
+                    OpcStringConversion::ToString(_pItemProperty->szDescription, description_);
 
 
                     // Note: some servers returns a null pointer and not a NULL string
-                    itemId_ = _pItemProperty->szItemID ? OLE2A(_pItemProperty->szItemID) : "";
+                    OpcStringConversion::ToString(_pItemProperty->szItemID, itemId_);
                     dataType_ = _pItemProperty->vtDataType;
 
                     // Workaround for some servers
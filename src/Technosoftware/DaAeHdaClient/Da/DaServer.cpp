@@ -367,21 +367,21 @@ namespace Technosoftware
                     return Technosoftware::DaAeHdaClient::GetStatusFromHResult(E_NOTIMPL);
                 }
 
-                USES_CONVERSION;
                 if (fMachineNameAsPrefix) {
-                    TCHAR szComputerName[MAX_COMPUTERNAME_LENGTH + 1];
+                    WCHAR szComputerName[MAX_COMPUTERNAME_LENGTH + 1];
                     DWORD dwNameLen = _countof(szComputerName);
 
-                    if (!GetComputerName(szComputerName, &dwNameLen)) {
+                    if (!GetComputerNameW(szComputerName, &dwNameLen)) {
                         return Technosoftware::DaAeHdaClient::GetStatusFromHResult(HRESULT_FROM_WIN32(GetLastError()));
                     }
                     sRegisterName = "\\\\";
-                    sRegisterName += T2A(szComputerName);
+                    sRegisterName += OpcStringConversion::ToString(szComputerName);
                     sRegisterName += "\\";
                 }
                 sRegisterName += sClientName;
 
-                HRESULT hr = m_pIOPCCommon->SetClientName(A2CW(sRegisterName.c_str()));
+                OpcStringConversion conversion;
+                HRESULT hr = m_pIOPCCommon->SetClientName(conversion.ToWide(sRegisterName));
                 return Technosoftware::DaAeHdaClient::GetStatusFromHResult(hr,Base::StatusCode::DaFuncCall);
             }
             catch (...) {
@@ -501,7 +501,6 @@ namespace Technosoftware
             OPCSERVERSTATUS* pStatusResult;
             HRESULT hr = pIOPCServer->GetStatus(&pStatusResult);
             if (SUCCEEDED(hr)) {
-                USES_CONVERSION;
                 pStatus->startTime_ = Base::Timestamp::FromFileTime((uint32_t)pStatusResult->ftStartTime.dwLowDateTime, (uint32_t)pStatusResult->ftStartTime.dwHighDateTime);
                 pStatus->currentTime_ = Base::Timestamp::FromFileTime((uint32_t)pStatusResult->ftCurrentTime.dwLowDateTime, (uint32_t)pStatusResult->ftCurrentTime.dwHighDateTime);
                 pStatus->lastUpdateTime_ = Base::Timestamp::FromFileTime((uint32_t)pStatusResult->ftLastUpdateTime.dwLowDateTime, (uint32_t)pStatusResult->ftLastUpdateTime.dwHighDateTime);
@@ -533,7 +532,7 @@ namespace Technosoftware
                 pStatus->minorVersion_ = pStatusResult->wMinorVersion;
                 pStatus->buildNumber_ = pStatusResult->wBuildNumber;
                 pStatus->reserved_ = pStatusResult->wReserved;
-                pStatus->vendorInfo_ = OLE2A(pStatusResult->szVendorInfo);
+                OpcStringConversion::ToString(pStatusResult->szVendorInfo, pStatus->vendorInfo_);
 
                 CoTaskMemFree(pStatusResult->szVendorInfo);
                 CoTaskMemFree(pStatusResult);
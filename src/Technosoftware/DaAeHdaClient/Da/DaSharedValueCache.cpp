@@ -0,0 +1,397 @@
+/*
+ * Copyright (c) 2011-2021 Technosoftware GmbH. All rights reserved
+ * Web: https://www.technosoftware.com
+ *
+ * The source code in this file is covered under a dual-license scenario:
+ *   - Owner of a purchased license: SCLA 1.0
+ *   - GPL V3: everybody else
+ *
+ * SCLA license terms accompanied with this source code.
+ * See SCLA 1.0: https://technosoftware.com/license/Source_Code_License_Agreement.pdf
+ *
+ * GNU General Public License as published by the Free Software Foundation;
+ * version 3 of the License are accompanied with this source code.
+ * See https://technosoftware.com/license/GPLv3License.txt
+ *
+ * This source code is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#include "OpcInternal.h"
+#include "DaAeHdaClient/Da/DaSharedValueCache.h"
+#include "DaAeHdaClient/Da/DaItem.h"
+
+#include "Base/Exception.h"
+
+#include <atomic>
+#include <string.h>
+
+
+namespace Technosoftware
+{
+    namespace DaAeHdaClient
+    {
+        //----------------------------------------------------------------------------------------------------------------------
+        // Shared memory layout
+        // --------------------
+        //    The table consists of a header followed by capacity entries. The first cache line of an entry holds the
+        //    value, the rest the item identifier. Publisher and readers may be built by different compilers, so the
+        //    layout only uses fixed size types.
+        //
+        //    The mapping lives as long as any process holds it. A publisher which finds an existing table takes it
+        //    over if the process recorded in the header has terminated, and resets all entries under the sequence
+        //    protocol so that readers which keep the table mapped never see a partly reset entry.
+        //----------------------------------------------------------------------------------------------------------------------
+
+        static const uint32_t SharedValueCacheMagic = 0x56434144;     // "DACV"
+        static const uint32_t SharedValueCacheVersion = 1;
+        static const uint32_t MaxReadAttempts = 1000;                 // Gives up if the publisher died while writing
+
+        struct DaSharedValueCacheHeader
+        {
+            uint32_t                    magic;
+            uint32_t                    version;
+            uint32_t                    capacity;
+            uint32_t                    entrySize;
+            std::atomic<uint32_t>       publisherProcessId;     // 0 if no publisher owns the table
+            unsigned char               reserved[44];
+        };
+
+        struct DaSharedValueCacheEntry
+        {
+            std::atomic<uint32_t>       sequence;               // Odd while the publisher updates the entry
+            uint32_t                    published;              // 0 until the first value has been published
+            DaValueSample               sample;
+            unsigned char               reserved[32];
+            char                        itemIdentifier[192];
+        };
+
+        static_assert(sizeof(DaSharedValueCacheHeader) == 64, "Unexpected shared value cache header size");
+        static_assert(sizeof(DaSharedValueCacheEntry) == 256, "Unexpected shared value cache entry size");
+
+        static inline DaSharedValueCacheEntry* GetEntry(const DaSharedValueCacheHeader* header, uint32_t index)
+        {
+            return reinterpret_cast<DaSharedValueCacheEntry*>(
+                reinterpret_cast<unsigned char*>(const_cast<DaSharedValueCacheHeader*>(header)) + sizeof(DaSharedValueCacheHeader)) + index;
+        }
+
+        // Returns the number of bytes of a mapped view, rounded up to whole pages.
+        static uint64_t GetViewSize(const void* view)
+        {
+            MEMORY_BASIC_INFORMATION info;
+            if (VirtualQuery(view, &info, sizeof(info)) != sizeof(info)) return 0;
+            return info.RegionSize;
+        }
+
+        // Returns the number of entries which fit into a mapped view.
+        static uint32_t GetViewCapacity(uint64_t viewSize)
+        {
+            if (viewSize < sizeof(DaSharedValueCacheHeader)) return 0;
+            uint64_t entries = (viewSize - sizeof(DaSharedValueCacheHeader)) / sizeof(DaSharedValueCacheEntry);
+            return entries > 0xFFFFFFFF ? 0xFFFFFFFF : (uint32_t)entries;
+        }
+
+        static bool IsProcessRunning(DWORD processId)
+        {
+            HANDLE hProcess = OpenProcess(SYNCHRONIZE, FALSE, processId);
+            if (!hProcess) {
+                return GetLastError() == ERROR_ACCESS_DENIED;          // Exists but belongs to another user
+            }
+            bool running = WaitForSingleObject(hProcess, 0) == WAIT_TIMEOUT;
+            CloseHandle(hProcess);
+            return running;
+        }
+
+        // Makes the calling process the publisher of the table unless the recorded publisher is still running.
+        static bool ClaimTable(DaSharedValueCacheHeader* header)
+        {
+            uint32_t processId = GetCurrentProcessId();
+            uint32_t owner = header->publisherProcessId.load(std::memory_order_acquire);
+            for (;;) {
+                if (owner != 0 && IsProcessRunning(owner)) return false;
+                if (header->publisherProcessId.compare_exchange_weak(owner, processId, std::memory_order_acq_rel)) return true;
+            }
+        }
+
+        // Returns true if an existing mapping is a table of this layout or has not been initialized yet.
+        static bool IsCompatibleTable(const DaSharedValueCacheHeader* header)
+        {
+            return header->magic == 0 ||
+                (header->magic == SharedValueCacheMagic &&
+                 header->version == SharedValueCacheVersion &&
+                 header->entrySize == sizeof(DaSharedValueCacheEntry));
+        }
+
+        // Makes the calling thread the only writer of an entry. The data callbacks of several groups may publish the same
+        // index concurrently, so the sequence is moved from even to odd with a compare and swap. Returns the even
+        // sequence; EndEntryUpdate() stores sequence + 2.
+        static uint32_t BeginEntryUpdate(DaSharedValueCacheEntry* entry)
+        {
+            unsigned int spins = 0;
+            uint32_t sequence = entry->sequence.load(std::memory_order_relaxed);
+            for (;;) {
+                if ((sequence & 1) == 0 &&
+                    entry->sequence.compare_exchange_weak(sequence, sequence + 1, std::memory_order_acquire, std::memory_order_relaxed)) {
+                    break;
+                }
+                if (++spins > 64) SwitchToThread(); else YieldProcessor();      // Another writer is active
+                sequence = entry->sequence.load(std::memory_order_relaxed);
+            }
+            // Readers seeing any of the following stores must also see the odd sequence.
+            std::atomic_thread_fence(std::memory_order_release);
+            return sequence;
+        }
+
+        static inline void EndEntryUpdate(DaSharedValueCacheEntry* entry, uint32_t sequence)
+        {
+            entry->sequence.store(sequence + 2, std::memory_order_release);
+        }
+
+        // Clears all entries of a table left by a terminated publisher.
+        static void ResetTable(DaSharedValueCacheHeader* header, uint32_t viewCapacity)
+        {
+            for (uint32_t i = 0; i < viewCapacity; i++) {
+                DaSharedValueCacheEntry* entry = GetEntry(header, i);
+                uint32_t sequence = entry->sequence.load(std::memory_order_relaxed);
+                sequence += sequence & 1;                          // The publisher may have died while writing
+                entry->sequence.store(sequence + 1, std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_release);
+
+                entry->published = 0;
+                memset(&entry->sample, 0, sizeof(entry->sample));
+                memset(entry->itemIdentifier, 0, sizeof(entry->itemIdentifier));
+
+                entry->sequence.store(sequence + 2, std::memory_order_release);
+            }
+        }
+
+
+        //----------------------------------------------------------------------------------------------------------------------
+        // CLASS DaSharedValuePublisher
+        //----------------------------------------------------------------------------------------------------------------------
+
+        DaSharedValuePublisher::DaSharedValuePublisher(const char* name, uint32_t capacity, DaIDataCallback* userDataCallback) noexcept(false)
+        {
+            if (!name || capacity == 0) throw Technosoftware::Base::InvalidArgumentException();
+
+            uint64_t size = sizeof(DaSharedValueCacheHeader) + (uint64_t)capacity * sizeof(DaSharedValueCacheEntry);
+            HANDLE hMapping = CreateFileMappingA(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE,
+                (DWORD)(size >> 32), (DWORD)(size & 0xFFFFFFFF), name);
+            if (!hMapping) {
+                throw Technosoftware::Base::StatusException(Technosoftware::DaAeHdaClient::GetStatusFromHResult(HRESULT_FROM_WIN32(GetLastError())));
+            }
+            bool existing = GetLastError() == ERROR_ALREADY_EXISTS;  // Held by readers or another publisher
+
+            void* pView = MapViewOfFile(hMapping, FILE_MAP_WRITE, 0, 0, 0);
+            if (!pView) {
+                HRESULT hr = HRESULT_FROM_WIN32(GetLastError());
+                CloseHandle(hMapping);
+                throw Technosoftware::Base::StatusException(Technosoftware::DaAeHdaClient::GetStatusFromHResult(hr));
+            }
+
+            // The size of an existing mapping can't be changed
+            DaSharedValueCacheHeader* pHeader = static_cast<DaSharedValueCacheHeader*>(pView);
+            uint32_t viewCapacity = GetViewCapacity(GetViewSize(pView));
+            HRESULT hr = S_OK;
+            if (viewCapacity < capacity || (existing && !IsCompatibleTable(pHeader))) {
+                hr = E_INVALIDARG;
+            }
+            else if (!ClaimTable(pHeader)) {
+                hr = HRESULT_FROM_WIN32(ERROR_ALREADY_EXISTS);
+            }
+            if (FAILED(hr)) {
+                UnmapViewOfFile(pView);
+                CloseHandle(hMapping);
+                throw Technosoftware::Base::StatusException(Technosoftware::DaAeHdaClient::GetStatusFromHResult(hr));
+            }
+
+            // The pages of a new mapping are zero-initialized, so all entries are unpublished. The entries of a
+            // table taken over are reset before the header is rewritten.
+            if (existing) ResetTable(pHeader, viewCapacity);
+            mapping_ = hMapping;
+            header_ = pHeader;
+            header_->version = SharedValueCacheVersion;
+            header_->capacity = capacity;
+            header_->entrySize = sizeof(DaSharedValueCacheEntry);
+            std::atomic_thread_fence(std::memory_order_release);
+            header_->magic = SharedValueCacheMagic;
+            userDataCallback_ = userDataCallback;
+        }
+
+        DaSharedValuePublisher::~DaSharedValuePublisher() noexcept
+        {
+            if (header_) {
+                header_->publisherProcessId.store(0, std::memory_order_release);
+                UnmapViewOfFile(header_);
+            }
+            if (mapping_) CloseHandle(mapping_);
+        }
+
+        uint32_t DaSharedValuePublisher::GetCapacity() const noexcept { return header_->capacity; }
+
+        Base::Status DaSharedValuePublisher::SetItemIdentifier(uint32_t index, const char* itemIdentifier)
+        {
+            if (index >= header_->capacity || !itemIdentifier) return Technosoftware::DaAeHdaClient::GetStatusFromHResult(E_INVALIDARG);
+
+            DaSharedValueCacheEntry* entry = GetEntry(header_, index);
+            uint32_t sequence = BeginEntryUpdate(entry);
+
+            strncpy(entry->itemIdentifier, itemIdentifier, sizeof(entry->itemIdentifier) - 1);
+            entry->itemIdentifier[sizeof(entry->itemIdentifier) - 1] = '\0';
+
+            EndEntryUpdate(entry, sequence);
+            return Technosoftware::DaAeHdaClient::GetStatusFromHResult(S_OK);
+        }
+
+        void DaSharedValuePublisher::Publish(uint32_t index, const VARIANT* value, Base::Timestamp timeStamp, uint16_t quality) noexcept
+        {
+            if (index >= header_->capacity) return;
+
+            DaSharedValueCacheEntry* entry = GetEntry(header_, index);
+            uint32_t sequence = BeginEntryUpdate(entry);
+
+            entry->sample.TimeStamp = timeStamp.GetEpochMicroseconds();
+            entry->sample.Quality = quality;
+            entry->sample.Reserved = 0;
+            DaValueHistory::FromVariant(value, entry->sample);
+            entry->published = 1;
+
+            EndEntryUpdate(entry, sequence);
+        }
+
+        void DaSharedValuePublisher::PublishItems(uint32_t numberOfItems, DaItem** items) noexcept
+        {
+            for (uint32_t i = 0; i < numberOfItems; i++) {
+                DaItem::DaReadResult& result = items[i]->GetReadAsyncResult();
+                if (result.GetResult().IsNotGood()) continue;
+                Publish(items[i]->GetClientHandle(), result.GetValue(), result.GetTimeStamp(), result.GetQuality());
+            }
+        }
+
+        void DaSharedValuePublisher::DataChange(uint32_t transactionId, DaGroup* group, bool allQualitiesGood, bool allResultsOk, uint32_t numberOfItems, DaItem** items)
+        {
+            PublishItems(numberOfItems, items);
+            if (userDataCallback_) userDataCallback_->DataChange(transactionId, group, allQualitiesGood, allResultsOk, numberOfItems, items);
+        }
+
+        void DaSharedValuePublisher::ReadComplete(uint32_t transactionId, DaGroup* group, bool allQualitiesGood, bool allResultsOk, uint32_t numberOfItems, DaItem** items)
+        {
+            PublishItems(numberOfItems, items);
+            if (userDataCallback_) userDataCallback_->ReadComplete(transactionId, group, allQualitiesGood, allResultsOk, numberOfItems, items);
+        }
+
+        void DaSharedValuePublisher::WriteComplete(uint32_t transactionId, DaGroup* group, bool allResultsOk, uint32_t numberOfItems, DaItem** items)
+        {
+            if (userDataCallback_) userDataCallback_->WriteComplete(transactionId, group, allResultsOk, numberOfItems, items);
+        }
+
+        void DaSharedValuePublisher::CancelComplete(uint32_t transactionId, DaGroup* group)
+        {
+            if (userDataCallback_) userDataCallback_->CancelComplete(transactionId, group);
+        }
+
+
+        //----------------------------------------------------------------------------------------------------------------------
+        // CLASS DaSharedValueReader
+        //----------------------------------------------------------------------------------------------------------------------
+
+        DaSharedValueReader::DaSharedValueReader(const char* name) noexcept(false)
+        {
+            if (!name) throw Technosoftware::Base::InvalidArgumentException();
+
+            HANDLE hMapping = OpenFileMappingA(FILE_MAP_READ, FALSE, name);
+            if (!hMapping) {
+                throw Technosoftware::Base::StatusException(Technosoftware::DaAeHdaClient::GetStatusFromHResult(HRESULT_FROM_WIN32(GetLastError())));
+            }
+
+            const void* pView = MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0);
+            if (!pView) {
+                HRESULT hr = HRESULT_FROM_WIN32(GetLastError());
+                CloseHandle(hMapping);
+                throw Technosoftware::Base::StatusException(Technosoftware::DaAeHdaClient::GetStatusFromHResult(hr));
+            }
+
+            // The header is only trusted as far as the view really extends
+            const DaSharedValueCacheHeader* pHeader = static_cast<const DaSharedValueCacheHeader*>(pView);
+            uint64_t viewSize = GetViewSize(pView);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (viewSize < sizeof(DaSharedValueCacheHeader) ||
+                pHeader->magic != SharedValueCacheMagic ||
+                pHeader->version != SharedValueCacheVersion ||
+                pHeader->entrySize != sizeof(DaSharedValueCacheEntry) ||
+                pHeader->capacity > GetViewCapacity(viewSize)) {
+                UnmapViewOfFile(pView);
+                CloseHandle(hMapping);
+                throw Technosoftware::Base::StatusException(Technosoftware::DaAeHdaClient::GetStatusFromHResult(E_INVALIDARG));
+            }
+
+            mapping_ = hMapping;
+            header_ = pHeader;
+            viewCapacity_ = GetViewCapacity(viewSize);
+        }
+
+        DaSharedValueReader::~DaSharedValueReader() noexcept
+        {
+            if (header_) UnmapViewOfFile(header_);
+            if (mapping_) CloseHandle(mapping_);
+        }
+
+        uint32_t DaSharedValueReader::GetCapacity() const noexcept
+        {
+            // A publisher which takes over the table may change the capacity, but never beyond the mapping
+            uint32_t capacity = header_->capacity;
+            return capacity < viewCapacity_ ? capacity : viewCapacity_;
+        }
+
+        bool DaSharedValueReader::Read(uint32_t index, DaValueSample& sample) const noexcept
+        {
+            if (index >= GetCapacity()) return false;
+
+            const DaSharedValueCacheEntry* entry = GetEntry(header_, index);
+            for (uint32_t attempt = 0; attempt < MaxReadAttempts; attempt++) {
+                uint32_t sequence = entry->sequence.load(std::memory_order_acquire);
+                if (sequence & 1) {
+                    YieldProcessor();                                  // Publisher active
+                    continue;
+                }
+
+                uint32_t published = entry->published;
+                sample = entry->sample;
+
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (entry->sequence.load(std::memory_order_relaxed) == sequence) {
+                    return published != 0;
+                }
+            }
+            return false;
+        }
+
+        bool DaSharedValueReader::FindIndex(const char* itemIdentifier, uint32_t& index) const noexcept
+        {
+            if (!itemIdentifier) return false;
+
+            char szName[sizeof(DaSharedValueCacheEntry::itemIdentifier)];
+            uint32_t capacity = GetCapacity();
+            for (uint32_t i = 0; i < capacity; i++) {
+                const DaSharedValueCacheEntry* entry = GetEntry(header_, i);
+                uint32_t attempt;
+                for (attempt = 0; attempt < MaxReadAttempts; attempt++) {
+                    uint32_t sequence = entry->sequence.load(std::memory_order_acquire);
+                    if (sequence & 1) continue;
+                    memcpy(szName, entry->itemIdentifier, sizeof(szName));
+                    std::atomic_thread_fence(std::memory_order_acquire);
+                    if (entry->sequence.load(std::memory_order_relaxed) == sequence) break;
+                }
+                if (attempt == MaxReadAttempts) continue;
+
+                szName[sizeof(szName) - 1] = '\0';
+                if (strcmp(szName, itemIdentifier) == 0) {
+                    index = i;
+                    return true;
+                }
+            }
+            return false;
+        }
+    }
+}
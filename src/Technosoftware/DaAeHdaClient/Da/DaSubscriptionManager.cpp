@@ -0,0 +1,595 @@
+/*
+ * Copyright (c) 2011-2021 Technosoftware GmbH. All rights reserved
+ * Web: https://www.technosoftware.com
+ *
+ * The source code in this file is covered under a dual-license scenario:
+ *   - Owner of a purchased license: SCLA 1.0
+ *   - GPL V3: everybody else
+ *
+ * SCLA license terms accompanied with this source code.
+ * See SCLA 1.0: https://technosoftware.com/license/Source_Code_License_Agreement.pdf
+ *
+ * GNU General Public License as published by the Free Software Foundation;
+ * version 3 of the License are accompanied with this source code.
+ * See https://technosoftware.com/license/GPLv3License.txt
+ *
+ * This source code is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#include <vector>
+#include <map>
+#include <set>
+#include <algorithm>
+
+
+#include "OpcInternal.h"
+#include "DaAeHdaClient/Da/DaSubscriptionManager.h"
+#include "DaSubscriptionManagerImpl.h"
+#include "DaAeHdaClient/Da/DaServer.h"
+#include "DaAeHdaClient/Da/DaGroup.h"
+#include "DaGroupImpl.h"
+#include "DaAeHdaClient/Da/DaItem.h"
+
+#include "Base/Exception.h"
+
+
+namespace Technosoftware
+{
+    namespace DaAeHdaClient
+    {
+        DaSubscriptionManager::DaSubscriptionManager(DaServer* server, DaIDataCallback* userDataCallback, uint32_t maxItemsPerGroup) noexcept(false)
+        {
+            impl_.Attach(new (std::nothrow) DaSubscriptionManagerImpl(server, userDataCallback, maxItemsPerGroup));
+            if (!impl_) throw Technosoftware::Base::OutOfMemoryException();
+        }
+
+        DaSubscriptionManager::~DaSubscriptionManager() noexcept
+        {
+        }
+
+        Base::Status DaSubscriptionManager::AddItems(const vector<DaSubscriptionItem>& items,
+            const std::function<void(const DaSubscriptionItem&, Base::Status)>& errorHandler)
+        {
+            return impl_->AddItems(items, errorHandler);
+        }
+
+        Base::Status DaSubscriptionManager::RemoveItems(const vector<Base::ClientHandle>& clientHandles) { return impl_->RemoveItems(clientHandles); }
+
+        void DaSubscriptionManager::RemoveAllItems() noexcept { impl_->RemoveAllItems(); }
+
+        Base::Status DaSubscriptionManager::Rebalance() { return impl_->Rebalance(); }
+
+        void DaSubscriptionManager::SetMaxItemsPerGroup(uint32_t maxItemsPerGroup) noexcept
+        {
+            Base::FastMutex::ScopedLock lock(impl_->m_Lock);
+            impl_->m_dwMaxItemsPerGroup = maxItemsPerGroup ? maxItemsPerGroup : 1;
+        }
+
+        uint32_t DaSubscriptionManager::GetMaxItemsPerGroup() const noexcept
+        {
+            Base::FastMutex::ScopedLock lock(impl_->m_Lock);
+            return impl_->m_dwMaxItemsPerGroup;
+        }
+
+        uint32_t DaSubscriptionManager::GetGroupCount() const noexcept
+        {
+            Base::FastMutex::ScopedLock lock(impl_->m_Lock);
+            return (uint32_t)impl_->m_arGroups.size();
+        }
+
+        uint32_t DaSubscriptionManager::GetItemCount() const noexcept
+        {
+            Base::FastMutex::ScopedLock lock(impl_->m_Lock);
+            return (uint32_t)impl_->m_cManagedItems.size();
+        }
+
+        Base::Status DaSubscriptionManager::AccessItem(Base::ClientHandle clientHandle, const std::function<void(DaGroup*, DaItem*)>& function) const
+        {
+            Base::FastMutex::ScopedLock lock(impl_->m_Lock);
+            auto result = impl_->m_cManagedItems.find(clientHandle);
+            if (result == impl_->m_cManagedItems.end() || !result->second->m_pItem) {
+                return Technosoftware::DaAeHdaClient::GetStatusFromHResult(E_INVALIDARG);
+            }
+            function(result->second->m_pGroup->m_pGroup, result->second->m_pItem);
+            return Technosoftware::DaAeHdaClient::GetStatusFromHResult(S_OK);
+        }
+
+        Base::Status DaSubscriptionManager::SetActive(bool active) { return impl_->SetActive(active); }
+
+
+        //----------------------------------------------------------------------------------------------------------------------
+        // IMPLEMENTATION CLASS DaSubscriptionManagerImpl
+        //----------------------------------------------------------------------------------------------------------------------
+        //
+        // Please refer to class DaSubscriptionManager for the description and documentation of attributes and member
+        // functions.
+        //
+        // The items are bucketed by the revised update rate of their requested update rate and by their percent
+        // deadband. A bucket with n items uses ceil(n / m_dwMaxItemsPerGroup) groups. New items are distributed so that
+        // the groups of a bucket are filled evenly; removing items dissolves the least filled groups of a bucket and
+        // moves their items to the remaining groups.
+        //
+        // Moved items get new DaItem instances in their new group. The dissolved group is only unsubscribed and kept
+        // with its item instances until no data callback is in progress, because the user may still use the old
+        // instances in a callback.
+        //
+
+        //----------------------------------------------------------------------------------------------------------------------
+        // Constructor
+        //----------------------------------------------------------------------------------------------------------------------
+        DaSubscriptionManagerImpl::DaSubscriptionManagerImpl(DaServer* pServer, DaIDataCallback* pIUserDataCallback, uint32_t dwMaxItemsPerGroup) noexcept(false)
+        {
+            if (!pServer || !pIUserDataCallback) throw Technosoftware::Base::InvalidArgumentException();
+
+            m_pServer = pServer;
+            m_pIUserDataCallback = pIUserDataCallback;
+            m_dwMaxItemsPerGroup = dwMaxItemsPerGroup ? dwMaxItemsPerGroup : 1;
+            m_dwNextGroupHandle = 0;
+        }
+
+
+        //----------------------------------------------------------------------------------------------------------------------
+        // Destructor
+        //----------------------------------------------------------------------------------------------------------------------
+        DaSubscriptionManagerImpl::~DaSubscriptionManagerImpl() noexcept
+        {
+            RemoveAllItems();
+        }
+
+
+        //----------------------------------------------------------------------------------------------------------------------
+        // AddItems
+        //----------------------------------------------------------------------------------------------------------------------
+        Technosoftware::Base::Status DaSubscriptionManagerImpl::AddItems(const vector<DaSubscriptionItem>& arItems,
+            const std::function<void(const DaSubscriptionItem&, Base::Status)>& pfnErrHandler)
+        {
+            Base::FastMutex::ScopedLock lock(m_Lock);
+            Technosoftware::Base::Status res = Technosoftware::DaAeHdaClient::GetStatusFromHResult(S_OK);
+            DeleteRetiredGroups(false);
+
+            // Items which could not be subscribed are reported to the user and forgotten.
+            auto pfnDrop = [&](DaManagedItem* pItem, Base::Status status) {
+                if (pfnErrHandler) {
+                    DaSubscriptionItem item;
+                    item.ItemIdentifier = pItem->m_sItemIdentifier.c_str();
+                    item.ClientHandle = pItem->m_hClient;
+                    item.RequestedUpdateRate = pItem->m_dwRequestedUpdateRate;
+                    item.PercentDeadband = pItem->m_fPercentDeadband;
+                    pfnErrHandler(item, status);
+                }
+                m_cManagedItems.erase(pItem->m_hClient);
+                delete pItem;
+            };
+
+            // Partition the items by requested update rate and deadband
+            std::map<std::pair<uint32_t, float>, vector<DaManagedItem*> > cPartitions;
+            for (const DaSubscriptionItem& item : arItems) {
+                if (!item.ItemIdentifier || m_cManagedItems.count(item.ClientHandle)) {
+                    res = Technosoftware::DaAeHdaClient::GetStatusFromHResult(E_INVALIDARG);
+                    if (pfnErrHandler) pfnErrHandler(item, res);
+                    continue;
+                }
+                DaManagedItem* pItem = new (std::nothrow) DaManagedItem;
+                if (!pItem) return Technosoftware::DaAeHdaClient::GetStatusFromHResult(E_OUTOFMEMORY);
+                pItem->m_sItemIdentifier = item.ItemIdentifier;
+                pItem->m_hClient = item.ClientHandle;
+                pItem->m_dwRequestedUpdateRate = item.RequestedUpdateRate;
+                pItem->m_fPercentDeadband = item.PercentDeadband;
+                pItem->m_pGroup = nullptr;
+                pItem->m_pItem = nullptr;
+                m_cManagedItems[item.ClientHandle] = pItem;
+                cPartitions[std::make_pair(item.RequestedUpdateRate, item.PercentDeadband)].push_back(pItem);
+            }
+
+            for (auto& partition : cPartitions) {
+                Technosoftware::Base::Status resBucket = AddToBucket(partition.first.first, partition.first.second, partition.second, pfnDrop);
+                if (resBucket.IsNotGood()) res = resBucket;
+            }
+            return res;
+        }
+
+
+        //----------------------------------------------------------------------------------------------------------------------
+        // RemoveItems
+        //----------------------------------------------------------------------------------------------------------------------
+        Technosoftware::Base::Status DaSubscriptionManagerImpl::RemoveItems(const vector<Base::ClientHandle>& arClientHandles)
+        {
+            Base::FastMutex::ScopedLock lock(m_Lock);
+            Technosoftware::Base::Status res = Technosoftware::DaAeHdaClient::GetStatusFromHResult(S_OK);
+            DeleteRetiredGroups(false);
+
+            std::map<DaManagedGroup*, vector<DaManagedItem*> > cRemovals;
+            for (Base::ClientHandle hClient : arClientHandles) {
+                auto result = m_cManagedItems.find(hClient);
+                if (result == m_cManagedItems.end()) {
+                    res = Technosoftware::DaAeHdaClient::GetStatusFromHResult(E_INVALIDARG);
+                    continue;
+                }
+                cRemovals[result->second->m_pGroup].push_back(result->second);
+            }
+
+            std::set<std::pair<uint32_t, float> > cBuckets;
+            for (auto& removal : cRemovals) {
+                DaManagedGroup* pGroup = removal.first;
+                vector<DaItem*> arNotRemoved;
+                for (DaManagedItem* pItem : removal.second) arNotRemoved.push_back(pItem->m_pItem);
+
+                Technosoftware::Base::Status resGroup = pGroup->m_pGroup->RemoveItems(arNotRemoved);
+                if (resGroup.IsNotGood()) res = resGroup;
+
+                // The item instances removed from the server are already deleted by the group
+                std::set<DaItem*> cNotRemoved(arNotRemoved.begin(), arNotRemoved.end());
+                for (DaManagedItem* pItem : removal.second) {
+                    if (cNotRemoved.count(pItem->m_pItem)) continue;
+                    pGroup->m_arItems.erase(std::find(pGroup->m_arItems.begin(), pGroup->m_arItems.end(), pItem->m_pItem));
+                    m_cManagedItems.erase(pItem->m_hClient);
+                    delete pItem;
+                }
+                cBuckets.insert(std::make_pair(pGroup->m_dwRevisedUpdateRate, pGroup->m_fPercentDeadband));
+            }
+
+            for (auto& bucket : cBuckets) {
+                Technosoftware::Base::Status resBucket = CompactBucket(bucket.first, bucket.second);
+                if (resBucket.IsNotGood()) res = resBucket;
+            }
+            return res;
+        }
+
+
+        //----------------------------------------------------------------------------------------------------------------------
+        // RemoveAllItems
+        //----------------------------------------------------------------------------------------------------------------------
+        void DaSubscriptionManagerImpl::RemoveAllItems() noexcept
+        {
+            try {
+                Base::FastMutex::ScopedLock lock(m_Lock);
+                while (!m_arGroups.empty()) {
+                    DeleteGroup(m_arGroups.back());
+                }
+                DeleteRetiredGroups(true);
+                for (auto& entry : m_cManagedItems) {
+                    delete entry.second;
+                }
+                m_cManagedItems.clear();
+            }
+            catch (...) {}
+        }
+
+
+        //----------------------------------------------------------------------------------------------------------------------
+        // Rebalance
+        //----------------------------------------------------------------------------------------------------------------------
+        Technosoftware::Base::Status DaSubscriptionManagerImpl::Rebalance()
+        {
+            Base::FastMutex::ScopedLock lock(m_Lock);
+            Technosoftware::Base::Status res = Technosoftware::DaAeHdaClient::GetStatusFromHResult(S_OK);
+            DeleteRetiredGroups(false);
+
+            std::set<std::pair<uint32_t, float> > cBuckets;
+            for (DaManagedGroup* pGroup : m_arGroups) {
+                cBuckets.insert(std::make_pair(pGroup->m_dwRevisedUpdateRate, pGroup->m_fPercentDeadband));
+            }
+            for (auto& bucket : cBuckets) {
+                Technosoftware::Base::Status resBucket = CompactBucket(bucket.first, bucket.second);
+                if (resBucket.IsNotGood()) res = resBucket;
+            }
+            return res;
+        }
+
+
+        //----------------------------------------------------------------------------------------------------------------------
+        // SetActive
+        //----------------------------------------------------------------------------------------------------------------------
+        Technosoftware::Base::Status DaSubscriptionManagerImpl::SetActive(bool fActive)
+        {
+            Base::FastMutex::ScopedLock lock(m_Lock);
+            Technosoftware::Base::Status res = Technosoftware::DaAeHdaClient::GetStatusFromHResult(S_OK);
+            DeleteRetiredGroups(false);
+
+            for (DaManagedGroup* pGroup : m_arGroups) {
+                Technosoftware::Base::Status resGroup = pGroup->m_pGroup->SetActive(fActive);
+                if (resGroup.IsNotGood()) res = resGroup;
+            }
+            return res;
+        }
+
+
+        //----------------------------------------------------------------------------------------------------------------------
+        // CreateGroup
+        // -----------
+        //    Creates a new subscribed group and learns the revised update rate of the requested update rate.
+        //----------------------------------------------------------------------------------------------------------------------
+        DaManagedGroup* DaSubscriptionManagerImpl::CreateGroup(uint32_t dwRequestedUpdateRate, float fPercentDeadband) noexcept(false)
+        {
+            DaManagedGroup* pGroup = new (std::nothrow) DaManagedGroup;
+            if (!pGroup) throw Technosoftware::Base::OutOfMemoryException();
+
+            try {
+                pGroup->m_pGroup = new DaGroup(m_pServer, nullptr, true, dwRequestedUpdateRate,
+                    (Base::ClientHandle)m_dwNextGroupHandle++, nullptr, &fPercentDeadband);
+            }
+            catch (...) {
+                delete pGroup;
+                throw;
+            }
+
+            Technosoftware::Base::Status res = pGroup->m_pGroup->SetDataSubscription(this);
+            if (res.IsNotGood()) {
+                delete pGroup->m_pGroup;
+                delete pGroup;
+                throw Technosoftware::Base::StatusException(res);
+            }
+
+            pGroup->m_dwRequestedUpdateRate = dwRequestedUpdateRate;
+            pGroup->m_dwRevisedUpdateRate = pGroup->m_pGroup->GetRevisedUpdateRate();
+            pGroup->m_fPercentDeadband = fPercentDeadband;
+            m_cRevisedUpdateRates[dwRequestedUpdateRate] = pGroup->m_dwRevisedUpdateRate;
+
+            m_arGroups.push_back(pGroup);
+            return pGroup;
+        }
+
+
+        //----------------------------------------------------------------------------------------------------------------------
+        // DeleteGroup
+        // -----------
+        //    Removes the group and all its items from the server. The managed items are kept but no longer
+        //    reference an item instance.
+        //----------------------------------------------------------------------------------------------------------------------
+        void DaSubscriptionManagerImpl::DeleteGroup(DaManagedGroup* pGroup) noexcept
+        {
+            try {
+                for (DaItem* pItem : pGroup->m_arItems) {
+                    auto result = m_cManagedItems.find(pItem->GetClientHandle());
+                    if (result != m_cManagedItems.end()) {
+                        result->second->m_pGroup = nullptr;
+                        result->second->m_pItem = nullptr;
+                    }
+                }
+                m_arGroups.erase(std::find(m_arGroups.begin(), m_arGroups.end(), pGroup));
+                delete pGroup->m_pGroup;                      // Also deletes the item instances
+                delete pGroup;
+            }
+            catch (...) {}
+        }
+
+
+        //----------------------------------------------------------------------------------------------------------------------
+        // RetireGroup
+        // -----------
+        //    Unsubscribes a group whose items have been moved to other groups. The group and its item instances are
+        //    deleted by DeleteRetiredGroups() once no data callback is in progress.
+        //----------------------------------------------------------------------------------------------------------------------
+        void DaSubscriptionManagerImpl::RetireGroup(DaManagedGroup* pGroup) noexcept
+        {
+            try {
+                pGroup->m_pGroup->SetDataSubscription(nullptr);
+                m_arRetiredGroups.push_back(pGroup->m_pGroup);
+                delete pGroup;
+            }
+            catch (...) {}
+        }
+
+
+        //----------------------------------------------------------------------------------------------------------------------
+        // DeleteRetiredGroups
+        // -------------------
+        //    A callback which started before a group was retired may still pass its item instances to the user, so
+        //    retired groups are deleted only when no callback is in progress or when forced.
+        //----------------------------------------------------------------------------------------------------------------------
+        void DaSubscriptionManagerImpl::DeleteRetiredGroups(bool fForce) noexcept
+        {
+            if (m_arRetiredGroups.empty()) return;
+            if (!fForce && g_uCallbacksInProgress.load() != 0) return;
+
+            for (DaGroup* pGroup : m_arRetiredGroups) {
+                delete pGroup;                                // Also deletes the item instances
+            }
+            m_arRetiredGroups.clear();
+        }
+
+
+        //----------------------------------------------------------------------------------------------------------------------
+        // GetBucket
+        //----------------------------------------------------------------------------------------------------------------------
+        void DaSubscriptionManagerImpl::GetBucket(uint32_t dwRevisedUpdateRate, float fPercentDeadband, DaManagedGroupArray& arBucket) const
+        {
+            arBucket.clear();
+            for (DaManagedGroup* pGroup : m_arGroups) {
+                if (pGroup->m_dwRevisedUpdateRate == dwRevisedUpdateRate && pGroup->m_fPercentDeadband == fPercentDeadband) {
+                    arBucket.push_back(pGroup);
+                }
+            }
+        }
+
+
+        //----------------------------------------------------------------------------------------------------------------------
+        // AddToBucket
+        // -----------
+        //    Adds items with the same requested update rate and deadband to the groups of their bucket. Groups are
+        //    created as long as the bucket would exceed the maximum number of items per group and the items are
+        //    distributed so that all groups of the bucket end up with about the same number of items.
+        //----------------------------------------------------------------------------------------------------------------------
+        Technosoftware::Base::Status DaSubscriptionManagerImpl::AddToBucket(uint32_t dwRequestedUpdateRate, float fPercentDeadband,
+            vector<DaManagedItem*>& arItems,
+            const std::function<void(DaManagedItem*, Base::Status)>& pfnErrHandler)
+        {
+            Technosoftware::Base::Status res = Technosoftware::DaAeHdaClient::GetStatusFromHResult(S_OK);
+            DaManagedGroupArray arBucket;
+            size_t i, nDone = 0;
+
+            try {
+                auto rate = m_cRevisedUpdateRates.find(dwRequestedUpdateRate);
+                if (rate == m_cRevisedUpdateRates.end()) {
+                    CreateGroup(dwRequestedUpdateRate, fPercentDeadband);
+                    rate = m_cRevisedUpdateRates.find(dwRequestedUpdateRate);
+                }
+                GetBucket(rate->second, fPercentDeadband, arBucket);
+
+                size_t nTotal = arItems.size();
+                for (DaManagedGroup* pGroup : arBucket) nTotal += pGroup->m_arItems.size();
+
+                size_t nRequired = (nTotal + m_dwMaxItemsPerGroup - 1) / m_dwMaxItemsPerGroup;
+                while (arBucket.size() < nRequired) {
+                    arBucket.push_back(CreateGroup(dwRequestedUpdateRate, fPercentDeadband));
+                }
+
+                // Fill every group up to the average; the sum of the gaps always covers the new items.
+                size_t nTarget = (nTotal + arBucket.size() - 1) / arBucket.size();
+                for (DaManagedGroup* pGroup : arBucket) {
+                    if (nDone == arItems.size()) break;
+                    if (pGroup->m_arItems.size() >= nTarget) continue;
+                    size_t nCount = (std::min)(nTarget - pGroup->m_arItems.size(), arItems.size() - nDone);
+                    Technosoftware::Base::Status resGroup = AddToGroup(pGroup, &arItems[nDone], nCount, pfnErrHandler);
+                    if (resGroup.IsNotGood()) res = resGroup;
+                    nDone += nCount;
+                }
+            }
+            catch (Technosoftware::Base::StatusException& e) {
+                res = e.GetStatus();
+            }
+            catch (Technosoftware::Base::Status& resEx) {
+                res = resEx;
+            }
+            catch (...) {
+                res = Technosoftware::DaAeHdaClient::GetStatusFromHResult(E_FAIL);
+            }
+
+            // Items which were not handled because of an error
+            for (i = nDone; i < arItems.size(); i++) {
+                pfnErrHandler(arItems[i], res);
+            }
+
+            // Do not keep groups which did not get any item
+            for (DaManagedGroup* pGroup : arBucket) {
+                if (pGroup->m_arItems.empty()) DeleteGroup(pGroup);
+            }
+            return res;
+        }
+
+
+        //----------------------------------------------------------------------------------------------------------------------
+        // AddToGroup
+        //----------------------------------------------------------------------------------------------------------------------
+        Technosoftware::Base::Status DaSubscriptionManagerImpl::AddToGroup(DaManagedGroup* pGroup,
+            DaManagedItem** ppItems, size_t nCount,
+            const std::function<void(DaManagedItem*, Base::Status)>& pfnErrHandler)
+        {
+            DaItemDefinitions ItemDefs;
+            vector<DaItem*> arAdded;
+            std::map<Base::ClientHandle, Base::Status> cErrors;
+            size_t i;
+
+            for (i = 0; i < nCount; i++) {
+                Technosoftware::Base::Status resDef = ItemDefs.Add(ppItems[i]->m_sItemIdentifier.c_str(), ppItems[i]->m_hClient);
+                if (resDef.IsNotGood()) cErrors[ppItems[i]->m_hClient] = resDef;
+            }
+
+            Technosoftware::Base::Status res = pGroup->m_pGroup->AddItems(ItemDefs, arAdded,
+                [&cErrors](const DaItemDefinition& def, Base::Status status) { cErrors[def.ClientHandle] = status; });
+
+            for (DaItem* pItem : arAdded) {
+                auto result = m_cManagedItems.find(pItem->GetClientHandle());
+                if (result == m_cManagedItems.end()) continue;
+                result->second->m_pGroup = pGroup;
+                result->second->m_pItem = pItem;
+                pGroup->m_arItems.push_back(pItem);
+            }
+
+            for (i = 0; i < nCount; i++) {
+                if (ppItems[i]->m_pItem) continue;
+                auto error = cErrors.find(ppItems[i]->m_hClient);
+                pfnErrHandler(ppItems[i], (error != cErrors.end()) ? error->second : res);
+            }
+            return res;
+        }
+
+
+        //----------------------------------------------------------------------------------------------------------------------
+        // CompactBucket
+        // -------------
+        //    Dissolves the least filled groups of a bucket until it uses the minimum number of groups, and all groups
+        //    exceeding the maximum number of items. The items of the dissolved groups are added to the remaining
+        //    groups first; the dissolved groups keep notifying until then and are retired afterwards.
+        //----------------------------------------------------------------------------------------------------------------------
+        Technosoftware::Base::Status DaSubscriptionManagerImpl::CompactBucket(uint32_t dwRevisedUpdateRate, float fPercentDeadband)
+        {
+            Technosoftware::Base::Status res = Technosoftware::DaAeHdaClient::GetStatusFromHResult(S_OK);
+            DaManagedGroupArray arBucket;
+            DaManagedGroupArray arDissolved;
+            vector<DaManagedItem*> arMoved;
+            size_t i, nTotal = 0;
+
+            GetBucket(dwRevisedUpdateRate, fPercentDeadband, arBucket);
+            if (arBucket.empty()) return res;
+
+            uint32_t dwRequestedUpdateRate = arBucket[0]->m_dwRequestedUpdateRate;
+            for (DaManagedGroup* pGroup : arBucket) nTotal += pGroup->m_arItems.size();
+            size_t nRequired = (nTotal + m_dwMaxItemsPerGroup - 1) / m_dwMaxItemsPerGroup;
+
+            std::sort(arBucket.begin(), arBucket.end(),
+                [](const DaManagedGroup* a, const DaManagedGroup* b) { return a->m_arItems.size() < b->m_arItems.size(); });
+
+            size_t nDissolve = (arBucket.size() > nRequired) ? arBucket.size() - nRequired : 0;
+            for (i = 0; i < arBucket.size(); i++) {
+                if (i < nDissolve || arBucket[i]->m_arItems.size() > m_dwMaxItemsPerGroup) arDissolved.push_back(arBucket[i]);
+            }
+            if (arDissolved.empty()) return res;
+
+            // The dissolved groups are no longer part of the bucket, but their item instances stay subscribed
+            for (DaManagedGroup* pGroup : arDissolved) {
+                m_arGroups.erase(std::find(m_arGroups.begin(), m_arGroups.end(), pGroup));
+                for (DaItem* pItem : pGroup->m_arItems) {
+                    auto result = m_cManagedItems.find(pItem->GetClientHandle());
+                    if (result == m_cManagedItems.end()) continue;
+                    result->second->m_pGroup = nullptr;
+                    result->second->m_pItem = nullptr;
+                    arMoved.push_back(result->second);
+                }
+            }
+
+            // Moved items which cannot be added are no longer subscribed
+            Technosoftware::Base::Status resMove = Technosoftware::DaAeHdaClient::GetStatusFromHResult(S_OK);
+            if (!arMoved.empty()) {
+                resMove = AddToBucket(dwRequestedUpdateRate, fPercentDeadband, arMoved,
+                    [this](DaManagedItem* pItem, Base::Status) {
+                        m_cManagedItems.erase(pItem->m_hClient);
+                        delete pItem;
+                    });
+            }
+
+            for (DaManagedGroup* pGroup : arDissolved) {
+                RetireGroup(pGroup);
+            }
+            return resMove.IsNotGood() ? resMove : res;
+        }
+
+
+        //----------------------------------------------------------------------------------------------------------------------
+        // DaIDataCallback functions
+        // -------------------------
+        //    Notifications of all managed groups are forwarded to the one user callback.
+        //----------------------------------------------------------------------------------------------------------------------
+        void DaSubscriptionManagerImpl::DataChange(uint32_t dwTransid, DaGroup* pGroup, bool fAllQualitiesGood, bool fAllResultsOk, uint32_t dwCount, DaItem** ppItems)
+        {
+            m_pIUserDataCallback->DataChange(dwTransid, pGroup, fAllQualitiesGood, fAllResultsOk, dwCount, ppItems);
+        }
+
+        void DaSubscriptionManagerImpl::ReadComplete(uint32_t dwTransid, DaGroup* pGroup, bool fAllQualitiesGood, bool fAllResultsOk, uint32_t dwCount, DaItem** ppItems)
+        {
+            m_pIUserDataCallback->ReadComplete(dwTransid, pGroup, fAllQualitiesGood, fAllResultsOk, dwCount, ppItems);
+        }
+
+        void DaSubscriptionManagerImpl::WriteComplete(uint32_t dwTransid, DaGroup* pGroup, bool fAllResultsOk, uint32_t dwCount, DaItem** ppItems)
+        {
+            m_pIUserDataCallback->WriteComplete(dwTransid, pGroup, fAllResultsOk, dwCount, ppItems);
+        }
+
+        void DaSubscriptionManagerImpl::CancelComplete(uint32_t dwTransid, DaGroup* pGroup)
+        {
+            m_pIUserDataCallback->CancelComplete(dwTransid, pGroup);
+        }
+    }
+}
@@ -0,0 +1,115 @@
+/*
+ * Copyright (c) 2011-2021 Technosoftware GmbH. All rights reserved
+ * Web: https://technosoftware.com
+ *
+ * Purpose:
+ *
+ * This file is provided AS IS with NO WARRANTY OF ANY KIND, INCLUDING THE
+ * WARRANTY OF DESIGN, MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+
+
+#ifndef __DaSUBSCRIPTIONMANAGERIMPL_H
+#define __DaSUBSCRIPTIONMANAGERIMPL_H
+
+#include "Base/Status.h"
+#include "Base/FlatHashMap.h"
+#include "Base/Mutex.h"
+#include "DaAeHdaClient/OpcBase.h"
+#include "DaAeHdaClient/Da/DaItem.h"
+#include "DaAeHdaClient/Da/DaSubscriptionManager.h"
+
+#include <map>
+
+namespace Technosoftware
+{
+    namespace DaAeHdaClient
+    {
+        class DaServer;
+        class DaGroup;
+
+        //----------------------------------------------------------------------------------------------------------------------
+        // STRUCT DaManagedGroup
+        //----------------------------------------------------------------------------------------------------------------------
+        struct DaManagedGroup
+        {
+            DaGroup*                   m_pGroup;
+            uint32_t                   m_dwRequestedUpdateRate;
+            uint32_t                   m_dwRevisedUpdateRate;     // Bucket key together with the deadband
+            float                      m_fPercentDeadband;
+            vector<DaItem*>            m_arItems;
+        };
+
+
+        //----------------------------------------------------------------------------------------------------------------------
+        // STRUCT DaManagedItem
+        //----------------------------------------------------------------------------------------------------------------------
+        struct DaManagedItem
+        {
+            string                     m_sItemIdentifier;
+            Base::ClientHandle         m_hClient;
+            uint32_t                   m_dwRequestedUpdateRate;
+            float                      m_fPercentDeadband;
+            DaManagedGroup*            m_pGroup;
+            DaItem*                    m_pItem;
+        };
+
+
+        //----------------------------------------------------------------------------------------------------------------------
+        // CLASS DaSubscriptionManagerImpl
+        //----------------------------------------------------------------------------------------------------------------------
+        class DaSubscriptionManagerImpl : public DaIDataCallback
+        {
+            // Construction / Destruction
+        public:
+            DaSubscriptionManagerImpl(DaServer* pServer, DaIDataCallback* pIUserDataCallback, uint32_t dwMaxItemsPerGroup) noexcept(false);
+            ~DaSubscriptionManagerImpl() noexcept;
+
+            // Operations
+            inline Technosoftware::Base::Status AddItems(const vector<DaSubscriptionItem>& arItems,
+                const std::function<void(const DaSubscriptionItem&, Base::Status)>& pfnErrHandler);
+            inline Technosoftware::Base::Status RemoveItems(const vector<Base::ClientHandle>& arClientHandles);
+            inline void RemoveAllItems() noexcept;
+            inline Technosoftware::Base::Status Rebalance();
+            inline Technosoftware::Base::Status SetActive(bool fActive);
+
+            // DaIDataCallback functions, forwarded to the user callback
+            void DataChange(uint32_t dwTransid, DaGroup* pGroup, bool fAllQualitiesGood, bool fAllResultsOk, uint32_t dwCount, DaItem** ppItems);
+            void ReadComplete(uint32_t dwTransid, DaGroup* pGroup, bool fAllQualitiesGood, bool fAllResultsOk, uint32_t dwCount, DaItem** ppItems);
+            void WriteComplete(uint32_t dwTransid, DaGroup* pGroup, bool fAllResultsOk, uint32_t dwCount, DaItem** ppItems);
+            void CancelComplete(uint32_t dwTransid, DaGroup* pGroup);
+
+            // Implementation
+        protected:
+            friend class DaSubscriptionManager;
+
+            typedef vector<DaManagedGroup*> DaManagedGroupArray;
+
+            DaManagedGroup* CreateGroup(uint32_t dwRequestedUpdateRate, float fPercentDeadband) noexcept(false);
+            void DeleteGroup(DaManagedGroup* pGroup) noexcept;
+            void RetireGroup(DaManagedGroup* pGroup) noexcept;
+            void DeleteRetiredGroups(bool fForce) noexcept;
+            void GetBucket(uint32_t dwRevisedUpdateRate, float fPercentDeadband, DaManagedGroupArray& arBucket) const;
+            Technosoftware::Base::Status AddToBucket(uint32_t dwRequestedUpdateRate, float fPercentDeadband,
+                vector<DaManagedItem*>& arItems,
+                const std::function<void(DaManagedItem*, Base::Status)>& pfnErrHandler);
+            Technosoftware::Base::Status AddToGroup(DaManagedGroup* pGroup,
+                DaManagedItem** ppItems, size_t nCount,
+                const std::function<void(DaManagedItem*, Base::Status)>& pfnErrHandler);
+            Technosoftware::Base::Status CompactBucket(uint32_t dwRevisedUpdateRate, float fPercentDeadband);
+
+            DaServer*                                       m_pServer;
+            DaIDataCallback*                                m_pIUserDataCallback;
+            uint32_t                                        m_dwMaxItemsPerGroup;
+            uint32_t                                        m_dwNextGroupHandle;    // Client handle of the next group
+            DaManagedGroupArray                             m_arGroups;
+            vector<DaGroup*>                                m_arRetiredGroups;      // Unsubscribed, deleted when no callback runs
+            Base::FlatHashMap<Base::ClientHandle, DaManagedItem*> m_cManagedItems;
+            std::map<uint32_t, uint32_t>                    m_cRevisedUpdateRates;  // Requested -> revised rate
+            mutable Base::FastMutex                         m_Lock;
+        };
+
+    }
+}
+#endif // __DaSUBSCRIPTIONMANAGERIMPL_H
@@ -0,0 +1,229 @@
+/*
+ * Copyright (c) 2011-2021 Technosoftware GmbH. All rights reserved
+ * Web: https://www.technosoftware.com
+ *
+ * The source code in this file is covered under a dual-license scenario:
+ *   - Owner of a purchased license: SCLA 1.0
+ *   - GPL V3: everybody else
+ *
+ * SCLA license terms accompanied with this source code.
+ * See SCLA 1.0: https://technosoftware.com/license/Source_Code_License_Agreement.pdf
+ *
+ * GNU General Public License as published by the Free Software Foundation;
+ * version 3 of the License are accompanied with this source code.
+ * See https://technosoftware.com/license/GPLv3License.txt
+ *
+ * This source code is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#include "OpcInternal.h"
+#include "DaAeHdaClient/Da/DaValueHistory.h"
+#include "DaAeHdaClient/Da/DaItem.h"
+
+#include "Base/Exception.h"
+
+#include <new>
+
+
+namespace Technosoftware
+{
+    namespace DaAeHdaClient
+    {
+        static const size_t CacheLineSize = 64;
+
+        //----------------------------------------------------------------------------------------------------------------------
+        // GetScalarSize
+        //    The size of types whose value fits into the 8 byte payload of a VARIANT, 0 for all other types. Only these
+        //    bytes of the payload are defined.
+        //----------------------------------------------------------------------------------------------------------------------
+        static inline uint32_t GetScalarSize(VARTYPE vt)
+        {
+            switch (vt) {
+            case VT_I1: case VT_UI1:
+                return 1;
+            case VT_I2: case VT_UI2: case VT_BOOL:
+                return 2;
+            case VT_I4: case VT_UI4: case VT_INT: case VT_UINT: case VT_R4: case VT_ERROR:
+                return 4;
+            case VT_I8: case VT_UI8: case VT_R8: case VT_CY: case VT_DATE:
+                return 8;
+            default:
+                return 0;
+            }
+        }
+
+
+        //----------------------------------------------------------------------------------------------------------------------
+        // Constructor
+        //----------------------------------------------------------------------------------------------------------------------
+        DaValueHistory::DaValueHistory(uint32_t maxItems, uint32_t depth) noexcept(false)
+        {
+            if (maxItems == 0 || depth == 0) throw Technosoftware::Base::InvalidArgumentException();
+
+            maxItems_ = maxItems;
+            depth_ = depth;
+
+            // Each ring starts on its own cache line so that rings of different items never share one.
+            stride_ = (HeaderSize + (size_t)depth * sizeof(DaValueSample) + CacheLineSize - 1) & ~(CacheLineSize - 1);
+
+            memory_ = new (std::nothrow) unsigned char[stride_ * maxItems + CacheLineSize];
+            if (!memory_) throw Technosoftware::Base::OutOfMemoryException();
+            arena_ = reinterpret_cast<unsigned char*>((reinterpret_cast<uintptr_t>(memory_) + CacheLineSize - 1) & ~(uintptr_t)(CacheLineSize - 1));
+
+            freeSlots_ = new (std::nothrow) uint32_t[maxItems];
+            if (!freeSlots_) {
+                delete[] memory_;
+                throw Technosoftware::Base::OutOfMemoryException();
+            }
+
+            for (uint32_t i = 0; i < maxItems; i++) {
+                SlotHeader* header = GetSlot(i);
+                new (&header->sequence) std::atomic<uint32_t>(0);
+                header->written = 0;
+                freeSlots_[i] = maxItems - 1 - i;            // Hand out the slots in ascending order
+            }
+            freeSlotCount_ = maxItems;
+        }
+
+
+        //----------------------------------------------------------------------------------------------------------------------
+        // Destructor
+        //----------------------------------------------------------------------------------------------------------------------
+        DaValueHistory::~DaValueHistory() noexcept
+        {
+            delete[] freeSlots_;
+            delete[] memory_;
+        }
+
+
+        //----------------------------------------------------------------------------------------------------------------------
+        // GetLatest
+        //----------------------------------------------------------------------------------------------------------------------
+        bool DaValueHistory::GetLatest(const DaItem* item, DaValueSample& sample) const noexcept
+        {
+            if (!item || item->valueHistorySlot_ == NoSlot) return false;
+            return Read(item->valueHistorySlot_, &sample, 1) == 1;
+        }
+
+
+        //----------------------------------------------------------------------------------------------------------------------
+        // GetLast
+        //----------------------------------------------------------------------------------------------------------------------
+        uint32_t DaValueHistory::GetLast(const DaItem* item, DaValueSample* samples, uint32_t count) const noexcept
+        {
+            if (!item || !samples || item->valueHistorySlot_ == NoSlot) return 0;
+            return Read(item->valueHistorySlot_, samples, count);
+        }
+
+
+        //----------------------------------------------------------------------------------------------------------------------
+        // ToVariant
+        //----------------------------------------------------------------------------------------------------------------------
+        void DaValueHistory::ToVariant(const DaValueSample& sample, VARIANT* value) noexcept
+        {
+            VariantInit(value);
+            value->vt = sample.DataType;
+            value->llVal = 0;
+            memcpy(&value->llVal, &sample.Value, GetScalarSize(sample.DataType));
+        }
+
+
+        //----------------------------------------------------------------------------------------------------------------------
+        // FromVariant
+        //----------------------------------------------------------------------------------------------------------------------
+        bool DaValueHistory::FromVariant(const VARIANT* value, DaValueSample& sample) noexcept
+        {
+            uint32_t size = GetScalarSize(value->vt);
+            if (size) {
+                sample.DataType = value->vt;
+                sample.Value = 0;
+                memcpy(&sample.Value, &value->llVal, size);
+                return true;
+            }
+            sample.DataType = VT_EMPTY;
+            sample.Value = 0;
+            return false;
+        }
+
+
+        //----------------------------------------------------------------------------------------------------------------------
+        // AllocateSlot / ReleaseSlot
+        //    Only used when items are added or removed, so a mutex is sufficient.
+        //----------------------------------------------------------------------------------------------------------------------
+        uint32_t DaValueHistory::AllocateSlot() noexcept
+        {
+            Base::FastMutex::ScopedLock lock(mutex_);
+            if (freeSlotCount_ == 0) return NoSlot;
+            return freeSlots_[--freeSlotCount_];
+        }
+
+        void DaValueHistory::ReleaseSlot(uint32_t slot) noexcept
+        {
+            SlotHeader* header = GetSlot(slot);
+            uint32_t sequence = header->sequence.load(std::memory_order_relaxed);
+            header->sequence.store(sequence + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            header->written = 0;
+            header->sequence.store(sequence + 2, std::memory_order_release);
+
+            Base::FastMutex::ScopedLock lock(mutex_);
+            freeSlots_[freeSlotCount_++] = slot;
+        }
+
+
+        //----------------------------------------------------------------------------------------------------------------------
+        // Record
+        //    Called by the data callback, the only writer of a ring.
+        //----------------------------------------------------------------------------------------------------------------------
+        void DaValueHistory::Record(uint32_t slot, const VARIANT* value, const FILETIME* timeStamp, uint16_t quality) noexcept
+        {
+            SlotHeader* header = GetSlot(slot);
+            DaValueSample* sample = GetSamples(header) + (header->written % depth_);
+
+            uint32_t sequence = header->sequence.load(std::memory_order_relaxed);
+            header->sequence.store(sequence + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+
+            sample->TimeStamp = Base::Timestamp::FromFileTime(timeStamp->dwLowDateTime, timeStamp->dwHighDateTime).GetEpochMicroseconds();
+            sample->Quality = quality;
+            sample->Reserved = 0;
+            FromVariant(value, *sample);
+            header->written++;
+
+            header->sequence.store(sequence + 2, std::memory_order_release);
+        }
+
+
+        //----------------------------------------------------------------------------------------------------------------------
+        // Read
+        //    Copies the last samples of a ring. The copy is retried if the writer updated the ring meanwhile.
+        //----------------------------------------------------------------------------------------------------------------------
+        uint32_t DaValueHistory::Read(uint32_t slot, DaValueSample* samples, uint32_t count) const noexcept
+        {
+            SlotHeader* header = GetSlot(slot);
+            const DaValueSample* ring = GetSamples(header);
+
+            for (;;) {
+                uint32_t sequence = header->sequence.load(std::memory_order_acquire);
+                if (sequence & 1) {
+                    YieldProcessor();                        // Writer active
+                    continue;
+                }
+
+                uint64_t written = header->written;
+                uint32_t available = (written < depth_) ? (uint32_t)written : depth_;
+                uint32_t n = (count < available) ? count : available;
+                for (uint32_t i = 0; i < n; i++) {
+                    samples[i] = ring[(written - n + i) % depth_];
+                }
+
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (header->sequence.load(std::memory_order_relaxed) == sequence) {
+                    return n;
+                }
+            }
+        }
+    }
+}
@@ -365,21 +365,21 @@ namespace Technosoftware
                     return Technosoftware::DaAeHdaClient::GetStatusFromHResult(E_NOTIMPL);
                 }
 
-                USES_CONVERSION;
                 if (fMachineNameAsPrefix) {
-                    TCHAR szComputerName[MAX_COMPUTERNAME_LENGTH + 1];
+                    WCHAR szComputerName[MAX_COMPUTERNAME_LENGTH + 1];
                     DWORD dwNameLen = _countof(szComputerName);
 
-                    if (!GetComputerName(szComputerName, &dwNameLen)) {
+                    if (!GetComputerNameW(szComputerName, &dwNameLen)) {
                         return Technosoftware::DaAeHdaClient::GetStatusFromHResult(HRESULT_FROM_WIN32(GetLastError()));
                     }
                     sRegisterName = "\\\\";
-                    sRegisterName += T2A(szComputerName);
+                    sRegisterName += OpcStringConversion::ToString(szComputerName);
                     sRegisterName += "\\";
                 }
                 sRegisterName += sClientName;
 
-                return Technosoftware::DaAeHdaClient::GetStatusFromHResult(m_pIOPCCommon->SetClientName(A2CW(sRegisterName.c_str())),Base::StatusCode::HdaFuncCall);
+                OpcStringConversion conversion;
+                return Technosoftware::DaAeHdaClient::GetStatusFromHResult(m_pIOPCCommon->SetClientName(conversion.ToWide(sRegisterName)),Base::StatusCode::HdaFuncCall);
             }
             catch (...) {
                 return Technosoftware::DaAeHdaClient::GetStatusFromHResult(E_OUTOFMEMORY);
@@ -511,9 +511,8 @@ namespace Technosoftware
 			{
 				for (dwIndex = 0L; dwIndex < count; dwIndex++)
 				{
-					USES_CONVERSION;
-					string name = OLE2A(attributeNames[dwIndex]);
-					string description = OLE2A(attributeDescriptions[dwIndex]);
+					string name = OpcStringConversion::ToString(attributeNames[dwIndex]);
+					string description = OpcStringConversion::ToString(attributeDescriptions[dwIndex]);
 
 					HdaItemAttribute itemAttribute(attributeIds[dwIndex], name, description, attributeDataTypes[dwIndex]);
 					hdaitemAtttributes.push_back(itemAttribute);
@@ -573,9 +572,8 @@ namespace Technosoftware
 			{
 				for (dwIndex = 0L; dwIndex < count; dwIndex++)
 				{
-					USES_CONVERSION;
-					string name = OLE2A(aggregateNames[dwIndex]);
-					string description = OLE2A(aggregateDescriptions[dwIndex]);
+					string name = OpcStringConversion::ToString(aggregateNames[dwIndex]);
+					string description = OpcStringConversion::ToString(aggregateDescriptions[dwIndex]);
 
 					HdaAggregate aggregate(aggregateIds[dwIndex], name, description);
 					hdaAggregates.push_back(aggregate);
@@ -738,7 +736,6 @@ namespace Technosoftware
                 &pwMajorVersion, &pwMinorVersion, &pwBuildNumber,
                 &pdwMaxReturnValues, &pszStatusString, &pszVendorInfo);
             if (SUCCEEDED(hr)) {
-                USES_CONVERSION;
                 pStatus->m_ftStartTime = *(Base::Timestamp*)&pftStartTime;
                 pStatus->m_ftCurrentTime = *(Base::Timestamp*)&pftCurrentTime;
                 switch (pwStatus) {
@@ -756,7 +753,7 @@ namespace Technosoftware
                 pStatus->m_wMajorVersion = pwMajorVersion;
                 pStatus->m_wMinorVersion = pwMinorVersion;
                 pStatus->m_wBuildNumber = pwBuildNumber;
-                pStatus->m_sVendorInfo = OLE2A(pszVendorInfo);
+                OpcStringConversion::ToString(pszVendorInfo, pStatus->m_sVendorInfo);
 
                 if (pftStartTime)
                     CoTaskMemFree(pftStartTime);
@@ -788,10 +785,10 @@ namespace Technosoftware
 
             // setup function parameters
             dwCount = 1;
-            // SzItemID, szAccessPath and blob_
-            USES_CONVERSION;
-            bstrItemID = _wcsdup(A2W(itemId));
-            if (!bstrItemID) throw Technosoftware::Base::OutOfMemoryException();
+            // The item ID is only needed during the call
+            OpcStringConversion conversion;
+            bstrItemID = conversion.ToWide(itemId);
+            if (!bstrItemID) throw Technosoftware::Base::InvalidArgumentException();
             phClient = 1;
             phServer = NULL;
             pErrors = NULL;
@@ -808,8 +805,6 @@ namespace Technosoftware
 
             ///////////////////////////////////////
             // cleanup
-            if (bstrItemID)
-                free(bstrItemID);
             if (phServer)
                 ::CoTaskMemFree(phServer);
             if (pErrors)
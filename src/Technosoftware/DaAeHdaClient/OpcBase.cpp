@@ -167,8 +167,7 @@ namespace Technosoftware
         STDMETHODIMP CComOPCShutdownImpl::ShutdownRequest(
             /* [in] */           LPCWSTR     szReason)
         {
-            USES_CONVERSION;
-            m_pfnShutdownRequestSink(string(W2A(szReason)));
+            m_pfnShutdownRequestSink(OpcStringConversion::ToString(szReason));
             return S_OK;                                 // Must be be always S_OK
         }
     }
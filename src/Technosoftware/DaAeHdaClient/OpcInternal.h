@@ -32,6 +32,7 @@ using std::transform;
 
 #include "DaAeHdaClient/OpcBase.h"
 #include "OpcUti.h"
+#include "OpcStringConversion.h"
 #include "OpcDefs.h"
 
 namespace Technosoftware
@@ -0,0 +1,264 @@
+/*
+ * Copyright (c) 2011-2021 Technosoftware GmbH. All rights reserved
+ * Web: https://www.technosoftware.com
+ *
+ * The source code in this file is covered under a dual-license scenario:
+ *   - Owner of a purchased license: SCLA 1.0
+ *   - GPL V3: everybody else
+ *
+ * SCLA license terms accompanied with this source code.
+ * See SCLA 1.0: https://technosoftware.com/license/Source_Code_License_Agreement.pdf
+ *
+ * GNU General Public License as published by the Free Software Foundation;
+ * version 3 of the License are accompanied with this source code.
+ * See https://technosoftware.com/license/GPLv3License.txt
+ *
+ * This source code is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#include "OpcInternal.h"
+#include "Base/UnicodeConverter.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <cwchar>
+#include <memory>
+#include <vector>
+
+using namespace Technosoftware::Base;
+
+namespace Technosoftware
+{
+    namespace DaAeHdaClient
+    {
+        namespace
+        {
+            const std::size_t SCRATCH_BLOCK_SIZE = 4096;          // Size of the first block
+            const std::size_t SCRATCH_MAX_RETAINED = 1024 * 1024;  // Memory kept by an idle thread
+            const std::size_t SCRATCH_ALIGNMENT = 8;
+
+            /**
+             * @class   ScratchBuffer
+             *
+             * @brief   Stack like allocator made of blocks with doubling sizes. Memory is only released
+             *          by rolling back to an earlier fill level, blocks are kept for the next conversions.
+             *          Used only internally.
+             */
+
+            class ScratchBuffer
+            {
+            public:
+                ScratchBuffer() : block_(0), used_(0)
+                {
+                }
+
+                void* Allocate(std::size_t size)
+                {
+                    size = (size + SCRATCH_ALIGNMENT - 1) & ~(SCRATCH_ALIGNMENT - 1);
+                    while (block_ < blocks_.size())
+                    {
+                        Block& block = blocks_[block_];
+                        if (block.size - used_ >= size)
+                        {
+                            char* p = block.data.get() + used_;
+                            used_ += size;
+                            return p;
+                        }
+                        // Later blocks are larger, the remainder of this one is skipped until rollback
+                        if (block_ + 1 == blocks_.size()) break;
+                        ++block_;
+                        used_ = 0;
+                    }
+
+                    std::size_t blockSize = blocks_.empty() ? SCRATCH_BLOCK_SIZE : 2 * blocks_.back().size;
+                    while (blockSize < size) blockSize *= 2;
+                    Block block;
+                    block.data.reset(new char[blockSize]);
+                    block.size = blockSize;
+                    blocks_.push_back(std::move(block));
+                    block_ = blocks_.size() - 1;
+                    used_ = size;
+                    return blocks_.back().data.get();
+                }
+
+                void GetMark(std::size_t& block, std::size_t& used) const noexcept
+                {
+                    block = block_;
+                    used = used_;
+                }
+
+                void Rollback(std::size_t block, std::size_t used) noexcept
+                {
+                    block_ = block;
+                    used_ = used;
+                    if (block == 0 && used == 0)
+                    {
+                        // Nothing is in use any more; give back what a single large batch has grown
+                        std::size_t retained = 0;
+                        std::size_t count = 0;
+                        while (count < blocks_.size() && retained + blocks_[count].size <= SCRATCH_MAX_RETAINED)
+                        {
+                            retained += blocks_[count].size;
+                            ++count;
+                        }
+                        blocks_.resize(count);
+                    }
+                }
+
+            private:
+                struct Block
+                {
+                    std::unique_ptr<char[]> data;
+                    std::size_t             size;
+                };
+
+                std::vector<Block>  blocks_;
+                std::size_t         block_;             // Index of the block in use
+                std::size_t         used_;              // Bytes used in blocks_[block_]
+            };
+
+            thread_local ScratchBuffer scratchBuffer;
+
+            /**
+             * @fn  std::size_t WideLength(const char* utf8String, std::size_t length, bool& utf8)
+             *
+             * @brief   Number of wide characters required for the given string. Strings which are not
+             *          valid UTF-8 are converted with the ANSI code page. Used only internally.
+             *
+             * @param           utf8String  The string.
+             * @param           length      The length of the string in bytes.
+             * @param [out]     utf8        false if the ANSI code page must be used.
+             *
+             * @return  The number of wide characters.
+             */
+
+            std::size_t WideLength(const char* utf8String, std::size_t length, bool& utf8)
+            {
+                std::size_t wideLength = UnicodeConverter::UTF16Length(utf8String, length);
+                utf8 = wideLength != UnicodeConverter::INVALID_LENGTH;
+                if (!utf8)
+                {
+                    wideLength = static_cast<std::size_t>(::MultiByteToWideChar(CP_ACP, 0, utf8String, static_cast<int>(length), nullptr, 0));
+                }
+                return wideLength;
+            }
+
+            void TranscodeToWide(const char* utf8String, std::size_t length, bool utf8, LPWSTR wideString, std::size_t wideLength)
+            {
+                if (utf8)
+                {
+                    UnicodeConverter::Transcode(utf8String, length, wideString);
+                }
+                else
+                {
+                    ::MultiByteToWideChar(CP_ACP, 0, utf8String, static_cast<int>(length), wideString, static_cast<int>(wideLength));
+                }
+                wideString[wideLength] = L'\0';
+            }
+        }
+
+
+        OpcStringConversion::OpcStringConversion() noexcept
+        {
+            scratchBuffer.GetMark(block_, used_);
+        }
+
+
+        OpcStringConversion::~OpcStringConversion()
+        {
+            scratchBuffer.Rollback(block_, used_);
+        }
+
+
+        LPWSTR OpcStringConversion::ToWide(const char* utf8String)
+        {
+            if (utf8String == nullptr) return nullptr;
+
+            std::size_t length = std::strlen(utf8String);
+            bool utf8;
+            std::size_t wideLength = WideLength(utf8String, length, utf8);
+            LPWSTR wideString = static_cast<LPWSTR>(scratchBuffer.Allocate((wideLength + 1) * sizeof(WCHAR)));
+            TranscodeToWide(utf8String, length, utf8, wideString, wideLength);
+            return wideString;
+        }
+
+
+        LPWSTR OpcStringConversion::ToWide(const std::string& utf8String)
+        {
+            bool utf8;
+            std::size_t wideLength = WideLength(utf8String.data(), utf8String.size(), utf8);
+            LPWSTR wideString = static_cast<LPWSTR>(scratchBuffer.Allocate((wideLength + 1) * sizeof(WCHAR)));
+            TranscodeToWide(utf8String.data(), utf8String.size(), utf8, wideString, wideLength);
+            return wideString;
+        }
+
+
+        const char* OpcStringConversion::ToUtf8(LPCWSTR wideString)
+        {
+            if (wideString == nullptr) return nullptr;
+
+            std::size_t length = std::wcslen(wideString);
+            std::size_t utf8Length = UnicodeConverter::UTF8Length(wideString, length);
+            char* utf8String;
+            if (utf8Length != UnicodeConverter::INVALID_LENGTH)
+            {
+                utf8String = static_cast<char*>(scratchBuffer.Allocate(utf8Length + 1));
+                UnicodeConverter::Transcode(wideString, length, utf8String);
+            }
+            else
+            {
+                // Unpaired surrogates are replaced by U+FFFD
+                utf8Length = static_cast<std::size_t>(::WideCharToMultiByte(CP_UTF8, 0, wideString, static_cast<int>(length), nullptr, 0, nullptr, nullptr));
+                utf8String = static_cast<char*>(scratchBuffer.Allocate(utf8Length + 1));
+                ::WideCharToMultiByte(CP_UTF8, 0, wideString, static_cast<int>(length), utf8String, static_cast<int>(utf8Length), nullptr, nullptr);
+            }
+            utf8String[utf8Length] = '\0';
+            return utf8String;
+        }
+
+
+        std::string OpcStringConversion::ToString(LPCWSTR wideString)
+        {
+            std::string utf8String;
+            ToString(wideString, utf8String);
+            return utf8String;
+        }
+
+
+        void OpcStringConversion::ToString(LPCWSTR wideString, std::string& utf8String)
+        {
+            if (wideString == nullptr)
+            {
+                utf8String.clear();
+                return;
+            }
+
+            std::size_t length = std::wcslen(wideString);
+            if (!UnicodeConverter::TryConvert(wideString, length, utf8String))
+            {
+                int utf8Length = ::WideCharToMultiByte(CP_UTF8, 0, wideString, static_cast<int>(length), nullptr, 0, nullptr, nullptr);
+                utf8String.resize(static_cast<std::size_t>(utf8Length));
+                if (utf8Length > 0)
+                {
+                    ::WideCharToMultiByte(CP_UTF8, 0, wideString, static_cast<int>(length), &utf8String[0], utf8Length, nullptr, nullptr);
+                }
+            }
+        }
+
+
+        LPWSTR OpcStringConversion::DuplicateWide(const char* utf8String)
+        {
+            if (utf8String == nullptr) return nullptr;
+
+            std::size_t length = std::strlen(utf8String);
+            bool utf8;
+            std::size_t wideLength = WideLength(utf8String, length, utf8);
+            LPWSTR wideString = static_cast<LPWSTR>(std::malloc((wideLength + 1) * sizeof(WCHAR)));
+            if (wideString == nullptr) return nullptr;
+            TranscodeToWide(utf8String, length, utf8, wideString, wideLength);
+            return wideString;
+        }
+    }
+}
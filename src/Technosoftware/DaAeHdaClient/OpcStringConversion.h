@@ -0,0 +1,152 @@
+/*
+ * Copyright (c) 2011-2021 Technosoftware GmbH. All rights reserved
+ * Web: https://www.technosoftware.com
+ *
+ * The source code in this file is covered under a dual-license scenario:
+ *   - Owner of a purchased license: SCLA 1.0
+ *   - GPL V3: everybody else
+ *
+ * SCLA license terms accompanied with this source code.
+ * See SCLA 1.0: https://technosoftware.com/license/Source_Code_License_Agreement.pdf
+ *
+ * GNU General Public License as published by the Free Software Foundation;
+ * version 3 of the License are accompanied with this source code.
+ * See https://technosoftware.com/license/GPLv3License.txt
+ *
+ * This source code is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.
+ */
+
+#ifndef TECHNOSOFTWARE_OPCSTRINGCONVERSION_H
+#define TECHNOSOFTWARE_OPCSTRINGCONVERSION_H
+
+#include <string>
+
+namespace Technosoftware
+{
+    namespace DaAeHdaClient
+    {
+        /**
+         * @class   OpcStringConversion
+         *
+         * @brief   Converts between the UTF-8 strings of the client API and the wide strings of the COM
+         *          interfaces. Replaces the ATL conversion macros (USES_CONVERSION, A2W, W2A, OLE2A).
+         *
+         *          The wide strings returned by ToWide() and the UTF-8 strings returned by ToUtf8() are
+         *          stored in a growable scratch buffer of the calling thread instead of on the stack. They
+         *          stay valid until the OpcStringConversion object which returned them is destroyed; the
+         *          memory is then reused by the next conversion on this thread. Objects must therefore
+         *          be destroyed in reverse order of construction, which local variables always are.
+         *
+         *          Strings which are not valid UTF-8 are converted with the ANSI code page, as the ATL
+         *          macros did.
+         *
+         * @ingroup DaAeHdaClient
+         */
+
+        class OpcStringConversion
+        {
+        public:
+
+            /**
+             * @fn  OpcStringConversion::OpcStringConversion() noexcept;
+             *
+             * @brief   Remembers the fill level of the scratch buffer of the calling thread.
+             */
+
+            OpcStringConversion() noexcept;
+
+            /**
+             * @fn  OpcStringConversion::~OpcStringConversion();
+             *
+             * @brief   Releases all strings returned by this object.
+             */
+
+            ~OpcStringConversion();
+
+            /**
+             * @fn  LPWSTR OpcStringConversion::ToWide(const char* utf8String);
+             *
+             * @brief   Converts a zero terminated UTF-8 string into a wide string in the scratch buffer.
+             *
+             * @param   utf8String  The UTF-8 string.
+             *
+             * @return  The zero terminated wide string or nullptr if utf8String is nullptr.
+             */
+
+            LPWSTR ToWide(const char* utf8String);
+
+            /**
+             * @fn  LPWSTR OpcStringConversion::ToWide(const std::string& utf8String);
+             *
+             * @brief   Converts an UTF-8 string into a wide string in the scratch buffer.
+             *
+             * @param   utf8String  The UTF-8 string.
+             *
+             * @return  The zero terminated wide string.
+             */
+
+            LPWSTR ToWide(const std::string& utf8String);
+
+            /**
+             * @fn  const char* OpcStringConversion::ToUtf8(LPCWSTR wideString);
+             *
+             * @brief   Converts a zero terminated wide string into an UTF-8 string in the scratch buffer.
+             *
+             * @param   wideString  The wide string.
+             *
+             * @return  The zero terminated UTF-8 string or nullptr if wideString is nullptr.
+             */
+
+            const char* ToUtf8(LPCWSTR wideString);
+
+            /**
+             * @fn  static std::string OpcStringConversion::ToString(LPCWSTR wideString);
+             *
+             * @brief   Converts a zero terminated wide string into an UTF-8 string.
+             *
+             * @param   wideString  The wide string.
+             *
+             * @return  The UTF-8 string; empty if wideString is nullptr.
+             */
+
+            static std::string ToString(LPCWSTR wideString);
+
+            /**
+             * @fn  static void OpcStringConversion::ToString(LPCWSTR wideString, std::string& utf8String);
+             *
+             * @brief   Converts a zero terminated wide string directly into the given string, without an
+             *          intermediate copy.
+             *
+             * @param           wideString  The wide string.
+             * @param [out]     utf8String  The UTF-8 string; empty if wideString is nullptr.
+             */
+
+            static void ToString(LPCWSTR wideString, std::string& utf8String);
+
+            /**
+             * @fn  static LPWSTR OpcStringConversion::DuplicateWide(const char* utf8String);
+             *
+             * @brief   Converts a zero terminated UTF-8 string directly into a wide string allocated with
+             *          malloc(), as _wcsdup() would return it.
+             *
+             * @param   utf8String  The UTF-8 string.
+             *
+             * @return  The wide string which must be released with free(), or nullptr if utf8String is
+             *          nullptr or no memory is available.
+             */
+
+            static LPWSTR DuplicateWide(const char* utf8String);
+
+        private:
+            OpcStringConversion(const OpcStringConversion&);
+            OpcStringConversion& operator = (const OpcStringConversion&);
+
+            std::size_t block_;                         // Fill level of the scratch buffer at construction
+            std::size_t used_;
+        };
+    }
+}
+
+#endif // TECHNOSOFTWARE_OPCSTRINGCONVERSION_H